@@ -12,6 +12,8 @@ class Window;
 class Device;
 class DeviceContext;
 class Actor;
+struct CullingStats;
+class TextureStreamer;
 
 class 
 GUI {
@@ -62,6 +64,22 @@ public:
   void
   outliner(const std::vector<EU::TSharedPointer<Actor>>& actors);
 
+  /**
+   * @brief Ventana con los contadores de render del frame (FPS y frustum culling).
+   * @param cullingStats Culling por malla.
+   * @param meshletStats Culling por meshlets de las mallas visibles.
+   */
+  void
+  renderStats(const CullingStats& cullingStats, const CullingStats& meshletStats);
+
+  /**
+   * @brief Ventana de streaming de texturas: presupuesto de VRAM (editable) y
+   *        residencia de mips de cada textura.
+   * @param streamer Streamer cuyo presupuesto y estado se muestran.
+   */
+  void
+  textureStreaming(TextureStreamer& streamer);
+
   void 
   editTransform(const XMMATRIX& view, const XMMATRIX& projection, EU::TSharedPointer<Actor> actor);
 
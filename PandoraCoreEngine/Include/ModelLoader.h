@@ -1,9 +1,26 @@
 #pragma once
 #include "Prerequisites.h"
 #include "MeshComponent.h"
+#include "MeshSimplifier.h"
+#include <functional>
 
 // Declaraciones adelantadas
 class MeshComponent;
+struct ObjGeometry;
+class ThreadPool;
+
+/**
+ * @struct ModelLoadStats
+ * @brief Tiempos y tamao de la ltima carga de ModelLoader::init().
+ */
+struct ModelLoadStats
+{
+  bool fromCache = false;  ///< La malla sali de la cach ".pcmesh".
+  unsigned int chunks = 0; ///< Fragmentos de parseo.
+  double parseMs = 0.0;    ///< Proyeccin del archivo y tokenizacin.
+  double weldMs = 0.0;     ///< Soldadura de esquinas.
+  double totalMs = 0.0;    ///< Carga completa (optimizacin, LODs, meshlets y cach incluidos).
+};
 
 /**
  * @class ModelLoader
@@ -12,18 +29,124 @@ class MeshComponent;
  * Esta clase es responsable de la lectura, el parseo y la triangulacin de
  * archivos de modelos OBJ para extraer la geometra y poblar un objeto MeshComponent
  * con datos de vrtices e ndices re-indexados.
+ *
+ * El archivo se proyecta en memoria (@c MappedFile) y se recorre in situ con
+ * @c ObjTokenizer, sin reservas de memoria por lnea. Los archivos grandes se
+ * parten en fragmentos por lneas que se tokenizan en paralelo; el resultado
+ * es idntico al del recorrido en serie.
  */
 class ModelLoader {
 public:
+  /** @brief Tope de hilos de parseo que acepta setThreadCount(). */
+  static constexpr unsigned int kMaxThreads = 64;
+
   /** @brief Constructor por defecto. */
   ModelLoader() = default;
 
   /** @brief Destructor por defecto. */
   ~ModelLoader() = default;
 
+  /**
+   * @brief Funcin que recibe cada fragmento emitido por stream().
+   *
+   * El fragmento puede moverse a otro lugar (subirlo a GPU, guardarlo, etc.).
+   * Devolver un cdigo de fallo detiene la lectura y stream() lo propaga.
+   */
+  using ChunkCallback = std::function<HRESULT(MeshComponent& chunk)>;
+
   HRESULT init(MeshComponent& mesh, const std::string& fileName);
 
+  /**
+   * @brief Lee un OBJ en flujo y emite mallas parciales conforme se consume el archivo.
+   *
+   * Cada fragmento contiene como mximo @p maxVertices vrtices y @p maxIndices
+   * ndices, y se corta adems en cada registro @c o, @c g o @c usemtl. Las caras
+   * se sueldan solo dentro de su fragmento, de modo que la memoria temporal queda
+   * acotada por el tamao del fragmento y no por el del archivo; nicamente los
+   * arreglos de atributos (v/vt/vn) se conservan completos porque cualquier cara
+   * posterior puede referenciarlos.
+   *
+   * @param fileName    Ruta del archivo OBJ.
+   * @param onChunk     Funcin invocada por cada fragmento, en orden de archivo.
+   * @param maxVertices Tope de vrtices por fragmento (mnimo 3).
+   * @param maxIndices  Tope de ndices por fragmento (mnimo 3).
+   * @return @c S_OK si fue exitoso; @c E_INVALIDARG, @c E_FAIL o el error devuelto por @p onChunk.
+   */
+  HRESULT stream(const std::string& fileName,
+                 const ChunkCallback& onChunk,
+                 size_t maxVertices = 65536,
+                 size_t maxIndices = 65536 * 3);
+
   void update();
   void render();
   void destroy();
+
+  /**
+   * @brief Define en cuntos fragmentos (hilos) se tokeniza el archivo.
+   *
+   * Un valor mayor que el pool compartido (ncleos - 1 hilos) usa un @c ThreadPool propio
+   * durante el parseo, as que el nmero de hilos pedido es el que realmente trabaja.
+   *
+   * @param threadCount 1 = en serie; 0 = automtico segn tamao y ncleos disponibles;
+   *                    como mximo @c kMaxThreads.
+   */
+  void setThreadCount(unsigned int threadCount) { m_threadCount = threadCount; }
+
+  /**
+   * @brief Nmero de hilos configurado (0 = automtico).
+   */
+  unsigned int getThreadCount() const { return m_threadCount; }
+
+  /**
+   * @brief Tiempos de la ltima llamada a init().
+   */
+  const ModelLoadStats& getLastLoadStats() const { return m_lastLoad; }
+
+  /**
+   * @brief Si se activa, init() y stream() codifican las mallas a @c CompactVertex y liberan
+   *        @c m_vertex (solo se sube la versin compacta).
+   * @sa VertexCodec::encodeMesh()
+   */
+  void setCompactVertices(bool enabled) { m_compactVertices = enabled; }
+
+  /**
+   * @brief Cadena de LODs que init() genera para la malla (ratios vacos la desactivan).
+   * @sa MeshSimplifier::buildLods()
+   */
+  void setLodChain(const LodChainDesc& lodChain) { m_lodChain = lodChain; }
+
+private:
+  /**
+   * @brief Tokeniza el texto en @p chunkCount fragmentos cortados en fin de lnea y los fusiona.
+   *
+   * Cada fragmento produce sus propios arreglos; la fusin los concatena en orden
+   * y suma los desplazamientos globales a las esquinas con ndices relativos.
+   *
+   * @param pool Pool que ejecuta los fragmentos (el llamador tambin trabaja).
+   * @return @c S_OK si fue exitoso; @c E_FAIL si algn fragmento contiene caras invlidas.
+   */
+  HRESULT parseParallel(const char* begin,
+                        const char* end,
+                        unsigned int chunkCount,
+                        ThreadPool& pool,
+                        ObjGeometry& geometry);
+
+  /**
+   * @brief Calcula el nmero de fragmentos a usar para un archivo de @p fileSize bytes.
+   */
+  unsigned int resolveChunkCount(size_t fileSize) const;
+
+  /**
+   * @brief Suelda las esquinas (pos, tex, normal) idnticas y agrega el resultado a @p mesh.
+   * @param geometry Arreglos crudos producidos por @c ObjTokenizer.
+   * @param mesh     Malla destino; se actualizan @c m_numVertex y @c m_numIndex.
+   * @return @c S_OK si fue exitoso; @c E_FAIL si hay ndices de posicin invlidos.
+   */
+  HRESULT weldVertices(const ObjGeometry& geometry, MeshComponent& mesh);
+
+private:
+  unsigned int m_threadCount = 0; ///< Hilos de parseo (0 = automtico, 1 = en serie).
+  bool m_compactVertices = false; ///< Codificar a @c CompactVertex tras importar.
+  LodChainDesc m_lodChain;        ///< LODs generados por init().
+  ModelLoadStats m_lastLoad;      ///< Tiempos de la ltima carga.
 };
@@ -0,0 +1,148 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @struct VertexData
+ * @brief Tripleta de índices (base 0) de una esquina de cara OBJ: posición, textura y normal.
+ */
+struct VertexData
+{
+  unsigned int PosIndex;
+  unsigned int TexIndex;
+  unsigned int NormalIndex;
+
+  bool operator==(const VertexData& other) const {
+    return PosIndex == other.PosIndex &&
+      TexIndex == other.TexIndex &&
+      NormalIndex == other.NormalIndex;
+  }
+};
+
+/**
+ * @enum ObjIndexMask
+ * @brief Atributos de una esquina que usaron un índice relativo (negativo).
+ */
+enum
+  ObjIndexMask {
+  OBJ_RELATIVE_POS = 1 << 0,
+  OBJ_RELATIVE_TEX = 1 << 1,
+  OBJ_RELATIVE_NORMAL = 1 << 2
+};
+
+/**
+ * @struct ObjRelativeCorner
+ * @brief Esquina cuyos índices relativos se resolvieron contra los conteos locales del rango.
+ */
+struct ObjRelativeCorner
+{
+  size_t Corner;      ///< Posición dentro de @c ObjGeometry::corners.
+  unsigned char Mask; ///< Combinación de @c ObjIndexMask.
+};
+
+/**
+ * @struct ObjGeometry
+ * @brief Arreglos crudos producidos por el tokenizador OBJ.
+ *
+ * @c corners contiene las esquinas ya trianguladas en abanico (3 por triángulo),
+ * con índices resueltos a base 0 sobre @c positions, @c texcoords y @c normals.
+ *
+ * Cuando el texto se tokeniza por fragmentos, los índices negativos se resuelven
+ * contra los conteos del propio fragmento; @c relativeCorners registra esas
+ * esquinas para que la fusión les sume el desplazamiento global.
+ */
+struct ObjGeometry
+{
+  std::vector<XMFLOAT3> positions;
+  std::vector<XMFLOAT2> texcoords;
+  std::vector<XMFLOAT3> normals;
+  std::vector<VertexData> corners;
+  std::vector<ObjRelativeCorner> relativeCorners;
+};
+
+/**
+ * @enum ObjRecordType
+ * @brief Tipo de registro (línea) reconocido por el tokenizador.
+ */
+enum
+  ObjRecordType {
+  OBJ_RECORD_NONE = 0,  ///< Línea vacía, comentario o registro ignorado.
+  OBJ_RECORD_POSITION,  ///< v
+  OBJ_RECORD_TEXCOORD,  ///< vt
+  OBJ_RECORD_NORMAL,    ///< vn
+  OBJ_RECORD_FACE,      ///< f
+  OBJ_RECORD_OBJECT,    ///< o
+  OBJ_RECORD_GROUP,     ///< g
+  OBJ_RECORD_MATERIAL,  ///< usemtl
+  OBJ_RECORD_ERROR      ///< Segmento de cara inválido.
+};
+
+/**
+ * @class ObjTokenizer
+ * @brief Tokenizador OBJ que recorre el texto in situ, sin reservas por línea.
+ *
+ * Trabaja sobre un rango de memoria (normalmente un @c MappedFile) y convierte
+ * números con @c std::from_chars. Las caras se triangulan en abanico al vuelo,
+ * por lo que no se necesita ningún arreglo temporal por polígono.
+ */
+class
+  ObjTokenizer {
+public:
+  ObjTokenizer() = default;
+  ~ObjTokenizer() = default;
+
+  /**
+   * @brief Tokeniza el rango completo y agrega sus registros a @p geometry.
+   *
+   * @param begin    Inicio del texto.
+   * @param end      Fin del texto (exclusivo).
+   * @param geometry Destino de posiciones, UVs, normales y esquinas.
+   * @return @c S_OK si fue exitoso; @c E_FAIL si algún segmento de cara es inválido.
+   */
+  HRESULT
+    parse(const char* begin, const char* end, ObjGeometry& geometry);
+
+  /**
+   * @brief Tokeniza una sola línea y avanza @p cursor al inicio de la siguiente.
+   *
+   * Los índices relativos (negativos) se resuelven contra el tamaño actual
+   * de los arreglos de @p geometry.
+   *
+   * @param cursor   Posición actual; al regresar apunta a la siguiente línea.
+   * @param end      Fin del texto (exclusivo).
+   * @param geometry Destino de los datos del registro.
+   * @param name     Si no es nulo, recibe el nombre de registros o/g/usemtl (apunta al texto original).
+   * @return Tipo de registro procesado.
+   */
+  ObjRecordType
+    parseLine(const char*& cursor,
+              const char* end,
+              ObjGeometry& geometry,
+              std::pair<const char*, const char*>* name = nullptr);
+
+  /**
+   * @brief Número de línea (base 1) de la última línea procesada.
+   */
+  size_t
+    getLineNumber() const { return m_line; }
+
+private:
+  /**
+   * @brief Lee un segmento de cara "p", "p/t", "p//n" o "p/t/n".
+   * @param relativeMask Recibe los atributos que usaron índices negativos (@c ObjIndexMask).
+   */
+  bool
+    parseCorner(const char*& p,
+                const char* end,
+                const ObjGeometry& geometry,
+                VertexData& out,
+                unsigned char& relativeMask) const;
+
+  /**
+   * @brief Agrega una esquina triangulada y registra si requiere corrección de índices relativos.
+   */
+  void
+    pushCorner(ObjGeometry& geometry, const VertexData& corner, unsigned char relativeMask) const;
+
+private:
+  size_t m_line = 0; ///< Contador de líneas para diagnóstico.
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "Prerequisites.h"
+#include "FrustumCuller.h"
 
 class Entity;
 class DeviceContext;
@@ -28,6 +29,31 @@ public:
 	bool
 	detach(Entity* child);
 
+	/**
+	 * @brief Cmara usada por update() para elegir el LOD de cada actor.
+	 * @param viewportHeight Alto del viewport en pxeles.
+	 */
+	void
+	setCamera(const XMMATRIX& view, const XMMATRIX& projection, float viewportHeight);
+
+	/**
+	 * @brief Error mximo en pxeles que se tolera al elegir LODs (1 por defecto).
+	 */
+	void
+	setLodPixelError(float pixelError) { m_lodPixelError = pixelError; }
+
+	/**
+	 * @brief Contadores del frustum culling del ltimo update() (mallas probadas, visibles y descartadas).
+	 */
+	const CullingStats&
+	getCullingStats() const { return m_cullingStats; }
+
+	/**
+	 * @brief Contadores del culling por meshlets del ltimo update().
+	 */
+	const CullingStats&
+	getMeshletStats() const { return m_meshletStats; }
+
 	void 
 	update(float deltaTime, DeviceContext& deviceContext);
 	
@@ -46,8 +72,37 @@ private:
 	bool
 	isRegistered(Entity* e) const;
 
+	/**
+	 * @brief Actualiza los volmenes en mundo de los actores y arma @c m_visibleEntities.
+	 *
+	 * Sin cmara todas las mallas se consideran visibles. Las entidades que no son
+	 * actores no tienen volumen y siempre se dibujan. Con cmara, las mallas visibles
+	 * se refinan adems por meshlets.
+	 */
+	void
+	cullEntities();
+
 private:
+	/**
+	 * @brief Malla registrada en el culler: ndice en @c m_entities e ndice de malla del actor.
+	 */
+	struct CullItem {
+		uint32_t entity;
+		uint32_t mesh;
+	};
+
+	FrustumCuller m_culler;
+	std::vector<CullItem> m_cullItems;        ///< Entrada i del culler -> malla de un actor.
+	std::vector<uint32_t> m_visibleItems;     ///< Resultado de la ltima pasada del culler.
+	std::vector<uint8_t> m_entityVisible;     ///< Por entidad: alguna de sus mallas es visible.
+	std::vector<Entity*> m_visibleEntities;   ///< Entidades a dibujar en render(), en orden de registro.
+	CullingStats m_cullingStats;
+	CullingStats m_meshletStats;
 	//std::vector<EU::TSharedPointer<Entity>> m_entities;
+	XMMATRIX m_view = XMMatrixIdentity();
+	XMMATRIX m_projection = XMMatrixIdentity();
+	float m_viewportHeight = 0.0f;   ///< 0 mientras no haya cmara: todo se dibuja en LOD 0.
+	float m_lodPixelError = 1.0f;
 public:
 	std::vector<Entity*> m_entities;
 };
\ No newline at end of file
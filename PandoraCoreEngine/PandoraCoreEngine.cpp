@@ -1,4 +1,7 @@
 #include "BaseApp.h"
+#include "TextureCache.h"
+#include "FileSource.h"
+#include "SelfTest.h"
 
 //--------------------------------------------------------------------------------------
 // Entry point to the program. Initializes everything and goes into a message processing 
@@ -6,6 +9,21 @@
 //--------------------------------------------------------------------------------------
 int WINAPI
 wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow) {
+	// "-warmcache": genera la caché de texturas de Assets sin abrir ventana y termina.
+	if (lpCmdLine && wcsstr(lpCmdLine, L"-warmcache")) {
+		return SUCCEEDED(TextureCache::warmDirectory("Assets", TextureImportSettings())) ? 0 : 1;
+	}
+	// "-pack": empaqueta Assets y Skybox en Assets.pcpak (BaseApp lo monta si existe) y termina.
+	if (lpCmdLine && wcsstr(lpCmdLine, L"-pack")) {
+		return SUCCEEDED(PackFileSource::writeDirectories("Assets.pcpak", { "Assets", "Skybox" })) ? 0 : 1;
+	}
+	// "-selftest" / "-bench": comprobaciones (y mediciones) sin ventana; escribe SelfTest.log.
+	if (lpCmdLine && wcsstr(lpCmdLine, L"-selftest")) {
+		return SelfTest::run(false) == 0 ? 0 : 1;
+	}
+	if (lpCmdLine && wcsstr(lpCmdLine, L"-bench")) {
+		return SelfTest::run(true) == 0 ? 0 : 1;
+	}
 	BaseApp app;
 	return app.run(hInstance, nCmdShow);
 }
\ No newline at end of file
@@ -1,19 +1,65 @@
 #include "ModelLoader.h"
-#include <cstdio>
+#include "ObjTokenizer.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "VertexCodec.h"
+#include "MeshletBuilder.h"
+#include <chrono>
 
-struct VertexData
-{
-  unsigned int PosIndex;
-  unsigned int TexIndex;
-  unsigned int NormalIndex;
+namespace {
+  // Por debajo de este tamao por fragmento no compensa repartir el parseo.
+  constexpr size_t kMinChunkBytes = 4u * 1024u * 1024u;
+
+  // Opciones del importador OBJ que forman parte de la clave de cach.
+  const char* kObjImporterSettings = "obj;flip-v;fan;weld;opt-vcache-overdraw-fetch";
+}
 
-  bool operator==(const VertexData& other) const {
-    return PosIndex == other.PosIndex &&
-      TexIndex == other.TexIndex &&
-      NormalIndex == other.NormalIndex;
+/**
+ * @brief Hash para la tripleta (pos, tex, normal) de @c VertexData.
+ * @details Mezcla estilo FNV-1a de los tres ndices; suficiente para soldar
+ * esquinas en O(1) promedio en lugar de un recorrido lineal.
+ */
+struct VertexDataHash
+{
+  size_t operator()(const VertexData& vd) const {
+    uint64_t h = 14695981039346656037ull;
+    h = (h ^ vd.PosIndex) * 1099511628211ull;
+    h = (h ^ vd.TexIndex) * 1099511628211ull;
+    h = (h ^ vd.NormalIndex) * 1099511628211ull;
+    return static_cast<size_t>(h ^ (h >> 32));
   }
 };
 
+namespace {
+  /**
+   * @brief Construye el vrtice final de una esquina a partir de los arreglos de atributos.
+   * @return @c false si el ndice de posicin es invlido.
+   */
+  bool
+  buildVertex(const ObjGeometry& geometry, const VertexData& vd, SimpleVertex& out) {
+    out = {};
+
+    if (vd.PosIndex < geometry.positions.size()) {
+      out.Pos = geometry.positions[vd.PosIndex];
+    }
+    else {
+      ERROR("ModelLoader", "Reconstruccion", "Error: ndice de posicin invlido.");
+      return false;
+    }
+
+    if (vd.TexIndex < geometry.texcoords.size()) {
+      out.Tex = geometry.texcoords[vd.TexIndex];
+    }
+    else {
+      out.Tex = XMFLOAT2(0.0f, 0.0f);
+    }
+    // SimpleVertex no tiene normal: el ndice vn solo distingue esquinas al soldar.
+    return true;
+  }
+}
+
 HRESULT
 ModelLoader::init(MeshComponent& mesh, const std::string& fileName) {
   if (fileName.empty()) {
@@ -21,131 +67,349 @@ ModelLoader::init(MeshComponent& mesh, const std::string& fileName) {
     return E_INVALIDARG;
   }
 
-  std::vector<XMFLOAT3> temp_positions;
-  std::vector<XMFLOAT2> temp_texcoords;
-  std::vector<XMFLOAT3> temp_normals;
-
-  std::vector<VertexData> face_data;
-  std::vector<VertexData> unique_vertices;
+  const auto loadStart = std::chrono::steady_clock::now();
+  m_lastLoad = ModelLoadStats();
 
   mesh.m_vertex.clear();
   mesh.m_index.clear();
+  mesh.m_index16.clear();
+  mesh.m_indexFormat = DXGI_FORMAT_R32_UINT;
+  mesh.m_compactVertex.clear();
+  mesh.m_lods.clear();
+  mesh.m_meshlets.clear();
 
-  FILE* file = nullptr;
-  if (fopen_s(&file, fileName.c_str(), "r") != 0 || file == nullptr) {
+  MappedFile file;
+  if (FAILED(file.init(fileName))) {
     ERROR("ModelLoader", "init",
       ("Fallo al abrir el archivo de modelo. Verifique la ruta: " + fileName).c_str());
     return E_FAIL;
   }
 
-  char lineBuffer[1024];
-  while (std::fgets(lineBuffer, 1024, file) != nullptr) {
-    std::string line(lineBuffer);
-    if (line.empty() || line[0] == '#') continue;
+  // Cach binaria: si coincide con el contenido actual se omite el parseo.
+  const std::string cachePath = MeshCache::getCachePath(fileName);
+  const uint64_t cacheKey = MeshCache::computeKey(file.data(), file.size(),
+                                                  std::string(kObjImporterSettings) + ";" + m_lodChain.toString());
+  std::vector<MeshComponent> cached;
+  if (MeshCache::load(cachePath, cacheKey, cached) && cached.size() == 1) {
+    file.destroy();
+    mesh = std::move(cached.front());
+    if (m_compactVertices) {
+      VertexCodec::encodeMesh(mesh, false);
+    }
+    const double loadMs = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - loadStart).count();
+    m_lastLoad.fromCache = true;
+    m_lastLoad.totalMs = loadMs;
+    MESSAGE("ModelLoader", "init", ("Carga desde cach de: " + fileName +
+      " (ms): " + std::to_string(loadMs)).c_str());
+    return S_OK;
+  }
+
+  // Tokenizacin in situ sobre el archivo proyectado en memoria.
+  ObjGeometry geometry;
+  HRESULT hr = S_OK;
+  const unsigned int chunkCount = resolveChunkCount(file.size());
+  if (chunkCount <= 1) {
+    ObjTokenizer tokenizer;
+    hr = tokenizer.parse(file.data(), file.data() + file.size(), geometry);
+  }
+  else if (chunkCount - 1 > ThreadPool::getInstance().getThreadCount()) {
+    // Valor explcito mayor que el pool compartido: pool propio con un hilo por fragmento.
+    ThreadPool pool(chunkCount - 1);
+    hr = parseParallel(file.data(), file.data() + file.size(), chunkCount, pool, geometry);
+  }
+  else {
+    hr = parseParallel(file.data(), file.data() + file.size(), chunkCount,
+                       ThreadPool::getInstance(), geometry);
+  }
+  file.destroy();
+  if (FAILED(hr)) {
+    ERROR("ModelLoader", "ParseFace",
+      ("Error al parsear las caras de: " + fileName).c_str());
+    return hr;
+  }
+
+  const auto parseEnd = std::chrono::steady_clock::now();
 
-    std::stringstream ss(line);
-    std::string prefix;
-    ss >> prefix;
+  hr = weldVertices(geometry, mesh);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  const auto weldEnd = std::chrono::steady_clock::now();
+  // Si la optimizacin falla se conserva la malla soldada, sin LODs ni meshlets.
+  const bool optimized = SUCCEEDED(MeshOptimizer::optimize(mesh));
+  if (!optimized) {
+    MESSAGE("ModelLoader", "init", ("Malla sin optimizar: " + fileName).c_str());
+  }
+  mesh.computeBounds();
+  if (optimized) {
+    MeshSimplifier::buildLods(mesh, m_lodChain);
+    MeshletBuilder::build(mesh);
+  }
+  mesh.compactIndices();
+  MeshCache::save(cachePath, cacheKey, { mesh });
+  if (m_compactVertices) {
+    VertexCodec::encodeMesh(mesh, false);
+  }
+
+  const auto loadEnd = std::chrono::steady_clock::now();
+  const double parseMs = std::chrono::duration<double, std::milli>(parseEnd - loadStart).count();
+  const double loadMs = std::chrono::duration<double, std::milli>(loadEnd - loadStart).count();
+  m_lastLoad.chunks = chunkCount;
+  m_lastLoad.parseMs = parseMs;
+  m_lastLoad.weldMs = std::chrono::duration<double, std::milli>(weldEnd - parseEnd).count();
+  m_lastLoad.totalMs = loadMs;
+
+  MESSAGE("ModelLoader", "init", ("Carga y re-indexacin exitosa de: " + fileName).c_str());
+  MESSAGE("ModelLoader", "init", ("Fragmentos de parseo: " + std::to_string(chunkCount) +
+    ", parseo (ms): " + std::to_string(parseMs)).c_str());
+  MESSAGE("ModelLoader", "init", ("Tiempo de carga (ms): " + std::to_string(loadMs)).c_str());
+  MESSAGE("ModelLoader", "init", ("Vrtices finales (despus de re-indexacin): " + std::to_string(mesh.m_numVertex)).c_str());
+  MESSAGE("ModelLoader", "init", ("ndices finales: " + std::to_string(mesh.m_numIndex) +
+    (mesh.m_indexFormat == DXGI_FORMAT_R16_UINT ? " (16 bits)" : " (32 bits)")).c_str());
+
+  return S_OK;
+}
+
+HRESULT
+ModelLoader::stream(const std::string& fileName,
+                    const ChunkCallback& onChunk,
+                    size_t maxVertices,
+                    size_t maxIndices) {
+  if (fileName.empty() || !onChunk || maxVertices < 3 || maxIndices < 3) {
+    ERROR("ModelLoader", "stream", "Parmetros de streaming invlidos.");
+    return E_INVALIDARG;
+  }
+
+  MappedFile file;
+  if (FAILED(file.init(fileName))) {
+    ERROR("ModelLoader", "stream",
+      ("Fallo al abrir el archivo de modelo. Verifique la ruta: " + fileName).c_str());
+    return E_FAIL;
+  }
+
+  // Los atributos se acumulan completos; las esquinas se consumen cara por cara.
+  ObjGeometry geometry;
+  ObjTokenizer tokenizer;
+  MeshComponent chunk;
+  std::unordered_map<VertexData, unsigned int, VertexDataHash> chunkVertices;
+  std::string currentName;
+  size_t chunkCount = 0;
 
-    if (prefix == "v") {
-      XMFLOAT3 pos;
-      if (!(ss >> pos.x >> pos.y >> pos.z)) continue;
-      temp_positions.push_back(pos);
+  auto flush = [&]() -> HRESULT {
+    if (chunk.m_index.empty()) {
+      return S_OK;
     }
-    else if (prefix == "vt") {
-      XMFLOAT2 tex;
-      if (!(ss >> tex.x >> tex.y)) continue;
-      tex.y = 1.0f - tex.y;
-      temp_texcoords.push_back(tex);
+    chunk.m_name = currentName;
+    chunk.m_numVertex = static_cast<int>(chunk.m_vertex.size());
+    chunk.m_numIndex = static_cast<int>(chunk.m_index.size());
+    if (FAILED(MeshOptimizer::optimize(chunk))) {
+      MESSAGE("ModelLoader", "stream", ("Fragmento sin optimizar: " + currentName).c_str());
     }
-    else if (prefix == "vn") {
-      XMFLOAT3 normal;
-      if (!(ss >> normal.x >> normal.y >> normal.z)) continue;
-      temp_normals.push_back(normal);
+    chunk.computeBounds();
+    chunk.compactIndices();
+    if (m_compactVertices) {
+      VertexCodec::encodeMesh(chunk, false);
     }
-    else if (prefix == "f") {
-      std::vector<VertexData> face_indices;
-      std::string segment;
+    ++chunkCount;
 
-      while (ss >> segment) {
-        VertexData vd = { 0, 0, 0 };
-        size_t pos_start = 0;
-        size_t tex_start = segment.find('/');
-        size_t norm_start = segment.find('/', tex_start + 1);
+    HRESULT hr = onChunk(chunk);
+    chunk = MeshComponent();
+    chunkVertices.clear();
+    return hr;
+  };
 
-        try {
-          vd.PosIndex = std::stoul(segment.substr(pos_start, tex_start));
+  const char* cursor = file.data();
+  const char* end = file.data() + file.size();
+  while (cursor < end) {
+    std::pair<const char*, const char*> name(nullptr, nullptr);
+    const ObjRecordType record = tokenizer.parseLine(cursor, end, geometry, &name);
 
-          if (tex_start != std::string::npos && norm_start != tex_start + 1) {
-            vd.TexIndex = std::stoul(segment.substr(tex_start + 1, norm_start - tex_start - 1));
-          }
+    if (record == OBJ_RECORD_ERROR) {
+      ERROR("ModelLoader", "stream",
+        ("Segmento de cara invlido en la lnea " + std::to_string(tokenizer.getLineNumber()) +
+         " de: " + fileName).c_str());
+      return E_FAIL;
+    }
 
-          if (norm_start != std::string::npos) {
-            vd.NormalIndex = std::stoul(segment.substr(norm_start + 1));
-          }
+    if (record == OBJ_RECORD_OBJECT || record == OBJ_RECORD_GROUP || record == OBJ_RECORD_MATERIAL) {
+      HRESULT hr = flush();
+      if (FAILED(hr)) {
+        return hr;
+      }
+      if (record != OBJ_RECORD_MATERIAL) {
+        currentName.assign(name.first, name.second);
+      }
+      continue;
+    }
 
-          vd.PosIndex--;
-          vd.TexIndex = (vd.TexIndex > 0) ? vd.TexIndex - 1 : 0;
-          vd.NormalIndex = (vd.NormalIndex > 0) ? vd.NormalIndex - 1 : 0;
+    if (record != OBJ_RECORD_FACE) {
+      continue;
+    }
 
-          face_indices.push_back(vd);
+    // Suelda tringulo por tringulo; si el siguiente no cabe, se emite el fragmento.
+    const std::vector<VertexData>& corners = geometry.corners;
+    for (size_t c = 0; c + 2 < corners.size(); c += 3) {
+      unsigned int added = 0;
+      for (size_t k = 0; k < 3; ++k) {
+        if (chunkVertices.find(corners[c + k]) == chunkVertices.end()) {
+          ++added;
+        }
+      }
+      if (chunk.m_vertex.size() + added > maxVertices || chunk.m_index.size() + 3 > maxIndices) {
+        HRESULT hr = flush();
+        if (FAILED(hr)) {
+          return hr;
+        }
+      }
 
+      for (size_t k = 0; k < 3; ++k) {
+        const VertexData& vd = corners[c + k];
+        auto it = chunkVertices.find(vd);
+        if (it != chunkVertices.end()) {
+          chunk.m_index.push_back(it->second);
+          continue;
         }
-        catch (const std::exception& e) {
-          ERROR("ModelLoader", "ParseFace",
-            ("Error al parsear segmento de cara '" + segment + "'. Detalle: " + e.what()).c_str());
-          std::fclose(file);
+        SimpleVertex vertex;
+        if (!buildVertex(geometry, vd, vertex)) {
           return E_FAIL;
         }
+        const unsigned int index = static_cast<unsigned int>(chunk.m_vertex.size());
+        chunkVertices.emplace(vd, index);
+        chunk.m_vertex.push_back(vertex);
+        chunk.m_index.push_back(index);
       }
+    }
 
-      for (size_t i = 1; i < face_indices.size() - 1; ++i) {
-        face_data.push_back(face_indices[0]);
-        face_data.push_back(face_indices[i]);
-        face_data.push_back(face_indices[i + 1]);
-      }
+    // En serie los ndices relativos ya quedaron resueltos contra los conteos globales.
+    geometry.corners.clear();
+    geometry.relativeCorners.clear();
+  }
+
+  HRESULT hr = flush();
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  MESSAGE("ModelLoader", "stream", ("Fragmentos emitidos: " + std::to_string(chunkCount) +
+    " de: " + fileName).c_str());
+  return S_OK;
+}
+
+unsigned int
+ModelLoader::resolveChunkCount(size_t fileSize) const {
+  if (m_threadCount == 1 || fileSize == 0) {
+    return 1;
+  }
+  if (m_threadCount > 1) {
+    // Valor explcito: se respeta aunque los fragmentos queden pequeos.
+    return (std::min)(m_threadCount, kMaxThreads);
+  }
+  const size_t bySize = (std::max)(static_cast<size_t>(1), fileSize / kMinChunkBytes);
+  const size_t cores = ThreadPool::getInstance().getThreadCount() + 1;
+  return static_cast<unsigned int>((std::min)(bySize, cores));
+}
+
+HRESULT
+ModelLoader::parseParallel(const char* begin,
+                           const char* end,
+                           unsigned int chunkCount,
+                           ThreadPool& pool,
+                           ObjGeometry& geometry) {
+  // 1) Cortes en fin de lnea para que ningn registro quede partido.
+  std::vector<const char*> bounds(chunkCount + 1, end);
+  bounds[0] = begin;
+  const size_t chunkSize = static_cast<size_t>(end - begin) / chunkCount;
+  for (unsigned int i = 1; i < chunkCount; ++i) {
+    const char* cut = (std::max)(bounds[i - 1], begin + chunkSize * i);
+    const char* eol = static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+    bounds[i] = eol ? eol + 1 : end;
+  }
+
+  // 2) Tokenizacin independiente por fragmento.
+  std::vector<ObjGeometry> chunks(chunkCount);
+  std::vector<HRESULT> results(chunkCount, S_OK);
+  pool.parallelFor(chunkCount, [&](size_t i) {
+    ObjTokenizer tokenizer;
+    results[i] = tokenizer.parse(bounds[i], bounds[i + 1], chunks[i]);
+  });
+
+  for (unsigned int i = 0; i < chunkCount; ++i) {
+    if (FAILED(results[i])) {
+      return results[i];
     }
   }
-  std::fclose(file);
 
-  for (const auto& vd : face_data) {
-    bool found = false;
-    unsigned int existing_index = 0;
-
-    for (unsigned int i = 0; i < unique_vertices.size(); ++i) {
-      if (unique_vertices[i] == vd) {
-        found = true;
-        existing_index = i;
-        break;
-      }
+  // 3) Fusin determinista en orden de archivo.
+  size_t positionCount = 0, texcoordCount = 0, normalCount = 0, cornerCount = 0;
+  for (const ObjGeometry& chunk : chunks) {
+    positionCount += chunk.positions.size();
+    texcoordCount += chunk.texcoords.size();
+    normalCount += chunk.normals.size();
+    cornerCount += chunk.corners.size();
+  }
+  geometry.positions.reserve(positionCount);
+  geometry.texcoords.reserve(texcoordCount);
+  geometry.normals.reserve(normalCount);
+  geometry.corners.reserve(cornerCount);
+
+  for (ObjGeometry& chunk : chunks) {
+    const unsigned int posBase = static_cast<unsigned int>(geometry.positions.size());
+    const unsigned int texBase = static_cast<unsigned int>(geometry.texcoords.size());
+    const unsigned int normalBase = static_cast<unsigned int>(geometry.normals.size());
+    const size_t cornerBase = geometry.corners.size();
+
+    // Los ndices absolutos ya son globales; los relativos se resolvieron
+    // contra los conteos locales y solo necesitan el desplazamiento del fragmento.
+    for (const ObjRelativeCorner& fixup : chunk.relativeCorners) {
+      VertexData& corner = chunk.corners[fixup.Corner];
+      if (fixup.Mask & OBJ_RELATIVE_POS) corner.PosIndex += posBase;
+      if (fixup.Mask & OBJ_RELATIVE_TEX) corner.TexIndex += texBase;
+      if (fixup.Mask & OBJ_RELATIVE_NORMAL) corner.NormalIndex += normalBase;
+      geometry.relativeCorners.push_back({ cornerBase + fixup.Corner, fixup.Mask });
     }
 
-    if (!found) {
-      unsigned int new_index = static_cast<unsigned int>(mesh.m_vertex.size());
-      unique_vertices.push_back(vd);
+    geometry.positions.insert(geometry.positions.end(), chunk.positions.begin(), chunk.positions.end());
+    geometry.texcoords.insert(geometry.texcoords.end(), chunk.texcoords.begin(), chunk.texcoords.end());
+    geometry.normals.insert(geometry.normals.end(), chunk.normals.begin(), chunk.normals.end());
+    geometry.corners.insert(geometry.corners.end(), chunk.corners.begin(), chunk.corners.end());
 
-      SimpleVertex new_vertex = {};
+    // Libera el fragmento en cuanto se fusiona para no duplicar el pico de memoria.
+    chunk = ObjGeometry();
+  }
 
-      if (vd.PosIndex < temp_positions.size()) {
-        new_vertex.Pos = temp_positions[vd.PosIndex];
-      }
-      else {
-        ERROR("ModelLoader", "Reconstruccion", "Error: ndice de posicin invlido.");
-        return E_FAIL;
-      }
+  return S_OK;
+}
 
-      if (vd.TexIndex < temp_texcoords.size()) {
-        new_vertex.Tex = temp_texcoords[vd.TexIndex];
-      }
-      else {
-        new_vertex.Tex = XMFLOAT2(0.0f, 0.0f);
-      }
+HRESULT
+ModelLoader::weldVertices(const ObjGeometry& geometry, MeshComponent& mesh) {
+  const std::vector<XMFLOAT3>& temp_positions = geometry.positions;
+  const std::vector<XMFLOAT2>& temp_texcoords = geometry.texcoords;
+  const std::vector<XMFLOAT3>& temp_normals = geometry.normals;
+  const std::vector<VertexData>& face_data = geometry.corners;
 
-      if (vd.NormalIndex < temp_normals.size()) {
-        new_vertex.Normal = temp_normals[vd.NormalIndex];
-      }
-      else {
-        new_vertex.Normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+  // Soldadura de vrtices indexada por hash.
+  // La cantidad de vrtices nicos suele estar cerca del mayor de los arreglos
+  // de atributos y nunca supera el nmero de esquinas.
+  size_t capacityHint = (std::max)(temp_positions.size(),
+                        (std::max)(temp_texcoords.size(), temp_normals.size()));
+  capacityHint = (std::min)(capacityHint, face_data.size());
+
+  std::unordered_map<VertexData, unsigned int, VertexDataHash> unique_vertices;
+  unique_vertices.reserve(capacityHint);
+  mesh.m_vertex.reserve(mesh.m_vertex.size() + capacityHint);
+  mesh.m_index.reserve(mesh.m_index.size() + face_data.size());
+
+  for (const auto& vd : face_data) {
+    auto it = unique_vertices.find(vd);
+
+    if (it == unique_vertices.end()) {
+      unsigned int new_index = static_cast<unsigned int>(mesh.m_vertex.size());
+      unique_vertices.emplace(vd, new_index);
+
+      SimpleVertex new_vertex;
+      if (!buildVertex(geometry, vd, new_vertex)) {
+        return E_FAIL;
       }
 
       mesh.m_vertex.push_back(new_vertex);
@@ -153,17 +417,13 @@ ModelLoader::init(MeshComponent& mesh, const std::string& fileName) {
 
     }
     else {
-      mesh.m_index.push_back(existing_index);
+      mesh.m_index.push_back(it->second);
     }
   }
 
   mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
   mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
 
-  MESSAGE("ModelLoader", "init", ("Carga y re-indexacin exitosa de: " + fileName).c_str());
-  MESSAGE("ModelLoader", "init", ("Vrtices finales (despus de re-indexacin): " + std::to_string(mesh.m_numVertex)).c_str());
-  MESSAGE("ModelLoader", "init", ("ndices finales: " + std::to_string(mesh.m_numIndex)).c_str());
-
   return S_OK;
 }
 
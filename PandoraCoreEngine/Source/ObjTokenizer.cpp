@@ -0,0 +1,214 @@
+﻿#include "ObjTokenizer.h"
+#include <charconv>
+#include <cstring>
+
+namespace {
+  inline bool
+  isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+  }
+
+  inline const char*
+  skipBlanks(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) ++p;
+    return p;
+  }
+
+  inline const char*
+  skipToken(const char* p, const char* end) {
+    while (p < end && !isBlank(*p)) ++p;
+    return p;
+  }
+
+  inline bool
+  parseFloat(const char*& p, const char* end, float& value) {
+    p = skipBlanks(p, end);
+    if (p < end && *p == '+') ++p;
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+  }
+
+  inline bool
+  parseInt(const char*& p, const char* end, long& value) {
+    if (p < end && *p == '+') ++p;
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+  }
+
+  // Índices OBJ: positivos en base 1, negativos relativos al final actual.
+  // Un índice 0 o fuera de rango queda como valor inválido (se detecta al reconstruir).
+  inline unsigned int
+  resolveIndex(long raw, size_t count) {
+    if (raw > 0) return static_cast<unsigned int>(raw - 1);
+    if (raw < 0) return static_cast<unsigned int>(static_cast<long long>(count) + raw);
+    return static_cast<unsigned int>(-1);
+  }
+
+  // UV y normal: un índice 0 se trata como "sin dato" y apunta al primer elemento.
+  inline unsigned int
+  resolveOptionalIndex(long raw, size_t count) {
+    return raw == 0 ? 0u : resolveIndex(raw, count);
+  }
+
+  inline bool
+  tokenIs(const char* token, size_t length, const char* literal) {
+    return std::strlen(literal) == length && std::memcmp(token, literal, length) == 0;
+  }
+}
+
+HRESULT
+ObjTokenizer::parse(const char* begin, const char* end, ObjGeometry& geometry) {
+  if (!begin || begin >= end) {
+    return S_OK;
+  }
+
+  const char* cursor = begin;
+  while (cursor < end) {
+    if (parseLine(cursor, end, geometry) == OBJ_RECORD_ERROR) {
+      ERROR("ObjTokenizer", "parse",
+        ("Invalid face segment at line " + std::to_string(m_line)).c_str());
+      return E_FAIL;
+    }
+  }
+  return S_OK;
+}
+
+ObjRecordType
+ObjTokenizer::parseLine(const char*& cursor,
+                        const char* end,
+                        ObjGeometry& geometry,
+                        std::pair<const char*, const char*>* name) {
+  const char* eol = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+  if (!eol) eol = end;
+
+  const char* p = skipBlanks(cursor, eol);
+  cursor = (eol < end) ? eol + 1 : end;
+  ++m_line;
+
+  if (p == eol || *p == '#') {
+    return OBJ_RECORD_NONE;
+  }
+
+  const char* token = p;
+  p = skipToken(p, eol);
+  const size_t tokenLength = static_cast<size_t>(p - token);
+
+  if (tokenIs(token, tokenLength, "v")) {
+    XMFLOAT3 pos;
+    if (!parseFloat(p, eol, pos.x) || !parseFloat(p, eol, pos.y) || !parseFloat(p, eol, pos.z)) {
+      return OBJ_RECORD_NONE;
+    }
+    geometry.positions.push_back(pos);
+    return OBJ_RECORD_POSITION;
+  }
+  if (tokenIs(token, tokenLength, "vt")) {
+    XMFLOAT2 tex;
+    if (!parseFloat(p, eol, tex.x) || !parseFloat(p, eol, tex.y)) {
+      return OBJ_RECORD_NONE;
+    }
+    tex.y = 1.0f - tex.y;
+    geometry.texcoords.push_back(tex);
+    return OBJ_RECORD_TEXCOORD;
+  }
+  if (tokenIs(token, tokenLength, "vn")) {
+    XMFLOAT3 normal;
+    if (!parseFloat(p, eol, normal.x) || !parseFloat(p, eol, normal.y) || !parseFloat(p, eol, normal.z)) {
+      return OBJ_RECORD_NONE;
+    }
+    geometry.normals.push_back(normal);
+    return OBJ_RECORD_NORMAL;
+  }
+  if (tokenIs(token, tokenLength, "f")) {
+    // Triangulación en abanico al vuelo: (0, k-1, k) por cada esquina k >= 2.
+    VertexData first = {};
+    VertexData previous = {};
+    unsigned char firstMask = 0;
+    unsigned char previousMask = 0;
+    unsigned int count = 0;
+
+    for (p = skipBlanks(p, eol); p < eol; p = skipBlanks(p, eol)) {
+      VertexData corner = {};
+      unsigned char mask = 0;
+      if (!parseCorner(p, eol, geometry, corner, mask)) {
+        return OBJ_RECORD_ERROR;
+      }
+      if (count == 0) {
+        first = corner;
+        firstMask = mask;
+      }
+      else if (count >= 2) {
+        pushCorner(geometry, first, firstMask);
+        pushCorner(geometry, previous, previousMask);
+        pushCorner(geometry, corner, mask);
+      }
+      previous = corner;
+      previousMask = mask;
+      ++count;
+    }
+    return OBJ_RECORD_FACE;
+  }
+
+  ObjRecordType type = OBJ_RECORD_NONE;
+  if (tokenIs(token, tokenLength, "o")) type = OBJ_RECORD_OBJECT;
+  else if (tokenIs(token, tokenLength, "g")) type = OBJ_RECORD_GROUP;
+  else if (tokenIs(token, tokenLength, "usemtl")) type = OBJ_RECORD_MATERIAL;
+
+  if (type != OBJ_RECORD_NONE && name) {
+    const char* nameBegin = skipBlanks(p, eol);
+    const char* nameEnd = eol;
+    while (nameEnd > nameBegin && isBlank(nameEnd[-1])) --nameEnd;
+    *name = std::make_pair(nameBegin, nameEnd);
+  }
+  return type;
+}
+
+bool
+ObjTokenizer::parseCorner(const char*& p,
+                          const char* end,
+                          const ObjGeometry& geometry,
+                          VertexData& out,
+                          unsigned char& relativeMask) const {
+  long raw = 0;
+  if (!parseInt(p, end, raw)) {
+    return false;
+  }
+  out.PosIndex = resolveIndex(raw, geometry.positions.size());
+  out.TexIndex = 0;
+  out.NormalIndex = 0;
+  relativeMask = (raw < 0) ? OBJ_RELATIVE_POS : 0;
+
+  if (p < end && *p == '/') {
+    ++p;
+    if (p < end && *p != '/' && !isBlank(*p)) {
+      if (!parseInt(p, end, raw)) return false;
+      out.TexIndex = resolveOptionalIndex(raw, geometry.texcoords.size());
+      if (raw < 0) relativeMask |= OBJ_RELATIVE_TEX;
+    }
+    if (p < end && *p == '/') {
+      ++p;
+      if (p < end && !isBlank(*p)) {
+        if (!parseInt(p, end, raw)) return false;
+        out.NormalIndex = resolveOptionalIndex(raw, geometry.normals.size());
+        if (raw < 0) relativeMask |= OBJ_RELATIVE_NORMAL;
+      }
+    }
+  }
+
+  // Ignora cualquier residuo del segmento, como hacía std::stoul.
+  p = skipToken(p, end);
+  return true;
+}
+
+void
+ObjTokenizer::pushCorner(ObjGeometry& geometry,
+                         const VertexData& corner,
+                         unsigned char relativeMask) const {
+  if (relativeMask) {
+    geometry.relativeCorners.push_back({ geometry.corners.size(), relativeMask });
+  }
+  geometry.corners.push_back(corner);
+}
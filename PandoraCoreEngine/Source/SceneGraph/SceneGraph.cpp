@@ -2,6 +2,7 @@
 #include "SceneGraph\HierarchyComponent.h"
 #include "ECS\Entity.h"
 #include "ECS\Transform.h"
+#include "ECS\Actor.h"
 #include "DeviceContext.h"
 
 void SceneGraph::init() {
@@ -21,6 +22,7 @@ void SceneGraph::destroy() {
 	}
 
 	m_entities.clear();
+	m_visibleEntities.clear();
 }
 
 void 
@@ -81,6 +83,8 @@ SceneGraph::removeEntity(Entity* e) {
 
 	// 3) eliminar del registro
 	m_entities.erase(std::remove(m_entities.begin(), m_entities.end(), e), m_entities.end());
+	m_visibleEntities.erase(std::remove(m_visibleEntities.begin(), m_visibleEntities.end(), e),
+	                        m_visibleEntities.end());
 }
 
 bool 
@@ -160,6 +164,13 @@ SceneGraph::detach(Entity* child) {
 	return true;
 }
 
+void
+SceneGraph::setCamera(const XMMATRIX& view, const XMMATRIX& projection, float viewportHeight) {
+	m_view = view;
+	m_projection = projection;
+	m_viewportHeight = viewportHeight;
+}
+
 void
 SceneGraph::update(float deltaTime, DeviceContext& deviceContext) {
 	// Actualiza todas las entidades
@@ -178,6 +189,90 @@ SceneGraph::update(float deltaTime, DeviceContext& deviceContext) {
 			updateWorldRecursive(e, XMMatrixIdentity());
 		}
 	}
+
+	// 3) LOD por actor según su tamaño proyectado (requiere cámara)
+	if (m_viewportHeight > 0.0f) {
+		for (Entity* e : m_entities)
+		{
+			Actor* actor = dynamic_cast<Actor*>(e);
+			if (actor) {
+				actor->selectLod(m_view, m_projection, m_viewportHeight, m_lodPixelError);
+			}
+		}
+	}
+
+	// 4) Frustum culling: lista de entidades visibles para render()
+	cullEntities();
+}
+
+void
+SceneGraph::cullEntities() {
+	const bool hasCamera = m_viewportHeight > 0.0f;
+	if (hasCamera) {
+		m_culler.setViewProjection(m_view * m_projection);
+	}
+	m_culler.clear();
+	m_cullItems.clear();
+	m_entityVisible.assign(m_entities.size(), 0);
+
+	// Volúmenes en mundo de cada malla de cada actor
+	for (uint32_t i = 0; i < m_entities.size(); ++i)
+	{
+		Actor* actor = dynamic_cast<Actor*>(m_entities[i]);
+		if (!actor) {
+			m_entityVisible[i] = m_entities[i] ? 1 : 0;
+			continue;
+		}
+		actor->updateWorldBounds();
+		actor->setMeshesVisible(!hasCamera);
+		m_entityVisible[i] = hasCamera ? 0 : 1;
+
+		const std::vector<BoundingVolume>& bounds = actor->getWorldBounds();
+		for (uint32_t mesh = 0; mesh < bounds.size(); ++mesh) {
+			m_culler.add(bounds[mesh]);
+			m_cullItems.push_back({ i, mesh });
+		}
+	}
+
+	if (hasCamera) {
+		m_culler.cull(m_visibleItems);
+		for (uint32_t item : m_visibleItems) {
+			const CullItem& c = m_cullItems[item];
+			static_cast<Actor*>(m_entities[c.entity])->setMeshVisible(c.mesh, true);
+			m_entityVisible[c.entity] = 1;
+		}
+		m_cullingStats = m_culler.getStats();
+
+		// Refinamiento por meshlets de las mallas visibles y mips que piden sus texturas en streaming
+		XMFLOAT4X4 cameraWorld;
+		XMStoreFloat4x4(&cameraWorld, XMMatrixInverse(nullptr, m_view));
+		const XMFLOAT3 cameraPosition(cameraWorld._41, cameraWorld._42, cameraWorld._43);
+		m_meshletStats = CullingStats();
+		for (uint32_t i = 0; i < m_entities.size(); ++i)
+		{
+			if (m_entityVisible[i]) {
+				Actor* actor = dynamic_cast<Actor*>(m_entities[i]);
+				if (actor) {
+					actor->cullMeshlets(m_culler, cameraPosition, m_meshletStats);
+					actor->requestTextureMips(m_view, m_projection, m_viewportHeight);
+				}
+			}
+		}
+	}
+	else {
+		m_cullingStats.tested = static_cast<uint32_t>(m_cullItems.size());
+		m_cullingStats.visible = m_cullingStats.tested;
+		m_cullingStats.culled = 0;
+		m_meshletStats = CullingStats();
+	}
+
+	m_visibleEntities.clear();
+	for (uint32_t i = 0; i < m_entities.size(); ++i)
+	{
+		if (m_entityVisible[i]) {
+			m_visibleEntities.push_back(m_entities[i]);
+		}
+	}
 }
 
 void 
@@ -199,8 +294,8 @@ SceneGraph::updateWorldRecursive(Entity* node, const XMMATRIX& parentWorld) {
 }
 
 void SceneGraph::render(DeviceContext& deviceContext) {
-	// Render all entities
-	for (auto& e : m_entities) {
+	// Render de las entidades que pasaron el culling en update()
+	for (auto& e : m_visibleEntities) {
 		if (e) {
 			e->render(deviceContext);
 		}
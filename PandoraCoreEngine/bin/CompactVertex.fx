@@ -0,0 +1,56 @@
+﻿//--------------------------------------------------------------------------------------
+// File: CompactVertex.fx
+//
+// Variante de PandoraCoreEngine.fx para mallas con CompactVertex (VertexCodec).
+// Mismos registros: b0 vista, b1 proyección, b2 mundo y color, t0/s0 albedo; b3 trae la
+// descuantización de la malla. GeometryPool solo toma de aquí el VS y el InputLayout,
+// el PS enlazado sigue siendo el de PandoraCoreEngine.fx (este PS es el equivalente).
+//--------------------------------------------------------------------------------------
+
+#include "CompactVertex.fxh"
+
+Texture2D txDiffuse : register( t0 );
+SamplerState samLinear : register( s0 );
+
+cbuffer cbNeverChanges : register( b0 )
+{
+    matrix View;
+};
+
+cbuffer cbChangeOnResize : register( b1 )
+{
+    matrix Projection;
+};
+
+cbuffer cbChangesEveryFrame : register( b2 )
+{
+    matrix World;
+    float4 vMeshColor;
+};
+
+struct PS_INPUT
+{
+    float4 Pos : SV_POSITION;
+    float2 Tex : TEXCOORD0;
+};
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+PS_INPUT VS( VS_COMPACT_INPUT input )
+{
+    PS_INPUT output = (PS_INPUT)0;
+    output.Pos = mul( DecodeCompactPosition( input.Pos ), World );
+    output.Pos = mul( output.Pos, View );
+    output.Pos = mul( output.Pos, Projection );
+    output.Tex = input.Tex;
+    return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader
+//--------------------------------------------------------------------------------------
+float4 PS( PS_INPUT input ) : SV_Target
+{
+    return txDiffuse.Sample( samLinear, input.Tex ) * vMeshColor;
+}
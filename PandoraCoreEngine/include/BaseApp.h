@@ -5,6 +5,8 @@
 #include "DeviceContext.h"
 #include "SwapChain.h"
 #include "Texture.h"
+#include "TextureLoader.h"
+#include "TextureStreamer.h"
 #include "RenderTargetView.h"
 #include "DepthStencilView.h"
 #include "Viewport.h"
@@ -59,11 +61,14 @@ private:
 	DepthStencilView									  m_depthStencilView;
 	Viewport                            m_viewport;
 	ShaderProgram												m_shaderProgram;
+	ShaderProgram												m_compactShaderProgram;
 
 	Buffer															m_cbNeverChanges;
 	Buffer															m_cbChangeOnResize;
 
-	Texture 														m_PrintStreamAlbedo;
+	TextureLoader                       m_textureLoader;
+	TextureStreamer                     m_textureStreamer;
+	EU::TSharedPointer<StreamedTexture> m_PrintStreamAlbedo;
   Texture         						        m_skyboxTex;
 
 	XMMATRIX                            m_View;
@@ -0,0 +1,75 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "MipGenerator.h"
+
+/**
+ * @brief Formato de compresión por bloques de las texturas importadas.
+ */
+enum class BlockFormat {
+  None = 0,  ///< Sin comprimir (R8G8B8A8).
+  Auto = 1,  ///< BC1 si la imagen es opaca, BC3 si tiene alfa.
+  BC1 = 2,   ///< RGB, 4 bits por texel (8:1). El alfa se descarta.
+  BC3 = 3,   ///< RGBA, 8 bits por texel (4:1). Color BC1 + alfa BC4.
+  BC5 = 4,   ///< Dos canales (RG), 8 bits por texel. Pensado para mapas de normales.
+  BC7 = 5    ///< RGBA, 8 bits por texel, mejor calidad. Requiere feature level 11_0.
+};
+
+/**
+ * @brief Compromiso entre velocidad de compresión y calidad.
+ */
+enum class CompressionQuality {
+  Fast = 0,    ///< Extremos por caja envolvente; una sola evaluación.
+  Normal = 1,  ///< Extremos por eje principal (PCA); prueba variantes (p-bits, modos BC4).
+  High = 2     ///< Normal + refinamiento por mínimos cuadrados de los extremos.
+};
+
+/**
+ * @class BlockCompressor
+ * @brief Compresor en CPU a BC1, BC3, BC5 y BC7 (modo 6) de una cadena de mips RGBA8.
+ *
+ * Cada bloque de 4x4 se carga en formato SoA (un registro SSE por canal para cuatro
+ * texeles) y la elección de índices compara cada texel contra toda la paleta del
+ * bloque con SSE. Las filas de bloques de cada nivel se reparten en el @c ThreadPool.
+ *
+ * Los texeles se comprimen en el espacio en que vienen (sRGB codificado para color),
+ * y el formato resultante es la variante @c _UNORM, igual que las texturas sin comprimir.
+ */
+class
+  BlockCompressor {
+public:
+  /**
+   * @brief Formato DXGI de un formato de bloque (ya resuelto, no @c Auto).
+   */
+  static DXGI_FORMAT
+    getDxgiFormat(BlockFormat format);
+
+  /**
+   * @brief Resuelve @c BlockFormat::Auto según el alfa del nivel 0 de @p source.
+   */
+  static BlockFormat
+    resolve(BlockFormat format, const MipChain& source);
+
+  /**
+   * @brief Describe un nivel de @p width x @p height en @p format (RGBA8 o BC).
+   *
+   * @param offset Desplazamiento del nivel dentro de los datos de la cadena.
+   */
+  static MipLevel
+    describeLevel(DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t offset);
+
+  /**
+   * @brief Comprime todos los niveles de @p source.
+   *
+   * @param source  Cadena RGBA8 (ver MipGenerator::generate()).
+   * @param format  Formato de bloque; @c Auto se resuelve con resolve().
+   * @param quality Compromiso velocidad/calidad.
+   * @param out     Recibe la cadena comprimida.
+   * @return @c S_OK si fue exitoso; @c E_INVALIDARG si la fuente no es RGBA8 o el
+   *         nivel 0 no mide un múltiplo de 4 (requisito de D3D11 para formatos BC).
+   */
+  static HRESULT
+    compress(const MipChain& source,
+             BlockFormat format,
+             CompressionQuality quality,
+             MipChain& out);
+};
@@ -103,6 +103,7 @@ public:
    * @param NumBuffers      Nmero de buffers a enlazar (tpicamente 1 para esta clase).
    * @param setPixelShader  Si es @c true y el buffer es de constantes, tambin se enlaza a PS (adems de VS).
    * @param format          Formato del ndice (@c DXGI_FORMAT_R16_UINT o @c DXGI_FORMAT_R32_UINT) cuando es Index Buffer.
+   *                        Con @c DXGI_FORMAT_UNKNOWN se usa el formato con el que se cre el buffer.
    *
    * @pre @c m_buffer debe estar creado y @c m_bindFlag configurado correctamente.
    * @sa init()
@@ -161,4 +162,9 @@ private:
    * @brief Bandera de enlace (@c D3D11_BIND_* ) que define el rol del buffer.
    */
   unsigned int m_bindFlag = 0;
+
+  /**
+   * @brief Formato de ndices con el que se cre el buffer (solo Index Buffer).
+   */
+  DXGI_FORMAT m_indexFormat = DXGI_FORMAT_UNKNOWN;
 };
\ No newline at end of file
@@ -0,0 +1,96 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @struct ConstantBufferUploaderStats
+ * @brief Resumen del frame anterior, para la interfaz.
+ */
+struct ConstantBufferUploaderStats
+{
+  uint32_t writes = 0;  ///< Map con @c WRITE_DISCARD (uno por render()).
+  uint32_t bytes = 0;   ///< Bytes copiados a los buffers mapeados.
+};
+
+/**
+ * @class ConstantBufferUploader
+ * @brief Constantes por draw sin un @c ID3D11Buffer por actor ni @c UpdateSubresource.
+ *
+ * Hay un buffer @c D3D11_USAGE_DYNAMIC por registro b#. render() lo mapea con
+ * @c WRITE_DISCARD, copia las constantes directamente desde quien llama y lo enlaza; el
+ * driver renombra el buffer en cada descarte, así que varios draws del mismo frame no se
+ * pisan. Un buffer por registro permite tener a la vez, p. ej., el mundo en b2 y la
+ * descuantización en b3.
+ *
+ * Existe una instancia del motor accesible con getInstance(); solo se usa en el hilo
+ * del dispositivo.
+ */
+class
+  ConstantBufferUploader {
+public:
+  /**
+   * @brief Bytes máximos de unas constantes (tamaño de cada buffer).
+   */
+  static constexpr uint32_t kMaxSize = 1024;
+
+  /**
+   * @brief Registros b# con buffer propio.
+   */
+  static constexpr unsigned int kSlotCount = D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT;
+
+  ConstantBufferUploader() = default;
+  ~ConstantBufferUploader() = default;
+
+  /**
+   * @brief Instancia compartida del motor.
+   */
+  static ConstantBufferUploader&
+    getInstance();
+
+  /**
+   * @brief Crea un buffer dinámico por registro.
+   *
+   * @return @c S_OK si fue exitoso; código @c HRESULT en caso contrario.
+   */
+  HRESULT
+    init(Device& device);
+
+  /**
+   * @brief Empieza un frame: guarda las estadísticas del anterior.
+   */
+  void
+    update();
+
+  /**
+   * @brief Copia @p size bytes de @p data al buffer del registro @p slot y lo enlaza.
+   *
+   * @param slot           Registro b# de destino.
+   * @param setPixelShader Si es @c true también se enlaza al Pixel Shader (además del VS).
+   */
+  void
+    render(DeviceContext& deviceContext,
+           const void* data,
+           uint32_t size,
+           unsigned int slot,
+           bool setPixelShader = false);
+
+  /**
+   * @brief Libera los buffers.
+   */
+  void
+    destroy();
+
+  /**
+   * @brief Uso del frame anterior.
+   */
+  const ConstantBufferUploaderStats&
+    getStats() const { return m_stats; }
+
+private:
+  ID3D11Buffer* m_buffers[kSlotCount] = {};  ///< Uno por registro b#.
+  uint32_t m_writes = 0;
+  uint32_t m_bytes = 0;
+  ConstantBufferUploaderStats m_stats;
+};
@@ -0,0 +1,81 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "MappedFile.h"
+
+/**
+ * @class ContentHash
+ * @brief Hash de contenido de 64 bits para claves de caché de recursos importados.
+ *
+ * Procesa bloques de 8 bytes con multiplicación y mezcla (no criptográfico);
+ * su único fin es detectar que un archivo fuente o la configuración de
+ * importación cambiaron.
+ */
+class
+  ContentHash {
+public:
+  /**
+   * @brief Calcula el hash de un bloque de memoria.
+   * @param data Puntero a los datos (puede ser @c nullptr si @p size es 0).
+   * @param size Tamaño en bytes.
+   * @param seed Semilla o hash previo para encadenar bloques.
+   */
+  static uint64_t
+    hashBytes(const void* data, size_t size, uint64_t seed = kSeed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t h = seed ^ (static_cast<uint64_t>(size) * kPrime);
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+      uint64_t word;
+      std::memcpy(&word, bytes + i, sizeof(word));
+      h = (h ^ mix(word)) * kPrime;
+    }
+    uint64_t tail = 0;
+    for (size_t shift = 0; i < size; ++i, shift += 8) {
+      tail |= static_cast<uint64_t>(bytes[i]) << shift;
+    }
+    h = (h ^ mix(tail)) * kPrime;
+    return mix(h);
+  }
+
+  /**
+   * @brief Calcula el hash de una cadena (p. ej. la configuración del importador).
+   */
+  static uint64_t
+    hashString(const std::string& text, uint64_t seed = kSeed) {
+    return hashBytes(text.data(), text.size(), seed);
+  }
+
+  /**
+   * @brief Calcula el hash del contenido completo de un archivo proyectado en memoria.
+   * @param fileName Ruta del archivo.
+   * @param outHash  Hash resultante.
+   * @return @c true si el archivo pudo leerse.
+   */
+  static bool
+    hashFile(const std::string& fileName, uint64_t& outHash) {
+    MappedFile file;
+    if (FAILED(file.init(fileName))) {
+      return false;
+    }
+    outHash = hashBytes(file.data(), file.size());
+    return true;
+  }
+
+private:
+  static constexpr uint64_t kSeed = 0x9E3779B97F4A7C15ull;  ///< Semilla por defecto.
+  static constexpr uint64_t kPrime = 0x100000001B3ull;      ///< Primo FNV de 64 bits.
+
+  /**
+   * @brief Finalizador de mezcla (splitmix64).
+   */
+  static uint64_t
+    mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+  }
+};
@@ -0,0 +1,51 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "MipGenerator.h"
+
+/**
+ * @class DdsFile
+ * @brief Lectura y escritura de archivos DDS generados por el motor.
+ *
+ * save() escribe una textura 2D con todos sus mips en un DDS estándar (encabezado
+ * DX10 para BC5/BC7, FourCC DXT1/DXT5 para BC1/BC3 y máscaras RGBA para RGBA8), que
+ * D3DX y el camino @c ExtensionType::DDS de Texture::init() cargan tal cual.
+ *
+ * En los campos reservados del encabezado se guarda una marca del motor y la clave
+ * de caché; así load() distingue una caché vigente de una obsoleta y save() nunca
+ * sobrescribe un DDS creado a mano o con otra herramienta.
+ */
+class
+  DdsFile {
+public:
+  /**
+   * @brief Versión del contenido que el motor escribe. Incrementar si cambia el compresor.
+   */
+  static constexpr uint32_t kVersion = 1;
+
+  /**
+   * @brief Indica si @p path es un DDS escrito por el motor (o no existe).
+   */
+  static bool
+    isWritable(const std::string& path);
+
+  /**
+   * @brief Proyecta un DDS del motor si su clave coincide (sin copiar los texeles,
+   *        ver @c MipChain::mapping).
+   *
+   * @param path  Ruta del archivo.
+   * @param key   Clave de caché esperada.
+   * @param chain Destino; solo se modifica si la carga es válida.
+   * @return @c true si el archivo era del motor, vigente y se cargó.
+   */
+  static bool
+    load(const std::string& path, uint64_t key, MipChain& chain);
+
+  /**
+   * @brief Escribe @p chain como DDS (archivo temporal + renombrado atómico).
+   *
+   * @return @c S_OK si fue exitoso; @c E_ACCESSDENIED si @p path es un DDS ajeno;
+   *         @c E_FAIL si no se pudo escribir.
+   */
+  static HRESULT
+    save(const std::string& path, uint64_t key, const MipChain& chain);
+};
@@ -41,11 +41,24 @@ public:
   void RSSetViewports(unsigned int NumViewports,
                       const D3D11_VIEWPORT* pViewports);
 
-  /** @brief Asigna Shader Resource Views a la etapa de Pixel Shader. */
+  /**
+   * @brief Asigna Shader Resource Views a la etapa de Pixel Shader.
+   *
+   * Omite la llamada si los slots ya tienen esas mismas vistas (p. ej. actores que
+   * comparten una pgina de atlas).
+   */
   void PSSetShaderResources(unsigned int StartSlot,
                             unsigned int NumViews,
                             ID3D11ShaderResourceView* const* ppShaderResourceViews);
 
+  /**
+   * @brief Olvida las vistas recordadas por PSSetShaderResources().
+   *
+   * Llamar cuando algo enlaza recursos sin pasar por esta clase (ImGui, ClearState()),
+   * tpicamente al inicio de cada frame.
+   */
+  void invalidateShaderResourceCache();
+
   /** @brief Define el Input Layout activo para la etapa de ensamblado de entrada. */
   void IASetInputLayout(ID3D11InputLayout* pInputLayout);
 
@@ -128,4 +141,11 @@ public:
 public:
   /** @brief Puntero al contexto inmediato de Direct3D 11. */
   ID3D11DeviceContext* m_deviceContext = nullptr;
+
+private:
+  /** @brief Slots de Pixel Shader cuyas vistas se recuerdan para omitir enlaces repetidos. */
+  static constexpr unsigned int kCachedShaderResourceSlots = 8;
+
+  /** @brief ltima vista enlazada en cada slot (nulo = desconocida). */
+  ID3D11ShaderResourceView* m_boundShaderResources[kCachedShaderResourceSlots] = {};
 };
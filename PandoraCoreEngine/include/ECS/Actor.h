@@ -2,12 +2,17 @@
 #include "Prerequisites.h"
 #include "Entity.h"
 #include "Buffer.h"
+#include "GeometryPool.h"
 #include "Texture.h"
+#include "TextureLoader.h"
+#include "TextureStreamer.h"
 #include "Transform.h"
 #include "SamplerState.h"
 //#include "Rasterizer.h"
 //#include "BlendState.h"
 #include "ShaderProgram.h"
+#include "FrustumCuller.h"
+#include "MeshletBuilder.h"
 //#include "DepthStencilState.h"
 
 class Device;
@@ -87,7 +92,8 @@ public:
 	/**
 	 * @brief Establece las mallas del actor.
 	 *
-	 * Inicializa buffers de vrtices e ndices asociados a las mallas.
+	 * Copia los vrtices e ndices de cada malla al GeometryPool (buffers compartidos por
+	 * todos los actores); destroy() los retira.
 	 *
 	 * @param device Dispositivo con el cual se inicializan las mallas.
 	 * @param meshes Vector de componentes de malla que se asignarn al actor.
@@ -116,6 +122,36 @@ public:
 	void
 		setTextures(std::vector<Texture> textures) { m_textures = textures; }
 
+	/**
+	 * @brief Establece texturas que se cargan en segundo plano.
+	 *
+	 * Solo se usan si el actor no tiene texturas sncronas; mientras no estn listas
+	 * se enlaza el placeholder del @c TextureLoader. El loader conserva la propiedad.
+	 * @param textures Texturas devueltas por TextureLoader::request().
+	 */
+	void
+		setAsyncTextures(std::vector<EU::TSharedPointer<AsyncTexture>> textures) { m_asyncTextures = textures; }
+
+	/**
+	 * @brief Establece texturas en streaming, con residencia de mips segn su tamao en pantalla.
+	 *
+	 * Tienen prioridad sobre las asncronas y ceden ante las sncronas. El @c TextureStreamer
+	 * conserva la propiedad.
+	 * @param textures Texturas devueltas por TextureStreamer::request().
+	 */
+	void
+		setStreamedTextures(std::vector<EU::TSharedPointer<StreamedTexture>> textures) { m_streamedTextures = textures; }
+
+	/**
+	 * @brief Dibuja el actor con una pgina de @c TextureAtlas en lugar de su propia textura.
+	 *
+	 * Las UV de las mallas deben haberse llevado antes a su regin con
+	 * TextureAtlas::remapUVs() (antes de setMesh()). El atlas conserva la propiedad.
+	 * @param page SRV devuelto por TextureAtlas::getPageView(); nulo para dejar de usarlo.
+	 */
+	void
+		setAtlasPage(ID3D11ShaderResourceView* page) { m_atlasPage = page; }
+
 	/**
 	 * @brief Define si el actor proyecta sombras.
 	 * @param v Valor booleano que habilita o deshabilita las sombras.
@@ -140,17 +176,114 @@ public:
 	void
 		renderShadow(DeviceContext& deviceContext);
 
+	/**
+	 * @brief Elige el LOD de cada malla segn su tamao proyectado en pantalla.
+	 *
+	 * Para cada malla se proyecta su esfera envolvente (en espacio de mundo) y se toma
+	 * el nivel ms simple cuyo error geomtrico, llevado a pxeles a la distancia del
+	 * punto ms cercano de la esfera, no supera @p maxPixelError. Las mallas que
+	 * ocupan menos de unos pocos pxeles usan directamente el ltimo nivel.
+	 *
+	 * @param view           Matriz de vista.
+	 * @param projection     Matriz de proyeccin en perspectiva.
+	 * @param viewportHeight Alto del viewport en pxeles.
+	 * @param maxPixelError  Error mximo tolerado en pxeles.
+	 */
+	void
+		selectLod(const XMMATRIX& view, const XMMATRIX& projection, float viewportHeight, float maxPixelError);
+
+	/**
+	 * @brief Nivel de detalle elegido para la malla @p meshIndex en el ltimo selectLod().
+	 */
+	unsigned int
+		getLodLevel(size_t meshIndex) const { return meshIndex < m_lodLevels.size() ? m_lodLevels[meshIndex] : 0; }
+
+	/**
+	 * @brief Lleva la caja y la esfera envolventes de cada malla a espacio de mundo.
+	 *
+	 * Usa la matriz del @c Transform, la misma con la que se dibuja el actor.
+	 */
+	void
+		updateWorldBounds();
+
+	/**
+	 * @brief Volmenes envolventes en espacio de mundo (uno por malla) del ltimo updateWorldBounds().
+	 */
+	const std::vector<BoundingVolume>&
+		getWorldBounds() const { return m_worldBounds; }
+
+	/**
+	 * @brief Marca todas las mallas como visibles u ocultas.
+	 */
+	void
+		setMeshesVisible(bool visible) {
+		m_meshVisible.assign(m_meshes.size(), visible ? 1 : 0);
+		m_meshletCulled.assign(m_meshes.size(), 0);
+	}
+
+	/**
+	 * @brief Marca la malla @p meshIndex como visible u oculta; render() omite las ocultas.
+	 */
+	void
+		setMeshVisible(size_t meshIndex, bool visible) {
+		if (meshIndex < m_meshVisible.size()) {
+			m_meshVisible[meshIndex] = visible ? 1 : 0;
+		}
+	}
+
+	/**
+	 * @brief Indica si la malla @p meshIndex pas el ltimo culling.
+	 */
+	bool
+		isMeshVisible(size_t meshIndex) const {
+		return meshIndex >= m_meshVisible.size() || m_meshVisible[meshIndex] != 0;
+	}
+
+	/**
+	 * @brief Culling por clsteres de las mallas visibles que se dibujan en LOD 0.
+	 *
+	 * Guarda por malla los rangos de ndices de los meshlets que quedan dentro del
+	 * frustum y de frente a la cmara; render() los dibuja en lugar del LOD completo.
+	 * setMeshesVisible() descarta el resultado del frame anterior.
+	 *
+	 * @param frustum        Culler con los planos de la cmara del frame.
+	 * @param cameraPosition Posicin de la cmara en espacio de mundo.
+	 * @param stats          Acumula los meshlets evaluados, visibles y descartados.
+	 */
+	void
+		cullMeshlets(const FrustumCuller& frustum, const XMFLOAT3& cameraPosition, CullingStats& stats);
+
+	/**
+	 * @brief Pide a las texturas en streaming el mip que necesitan sus mallas visibles.
+	 *
+	 * Proyecta la esfera envolvente de cada malla visible igual que selectLod() y pide
+	 * para el dimetro en pxeles resultante (StreamedTexture::requestScreenSize()).
+	 * Una malla que contiene a la cmara pide el nivel 0.
+	 *
+	 * @param view           Matriz de vista.
+	 * @param projection     Matriz de proyeccin en perspectiva.
+	 * @param viewportHeight Alto del viewport en pxeles.
+	 */
+	void
+		requestTextureMips(const XMMATRIX& view, const XMMATRIX& projection, float viewportHeight);
+
 private:
 	std::vector<MeshComponent> m_meshes;   ///< Conjunto de componentes de malla del actor.
+	std::vector<unsigned int> m_lodLevels; ///< LOD elegido por malla (0 = mximo detalle).
+	std::vector<BoundingVolume> m_worldBounds; ///< Volmenes envolventes por malla en espacio de mundo.
+	std::vector<uint8_t> m_meshVisible;    ///< Resultado del culling por malla (vaco = todas visibles).
+	std::vector<uint8_t> m_meshletCulled;  ///< Por malla: se dibujan los rangos de @c m_meshletRanges.
+	std::vector<std::vector<MeshletRange>> m_meshletRanges; ///< Rangos de meshlets visibles por malla.
 	std::vector<Texture> m_textures;       ///< Texturas aplicadas al actor.
-	std::vector<Buffer> m_vertexBuffers;   ///< Buffers de vrtices asociados a las mallas.
-	std::vector<Buffer> m_indexBuffers;    ///< Buffers de ndices asociados a las mallas.
+	std::vector<EU::TSharedPointer<AsyncTexture>> m_asyncTextures; ///< Texturas asncronas (propiedad del loader).
+	std::vector<EU::TSharedPointer<StreamedTexture>> m_streamedTextures; ///< Texturas en streaming (propiedad del streamer).
+	ID3D11ShaderResourceView* m_atlasPage = nullptr; ///< Pgina de atlas compartida (propiedad del atlas).
+	std::vector<GeometryHandle> m_geometry; ///< Vrtices e ndices de cada malla en el GeometryPool.
 
 	//BlendState m_blendstate;               ///< Estado de blending usado por el actor.
 	//Rasterizer m_rasterizer;               ///< Estado de rasterizacin usado por el actor.
 	SamplerState m_sampler;                ///< Estado de muestreo de texturas.
 	CBChangesEveryFrame m_model;           ///< Constante de buffer para transformaciones por frame.
-	Buffer m_modelBuffer;                  ///< Constant buffer que contiene @c m_model.
 
 	// Recursos para sombras
 	ShaderProgram m_shaderShadow;          ///< Shader program usado para renderizar sombras.
@@ -0,0 +1,188 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+class MeshComponent;
+
+/**
+ * @struct FbxAxisConversion
+ * @brief Sistema de ejes y unidades de un FBX (nodo @c GlobalSettings) y su paso al del motor.
+ *
+ * El motor usa el sistema de @c FbxAxisSystem::DirectX (Y arriba, Z al frente, mano izquierda)
+ * en metros. apply() lleva los vértices de la malla a ese sistema: permuta y escala las
+ * posiciones y, si la conversión cambia de mano, invierte el winding de los triángulos.
+ * Los valores por defecto son los que el SDK asume si el archivo no trae @c GlobalSettings.
+ *
+ * Tanto este lector como la ruta del SDK (Model3D) hornean la conversión en los vértices,
+ * así que las transformaciones de escena se expresan en metros: una exportación típica
+ * (Y arriba, mano derecha, centímetros) queda 100 veces más pequeña y reflejada en X
+ * respecto de sus control points.
+ */
+struct FbxAxisConversion
+{
+  int upAxis = 1;                ///< Eje arriba (0 = X, 1 = Y, 2 = Z).
+  int upAxisSign = 1;            ///< Sentido del eje arriba (+1 / -1).
+  int frontAxis = 2;             ///< Eje frontal.
+  int frontAxisSign = 1;
+  int coordAxis = 0;             ///< Eje restante.
+  int coordAxisSign = 1;
+  double unitScaleFactor = 1.0;  ///< Centímetros por unidad del archivo.
+
+  /**
+   * @brief Indica si los tres ejes son distintos, los signos son ±1 y la escala es positiva.
+   */
+  bool
+    isValid() const;
+
+  /**
+   * @brief Indica si el archivo ya está en el sistema del motor y apply() no cambiaría nada.
+   */
+  bool
+    isIdentity() const;
+
+  /**
+   * @brief Convierte las posiciones de @p vertices y, si cambia la mano, el winding de @p indices.
+   */
+  void
+    apply(std::vector<SimpleVertex>& vertices, std::vector<unsigned int>& indices) const;
+};
+
+/**
+ * @class FbxBinaryReader
+ * @brief Lector nativo de FBX binario (7.x) que no depende del FBX SDK.
+ *
+ * Recorre el árbol de registros de nodo, descomprime los arreglos de propiedades
+ * con @c Inflater y extrae de cada @c Geometry "Mesh" los nodos @c Vertices,
+ * @c PolygonVertexIndex y el primer @c LayerElementUV. Los polígonos se triangulan
+ * en abanico con el mismo orden de vértices que produce la ruta del SDK, de modo que
+ * ambas rutas generan mallas equivalentes. Los ejes y unidades de @c GlobalSettings se
+ * aplican a los vértices con FbxAxisConversion; si no son válidos, buildMeshes() falla y
+ * quien llama puede recurrir al SDK.
+ *
+ * El árbol se construye sobre los bytes originales (sin copias), por lo que el búfer
+ * de entrada debe seguir vivo mientras se use el lector.
+ */
+class
+  FbxBinaryReader {
+public:
+  FbxBinaryReader() = default;
+  ~FbxBinaryReader() = default;
+
+  /**
+   * @brief Indica si @p data comienza con la firma de un FBX binario.
+   */
+  static bool
+    isBinaryFbx(const char* data, size_t size);
+
+  /**
+   * @brief Analiza el árbol de nodos de un FBX binario.
+   *
+   * @param data Contenido completo del archivo.
+   * @param size Tamaño de @p data en bytes.
+   * @return @c S_OK si fue exitoso; @c E_FAIL si la firma, la versión o algún registro no son válidos.
+   */
+  HRESULT
+    init(const char* data, size_t size);
+
+  /**
+   * @brief Convierte cada geometría "Mesh" en un @c MeshComponent.
+   *
+   * Las mallas se procesan en paralelo con @c ThreadPool; el orden de salida sigue el
+   * orden de los nodos @c Geometry del archivo. Las mallas no se optimizan aquí.
+   *
+   * @param meshes Destino; se agregan las mallas encontradas.
+   * @return @c S_OK si se extrajo al menos una malla; @c E_FAIL en otro caso.
+   */
+  HRESULT
+    buildMeshes(std::vector<MeshComponent>& meshes) const;
+
+  /**
+   * @brief Proyecta @p fileName en memoria, lo analiza y extrae sus mallas.
+   */
+  HRESULT
+    load(const std::string& fileName, std::vector<MeshComponent>& meshes);
+
+  /**
+   * @brief Libera el árbol analizado.
+   */
+  void
+    destroy();
+
+  /**
+   * @brief Versión del formato leída de la cabecera (p. ej. 7400).
+   */
+  uint32_t
+    getVersion() const { return m_version; }
+
+  /**
+   * @brief Ejes y unidades leídos de @c GlobalSettings en init().
+   */
+  const FbxAxisConversion&
+    getAxisConversion() const { return m_axisConversion; }
+
+private:
+  /**
+   * @brief Propiedad de un nodo; apunta a los bytes originales del archivo.
+   */
+  struct Property {
+    char type = 0;                ///< Código de tipo (Y, C, I, F, D, L, S, R, f, d, l, i, b).
+    const char* data = nullptr;   ///< Inicio del valor (o del bloque del arreglo).
+    uint32_t size = 0;            ///< Bytes de @c data.
+    uint32_t arrayLength = 0;     ///< Elementos del arreglo (solo tipos en minúscula).
+    uint32_t encoding = 0;        ///< 0 = sin comprimir, 1 = zlib.
+  };
+
+  /**
+   * @brief Registro de nodo FBX con sus propiedades e hijos.
+   */
+  struct Node {
+    std::string name;
+    std::vector<Property> properties;
+    std::vector<Node> children;
+
+    const Node*
+      findChild(const char* childName) const;
+  };
+
+  /**
+   * @brief Lee un registro de nodo. @p isNull se activa con el registro nulo que cierra una lista.
+   */
+  bool
+    parseNode(const char*& cursor, Node& node, bool& isNull, int depth);
+
+  bool
+    parseProperty(const char*& cursor, const char* end, Property& property);
+
+  static bool
+    readString(const Property& property, std::string& out);
+
+  static bool
+    readInt64(const Property& property, int64_t& out);
+
+  static bool
+    readDouble(const Property& property, double& out);
+
+  /**
+   * @brief Lee los ejes y la escala de las propiedades @c P de @c GlobalSettings.
+   */
+  void
+    readGlobalSettings();
+
+  template<typename T>
+  static bool
+    readArray(const Property& property, std::vector<T>& out);
+
+  /**
+   * @brief Convierte un nodo @c Geometry en malla. Solo lee el árbol, por lo que es seguro en paralelo.
+   */
+  static HRESULT
+    buildMesh(const Node& geometry,
+              const std::string& name,
+              const FbxAxisConversion& conversion,
+              MeshComponent& mesh);
+
+  const char* m_begin = nullptr;  ///< Inicio del archivo.
+  const char* m_end = nullptr;    ///< Fin del archivo.
+  uint32_t m_version = 0;         ///< Versión del formato.
+  Node m_root;                    ///< Nodos de primer nivel.
+  FbxAxisConversion m_axisConversion;
+};
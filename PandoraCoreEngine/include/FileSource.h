@@ -0,0 +1,179 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "MappedFile.h"
+
+/**
+ * @struct FileSpan
+ * @brief Contenido de un archivo en memoria, sin copia: un rango dentro de una proyección.
+ *
+ * El rango es válido mientras exista alguna copia del @c FileSpan (o del
+ * @c shared_ptr de @c mapping), así que puede pasarse a otro hilo o guardarse en una
+ * @c MipChain. Varios spans de un mismo archivo empaquetado comparten la proyección.
+ */
+struct FileSpan
+{
+  std::shared_ptr<MappedFile> mapping; ///< Proyección que contiene el rango.
+  const uint8_t* data = nullptr;       ///< Primer byte del archivo.
+  size_t size = 0;                     ///< Tamaño del archivo en bytes.
+  std::string path;                    ///< Ruta pedida (normalizada), para mensajes.
+
+  /**
+   * @brief Libera la referencia a la proyección.
+   */
+  void
+    release() {
+    mapping.reset();
+    data = nullptr;
+    size = 0;
+  }
+};
+
+/**
+ * @class FileSource
+ * @brief Origen de archivos de solo lectura: directorio suelto, caché o paquete.
+ *
+ * Las rutas usan '/' y son relativas al directorio de trabajo (p. ej. "Assets/Text.png");
+ * normalizePath() las deja en esa forma. open() y exists() pueden llamarse desde
+ * cualquier hilo.
+ */
+class
+  FileSource {
+public:
+  virtual
+    ~FileSource() = default;
+
+  /**
+   * @brief Proyecta @p path.
+   *
+   * @param path Ruta normalizada.
+   * @param span Recibe el contenido; solo se modifica si tuvo éxito.
+   * @return @c S_OK si fue exitoso; @c E_FAIL (sin mensaje de error) si este origen
+   *         no tiene el archivo.
+   */
+  virtual HRESULT
+    open(const std::string& path, FileSpan& span) const = 0;
+
+  /**
+   * @brief Indica si este origen tiene @p path (ruta normalizada).
+   */
+  virtual bool
+    exists(const std::string& path) const = 0;
+
+  /**
+   * @brief Nombre para mensajes y estadísticas.
+   */
+  virtual std::string
+    getName() const = 0;
+
+  /**
+   * @brief Convierte '\' en '/', quita los "./" iniciales y une las '/' repetidas.
+   */
+  static std::string
+    normalizePath(const std::string& path);
+};
+
+/**
+ * @class LooseFileSource
+ * @brief Archivos sueltos bajo un directorio raíz, proyectados uno a uno.
+ */
+class
+  LooseFileSource : public FileSource {
+public:
+  /**
+   * @param root Directorio base; vacío = directorio de trabajo.
+   */
+  explicit LooseFileSource(const std::string& root = "") : m_root(root) {}
+
+  HRESULT
+    open(const std::string& path, FileSpan& span) const override;
+
+  bool
+    exists(const std::string& path) const override;
+
+  std::string
+    getName() const override { return m_root.empty() ? "." : m_root; }
+
+private:
+  /**
+   * @brief Ruta en disco de @p path.
+   */
+  std::string
+    resolve(const std::string& path) const;
+
+  std::string m_root; ///< Directorio base.
+};
+
+/**
+ * @class PackFileSource
+ * @brief Paquete ".pcpak": muchos archivos en una sola proyección.
+ *
+ * Formato: cabecera ("PCPK", versión, número de entradas), tabla de entradas
+ * (desplazamiento, tamaño y ruta) y el contenido de cada archivo alineado a
+ * kAlignment bytes. open() no copia ni hace llamadas al sistema: devuelve un rango
+ * dentro de la proyección del paquete, compartida por todos los spans.
+ */
+class
+  PackFileSource : public FileSource {
+public:
+  /**
+   * @brief Versión del formato. Incrementar al cambiar la cabecera o la tabla.
+   */
+  static constexpr uint32_t kVersion = 1;
+
+  /**
+   * @brief Alineación del contenido de cada archivo dentro del paquete.
+   */
+  static constexpr uint32_t kAlignment = 16;
+
+  PackFileSource() = default;
+  ~PackFileSource() = default;
+
+  /**
+   * @brief Proyecta el paquete y lee su tabla de entradas.
+   *
+   * @return @c S_OK si fue exitoso; @c E_FAIL si el archivo no existe o no es válido.
+   */
+  HRESULT
+    init(const std::string& archivePath);
+
+  HRESULT
+    open(const std::string& path, FileSpan& span) const override;
+
+  bool
+    exists(const std::string& path) const override;
+
+  std::string
+    getName() const override { return m_archivePath; }
+
+  /**
+   * @brief Número de archivos del paquete.
+   */
+  size_t
+    getEntryCount() const { return m_entries.size(); }
+
+  /**
+   * @brief Escribe un paquete con los archivos indicados (archivo temporal + renombrado).
+   *
+   * @param archivePath Paquete a crear.
+   * @param paths       Archivos a incluir; se guardan con su ruta normalizada.
+   * @return @c S_OK si fue exitoso; @c E_FAIL si algún archivo no pudo leerse o escribirse.
+   */
+  static HRESULT
+    write(const std::string& archivePath, const std::vector<std::string>& paths);
+
+  /**
+   * @brief Empaqueta todos los archivos bajo @p directories (recursivo).
+   */
+  static HRESULT
+    writeDirectories(const std::string& archivePath, const std::vector<std::string>& directories);
+
+private:
+  struct Entry {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  std::shared_ptr<MappedFile> m_mapping;                ///< Proyección del paquete completo.
+  std::unordered_map<std::string, Entry> m_entries;     ///< Ruta normalizada -> rango.
+  std::string m_archivePath;
+};
@@ -0,0 +1,55 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "FileSource.h"
+
+/**
+ * @class FileSystem
+ * @brief Punto único de lectura de assets: busca cada ruta en los orígenes montados.
+ *
+ * Los orígenes se consultan del último montado al primero; si ninguno tiene el archivo
+ * se recurre a los archivos sueltos del directorio de trabajo. Así un paquete ".pcpak"
+ * montado al inicio sustituye a los archivos de Assets sin cambiar las rutas del código,
+ * y durante el desarrollo basta con no montarlo.
+ *
+ * El contenido se entrega como @c FileSpan (proyección sin copia), listo para
+ * decodificar en memoria (ImageDecoder::decode()). Puede usarse desde cualquier hilo.
+ */
+class
+  FileSystem {
+public:
+  /**
+   * @brief Monta un origen con prioridad sobre los ya montados.
+   */
+  static void
+    mount(std::shared_ptr<FileSource> source);
+
+  /**
+   * @brief Monta el paquete @p archivePath si existe.
+   *
+   * @return @c S_OK si se montó; @c S_FALSE si no existe; @c E_FAIL si no es válido.
+   */
+  static HRESULT
+    mountPack(const std::string& archivePath);
+
+  /**
+   * @brief Desmonta todos los orígenes. Los spans ya abiertos siguen siendo válidos.
+   */
+  static void
+    unmountAll();
+
+  /**
+   * @brief Proyecta @p path desde el primer origen que lo tenga.
+   *
+   * @param path Ruta relativa al directorio de trabajo ('\' o '/').
+   * @param span Recibe el contenido.
+   * @return @c S_OK si fue exitoso; @c E_FAIL (sin mensaje de error) si no existe.
+   */
+  static HRESULT
+    open(const std::string& path, FileSpan& span);
+
+  /**
+   * @brief Indica si algún origen tiene @p path.
+   */
+  static bool
+    exists(const std::string& path);
+};
@@ -0,0 +1,201 @@
+﻿#pragma once
+#include <cstdint>
+#include <map>
+
+/**
+ * @struct FreeListAllocatorStats
+ * @brief Ocupación y fragmentación de un bloque, para la interfaz.
+ */
+struct FreeListAllocatorStats
+{
+  uint32_t capacity = 0;     ///< Unidades del bloque.
+  uint32_t used = 0;         ///< Unidades reservadas.
+  uint32_t allocations = 0;  ///< Rangos reservados.
+  uint32_t freeRanges = 0;   ///< Huecos libres (tras fusionar los contiguos).
+  uint32_t largestFree = 0;  ///< Hueco libre más grande.
+
+  /**
+   * @brief Fracción del espacio libre que no está en el hueco más grande (0 = sin fragmentar).
+   */
+  float
+    fragmentation() const {
+    const uint32_t freeUnits = capacity - used;
+    return freeUnits > 0 ? 1.0f - static_cast<float>(largestFree) / static_cast<float>(freeUnits) : 0.0f;
+  }
+};
+
+/**
+ * @class FreeListAllocator
+ * @brief Asignador de rangos con lista libre: solo lógica de desplazamientos, sin memoria ni GPU.
+ *
+ * Reparte rangos de un bloque de @c capacity unidades (vértices, índices...) con el
+ * criterio del hueco más ajustado (best fit) y fusiona los huecos contiguos al liberar.
+ * Los rangos viven hasta release(); cuando la fragmentación impide reservar aunque haya
+ * espacio total suficiente, quien lo usa mueve los datos y
+ * reconstruye el bloque con reset() y reserve() (ver GeometryPool::defragment()).
+ */
+class
+  FreeListAllocator {
+public:
+  FreeListAllocator() = default;
+  ~FreeListAllocator() = default;
+
+  /**
+   * @brief Fija la capacidad y deja todo el bloque libre.
+   */
+  void
+    init(uint32_t capacity) {
+    m_capacity = capacity;
+    reset();
+  }
+
+  /**
+   * @brief Libera todos los rangos.
+   */
+  void
+    reset() {
+    m_free.clear();
+    m_allocated.clear();
+    m_used = 0;
+    if (m_capacity > 0) {
+      m_free[0] = m_capacity;
+    }
+  }
+
+  /**
+   * @brief Reserva @p size unidades en el hueco más ajustado.
+   *
+   * @param size   Unidades pedidas (mayor que cero).
+   * @param offset Recibe el inicio del rango; solo se modifica si hubo espacio.
+   * @return @c false si @p size es cero o ningún hueco es suficiente.
+   */
+  bool
+    allocate(uint32_t size, uint32_t& offset) {
+    if (size == 0) {
+      return false;
+    }
+    auto best = m_free.end();
+    for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+      if (it->second >= size && (best == m_free.end() || it->second < best->second)) {
+        best = it;
+        if (it->second == size) {
+          break;
+        }
+      }
+    }
+    if (best == m_free.end()) {
+      return false;
+    }
+    offset = best->first;
+    const uint32_t remaining = best->second - size;
+    m_free.erase(best);
+    if (remaining > 0) {
+      m_free[offset + size] = remaining;
+    }
+    m_allocated[offset] = size;
+    m_used += size;
+    return true;
+  }
+
+  /**
+   * @brief Marca como reservado el rango [@p offset, @p offset + @p size), que debe estar libre.
+   *
+   * Sirve para reconstruir el bloque tras compactarlo.
+   */
+  bool
+    reserve(uint32_t offset, uint32_t size) {
+    if (size == 0) {
+      return false;
+    }
+    auto it = m_free.upper_bound(offset);
+    if (it == m_free.begin()) {
+      return false;
+    }
+    --it;
+    const uint32_t start = it->first;
+    const uint32_t length = it->second;
+    if (offset + size > start + length) {
+      return false;
+    }
+    m_free.erase(it);
+    if (offset > start) {
+      m_free[start] = offset - start;
+    }
+    if (offset + size < start + length) {
+      m_free[offset + size] = start + length - offset - size;
+    }
+    m_allocated[offset] = size;
+    m_used += size;
+    return true;
+  }
+
+  /**
+   * @brief Libera el rango que empieza en @p offset y lo fusiona con los huecos vecinos.
+   *
+   * @return @c false si @p offset no es el inicio de un rango reservado.
+   */
+  bool
+    release(uint32_t offset) {
+    auto allocated = m_allocated.find(offset);
+    if (allocated == m_allocated.end()) {
+      return false;
+    }
+    uint32_t start = offset;
+    uint32_t size = allocated->second;
+    m_allocated.erase(allocated);
+    m_used -= size;
+
+    auto next = m_free.find(start + size);
+    if (next != m_free.end()) {
+      size += next->second;
+      m_free.erase(next);
+    }
+    auto prev = m_free.lower_bound(start);
+    if (prev != m_free.begin()) {
+      --prev;
+      if (prev->first + prev->second == start) {
+        start = prev->first;
+        size += prev->second;
+        m_free.erase(prev);
+      }
+    }
+    m_free[start] = size;
+    return true;
+  }
+
+  /**
+   * @brief Capacidad del bloque.
+   */
+  uint32_t
+    getCapacity() const { return m_capacity; }
+
+  /**
+   * @brief Unidades libres en total (no necesariamente contiguas).
+   */
+  uint32_t
+    getFree() const { return m_capacity - m_used; }
+
+  /**
+   * @brief Ocupación y fragmentación actuales.
+   */
+  FreeListAllocatorStats
+    getStats() const {
+    FreeListAllocatorStats stats;
+    stats.capacity = m_capacity;
+    stats.used = m_used;
+    stats.allocations = static_cast<uint32_t>(m_allocated.size());
+    stats.freeRanges = static_cast<uint32_t>(m_free.size());
+    for (const auto& range : m_free) {
+      if (range.second > stats.largestFree) {
+        stats.largestFree = range.second;
+      }
+    }
+    return stats;
+  }
+
+private:
+  std::map<uint32_t, uint32_t> m_free;       ///< Huecos libres: inicio -> tamaño.
+  std::map<uint32_t, uint32_t> m_allocated;  ///< Rangos reservados: inicio -> tamaño.
+  uint32_t m_capacity = 0;
+  uint32_t m_used = 0;
+};
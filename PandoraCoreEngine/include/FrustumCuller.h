@@ -0,0 +1,131 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @struct BoundingVolume
+ * @brief Esfera y caja alineada a ejes que envuelven una malla en espacio de mundo.
+ */
+struct BoundingVolume
+{
+  XMFLOAT3 center;   ///< Centro de la esfera.
+  float radius;      ///< Radio de la esfera.
+  XMFLOAT3 aabbMin;  ///< Esquina mínima de la caja.
+  XMFLOAT3 aabbMax;  ///< Esquina máxima de la caja.
+};
+
+/**
+ * @struct CullingStats
+ * @brief Contadores de la última pasada de culling.
+ */
+struct CullingStats
+{
+  uint32_t tested = 0;   ///< Volúmenes evaluados.
+  uint32_t visible = 0;  ///< Volúmenes que intersecan el frustum.
+  uint32_t culled = 0;   ///< Volúmenes descartados.
+};
+
+/**
+ * @class FrustumCuller
+ * @brief Culling de volúmenes envolventes contra el frustum de la cámara en CPU.
+ *
+ * Los volúmenes se guardan en arreglos separados por componente (SoA) para que el
+ * kernel pruebe cuatro esferas por iteración con SSE contra los seis planos. Las
+ * esferas que sobreviven se confirman con su caja alineada a ejes, que descarta los
+ * falsos positivos de mallas alargadas cerca de los bordes del frustum.
+ *
+ * No depende del dispositivo gráfico: basta con setViewProjection(), add() y cull(),
+ * por lo que puede ejecutarse sin ventana sobre escenas sintéticas.
+ */
+class
+  FrustumCuller {
+public:
+  FrustumCuller() = default;
+  ~FrustumCuller() = default;
+
+  /**
+   * @brief Extrae y normaliza los seis planos del frustum de @p viewProjection.
+   *
+   * Usa la convención de DirectX (vectores fila, profundidad de recorte en [0, 1]);
+   * los planos apuntan hacia el interior del frustum.
+   */
+  void
+    setViewProjection(const XMMATRIX& viewProjection);
+
+  /**
+   * @brief Vacía la lista de volúmenes (conserva la memoria reservada).
+   */
+  void
+    clear();
+
+  /**
+   * @brief Reserva espacio para @p count volúmenes.
+   */
+  void
+    reserve(size_t count);
+
+  /**
+   * @brief Agrega un volumen y regresa su índice dentro de esta pasada.
+   */
+  uint32_t
+    add(const BoundingVolume& volume);
+
+  /**
+   * @brief Número de volúmenes agregados desde el último clear().
+   */
+  size_t
+    size() const { return m_radius.size(); }
+
+  /**
+   * @brief Prueba todos los volúmenes contra el frustum.
+   *
+   * @param visible Recibe, en orden creciente, los índices de los volúmenes visibles.
+   * @return Número de volúmenes visibles.
+   */
+  size_t
+    cull(std::vector<uint32_t>& visible);
+
+  /**
+   * @brief Contadores de la última llamada a cull().
+   */
+  const CullingStats&
+    getStats() const { return m_stats; }
+
+  /**
+   * @brief Planos del frustum (izquierdo, derecho, inferior, superior, cercano, lejano).
+   */
+  const XMFLOAT4*
+    getPlanes() const { return m_planes; }
+
+  /**
+   * @brief Lleva un volumen local a espacio de mundo.
+   *
+   * La caja se transforma con el método de Arvo (centro más extensión proyectada en
+   * valor absoluto) y el radio se escala por el mayor factor de escala de @p world.
+   *
+   * @param localMin    Esquina mínima de la caja local.
+   * @param localMax    Esquina máxima de la caja local.
+   * @param localRadius Radio de la esfera local, centrada en la caja.
+   * @param world       Matriz de mundo (vectores fila).
+   */
+  static BoundingVolume
+    transformBounds(const XMFLOAT3& localMin,
+                    const XMFLOAT3& localMax,
+                    float localRadius,
+                    const XMMATRIX& world);
+
+private:
+  /**
+   * @brief Prueba la caja del volumen @p index contra los seis planos.
+   */
+  bool
+    testAabb(size_t index) const;
+
+  XMFLOAT4 m_planes[6] = {};                  ///< Planos (a, b, c, d) normalizados.
+  std::vector<float> m_centerX;               ///< Centros de esfera, componente x.
+  std::vector<float> m_centerY;               ///< Centros de esfera, componente y.
+  std::vector<float> m_centerZ;               ///< Centros de esfera, componente z.
+  std::vector<float> m_radius;                ///< Radios de esfera.
+  std::vector<XMFLOAT3> m_aabbCenter;         ///< Centros de caja.
+  std::vector<XMFLOAT3> m_aabbExtent;         ///< Medias extensiones de caja.
+  CullingStats m_stats;                       ///< Contadores de la última pasada.
+};
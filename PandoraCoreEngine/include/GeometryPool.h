@@ -0,0 +1,247 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "FreeListAllocator.h"
+
+class Device;
+class DeviceContext;
+class MeshComponent;
+class ShaderProgram;
+
+/**
+ * @struct GeometryHandle
+ * @brief Malla registrada en el GeometryPool; sigue siendo válida aunque el pool mueva sus datos.
+ */
+struct GeometryHandle
+{
+  uint32_t id = 0;  ///< 0 = sin registrar.
+
+  bool
+    isValid() const { return id != 0; }
+};
+
+/**
+ * @struct GeometryRange
+ * @brief Ubicación de una malla dentro de una página del pool.
+ */
+struct GeometryRange
+{
+  uint32_t page = 0;         ///< Página (par de vertex e index buffer).
+  uint32_t baseVertex = 0;   ///< Primer vértice: @c BaseVertexLocation de DrawIndexed.
+  uint32_t vertexCount = 0;  ///< 0 = entrada libre.
+  uint32_t startIndex = 0;   ///< Primer índice: se suma al @c StartIndexLocation de cada draw.
+  uint32_t indexCount = 0;
+};
+
+/**
+ * @struct GeometryPoolStats
+ * @brief Ocupación del pool y enlaces del frame anterior, para la interfaz.
+ */
+struct GeometryPoolStats
+{
+  uint32_t pages = 0;                ///< Páginas creadas.
+  uint32_t meshes = 0;               ///< Mallas registradas.
+  uint64_t vertexCapacityBytes = 0;  ///< Suma de los vertex buffers.
+  uint64_t vertexUsedBytes = 0;
+  uint64_t indexCapacityBytes = 0;   ///< Suma de los index buffers.
+  uint64_t indexUsedBytes = 0;
+  uint32_t freeRanges = 0;           ///< Huecos libres en todas las páginas.
+  float fragmentation = 0.0f;        ///< La peor de las páginas (ver FreeListAllocatorStats::fragmentation()).
+  uint32_t defragmentations = 0;     ///< Páginas compactadas desde init().
+  uint32_t draws = 0;                ///< Draws del frame anterior.
+  uint32_t binds = 0;                ///< Cambios de página en IA del frame anterior.
+};
+
+/**
+ * @class GeometryPool
+ * @brief Geometría estática de todas las mallas en unos pocos vertex e index buffers grandes.
+ *
+ * Cada página es un vertex buffer y un index buffer (@c D3D11_USAGE_DEFAULT) repartidos con
+ * un @c FreeListAllocator; hay páginas distintas por stride de vértice (@c SimpleVertex o
+ * @c CompactVertex) y por formato de índice. Los índices de cada malla no se reescriben:
+ * render() dibuja con @c StartIndexLocation y @c BaseVertexLocation, así que los índices de
+ * 16 bits siguen sirviendo y dos draws seguidos de la misma página no vuelven a enlazar IA.
+ * Como cada stride necesita su InputLayout y su vertex shader, quien dibuja elige el formato
+ * de cada malla con bindVertexFormat() antes de render().
+ *
+ * Al retirar mallas quedan huecos; si una malla nueva no cabe en ninguno pero sí en el espacio
+ * libre total de la página, add() la compacta con defragment() (copia en GPU a buffers nuevos)
+ * y actualiza los rangos: los @c GeometryHandle no cambian.
+ *
+ * Existe una instancia del motor accesible con getInstance(); solo se usa en el hilo
+ * del dispositivo.
+ */
+class
+  GeometryPool {
+public:
+  /**
+   * @brief Tamaño de un vertex buffer de página (una malla más grande tiene página propia).
+   */
+  static constexpr uint32_t kVertexPageBytes = 16 * 1024 * 1024;
+
+  /**
+   * @brief Tamaño de un index buffer de página.
+   */
+  static constexpr uint32_t kIndexPageBytes = 8 * 1024 * 1024;
+
+  /**
+   * @brief Fragmentación a partir de la cual defragment() compacta una página.
+   */
+  static constexpr float kDefragmentThreshold = 0.5f;
+
+  GeometryPool() = default;
+  ~GeometryPool() = default;
+
+  /**
+   * @brief Pool compartido del motor.
+   */
+  static GeometryPool&
+    getInstance();
+
+  /**
+   * @brief Guarda el dispositivo y el contexto con los que se crean y copian las páginas.
+   *
+   * @return @c S_OK si fue exitoso; código @c HRESULT en caso contrario.
+   */
+  HRESULT
+    init(Device& device, DeviceContext& deviceContext);
+
+  /**
+   * @brief Empieza un frame: guarda las estadísticas y olvida la página enlazada.
+   */
+  void
+    update();
+
+  /**
+   * @brief Copia los vértices e índices de @p mesh a una página.
+   *
+   * @param handle Recibe la malla registrada.
+   * @return @c S_OK si fue exitoso; código @c HRESULT en caso contrario.
+   */
+  HRESULT
+    add(const MeshComponent& mesh, GeometryHandle& handle);
+
+  /**
+   * @brief Libera los rangos de @p handle y lo deja sin registrar.
+   */
+  void
+    remove(GeometryHandle& handle);
+
+  /**
+   * @brief Ubicación actual de @p handle (@c nullptr si no está registrado).
+   */
+  const GeometryRange*
+    getRange(GeometryHandle handle) const;
+
+  /**
+   * @brief Programas de las páginas de @c SimpleVertex y de @c CompactVertex.
+   *
+   * De cada uno solo se usan el InputLayout y el vertex shader; el pixel shader sigue siendo
+   * el que esté enlazado. El pool no toma la propiedad.
+   */
+  void
+    setShaderPrograms(ShaderProgram& standard, ShaderProgram& compact);
+
+  /**
+   * @brief Enlaza el InputLayout y el vertex shader del formato de vértice indicado.
+   *
+   * No hace nada si el formato ya estaba enlazado.
+   *
+   * @param compact @c true para mallas con @c CompactVertex (ver MeshComponent::hasCompactVertices()).
+   * @return @c false si no hay un programa válido para ese formato; la malla no debe dibujarse.
+   */
+  bool
+    bindVertexFormat(DeviceContext& deviceContext, bool compact);
+
+  /**
+   * @brief Dibuja @p indexCount índices de @p handle a partir de @p indexStart (relativo a la malla).
+   *
+   * Solo enlaza los buffers de la página si el draw anterior era de otra.
+   */
+  void
+    render(DeviceContext& deviceContext,
+           GeometryHandle handle,
+           uint32_t indexStart,
+           uint32_t indexCount);
+
+  /**
+   * @brief Olvida la página y el formato enlazados; llamar si algo más enlazó buffers,
+   *        InputLayout o vertex shader.
+   */
+  void
+    invalidateBindings() {
+    m_boundPage = kNoPage;
+    m_boundFormat = BoundFormat::None;
+  }
+
+  /**
+   * @brief Compacta las páginas cuya fragmentación supera @c kDefragmentThreshold.
+   *
+   * @return Número de páginas compactadas.
+   */
+  uint32_t
+    defragment();
+
+  /**
+   * @brief Libera todas las páginas; los handles dejan de ser válidos.
+   */
+  void
+    destroy();
+
+  /**
+   * @brief Ocupación actual y enlaces del frame anterior.
+   */
+  const GeometryPoolStats&
+    getStats() const { return m_stats; }
+
+private:
+  static constexpr uint32_t kNoPage = 0xFFFFFFFFu;
+
+  /**
+   * @brief Formato de vértice cuyo InputLayout y vertex shader están enlazados.
+   */
+  enum class BoundFormat {
+    None,
+    Simple,
+    Compact
+  };
+
+  /**
+   * @struct Page
+   * @brief Par de buffers con el mismo stride de vértice y formato de índice.
+   */
+  struct Page {
+    ID3D11Buffer* vertexBuffer = nullptr;
+    ID3D11Buffer* indexBuffer = nullptr;
+    unsigned int vertexStride = 0;
+    DXGI_FORMAT indexFormat = DXGI_FORMAT_UNKNOWN;
+    FreeListAllocator vertices;  ///< En vértices.
+    FreeListAllocator indices;   ///< En índices.
+  };
+
+  HRESULT
+    createPage(unsigned int vertexStride, DXGI_FORMAT indexFormat,
+               uint32_t vertexCount, uint32_t indexCount, uint32_t& pageIndex);
+
+  bool
+    allocate(uint32_t pageIndex, uint32_t vertexCount, uint32_t indexCount, GeometryRange& range);
+
+  HRESULT
+    defragmentPage(uint32_t pageIndex);
+
+  void
+    updateStats();
+
+  Device* m_device = nullptr;
+  DeviceContext* m_deviceContext = nullptr;
+  std::vector<Page> m_pages;
+  std::vector<GeometryRange> m_ranges;  ///< Por handle (id - 1).
+  std::vector<uint32_t> m_freeIds;      ///< Handles liberados para reutilizar.
+  ShaderProgram* m_standardProgram = nullptr;
+  ShaderProgram* m_compactProgram = nullptr;
+  uint32_t m_boundPage = kNoPage;
+  BoundFormat m_boundFormat = BoundFormat::None;
+  uint32_t m_draws = 0;
+  uint32_t m_binds = 0;
+  uint32_t m_defragmentations = 0;
+  GeometryPoolStats m_stats;
+};
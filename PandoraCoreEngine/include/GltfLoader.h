@@ -0,0 +1,102 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "MappedFile.h"
+
+class MeshComponent;
+
+/**
+ * @class GltfLoader
+ * @brief Importador glTF 2.0 (GLB o .gltf con buffers externos) sin dependencias.
+ *
+ * El archivo se proyecta en memoria; solo se interpreta el bloque JSON para ubicar
+ * accessors y bufferViews. Los vértices e índices se copian directamente de esos
+ * rangos: si los datos ya están intercalados como @c SimpleVertex (POSITION float3 y
+ * TEXCOORD_0 float2 con stride de 20 bytes) la copia es un único @c memcpy.
+ *
+ * Cada primitiva de triángulos produce un @c MeshComponent en espacio local. glTF es diestro
+ * (+Y arriba, +Z al frente, metros); se pasa a zurdo con @c FbxAxisConversion, igual que la
+ * ruta FBX, negando X e invirtiendo el orden de cada triángulo, de modo que un mismo asset
+ * exportado en ambos formatos queda orientado igual. Las UV se conservan (glTF ya usa
+ * origen superior izquierdo, como DirectX).
+ */
+class
+  GltfLoader {
+public:
+  GltfLoader() = default;
+  ~GltfLoader() = default;
+
+  /**
+   * @brief Proyecta @p fileName, lo analiza y extrae sus mallas.
+   *
+   * @param fileName Ruta del archivo .glb o .gltf.
+   * @param meshes   Destino; se agregan las mallas encontradas.
+   * @return @c S_OK si se extrajo al menos una malla; @c E_FAIL en otro caso.
+   */
+  HRESULT
+    load(const std::string& fileName, std::vector<MeshComponent>& meshes);
+
+  /**
+   * @brief Analiza un GLB (o JSON glTF) ya cargado en memoria.
+   *
+   * @param data          Contenido del archivo; debe seguir vivo mientras se use el lector.
+   * @param size          Tamaño de @p data en bytes.
+   * @param baseDirectory Carpeta para resolver buffers externos (con separador final).
+   * @return @c S_OK si fue exitoso; @c E_FAIL si el formato no es válido.
+   */
+  HRESULT
+    init(const char* data, size_t size, const std::string& baseDirectory = "");
+
+  /**
+   * @brief Convierte las primitivas analizadas en @c MeshComponent (en paralelo).
+   */
+  HRESULT
+    buildMeshes(std::vector<MeshComponent>& meshes) const;
+
+  /**
+   * @brief Libera las tablas analizadas y los buffers externos.
+   */
+  void
+    destroy();
+
+private:
+  /**
+   * @brief Vista tipada sobre un rango de un buffer.
+   */
+  struct Accessor {
+    const uint8_t* data = nullptr;  ///< Primer elemento.
+    size_t count = 0;               ///< Número de elementos.
+    size_t stride = 0;              ///< Bytes entre elementos.
+    int componentType = 0;          ///< Código GL (5121, 5123, 5125, 5126...).
+    int components = 0;             ///< 1 (SCALAR), 2 (VEC2), 3 (VEC3)...
+    bool normalized = false;        ///< Enteros normalizados a [0, 1] o [-1, 1].
+  };
+
+  /**
+   * @brief Primitiva de triángulos con índices a @c m_accessors (-1 si no existe).
+   */
+  struct Primitive {
+    std::string name;
+    int position = -1;
+    int texcoord = -1;
+    int indices = -1;
+  };
+
+  /**
+   * @brief Lee el componente @p component del elemento @p index como float.
+   */
+  static float
+    readFloat(const Accessor& accessor, size_t index, int component);
+
+  /**
+   * @brief Lee el elemento @p index de un accessor escalar entero.
+   */
+  static uint32_t
+    readIndex(const Accessor& accessor, size_t index);
+
+  HRESULT
+    buildMesh(const Primitive& primitive, MeshComponent& mesh) const;
+
+  std::vector<Accessor> m_accessors;    ///< Accessors resueltos contra sus buffers.
+  std::vector<Primitive> m_primitives;  ///< Primitivas de triángulos encontradas.
+  std::vector<MappedFile> m_buffers;    ///< Buffers externos proyectados.
+};
@@ -0,0 +1,69 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @struct DecodedImage
+ * @brief Imagen decodificada a RGBA8 en memoria de CPU.
+ */
+struct DecodedImage
+{
+  std::string path;                ///< Archivo de origen.
+  unsigned char* pixels = nullptr; ///< Píxeles RGBA8 (4 bytes por píxel); nulo si falló.
+  int width = 0;                   ///< Ancho en píxeles.
+  int height = 0;                  ///< Alto en píxeles.
+  std::string error;               ///< Motivo del fallo reportado por stb_image.
+
+  /**
+   * @brief Libera @c pixels. Idempotente.
+   */
+  void
+    release();
+};
+
+/**
+ * @class ImageDecoder
+ * @brief Decodificación de imágenes (PNG, JPG, ...) con stb_image, en serie o por lotes.
+ *
+ * stb_image no comparte estado entre hilos (el motivo de error es thread-local y el
+ * volteo vertical se fija por hilo), así que cada imagen de un lote se decodifica en
+ * un hilo del @c ThreadPool. Los archivos se leen con @c FileSystem. La creación de
+ * los recursos de GPU queda a cargo del llamador, en el hilo del dispositivo.
+ */
+class
+  ImageDecoder {
+public:
+  /**
+   * @brief Decodifica @p path a RGBA8 en el hilo actual, sin volteo vertical.
+   *
+   * El archivo se obtiene con FileSystem::open() (suelto o dentro de un paquete) y se
+   * decodifica desde la proyección, sin la E/S con buffer de stbi_load().
+   * @return @c S_OK si fue exitoso; @c E_FAIL con @c image.error en otro caso.
+   */
+  static HRESULT
+    decode(const std::string& path, DecodedImage& image);
+
+  /**
+   * @brief Decodifica una imagen ya cargada o proyectada en memoria a RGBA8.
+   *
+   * @param data  Contenido del archivo de imagen.
+   * @param size  Tamaño en bytes.
+   * @param path  Nombre para @c image.path y los mensajes de error.
+   * @param image Recibe los píxeles.
+   * @return @c S_OK si fue exitoso; @c E_FAIL con @c image.error en otro caso.
+   */
+  static HRESULT
+    decode(const void* data, size_t size, const std::string& path, DecodedImage& image);
+
+  /**
+   * @brief Decodifica todas las rutas en paralelo y reporta el tiempo total.
+   *
+   * @param paths     Archivos a decodificar.
+   * @param images    Recibe una imagen por ruta, en el mismo orden.
+   * @param wallMs    Si no es nulo, recibe el tiempo de pared del lote en milisegundos.
+   * @return @c S_OK si todas se decodificaron; @c E_FAIL si alguna falló (las demás quedan válidas).
+   */
+  static HRESULT
+    decodeBatch(const std::vector<std::string>& paths,
+                std::vector<DecodedImage>& images,
+                double* wallMs = nullptr);
+};
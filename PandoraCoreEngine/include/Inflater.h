@@ -0,0 +1,39 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class Inflater
+ * @brief Descompresor DEFLATE/zlib (RFC 1950/1951) sin dependencias externas.
+ *
+ * Se usa para los arreglos comprimidos de los FBX binarios. Decodifica bloques
+ * almacenados, Huffman fijos y dinámicos; los códigos de hasta 9 bits se
+ * resuelven con una tabla directa y el resto de forma canónica.
+ */
+class
+  Inflater {
+public:
+  /**
+   * @brief Descomprime un flujo zlib completo (cabecera + DEFLATE + Adler-32).
+   *
+   * @param data         Datos comprimidos.
+   * @param size         Tamaño de @p data en bytes.
+   * @param out          Destino; se reemplaza su contenido.
+   * @param expectedSize Tamaño descomprimido esperado (0 si se desconoce); solo reserva memoria.
+   * @return @c S_OK si fue exitoso; @c E_FAIL si el flujo está corrupto o truncado.
+   */
+  static HRESULT
+    inflateZlib(const void* data,
+                size_t size,
+                std::vector<uint8_t>& out,
+                size_t expectedSize = 0);
+
+  /**
+   * @brief Descomprime un flujo DEFLATE sin cabecera.
+   * @param consumed Si no es nulo, recibe los bytes de entrada consumidos.
+   */
+  static HRESULT
+    inflateRaw(const void* data,
+               size_t size,
+               std::vector<uint8_t>& out,
+               size_t* consumed = nullptr);
+};
@@ -0,0 +1,73 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class MappedFile
+ * @brief Proyecta un archivo de solo lectura en memoria (CreateFileMapping/MapViewOfFile).
+ *
+ * Permite recorrer el contenido de un archivo in situ, sin copias intermedias
+ * ni lecturas con buffer. La vista permanece válida hasta llamar a destroy()
+ * o hasta que el objeto se destruye.
+ *
+ * @note Un archivo vacío se considera abierto con @c size() == 0 y @c data() == nullptr.
+ */
+class
+  MappedFile {
+public:
+  /**
+   * @brief Constructor por defecto (no abre ningún archivo).
+   */
+  MappedFile() = default;
+
+  /**
+   * @brief Destructor. Libera la vista y los handles del sistema.
+   */
+  ~MappedFile() { destroy(); }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+  MappedFile&
+    operator=(MappedFile&& other) noexcept;
+
+  /**
+   * @brief Abre y proyecta el archivo indicado.
+   *
+   * @param fileName Ruta del archivo a proyectar.
+   * @return @c S_OK si fue exitoso; @c E_INVALIDARG o @c E_FAIL en caso contrario.
+   */
+  HRESULT
+    init(const std::string& fileName);
+
+  /**
+   * @brief Libera la vista proyectada y cierra los handles. Idempotente.
+   */
+  void
+    destroy();
+
+  /**
+   * @brief Puntero al primer byte del archivo proyectado.
+   */
+  const char*
+    data() const { return m_data; }
+
+  /**
+   * @brief Tamaño del archivo en bytes.
+   */
+  size_t
+    size() const { return m_size; }
+
+  /**
+   * @brief Indica si hay un archivo abierto.
+   */
+  bool
+    isOpen() const { return m_file != INVALID_HANDLE_VALUE; }
+
+private:
+  HANDLE m_file = INVALID_HANDLE_VALUE; ///< Handle del archivo.
+  HANDLE m_mapping = nullptr;           ///< Handle del objeto de proyección.
+  const char* m_data = nullptr;         ///< Vista proyectada.
+  size_t m_size = 0;                    ///< Tamaño del archivo en bytes.
+};
@@ -0,0 +1,86 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "MeshComponent.h"
+
+/**
+ * @class MeshCache
+ * @brief Contenedor binario versionado (".pcmesh") de mallas ya procesadas.
+ *
+ * Guarda el resultado final del importador (nombre, @c SimpleVertex, índices,
+ * caja y esfera envolventes, LODs y meshlets de cada @c MeshComponent) para que los siguientes arranques
+ * proyecten el archivo en memoria y copien los arreglos directamente, sin pasar
+ * por el FBX SDK ni por el parser OBJ.
+ *
+ * Distribución del archivo (little-endian, todo alineado a 4 bytes):
+ * - @c MeshCacheHeader
+ * - Por cada malla: @c MeshCacheEntry, nombre (rellenado a 4 bytes),
+ *   @c SimpleVertex[vertexCount], índices de 16 o 32 bits según @c indexStride
+ *   (rellenados a 4 bytes), @c MeshLod[lodCount] y @c Meshlet[meshletCount].
+ *
+ * La validez se decide con una clave de 64 bits: hash del contenido del
+ * archivo fuente combinado con la configuración del importador y la versión
+ * del formato. Cualquier diferencia invalida la caché y se vuelve a importar.
+ */
+class
+  MeshCache {
+public:
+  /**
+   * @brief Versión actual del formato. Incrementar al cambiar la distribución.
+   */
+  static constexpr uint32_t kVersion = 5;
+
+  /**
+   * @brief Ruta del archivo de caché asociado a un archivo fuente.
+   */
+  static std::string
+    getCachePath(const std::string& sourcePath) { return sourcePath + ".pcmesh"; }
+
+  /**
+   * @brief Calcula la clave de caché de un archivo fuente.
+   *
+   * @param sourcePath       Archivo fuente (FBX, OBJ, ...).
+   * @param importerSettings Descripción textual de las opciones del importador.
+   * @param outKey           Clave resultante.
+   * @return @c true si el archivo fuente pudo leerse.
+   */
+  static bool
+    computeKey(const std::string& sourcePath,
+               const std::string& importerSettings,
+               uint64_t& outKey);
+
+  /**
+   * @brief Calcula la clave a partir del contenido fuente ya cargado o proyectado en memoria.
+   *
+   * Evita leer dos veces el archivo cuando el importador ya lo tiene abierto.
+   */
+  static uint64_t
+    computeKey(const void* sourceData,
+               size_t sourceSize,
+               const std::string& importerSettings);
+
+  /**
+   * @brief Carga las mallas de la caché si existe y su clave coincide.
+   *
+   * @param cachePath Ruta del archivo ".pcmesh".
+   * @param key       Clave esperada (ver computeKey()).
+   * @param meshes    Destino; solo se modifica si la carga es válida.
+   * @return @c true si la caché era válida y se cargó.
+   */
+  static bool
+    load(const std::string& cachePath,
+         uint64_t key,
+         std::vector<MeshComponent>& meshes);
+
+  /**
+   * @brief Escribe las mallas en la caché (archivo temporal + renombrado atómico).
+   *
+   * @param cachePath Ruta del archivo ".pcmesh".
+   * @param key       Clave con la que se validará en cargas futuras.
+   * @param meshes    Mallas ya procesadas por el importador.
+   * @return @c S_OK si fue exitoso; @c E_FAIL si no se pudo escribir.
+   */
+  static HRESULT
+    save(const std::string& cachePath,
+         uint64_t key,
+         const std::vector<MeshComponent>& meshes);
+};
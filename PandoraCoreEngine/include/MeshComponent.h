@@ -1,7 +1,61 @@
 #pragma once
 #include "Prerequisites.h"
 #include "ECS\Component.h"
+#include <cmath>
 class DeviceContext;
+
+/**
+ * @brief Hash bit a bit de un @c SimpleVertex completo.
+ *
+ * Cubre automticamente cualquier atributo que se agregue al vrtice (normal, tangente...).
+ */
+struct SimpleVertexHash {
+  size_t operator()(const SimpleVertex& v) const {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&v);
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < sizeof(SimpleVertex); i += sizeof(uint32_t)) {
+      uint32_t word;
+      std::memcpy(&word, bytes + i, sizeof(word));
+      h = (h ^ word) * 1099511628211ull;
+    }
+    return static_cast<size_t>(h ^ (h >> 32));
+  }
+};
+
+struct SimpleVertexEqual {
+  bool operator()(const SimpleVertex& a, const SimpleVertex& b) const {
+    return std::memcmp(&a, &b, sizeof(SimpleVertex)) == 0;
+  }
+};
+
+static_assert(sizeof(SimpleVertex) % sizeof(uint32_t) == 0, "SimpleVertex must not need tail hashing");
+
+/**
+ * @struct MeshLod
+ * @brief Rango del index buffer que corresponde a un nivel de detalle.
+ */
+struct MeshLod
+{
+  uint32_t indexStart; ///< Primer ndice del nivel.
+  uint32_t indexCount; ///< Nmero de ndices del nivel.
+  float error;         ///< Error geomtrico respecto al LOD 0, en unidades de la malla.
+};
+
+/**
+ * @struct Meshlet
+ * @brief Clster de tringulos contiguos del LOD 0 con sus volmenes para culling.
+ * @sa MeshletBuilder
+ */
+struct Meshlet
+{
+  uint32_t indexStart;  ///< Primer ndice del clster en el index buffer.
+  uint32_t indexCount;  ///< Nmero de ndices (3 por tringulo).
+  XMFLOAT3 center;      ///< Centro de la esfera envolvente en espacio local.
+  float radius;         ///< Radio de la esfera envolvente.
+  XMFLOAT3 coneAxis;    ///< Eje del cono de normales en espacio local.
+  float coneCutoff;     ///< Seno del semingulo del cono; 1 si no puede descartarse por orientacin.
+};
+
 /**
  * @class MeshComponent
  * @brief Componente ECS que almacena la informacin de geometra (malla) de un actor.
@@ -31,6 +85,20 @@ public:
   virtual
     ~MeshComponent() = default;
 
+  /**
+   * @brief Copia y movimiento por defecto.
+   *
+   * El destructor declarado suprime el movimiento implcito; sin estos, cada
+   * std::vector<MeshComponent> que crece o se devuelve (cach .pcmesh, cargadores)
+   * copiara todos los vrtices e ndices en lugar de moverlos.
+   */
+  MeshComponent(const MeshComponent&) = default;
+  MeshComponent(MeshComponent&&) = default;
+  MeshComponent&
+    operator=(const MeshComponent&) = default;
+  MeshComponent&
+    operator=(MeshComponent&&) = default;
+
   /**
    * @brief Inicializa el componente de malla.
    *
@@ -72,6 +140,136 @@ public:
   void
     destroy() override {};
 
+  /**
+   * @brief Calcula la caja envolvente alineada a ejes (AABB) y la esfera envolvente en espacio local.
+   *
+   * Recorre @c m_vertex y actualiza @c m_boundsMin, @c m_boundsMax y @c m_boundsRadius.
+   * La esfera se centra en la caja y su radio es la distancia al vrtice ms lejano,
+   * ms ajustada que la media diagonal. Una malla sin vrtices queda degenerada en el origen.
+   */
+  void
+    computeBounds() {
+    if (m_vertex.empty()) {
+      m_boundsMin = XMFLOAT3(0.0f, 0.0f, 0.0f);
+      m_boundsMax = XMFLOAT3(0.0f, 0.0f, 0.0f);
+      m_boundsRadius = 0.0f;
+      return;
+    }
+    m_boundsMin = m_vertex[0].Pos;
+    m_boundsMax = m_vertex[0].Pos;
+    for (const SimpleVertex& v : m_vertex) {
+      m_boundsMin.x = (std::min)(m_boundsMin.x, v.Pos.x);
+      m_boundsMin.y = (std::min)(m_boundsMin.y, v.Pos.y);
+      m_boundsMin.z = (std::min)(m_boundsMin.z, v.Pos.z);
+      m_boundsMax.x = (std::max)(m_boundsMax.x, v.Pos.x);
+      m_boundsMax.y = (std::max)(m_boundsMax.y, v.Pos.y);
+      m_boundsMax.z = (std::max)(m_boundsMax.z, v.Pos.z);
+    }
+
+    const XMFLOAT3 center = getBoundsCenter();
+    float radiusSq = 0.0f;
+    for (const SimpleVertex& v : m_vertex) {
+      const float dx = v.Pos.x - center.x;
+      const float dy = v.Pos.y - center.y;
+      const float dz = v.Pos.z - center.z;
+      radiusSq = (std::max)(radiusSq, dx * dx + dy * dy + dz * dz);
+    }
+    m_boundsRadius = std::sqrt(radiusSq);
+  }
+
+  /**
+   * @brief Centro de la caja envolvente (y de la esfera envolvente) en espacio local.
+   */
+  XMFLOAT3
+    getBoundsCenter() const {
+    return XMFLOAT3((m_boundsMin.x + m_boundsMax.x) * 0.5f,
+                    (m_boundsMin.y + m_boundsMax.y) * 0.5f,
+                    (m_boundsMin.z + m_boundsMax.z) * 0.5f);
+  }
+
+  /**
+   * @brief Elige el formato de ndices ms pequeo posible para la malla.
+   *
+   * Si todos los vrtices son direccionables con 16 bits, copia los ndices a
+   * @c m_index16, libera @c m_index y cambia @c m_indexFormat a @c DXGI_FORMAT_R16_UINT.
+   * Debe llamarse al final de la importacin, cuando los ndices ya no cambiarn.
+   */
+  void
+    compactIndices() {
+    if (m_indexFormat == DXGI_FORMAT_R16_UINT || m_index.empty() || m_vertex.size() > 65536) {
+      return;
+    }
+    m_index16.assign(m_index.size(), 0);
+    for (size_t i = 0; i < m_index.size(); ++i) {
+      m_index16[i] = static_cast<uint16_t>(m_index[i]);
+    }
+    std::vector<unsigned int>().swap(m_index);
+    m_indexFormat = DXGI_FORMAT_R16_UINT;
+  }
+
+  /**
+   * @brief Regresa los ndices a 32 bits (p. ej. para volver a procesar la malla).
+   */
+  void
+    expandIndices() {
+    if (m_indexFormat != DXGI_FORMAT_R16_UINT) {
+      return;
+    }
+    m_index.assign(m_index16.begin(), m_index16.end());
+    std::vector<uint16_t>().swap(m_index16);
+    m_indexFormat = DXGI_FORMAT_R32_UINT;
+  }
+
+  /**
+   * @brief Indica si la malla usa el formato de vrtice compacto.
+   */
+  bool
+    hasCompactVertices() const { return !m_compactVertex.empty(); }
+
+  /**
+   * @brief Puntero a los ndices en el formato activo.
+   */
+  const void*
+    getIndexData() const {
+    return (m_indexFormat == DXGI_FORMAT_R16_UINT) ? static_cast<const void*>(m_index16.data())
+                                                   : static_cast<const void*>(m_index.data());
+  }
+
+  /**
+   * @brief Tamao en bytes de un ndice en el formato activo (2 o 4).
+   */
+  unsigned int
+    getIndexStride() const {
+    return (m_indexFormat == DXGI_FORMAT_R16_UINT) ? sizeof(uint16_t) : sizeof(unsigned int);
+  }
+
+  /**
+   * @brief Nmero de ndices almacenados en el formato activo.
+   */
+  size_t
+    getIndexCount() const {
+    return (m_indexFormat == DXGI_FORMAT_R16_UINT) ? m_index16.size() : m_index.size();
+  }
+
+  /**
+   * @brief Nmero de niveles de detalle (al menos 1).
+   */
+  size_t
+    getLodCount() const { return m_lods.empty() ? 1 : m_lods.size(); }
+
+  /**
+   * @brief Rango de ndices del nivel @p level (se limita al ltimo nivel disponible).
+   *
+   * Sin cadena de LODs, el nivel 0 cubre todo el index buffer.
+   */
+  MeshLod
+    getLod(size_t level) const {
+    if (m_lods.empty()) {
+      return { 0u, static_cast<uint32_t>(m_numIndex), 0.0f };
+    }
+    return m_lods[(std::min)(level, m_lods.size() - 1)];
+  }
+
 public:
   /**
    * @brief Nombre de la malla.
@@ -88,6 +286,39 @@ public:
    */
   std::vector<unsigned int> m_index;
 
+  /**
+   * @brief Vrtices cuantizados (@c CompactVertex); si no est vaco, es lo que se sube a GPU.
+   * @sa VertexCodec::encodeMesh()
+   */
+  std::vector<CompactVertex> m_compactVertex;
+
+  /**
+   * @brief Descuantizacin de @c m_compactVertex (constant buffer en el registro b3).
+   */
+  CBVertexDequant m_dequant = {};
+
+  /**
+   * @brief ndices de 16 bits; solo se usan cuando @c m_indexFormat es @c DXGI_FORMAT_R16_UINT.
+   */
+  std::vector<uint16_t> m_index16;
+
+  /**
+   * @brief Formato de ndices activo (@c DXGI_FORMAT_R32_UINT o @c DXGI_FORMAT_R16_UINT).
+   */
+  DXGI_FORMAT m_indexFormat = DXGI_FORMAT_R32_UINT;
+
+  /**
+   * @brief Niveles de detalle concatenados en el index buffer; vaco si solo existe el LOD 0.
+   * @sa MeshSimplifier::buildLods()
+   */
+  std::vector<MeshLod> m_lods;
+
+  /**
+   * @brief Clsteres del LOD 0, en el mismo orden que sus ndices; vaco si no se generaron.
+   * @sa MeshletBuilder::build()
+   */
+  std::vector<Meshlet> m_meshlets;
+
   /**
    * @brief Nmero total de vrtices en la malla.
    */
@@ -97,4 +328,19 @@ public:
    * @brief Nmero total de ndices en la malla.
    */
   int m_numIndex;
+
+  /**
+   * @brief Esquina mnima de la caja envolvente en espacio local.
+   */
+  XMFLOAT3 m_boundsMin = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+  /**
+   * @brief Esquina mxima de la caja envolvente en espacio local.
+   */
+  XMFLOAT3 m_boundsMax = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+  /**
+   * @brief Radio de la esfera envolvente centrada en getBoundsCenter(), en espacio local.
+   */
+  float m_boundsRadius = 0.0f;
 };
\ No newline at end of file
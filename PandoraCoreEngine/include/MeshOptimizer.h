@@ -0,0 +1,76 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "MeshComponent.h"
+
+/**
+ * @struct VertexCacheStats
+ * @brief Métricas de eficiencia de la caché post-transformación de vértices.
+ */
+struct VertexCacheStats
+{
+  float acmr = 0.0f; ///< Fallos de caché por triángulo (0.5 ideal, 3.0 peor caso).
+  float atvr = 0.0f; ///< Fallos de caché por vértice único (1.0 ideal).
+};
+
+/**
+ * @class MeshOptimizer
+ * @brief Etapa de optimización que se aplica a cada @c MeshComponent después de importarlo.
+ *
+ * Ejecuta, en este orden:
+ * 1. Reordenamiento de triángulos para localidad en la caché de vértices (Forsyth).
+ * 2. Opcionalmente, ordenamiento de clústeres de triángulos para reducir overdraw:
+ *    los clústeres cuya normal apunta hacia afuera del centro de la malla se dibujan primero.
+ * 3. Reordenamiento de @c m_vertex por primer uso para localidad en la lectura de vértices.
+ *
+ * Los triángulos conservan su winding; solo cambia el orden en que se emiten.
+ */
+class
+  MeshOptimizer {
+public:
+  /**
+   * @brief Ejecuta la etapa completa sobre @p mesh y registra ACMR/ATVR antes y después.
+   *
+   * @param mesh           Malla con triángulos indexados.
+   * @param reduceOverdraw Si es @c true, ordena los clústeres para reducir overdraw.
+   * @return @c S_OK si fue exitoso; @c E_INVALIDARG si los índices no forman triángulos válidos.
+   */
+  static HRESULT
+    optimize(MeshComponent& mesh, bool reduceOverdraw = true);
+
+  /**
+   * @brief Reordena los triángulos para maximizar aciertos en la caché de vértices.
+   *
+   * Implementa el algoritmo de puntuación lineal de Tom Forsyth con una caché LRU simulada.
+   */
+  static void
+    optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+
+  /**
+   * @brief Ordena clústeres de triángulos para que las caras exteriores se dibujen primero.
+   *
+   * Debe llamarse después de optimizeVertexCache(). Los clústeres se cortan donde la
+   * caché simulada se reinicia y donde partir no empeora el ACMR más allá de @p threshold.
+   *
+   * @param threshold Pérdida de ACMR tolerada al partir clústeres (1.05 = 5 %).
+   */
+  static void
+    optimizeOverdraw(std::vector<unsigned int>& indices,
+                     const std::vector<SimpleVertex>& vertices,
+                     float threshold = 1.05f);
+
+  /**
+   * @brief Reordena los vértices por orden de primer uso y reescribe los índices.
+   *
+   * Los vértices que ningún triángulo referencia se descartan.
+   */
+  static void
+    optimizeVertexFetch(std::vector<SimpleVertex>& vertices, std::vector<unsigned int>& indices);
+
+  /**
+   * @brief Simula una caché FIFO de @p cacheSize entradas y calcula ACMR/ATVR.
+   */
+  static VertexCacheStats
+    analyzeVertexCache(const std::vector<unsigned int>& indices,
+                       size_t vertexCount,
+                       unsigned int cacheSize = 16);
+};
@@ -0,0 +1,79 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+class MeshComponent;
+
+/**
+ * @struct LodChainDesc
+ * @brief Configuración de la cadena de LODs que se genera al importar.
+ */
+struct LodChainDesc
+{
+  /**
+   * @brief Fracción de triángulos de cada nivel respecto al LOD 0. Vacío desactiva los LODs.
+   */
+  std::vector<float> triangleRatios = { 0.5f, 0.25f, 0.125f };
+
+  /**
+   * @brief Error geométrico máximo por nivel, relativo a la diagonal de la caja envolvente.
+   */
+  float maxError = 0.02f;
+
+  /**
+   * @brief Representación estable para la clave de caché (p. ej. "lod:0.5,0.25,0.125@0.02").
+   */
+  std::string
+    toString() const {
+    std::ostringstream os;
+    os << "lod:";
+    for (size_t i = 0; i < triangleRatios.size(); ++i) {
+      os << (i ? "," : "") << triangleRatios[i];
+    }
+    os << "@" << maxError;
+    return os.str();
+  }
+};
+
+/**
+ * @class MeshSimplifier
+ * @brief Simplificación por colapso de aristas con métrica de error cuádrica (Garland-Heckbert).
+ *
+ * Solo reescribe índices: cada colapso mueve un vértice sobre un vecino existente,
+ * de modo que todos los LODs comparten el mismo vertex buffer. Las costuras de UV se
+ * respetan (un vértice con varias "cuñas" solo colapsa a lo largo de la costura) y
+ * los bordes abiertos solo colapsan a lo largo del borde. Se rechazan los colapsos
+ * que invierten triángulos.
+ */
+class
+  MeshSimplifier {
+public:
+  /**
+   * @brief Reduce @p indices hasta @p targetIndexCount sin superar @p targetError.
+   *
+   * @param vertices         Vértices de la malla (no se modifican).
+   * @param indices          Lista de triángulos de entrada.
+   * @param targetIndexCount Número de índices deseado; puede no alcanzarse si lo impide el error.
+   * @param targetError      Error máximo en unidades de la malla.
+   * @param out              Lista de triángulos simplificada.
+   * @param resultError      Si no es nulo, recibe el error alcanzado en unidades de la malla.
+   * @return Número de índices de @p out.
+   */
+  static size_t
+    simplify(const std::vector<SimpleVertex>& vertices,
+             const std::vector<unsigned int>& indices,
+             size_t targetIndexCount,
+             float targetError,
+             std::vector<unsigned int>& out,
+             float* resultError = nullptr);
+
+  /**
+   * @brief Genera la cadena de LODs de una malla y la agrega a su index buffer.
+   *
+   * Requiere índices de 32 bits y la caja envolvente calculada. Cada nivel se obtiene
+   * del anterior, se optimiza para la caché de vértices y se concatena en @c m_index;
+   * los rangos quedan en @c m_lods. La cadena se corta cuando un nivel ya no reduce
+   * al menos un 10 % los triángulos del anterior.
+   */
+  static void
+    buildLods(MeshComponent& mesh, const LodChainDesc& desc);
+};
@@ -0,0 +1,84 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+class MeshComponent;
+class FrustumCuller;
+struct Meshlet;
+
+/**
+ * @struct MeshletRange
+ * @brief Rango contiguo de índices que sobrevivió al culling de clústeres.
+ */
+struct MeshletRange
+{
+  uint32_t indexStart;  ///< Primer índice del rango.
+  uint32_t indexCount;  ///< Número de índices del rango.
+};
+
+/**
+ * @class MeshletBuilder
+ * @brief Parte el LOD 0 de una malla en clústeres pequeños para culling fino en CPU.
+ *
+ * Cada clúster tiene como máximo @c kMaxVertices vértices únicos y @c kMaxTriangles
+ * triángulos. Se construye creciendo desde un triángulo semilla hacia los vecinos que
+ * agregan menos vértices nuevos y quedan más cerca del centro, lo que da clústeres
+ * compactos con normales parecidas. Los índices del LOD 0 se reescriben en el orden de
+ * los clústeres, así que cada clúster es un rango contiguo del index buffer y los
+ * clústeres visibles consecutivos se dibujan con un solo @c DrawIndexed.
+ */
+class
+  MeshletBuilder {
+public:
+  /**
+   * @brief Máximo de vértices únicos por clúster.
+   */
+  static constexpr size_t kMaxVertices = 64;
+
+  /**
+   * @brief Máximo de triángulos por clúster.
+   */
+  static constexpr size_t kMaxTriangles = 124;
+
+  /**
+   * @brief Índices descartados que cull() acepta dibujar para unir dos rangos visibles
+   *        (un clúster lleno): un draw menos cuesta más que esos triángulos.
+   */
+  static constexpr uint32_t kMaxRangeGap = static_cast<uint32_t>(kMaxTriangles * 3);
+
+  /**
+   * @brief Máximo de rangos por malla; con más, cull() devuelve un solo rango del primer
+   *        al último clúster visible.
+   */
+  static constexpr size_t kMaxRanges = 8;
+
+  /**
+   * @brief Genera @c m_meshlets y reordena los índices del LOD 0.
+   *
+   * Requiere índices de 32 bits; debe llamarse después de MeshSimplifier::buildLods()
+   * y antes de compactIndices(). Los demás LODs no se modifican.
+   */
+  static void
+    build(MeshComponent& mesh);
+
+  /**
+   * @brief Descarta los clústeres fuera del frustum o vueltos de espaldas a la cámara.
+   *
+   * Los planos se llevan a espacio local una sola vez por malla. La prueba de cono
+   * se omite si @p world tiene escala no uniforme o espejo, porque entonces las
+   * normales no se transforman con la misma matriz.
+   *
+   * @param meshlets       Clústeres de la malla.
+   * @param world          Matriz de mundo de la malla.
+   * @param frustum        Culler con los planos de la cámara ya extraídos.
+   * @param cameraPosition Posición de la cámara en espacio de mundo.
+   * @param ranges         Recibe los rangos de índices visibles: se fusionan los separados por
+   *                       hasta @c kMaxRangeGap índices y nunca hay más de @c kMaxRanges.
+   * @return Número de clústeres visibles.
+   */
+  static size_t
+    cull(const std::vector<Meshlet>& meshlets,
+         const XMMATRIX& world,
+         const FrustumCuller& frustum,
+         const XMFLOAT3& cameraPosition,
+         std::vector<MeshletRange>& ranges);
+};
@@ -0,0 +1,130 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include <memory>
+
+class MappedFile;
+
+/**
+ * @brief Filtro de reducción usado entre niveles de mip.
+ */
+enum class MipFilter {
+  Box = 0,    ///< Promedio de área (2x2 en tamaños pares). El más rápido.
+  Kaiser = 1  ///< Sinc con ventana de Kaiser (ancho 3, alpha 4). Más nítido, menos aliasing.
+};
+
+/**
+ * @struct MipSettings
+ * @brief Opciones de generación de mips; forman parte de la clave de la caché de texturas.
+ */
+struct MipSettings
+{
+  MipFilter filter = MipFilter::Kaiser; ///< Filtro de reducción.
+  bool srgb = true;                     ///< Los texeles RGB están codificados en sRGB (filtrar en lineal).
+
+  /**
+   * @brief Descripción textual estable, para las claves de caché.
+   */
+  std::string
+    toString() const {
+    return std::string("mip=") + (filter == MipFilter::Box ? "box" : "kaiser") +
+      ";srgb=" + (srgb ? "1" : "0");
+  }
+};
+
+/**
+ * @struct MipLevel
+ * @brief Ubicación de un nivel dentro de @c MipChain::data.
+ */
+struct MipLevel
+{
+  uint32_t width;     ///< Ancho del nivel en píxeles.
+  uint32_t height;    ///< Alto del nivel en píxeles.
+  uint32_t rowPitch;  ///< Bytes por fila (o por fila de bloques en formatos comprimidos).
+  uint32_t offset;    ///< Desplazamiento del nivel en @c MipChain::data.
+  uint32_t size;      ///< Tamaño del nivel en bytes.
+};
+
+/**
+ * @struct MipChain
+ * @brief Texeles de una textura 2D con todos sus niveles de mip, contiguos en memoria.
+ *
+ * Los texeles están en @c data o, si vienen de la caché, directamente en el archivo
+ * proyectado (@c mapping), sin copia. Siempre deben leerse con getData()/getLevelData().
+ */
+struct MipChain
+{
+  DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM; ///< Formato de los texeles.
+  uint32_t width = 0;                              ///< Ancho del nivel 0.
+  uint32_t height = 0;                             ///< Alto del nivel 0.
+  std::vector<MipLevel> levels;                    ///< Niveles, del 0 (mayor) al 1x1.
+  std::vector<uint8_t> data;                       ///< Texeles propios (vacío si están proyectados).
+
+  /**
+   * @brief Archivo de caché proyectado que contiene los texeles.
+   *
+   * @c std::shared_ptr y no @c EU::TSharedPointer: la cadena se crea en un hilo de
+   * trabajo y se libera en el hilo del dispositivo.
+   */
+  std::shared_ptr<MappedFile> mapping;
+  const uint8_t* mappedData = nullptr;             ///< Primer texel dentro de @c mapping.
+  size_t mappedSize = 0;                           ///< Bytes de texeles dentro de @c mapping.
+
+  /**
+   * @brief Texeles de todos los niveles.
+   */
+  const uint8_t*
+    getData() const { return mappedData ? mappedData : data.data(); }
+
+  /**
+   * @brief Tamaño en bytes de los texeles de todos los niveles.
+   */
+  size_t
+    getDataSize() const { return mappedData ? mappedSize : data.size(); }
+
+  /**
+   * @brief Puntero a los texeles del nivel @p level.
+   */
+  const uint8_t*
+    getLevelData(size_t level) const { return getData() + levels[level].offset; }
+};
+
+/**
+ * @class MipGenerator
+ * @brief Genera en CPU la cadena completa de mips de una imagen RGBA8.
+ *
+ * Cada nivel se calcula a partir del anterior en punto flotante (sin recuantizar
+ * entre niveles) con un filtro separable: primero filas, luego columnas. Los pesos
+ * de cada píxel destino se precalculan por eje y se aplican con SSE, un píxel RGBA
+ * por registro. Con @c MipFilter::Box y dimensiones pares se usa un camino directo
+ * de promedio 2x2.
+ *
+ * En modo sRGB los canales RGB se linealizan antes de filtrar y se vuelven a
+ * codificar al cuantizar (con redondeo exacto); el alfa siempre se filtra en lineal.
+ * Así un damero blanco/negro reduce a gris perceptual 188 en lugar de 128.
+ */
+class
+  MipGenerator {
+public:
+  /**
+   * @brief Número de niveles de la cadena completa hasta 1x1.
+   */
+  static uint32_t
+    getMipCount(uint32_t width, uint32_t height);
+
+  /**
+   * @brief Genera la cadena completa a partir de texeles RGBA8.
+   *
+   * @param pixels   Nivel 0, RGBA8 con filas contiguas (@p width * 4 bytes por fila).
+   * @param width    Ancho del nivel 0.
+   * @param height   Alto del nivel 0.
+   * @param settings Filtro y espacio de color.
+   * @param chain    Recibe la cadena en @c DXGI_FORMAT_R8G8B8A8_UNORM.
+   * @return @c S_OK si fue exitoso; @c E_INVALIDARG si la imagen está vacía.
+   */
+  static HRESULT
+    generate(const unsigned char* pixels,
+             uint32_t width,
+             uint32_t height,
+             const MipSettings& settings,
+             MipChain& chain);
+};
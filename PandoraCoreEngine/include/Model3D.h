@@ -2,19 +2,28 @@
 #include "Prerequisites.h"
 #include "IResource.h"
 #include "MeshComponent.h"
+#include "MeshSimplifier.h"
+#include "FbxBinaryReader.h"
 #include "fbxsdk.h"
 
 enum
 	ModelType {
 	OBJ,
-	FBX
+	FBX,
+	GLTF
 };
 
 class
 	Model3D : public IResource {
 public:
-	Model3D(const std::string& name, ModelType modelType)
-		: IResource(name), m_modelType(modelType), lSdkManager(nullptr), lScene(nullptr) {
+	/**
+	 * @param compactVertices Si es @c true, las mallas se codifican a @c CompactVertex tras importarse.
+	 * @param lodChain        Cadena de LODs que se genera por malla (ratios vacos la desactivan).
+	 */
+	Model3D(const std::string& name, ModelType modelType, bool compactVertices = false,
+		const LodChainDesc& lodChain = LodChainDesc())
+		: IResource(name), m_modelType(modelType), lSdkManager(nullptr), lScene(nullptr),
+		  m_compactVertices(compactVertices), m_lodChain(lodChain) {
 		SetType(ResourceType::Model3D);
 		load(name);
 	}
@@ -43,11 +52,39 @@ public:
 	std::vector<MeshComponent>
 		LoadFBXModel(const std::string& filePath);
 
+	/**
+	 * @brief Recolecta en @p meshNodes los nodos con malla del subrbol de @p node.
+	 */
 	void
-		ProcessFBXNode(FbxNode* node);
+		ProcessFBXNode(FbxNode* node, std::vector<FbxNode*>& meshNodes);
 
-	void
-		ProcessFBXMesh(FbxNode* node);
+	/**
+	 * @brief Geometra de un nodo FBX copiada a memoria propia para convertirla fuera del SDK.
+	 */
+	struct FbxMeshSnapshot {
+		std::string name;
+		std::vector<XMFLOAT3> controlPoints;	///< Posiciones locales.
+		std::vector<int> polygonSizes;			///< Esquinas por polgono.
+		std::vector<int> polygonVertices;		///< Control point de cada esquina.
+		std::vector<XMFLOAT2> uvDirect;			///< Arreglo directo del primer canal UV.
+		std::vector<int> uvIndex;				///< ndices a @c uvDirect (vaco si es directo).
+		bool uvByControlPoint = false;			///< Mapeo por control point en vez de por esquina.
+		bool flipWinding = true;				///< Invertir el winding de todas las caras.
+		FbxAxisConversion axisConversion;		///< Ejes y unidades originales del archivo.
+	};
+
+	/**
+	 * @brief Copia la geometra de @p node a @p snapshot (usa el SDK; solo en el hilo que importa).
+	 * @return @c false si el nodo no tiene malla.
+	 */
+	bool
+		SnapshotFBXMesh(FbxNode* node, FbxMeshSnapshot& snapshot);
+
+	/**
+	 * @brief Convierte un snapshot en malla. No toca el SDK ni el modelo, por lo que es seguro en paralelo.
+	 */
+	static void
+		ProcessFBXMesh(const FbxMeshSnapshot& snapshot, MeshComponent& mc);
 
 	void
 		ProcessFBXMaterials(FbxSurfaceMaterial* material);
@@ -58,6 +95,8 @@ private:
 	FbxManager* lSdkManager;
 	FbxScene* lScene;
 	std::vector<std::string> textureFileNames;
+	bool m_compactVertices;
+	LodChainDesc m_lodChain;
 public:
 	ModelType m_modelType;
 	std::vector<MeshComponent> m_meshes;
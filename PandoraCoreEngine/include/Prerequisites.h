@@ -1,5 +1,6 @@
 #pragma once
 // Librerias STD
+#include <cstdint>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -57,6 +58,20 @@ struct SimpleVertex
   XMFLOAT2 Tex;
 };
 
+// Vrtice compacto (12 bytes): posicin SNORM16 relativa a la caja de la malla y UV en half float.
+struct CompactVertex
+{
+  int16_t Pos[4];
+  uint16_t Tex[2];
+};
+
+// Descuantizacin de CompactVertex: pos = snorm * vPosScale + vPosBias (registro b3).
+struct CBVertexDequant
+{
+  XMFLOAT4 vPosScale;
+  XMFLOAT4 vPosBias;
+};
+
 struct CBNeverChanges
 {
   XMMATRIX mView;
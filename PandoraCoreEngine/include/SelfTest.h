@@ -0,0 +1,26 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class SelfTest
+ * @brief Comprobaciones y mediciones de los módulos de CPU, sin ventana ni GPU.
+ *
+ * Las comprobaciones comparan cada módulo (soldadura OBJ, codecs, asignadores, culling,
+ * filtros...) con una implementación de referencia sencilla sobre datos sintéticos.
+ * Las mediciones generan escenas o archivos de tamaño creciente y reportan tiempos y
+ * memoria. wWinMain las ejecuta con "-selftest" (solo comprobaciones) o "-bench" (ambas).
+ *
+ * El resultado se escribe en @c SelfTest.log del directorio de trabajo y en la salida de
+ * depuración.
+ */
+class
+  SelfTest {
+public:
+  /**
+   * @brief Ejecuta las comprobaciones y, si @p benchmarks es @c true, también las mediciones.
+   *
+   * @return Número de comprobaciones fallidas (0 = todo correcto).
+   */
+  static int
+    run(bool benchmarks);
+};
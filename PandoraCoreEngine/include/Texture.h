@@ -3,6 +3,7 @@
 
 class Device;
 class DeviceContext;
+struct MipChain;
 
 /**
  * @class Texture
@@ -35,6 +36,9 @@ public:
    * Crea un recurso de textura a partir de un archivo de imagen y genera su
    * @c ShaderResourceView correspondiente para ser usado en shaders.
    *
+   * Las imágenes PNG/JPG se cargan con su cadena completa de mips, generada la
+   * primera vez con @c MipGenerator y guardada en @c TextureCache.
+   *
    * @param device        Dispositivo con el que se crear� la textura.
    * @param textureName   Nombre o ruta del archivo de textura.
    * @param extensionType Tipo de extensi�n de archivo (ej. PNG, JPG, DDS).
@@ -85,6 +89,52 @@ public:
   HRESULT 
   init(Device& device, Texture& textureRef, DXGI_FORMAT format);
 
+  /**
+   * @brief Crea la textura y su SRV a partir de píxeles RGBA8 ya decodificados.
+   *
+   * @param device Dispositivo con el que se creará la textura.
+   * @param pixels Píxeles RGBA8 con filas contiguas (@p width * 4 bytes por fila).
+   * @param width  Ancho en píxeles.
+   * @param height Alto en píxeles.
+   * @return @c S_OK si fue exitoso; código @c HRESULT en caso contrario.
+   */
+  HRESULT
+  initFromPixels(Device& device,
+                 const unsigned char* pixels,
+                 unsigned int width,
+                 unsigned int height);
+
+  /**
+   * @brief Crea la textura y su SRV con los niveles de @p chain a partir de @p firstMip.
+   *
+   * @param device   Dispositivo con el que se creará la textura.
+   * @param chain    Texeles de todos los mips (ver @c MipGenerator y @c TextureCache).
+   * @param firstMip Nivel que pasa a ser el 0 de la textura; los más detallados se omiten
+   *                 (ver @c TextureStreamer).
+   * @return @c S_OK si fue exitoso; código @c HRESULT en caso contrario.
+   */
+  HRESULT
+  initFromMips(Device& device, const MipChain& chain, uint32_t firstMip = 0);
+
+  /**
+   * @brief Carga varias texturas de archivo a la vez.
+   *
+   * Las cadenas de mips de las imágenes PNG/JPG se obtienen en paralelo en el
+   * @c ThreadPool (@c TextureCache::loadOrBuild: caché o decodificación + mips) y
+   * después se suben a GPU en el hilo que llama. Los DDS se cargan uno a uno con D3DX.
+   *
+   * @param device        Dispositivo con el que se crearán las texturas.
+   * @param textures      Recibe una textura por nombre, en el mismo orden; las que fallan quedan vacías.
+   * @param textureNames  Rutas sin extensión, como en init().
+   * @param extensionType Tipo de archivo de todo el lote.
+   * @return @c S_OK si todas se cargaron; el último código de fallo en otro caso.
+   */
+  static HRESULT
+  initBatch(Device& device,
+            std::vector<Texture>& textures,
+            const std::vector<std::string>& textureNames,
+            ExtensionType extensionType);
+
   /**
    * @brief Actualiza el contenido de la textura.
    *
@@ -122,6 +172,15 @@ public:
   void 
   destroy();
 
+  /**
+   * @brief Crea un cubemap a partir de seis imágenes (+X, -X, +Y, -Y, +Z, -Z).
+   *
+   * Las caras se obtienen en paralelo con @c TextureCache::loadOrBuild (sin compresión),
+   * así que los mips se generan en CPU una sola vez y los siguientes arranques proyectan
+   * la caché. Todas deben tener las mismas dimensiones.
+   *
+   * @param generateMips Si es @c true se suben todos los mips; si no, solo el nivel 0.
+   */
   HRESULT 
   CreateCubemap(Device& device,
                 DeviceContext& deviceContext,
@@ -0,0 +1,170 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Texture.h"
+#include "TextureCache.h"
+
+class Device;
+class MeshComponent;
+
+/**
+ * @struct AtlasSettings
+ * @brief Opciones del empaquetado; forman parte de la clave de caché del atlas.
+ */
+struct AtlasSettings
+{
+  uint32_t pageSize = 2048;       ///< Lado máximo de una página (potencia de 2).
+  uint32_t maxTextureSize = 256;  ///< Solo entran texturas cuyo lado mayor no supere este umbral.
+  uint32_t padding = 8;           ///< Borde replicado por lado, en texeles (potencia de 2; >= 4 con BC).
+  TextureImportSettings import;   ///< Compresión de las páginas (los mips siempre son de caja).
+
+  /**
+   * @brief Descripción textual estable, para las claves de caché.
+   */
+  std::string
+    toString() const {
+    return "page=" + std::to_string(pageSize) + ";max=" + std::to_string(maxTextureSize) +
+      ";pad=" + std::to_string(padding) + ";" + import.toString();
+  }
+};
+
+/**
+ * @struct AtlasRegion
+ * @brief Lugar de una textura dentro del atlas.
+ *
+ * Una UV original @c uv de la textura pasa a @c uv * uvScale + uvBias en la página.
+ */
+struct AtlasRegion
+{
+  uint32_t page = 0;    ///< Página que contiene la textura.
+  uint32_t x = 0;       ///< Primer texel del contenido (sin borde) en la página.
+  uint32_t y = 0;
+  uint32_t width = 0;   ///< Tamaño original de la textura.
+  uint32_t height = 0;
+  XMFLOAT2 uvScale = XMFLOAT2(1.0f, 1.0f);
+  XMFLOAT2 uvBias = XMFLOAT2(0.0f, 0.0f);
+};
+
+/**
+ * @class TextureAtlas
+ * @brief Empaqueta texturas pequeñas en páginas compartidas para dibujar muchos
+ *        props sin cambiar de textura entre draws.
+ *
+ * build() decodifica las fuentes en el @c ThreadPool, descarta las que superan
+ * @c AtlasSettings::maxTextureSize (siguen usando su propia textura) y las coloca por
+ * estantes, de la más alta a la más baja. Cada textura ocupa un rectángulo alineado a
+ * @c padding y rodeado de un borde que replica sus texeles de orilla; los mips de la
+ * página se generan con filtro de caja y solo hasta log2(padding), así ningún nivel
+ * mezcla texeles de dos texturas; si se comprimen en BC, solo hasta log2(padding) - 2,
+ * para que ningún bloque de 4x4 cruce entre dos regiones.
+ *
+ * loadOrBuild() guarda las páginas en el directorio de @c TextureCache y la pertenencia
+ * en un manifiesto ".pcatlas", de modo que los siguientes arranques solo proyectan la
+ * caché. Después de init(), remapUVs() lleva las UV de cada malla a su región.
+ *
+ * Las mallas cuyas UV salen de [0, 1] (texturas repetidas) no pueden usar el atlas.
+ */
+class
+  TextureAtlas {
+public:
+  /**
+   * @brief Versión del manifiesto y del empaquetado. Incrementar al cambiar cualquiera.
+   */
+  static constexpr uint32_t kVersion = 2;
+
+  TextureAtlas() = default;
+  ~TextureAtlas() = default;
+
+  /**
+   * @brief Empaqueta las fuentes en páginas en CPU (sin caché).
+   *
+   * @param sourcePaths Imágenes fuente (PNG, JPG, ...).
+   * @param settings    Opciones del empaquetado.
+   * @return @c S_OK si fue exitoso (aunque ninguna textura entre); @c E_INVALIDARG si
+   *         @p settings no es válido (incluido un @c padding menor que 4 con compresión).
+   */
+  HRESULT
+    build(const std::vector<std::string>& sourcePaths, const AtlasSettings& settings);
+
+  /**
+   * @brief Como build(), pero reutiliza la caché si las fuentes y opciones no cambiaron.
+   */
+  HRESULT
+    loadOrBuild(const std::vector<std::string>& sourcePaths, const AtlasSettings& settings);
+
+  /**
+   * @brief Crea en GPU las páginas y libera su copia en CPU.
+   */
+  HRESULT
+    init(Device& device);
+
+  /**
+   * @brief Libera las páginas y la pertenencia.
+   */
+  void
+    destroy();
+
+  /**
+   * @brief Región de @p sourcePath, o nulo si la textura no entró en el atlas.
+   */
+  const AtlasRegion*
+    findRegion(const std::string& sourcePath) const;
+
+  /**
+   * @brief Número de páginas.
+   */
+  uint32_t
+    getPageCount() const { return static_cast<uint32_t>(m_pageSizes.size()); }
+
+  /**
+   * @brief Texeles de la página @p page, o nulo después de init().
+   */
+  const MipChain*
+    getPageMips(uint32_t page) const {
+    return page < m_pageChains.size() ? &m_pageChains[page] : nullptr;
+  }
+
+  /**
+   * @brief SRV de la página @p page (válido después de init()).
+   */
+  ID3D11ShaderResourceView*
+    getPageView(uint32_t page) const {
+    return page < m_pages.size() ? m_pages[page].m_textureFromImg : nullptr;
+  }
+
+  /**
+   * @brief Lleva las UV de @p mesh a @p region (vértices normales y compactos).
+   *
+   * @return @c false, sin modificar la malla, si alguna UV sale de [0, 1].
+   */
+  static bool
+    remapUVs(MeshComponent& mesh, const AtlasRegion& region);
+
+private:
+  /**
+   * @brief Ruta del manifiesto del atlas con clave @p key.
+   */
+  static std::string
+    getManifestPath(uint64_t key);
+
+  /**
+   * @brief Carga el manifiesto y proyecta las páginas; @c false si algo falta o no coincide.
+   */
+  bool
+    loadCache(uint64_t key);
+
+  /**
+   * @brief Guarda las páginas y el manifiesto.
+   */
+  HRESULT
+    saveCache(uint64_t key) const;
+
+  struct PageSize {
+    uint32_t width;
+    uint32_t height;
+  };
+
+  std::unordered_map<std::string, AtlasRegion> m_regions;  ///< Pertenencia: fuente -> región.
+  std::vector<PageSize> m_pageSizes;                       ///< Ancho y alto de cada página.
+  std::vector<MipChain> m_pageChains;                      ///< Texeles de las páginas hasta init().
+  std::vector<Texture> m_pages;                            ///< Páginas en GPU.
+};
@@ -0,0 +1,182 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "MipGenerator.h"
+#include "BlockCompressor.h"
+
+/**
+ * @struct TextureImportSettings
+ * @brief Opciones de importación de una textura; forman parte de la clave de caché.
+ */
+struct TextureImportSettings
+{
+  MipSettings mips;                                         ///< Generación de mips.
+  BlockFormat compression = BlockFormat::Auto;              ///< Compresión por bloques (@c None = RGBA8).
+  CompressionQuality quality = CompressionQuality::Normal;  ///< Preset del compresor.
+
+  /**
+   * @brief Descripción textual estable, para las claves de caché.
+   */
+  std::string
+    toString() const {
+    return mips.toString() + ";bc=" + std::to_string(static_cast<int>(compression)) +
+      ";quality=" + std::to_string(static_cast<int>(quality));
+  }
+};
+
+/**
+ * @class TextureCache
+ * @brief Directorio de caché de texturas: contenedores binarios versionados (".pctex")
+ *        con la cadena de mips completa.
+ *
+ * Guarda los texeles ya decodificados (o comprimidos) y con todos sus mips para que los
+ * siguientes arranques proyecten el archivo en memoria y creen la textura directamente
+ * desde la vista, sin copias ni pasar por stb_image ni por @c MipGenerator.
+ *
+ * Las entradas viven en un directorio propio (getDirectory(), "Cache/Textures" por
+ * defecto) y se nombran por su clave, así que dos ajustes de importación de la misma
+ * imagen conviven. Tras cada escritura se desalojan las entradas menos usadas hasta
+ * quedar por debajo de getMaxSize(); cada carga renueva la fecha de la entrada.
+ *
+ * Distribución del archivo (little-endian):
+ * - @c TextureCacheHeader
+ * - @c MipLevel[mipCount]
+ * - Texeles de todos los niveles (@c MipChain::data)
+ *
+ * Igual que @c MeshCache, la validez se decide con una clave de 64 bits: hash del
+ * contenido de la imagen fuente combinado con @c TextureImportSettings y la versión del formato.
+ *
+ * Las texturas comprimidas por bloques se guardan como DDS en el mismo directorio
+ * ("<clave hex>.dds", ver @c DdsFile); si no se puede escribir, en el ".pctex". Nada
+ * se escribe junto a las fuentes, y evict() cuenta y desaloja ambos tipos de entrada.
+ */
+class
+  TextureCache {
+public:
+  /**
+   * @brief Versión actual del formato. Incrementar al cambiar la distribución.
+   */
+  static constexpr uint32_t kVersion = 1;
+
+  /**
+   * @brief Tamaño máximo por defecto del directorio de caché (512 MiB).
+   */
+  static constexpr uint64_t kDefaultMaxSize = 512ull * 1024 * 1024;
+
+  /**
+   * @brief Cambia el directorio de caché. No mueve las entradas existentes.
+   */
+  static void
+    setDirectory(const std::string& directory);
+
+  /**
+   * @brief Directorio de caché actual.
+   */
+  static std::string
+    getDirectory();
+
+  /**
+   * @brief Cambia el tamaño máximo del directorio (0 = sin límite).
+   */
+  static void
+    setMaxSize(uint64_t maxBytes);
+
+  /**
+   * @brief Tamaño máximo del directorio en bytes.
+   */
+  static uint64_t
+    getMaxSize();
+
+  /**
+   * @brief Ruta del archivo de caché de una clave ("<directorio>/<clave hex>.pctex").
+   */
+  static std::string
+    getCachePath(uint64_t key);
+
+  /**
+   * @brief Ruta del DDS comprimido de una clave ("<directorio>/<clave hex>.dds").
+   */
+  static std::string
+    getDdsPath(uint64_t key);
+
+  /**
+   * @brief Calcula la clave a partir del contenido fuente ya proyectado en memoria.
+   */
+  static uint64_t
+    computeKey(const void* sourceData,
+               size_t sourceSize,
+               const std::string& importSettings);
+
+  /**
+   * @brief Proyecta la cadena de mips si la caché existe y su clave coincide.
+   *
+   * Los texeles no se copian: @p chain retiene la proyección (@c MipChain::mapping)
+   * y apunta a ella hasta que se destruye.
+   *
+   * @param cachePath Ruta del archivo ".pctex".
+   * @param key       Clave esperada (ver computeKey()).
+   * @param chain     Destino; solo se modifica si la carga es válida.
+   * @return @c true si la caché era válida y se cargó.
+   */
+  static bool
+    load(const std::string& cachePath, uint64_t key, MipChain& chain);
+
+  /**
+   * @brief Escribe la cadena en la caché (archivo temporal + renombrado atómico).
+   *
+   * Crea el directorio si hace falta. No desaloja; ver evict().
+   *
+   * @return @c S_OK si fue exitoso; @c E_FAIL si no se pudo escribir.
+   */
+  static HRESULT
+    save(const std::string& cachePath, uint64_t key, const MipChain& chain);
+
+  /**
+   * @brief Obtiene la cadena de mips de una imagen: de la caché o decodificando y generando.
+   *
+   * Si la caché no es válida, decodifica con @c ImageDecoder, genera los mips, los
+   * comprime según @p settings y guarda el resultado para la próxima vez. Si el nivel 0
+   * no mide un múltiplo de 4 se guarda sin comprimir. Puede llamarse desde cualquier hilo.
+   *
+   * @param sourcePath Imagen fuente (PNG, JPG, ...).
+   * @param settings   Opciones de importación.
+   * @param chain      Recibe la cadena completa.
+   * @param error      Si no es nulo, recibe el motivo del fallo.
+   * @return @c S_OK si fue exitoso; @c E_FAIL si la imagen no pudo leerse o decodificarse.
+   */
+  static HRESULT
+    loadOrBuild(const std::string& sourcePath,
+                const TextureImportSettings& settings,
+                MipChain& chain,
+                std::string* error = nullptr);
+
+  /**
+   * @brief Borra las entradas ".pctex" y ".dds" más antiguas hasta que el directorio
+   *        ocupe como mucho @p maxBytes.
+   *
+   * Las entradas que están proyectadas (en uso) no pueden borrarse y se saltan.
+   *
+   * @return Número de bytes liberados.
+   */
+  static uint64_t
+    evict(uint64_t maxBytes);
+
+  /**
+   * @brief Precalienta la caché: llama a loadOrBuild() para cada imagen en el
+   *        @c ThreadPool y descarta los resultados.
+   *
+   * Pensado para ejecutarse sin ventana (ver "-warmcache" en wWinMain) o como paso
+   * de empaquetado, para que el primer arranque no decodifique nada.
+   *
+   * @return @c S_OK si todas las imágenes quedaron en caché; @c E_FAIL si alguna falló.
+   */
+  static HRESULT
+    warm(const std::vector<std::string>& sourcePaths,
+         const TextureImportSettings& settings);
+
+  /**
+   * @brief Precalienta todas las imágenes PNG/JPG bajo @p directory (recursivo).
+   */
+  static HRESULT
+    warmDirectory(const std::string& directory,
+                  const TextureImportSettings& settings);
+};
@@ -0,0 +1,184 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Texture.h"
+#include "MipGenerator.h"
+#include "FileSource.h"
+#include <deque>
+#include <future>
+#include <mutex>
+
+class Device;
+class DeviceContext;
+
+/**
+ * @brief Estado de una textura pedida a @c TextureLoader.
+ */
+enum class AsyncTextureState {
+  Pending = 0, ///< Decodificándose o esperando su turno de subida a GPU.
+  Ready = 1,   ///< La textura final está creada.
+  Failed = 2   ///< No se pudo leer, decodificar o crear; se sigue usando el placeholder.
+};
+
+/**
+ * @class AsyncTexture
+ * @brief Textura cuya carga ocurre en segundo plano; hasta estar lista se dibuja un placeholder.
+ *
+ * Solo se consulta y se modifica en el hilo principal; los hilos de trabajo nunca la tocan
+ * directamente, sino que dejan los píxeles en la cola de @c TextureLoader.
+ */
+class
+  AsyncTexture {
+public:
+  AsyncTexture() = default;
+  ~AsyncTexture() = default;
+
+  /**
+   * @brief Estado actual de la carga.
+   */
+  AsyncTextureState
+    getState() const { return m_state; }
+
+  /**
+   * @brief Indica si la textura final ya está creada.
+   */
+  bool
+    isReady() const { return m_state == AsyncTextureState::Ready; }
+
+  /**
+   * @brief Ruta del archivo pedido (con extensión).
+   */
+  const std::string&
+    getName() const { return m_texture.m_textureName; }
+
+  /**
+   * @brief SRV a enlazar: la textura final o, mientras no exista, el placeholder.
+   */
+  ID3D11ShaderResourceView*
+    getShaderResourceView() const {
+    return isReady() ? m_texture.m_textureFromImg : m_placeholder;
+  }
+
+  /**
+   * @brief Enlaza getShaderResourceView() en el Pixel Shader.
+   */
+  void
+    render(DeviceContext& deviceContext, unsigned int startSlot, unsigned int numViews);
+
+private:
+  friend class TextureLoader;
+
+  Texture m_texture;                                  ///< Textura final (válida en @c Ready).
+  ID3D11ShaderResourceView* m_placeholder = nullptr;  ///< SRV del placeholder, propiedad del loader.
+  AsyncTextureState m_state = AsyncTextureState::Pending;
+  double m_requestTime = 0.0;                         ///< Momento de la petición (ms), para el log.
+};
+
+/**
+ * @class TextureLoader
+ * @brief Carga asíncrona de texturas con subida a GPU acotada por frame.
+ *
+ * request() devuelve de inmediato una @c AsyncTexture y encola en el @c ThreadPool
+ * la obtención de su cadena de mips (@c TextureCache: caché o decodificación + mips).
+ * Los resultados quedan en una cola de staging protegida por mutex; update(), llamado
+ * una vez por frame en el hilo del dispositivo, crea las texturas de esa cola hasta
+ * agotar el presupuesto de bytes del frame. Así el bucle principal nunca espera a
+ * disco, a stb_image ni al filtrado de mips, y el costo de creación en GPU se reparte
+ * entre varios frames.
+ *
+ * Los DDS no se decodifican: el hilo de trabajo lee el archivo a memoria y update()
+ * lo crea con D3DX desde ese bloque.
+ */
+class
+  TextureLoader {
+public:
+  /**
+   * @brief Presupuesto por defecto de bytes subidos a GPU por frame (8 MiB).
+   */
+  static constexpr size_t kDefaultFrameBudget = 8u * 1024u * 1024u;
+
+  TextureLoader() = default;
+  ~TextureLoader() = default;
+
+  /**
+   * @brief Crea el placeholder (damero gris de 4x4).
+   *
+   * @param device      Dispositivo para el placeholder.
+   * @param frameBudget Bytes de textura que update() puede crear por frame.
+   * @return @c S_OK si fue exitoso; código @c HRESULT en caso contrario.
+   */
+  HRESULT
+    init(Device& device, size_t frameBudget = kDefaultFrameBudget);
+
+  /**
+   * @brief Pide una textura; regresa de inmediato.
+   *
+   * @param textureName   Ruta sin extensión, como en Texture::init().
+   * @param extensionType Tipo de archivo.
+   * @return Textura que dibuja el placeholder hasta que update() la complete.
+   */
+  EU::TSharedPointer<AsyncTexture>
+    request(const std::string& textureName, ExtensionType extensionType);
+
+  /**
+   * @brief Crea en GPU las texturas decodificadas, hasta el presupuesto del frame.
+   *
+   * Siempre crea al menos una si hay alguna lista, para que las texturas más grandes
+   * que el presupuesto también avancen.
+   *
+   * @return Número de texturas completadas (listas o fallidas) en este frame.
+   */
+  unsigned int
+    update(Device& device);
+
+  /**
+   * @brief Espera las decodificaciones en curso y libera todas las texturas y el placeholder.
+   */
+  void
+    destroy();
+
+  /**
+   * @brief Texturas pedidas que aún no terminan.
+   */
+  size_t
+    getPendingCount() const { return m_pendingCount; }
+
+  /**
+   * @brief Bytes creados en GPU en el último update().
+   */
+  size_t
+    getLastFrameBytes() const { return m_lastFrameBytes; }
+
+private:
+  /**
+   * @brief Resultado de un hilo de trabajo, pendiente de crearse en GPU.
+   */
+  struct StagedTexture {
+    AsyncTexture* target = nullptr;  ///< Destino (lo mantiene vivo @c m_requests).
+    ExtensionType type = PNG;
+    MipChain chain;                  ///< Cadena de mips (PNG/JPG).
+    FileSpan file;                   ///< Contenido del archivo proyectado (DDS).
+    size_t bytes = 0;                ///< Costo de subida para el presupuesto.
+    std::string error;               ///< Motivo del fallo, si lo hubo.
+  };
+
+  /**
+   * @brief Trabajo de un hilo del pool: lee/decodifica y deja el resultado en @c m_staged.
+   */
+  void
+    stage(AsyncTexture* target, const std::string& path, ExtensionType extensionType);
+
+  /**
+   * @brief Crea la textura de @p staged en GPU (hilo del dispositivo).
+   */
+  HRESULT
+    upload(Device& device, StagedTexture& staged);
+
+  Texture m_placeholder;                                   ///< Textura mostrada mientras se carga.
+  std::vector<EU::TSharedPointer<AsyncTexture>> m_requests; ///< Todas las texturas pedidas.
+  std::vector<std::future<void>> m_inFlight;               ///< Decodificaciones en curso.
+  std::deque<StagedTexture> m_staged;                      ///< Cola de staging (protegida por @c m_mutex).
+  std::mutex m_mutex;
+  size_t m_frameBudget = kDefaultFrameBudget;
+  size_t m_pendingCount = 0;
+  size_t m_lastFrameBytes = 0;
+};
@@ -0,0 +1,284 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Texture.h"
+#include "MipGenerator.h"
+#include <future>
+
+class Device;
+class DeviceContext;
+
+/**
+ * @struct TextureStreamingStats
+ * @brief Resumen del último TextureStreamer::update(), para la interfaz.
+ */
+struct TextureStreamingStats {
+  uint64_t budgetBytes = 0;    ///< Presupuesto global de VRAM para texturas en streaming.
+  uint64_t residentBytes = 0;  ///< Bytes de mips residentes en GPU.
+  uint64_t wantedBytes = 0;    ///< Bytes que harían falta para cumplir todas las peticiones.
+  uint32_t textures = 0;       ///< Texturas registradas.
+  uint32_t loading = 0;        ///< Texturas cuya cadena de mips aún se está cargando.
+  uint32_t uploads = 0;        ///< Texturas que subieron de detalle en este frame.
+  uint32_t drops = 0;          ///< Texturas que bajaron de detalle en este frame.
+};
+
+/**
+ * @class StreamedTexture
+ * @brief Textura con residencia parcial de mips: solo los niveles a partir de
+ *        getResidentMip() existen en GPU.
+ *
+ * Los actores piden cada frame el nivel que necesitan con requestScreenSize();
+ * @c TextureStreamer decide qué se carga o se descarta. Solo se usa en el hilo principal.
+ */
+class
+  StreamedTexture {
+public:
+  StreamedTexture() = default;
+  ~StreamedTexture() = default;
+
+  /**
+   * @brief Ruta del archivo pedido (con extensión).
+   */
+  const std::string&
+    getName() const { return m_texture.m_textureName; }
+
+  /**
+   * @brief Indica si ya hay algún nivel en GPU.
+   */
+  bool
+    isLoaded() const { return m_texture.m_textureFromImg != nullptr; }
+
+  /**
+   * @brief Indica si la carga de la cadena de mips falló.
+   */
+  bool
+    hasFailed() const { return m_failed; }
+
+  /**
+   * @brief Número total de niveles de la cadena (0 mientras se carga).
+   */
+  uint32_t
+    getMipCount() const { return static_cast<uint32_t>(m_chain.levels.size()); }
+
+  /**
+   * @brief Nivel más detallado presente en GPU (getMipCount() si ninguno).
+   */
+  uint32_t
+    getResidentMip() const { return m_residentMip; }
+
+  /**
+   * @brief Nivel que pide la escena (antes de aplicar el presupuesto).
+   */
+  uint32_t
+    getWantedMip() const { return m_wantedMip; }
+
+  /**
+   * @brief Nivel elegido por el streamer tras aplicar el presupuesto.
+   */
+  uint32_t
+    getTargetMip() const { return m_targetMip; }
+
+  /**
+   * @brief Ancho y alto de un nivel de la cadena.
+   */
+  uint32_t
+    getMipWidth(uint32_t mip) const { return mip < m_chain.levels.size() ? m_chain.levels[mip].width : 0; }
+
+  uint32_t
+    getMipHeight(uint32_t mip) const { return mip < m_chain.levels.size() ? m_chain.levels[mip].height : 0; }
+
+  /**
+   * @brief Bytes en GPU de los niveles desde @p mip hasta el último.
+   */
+  uint64_t
+    getBytesFrom(uint32_t mip) const;
+
+  /**
+   * @brief Pide el nivel adecuado para cubrir @p pixels píxeles en pantalla.
+   *
+   * Se asume que la textura cubre una vez la malla (UV de 0 a 1), así que el nivel
+   * ideal es aquel cuyo lado mayor se acerca a @p pixels. Varias peticiones en el mismo
+   * frame se combinan tomando la más detallada.
+   */
+  void
+    requestScreenSize(float pixels);
+
+  /**
+   * @brief Pide directamente un nivel de mip (0 = máximo detalle).
+   */
+  void
+    requestMip(uint32_t mip) {
+    if (mip < m_requestedMip) {
+      m_requestedMip = mip;
+    }
+  }
+
+  /**
+   * @brief SRV a enlazar: los niveles residentes o, si aún no hay, el placeholder.
+   */
+  ID3D11ShaderResourceView*
+    getShaderResourceView() const {
+    return isLoaded() ? m_texture.m_textureFromImg : m_placeholder;
+  }
+
+  /**
+   * @brief Enlaza getShaderResourceView() en el Pixel Shader.
+   */
+  void
+    render(DeviceContext& deviceContext, unsigned int startSlot, unsigned int numViews);
+
+private:
+  friend class TextureStreamer;
+
+  static constexpr uint32_t kNoRequest = 0xFFFFFFFFu;
+
+  Texture m_texture;                                  ///< Niveles residentes.
+  ID3D11ShaderResourceView* m_placeholder = nullptr;  ///< SRV del placeholder, propiedad del streamer.
+  MipChain m_chain;                                   ///< Cadena completa (proyectada desde la caché).
+  std::future<HRESULT> m_load;                        ///< Carga de la cadena en el @c ThreadPool.
+  std::future<void> m_prefetch;                       ///< Lectura anticipada de los niveles a subir.
+  std::string m_error;                                ///< Motivo del fallo de carga.
+  bool m_failed = false;
+  uint32_t m_prefetchMip = kNoRequest;                ///< Nivel que cubre @c m_prefetch.
+  uint32_t m_minMip = 0;                              ///< Nivel más detallado que se puede crear.
+  uint32_t m_initialMip = 0;                          ///< Niveles que se cargan al inicio y nunca se descartan.
+  uint32_t m_residentMip = 0;
+  uint32_t m_wantedMip = 0;
+  uint32_t m_targetMip = 0;
+  uint32_t m_requestedMip = kNoRequest;               ///< Petición del frame en curso.
+  uint64_t m_wantedFrame = 0;                         ///< Último frame en que se pidió @c m_wantedMip.
+};
+
+/**
+ * @class TextureStreamer
+ * @brief Streaming de texturas: residencia de mips guiada por el tamaño en pantalla
+ *        y limitada por un presupuesto global de VRAM.
+ *
+ * request() carga en el @c ThreadPool la cadena de mips con @c TextureCache (la caché
+ * queda proyectada en memoria, así que los niveles no usados no se leen de disco) y al
+ * principio solo sube los niveles de hasta kInitialResolution texeles de lado.
+ *
+ * update(), una vez por frame después del culling:
+ * - Combina las peticiones de los actores en un nivel deseado por textura. Subir de
+ *   detalle es inmediato; bajarlo espera kDropDelayFrames para evitar oscilaciones.
+ * - Si la suma de niveles deseados excede el presupuesto, quita un nivel a la vez a la
+ *   textura con el nivel superior más grande, hasta caber.
+ * - Descarta niveles de inmediato y sube los nuevos cuando su lectura anticipada ya
+ *   terminó, hasta el presupuesto de subida por frame.
+ *
+ * D3D11 no permite cambiar los mips de una textura existente, así que cada cambio de
+ * residencia recrea la textura con los niveles desde el nuevo mip (Texture::initFromMips()).
+ */
+class
+  TextureStreamer {
+public:
+  /**
+   * @brief Presupuesto global por defecto (256 MiB).
+   */
+  static constexpr uint64_t kDefaultBudget = 256ull * 1024 * 1024;
+
+  /**
+   * @brief Bytes que update() puede subir por frame por defecto (8 MiB).
+   */
+  static constexpr uint64_t kDefaultFrameUploadBudget = 8ull * 1024 * 1024;
+
+  /**
+   * @brief Lado máximo de los niveles que se cargan al inicio y siempre quedan residentes.
+   */
+  static constexpr uint32_t kInitialResolution = 64;
+
+  /**
+   * @brief Frames que un nivel debe dejar de pedirse antes de descartarlo.
+   */
+  static constexpr uint64_t kDropDelayFrames = 60;
+
+  TextureStreamer() = default;
+  ~TextureStreamer() = default;
+
+  /**
+   * @brief Crea el placeholder.
+   *
+   * @param device            Dispositivo para el placeholder.
+   * @param budget            Presupuesto global de VRAM en bytes.
+   * @param frameUploadBudget Bytes que update() puede subir por frame.
+   * @return @c S_OK si fue exitoso; código @c HRESULT en caso contrario.
+   */
+  HRESULT
+    init(Device& device,
+         uint64_t budget = kDefaultBudget,
+         uint64_t frameUploadBudget = kDefaultFrameUploadBudget);
+
+  /**
+   * @brief Registra una textura en streaming; regresa de inmediato.
+   *
+   * @param textureName   Ruta sin extensión, como en Texture::init().
+   * @param extensionType @c PNG o @c JPG (los DDS no pasan por la caché de mips).
+   * @return Textura que dibuja el placeholder hasta que lleguen sus primeros niveles.
+   */
+  EU::TSharedPointer<StreamedTexture>
+    request(const std::string& textureName, ExtensionType extensionType);
+
+  /**
+   * @brief Aplica las peticiones del frame y el presupuesto, y crea o descarta niveles.
+   */
+  void
+    update(Device& device);
+
+  /**
+   * @brief Espera las cargas en curso y libera todas las texturas y el placeholder.
+   */
+  void
+    destroy();
+
+  /**
+   * @brief Cambia el presupuesto global de VRAM.
+   */
+  void
+    setBudget(uint64_t budget) { m_budget = budget; }
+
+  uint64_t
+    getBudget() const { return m_budget; }
+
+  /**
+   * @brief Resultado del último update().
+   */
+  const TextureStreamingStats&
+    getStats() const { return m_stats; }
+
+  /**
+   * @brief Texturas registradas, para mostrar su residencia.
+   */
+  const std::vector<EU::TSharedPointer<StreamedTexture>>&
+    getTextures() const { return m_textures; }
+
+private:
+  /**
+   * @brief Primeros niveles de una cadena recién cargada.
+   */
+  HRESULT
+    finishLoad(Device& device, StreamedTexture& texture);
+
+  /**
+   * @brief Recrea la textura con los niveles desde @p mip.
+   */
+  HRESULT
+    makeResident(Device& device, StreamedTexture& texture, uint32_t mip);
+
+  /**
+   * @brief Nivel deseado del frame según las peticiones y la histéresis de descarte.
+   */
+  void
+    updateWantedMip(StreamedTexture& texture);
+
+  /**
+   * @brief Reparte el presupuesto: fija @c m_targetMip de cada textura.
+   */
+  void
+    applyBudget();
+
+  Texture m_placeholder;                                         ///< Se muestra mientras carga.
+  std::vector<EU::TSharedPointer<StreamedTexture>> m_textures;   ///< Todas las texturas registradas.
+  uint64_t m_budget = kDefaultBudget;
+  uint64_t m_frameUploadBudget = kDefaultFrameUploadBudget;
+  uint64_t m_frame = 0;
+  TextureStreamingStats m_stats;
+};
@@ -0,0 +1,112 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+
+/**
+ * @class ThreadPool
+ * @brief Conjunto fijo de hilos de trabajo con una cola FIFO de tareas.
+ *
+ * Se usa para las etapas de importación que pueden repartirse entre núcleos
+ * (parseo por fragmentos, conversión de mallas, decodificación de imágenes).
+ * Existe una instancia compartida del motor accesible con getInstance().
+ *
+ * @note Si el pool no tiene hilos (no inicializado), las tareas se ejecutan en el hilo que las encola.
+ */
+class
+  ThreadPool {
+public:
+  /**
+   * @brief Constructor por defecto (sin hilos).
+   */
+  ThreadPool() = default;
+
+  /**
+   * @brief Crea el pool con @p threadCount hilos de trabajo.
+   */
+  explicit ThreadPool(unsigned int threadCount) { init(threadCount); }
+
+  /**
+   * @brief Destructor. Termina las tareas pendientes y une los hilos.
+   */
+  ~ThreadPool() { destroy(); }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Pool compartido del motor (núcleos de hardware menos el hilo principal).
+   */
+  static ThreadPool&
+    getInstance();
+
+  /**
+   * @brief Lanza los hilos de trabajo.
+   * @param threadCount Número de hilos; 0 usa @c std::thread::hardware_concurrency().
+   * @return @c S_OK si fue exitoso.
+   */
+  HRESULT
+    init(unsigned int threadCount = 0);
+
+  /**
+   * @brief Vacía la cola y une todos los hilos. Idempotente.
+   */
+  void
+    destroy();
+
+  /**
+   * @brief Encola una tarea y devuelve un @c std::future con su resultado.
+   */
+  template<typename F, typename R = std::invoke_result_t<std::decay_t<F>>>
+  std::future<R>
+    enqueue(F&& task) {
+    auto packaged = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+    std::future<R> result = packaged->get_future();
+    if (m_workers.empty()) {
+      (*packaged)();
+      return result;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_tasks.emplace([packaged]() { (*packaged)(); });
+    }
+    m_condition.notify_one();
+    return result;
+  }
+
+  /**
+   * @brief Ejecuta @p body(i) para i en [0, count) repartiendo el trabajo entre el pool y el llamador.
+   *
+   * Bloquea hasta que todas las iteraciones terminan. El hilo llamador también
+   * consume iteraciones, por lo que es seguro invocarlo desde una tarea del pool.
+   * Si @p body lanza, las iteraciones que aún no empezaron se omiten y la primera
+   * excepción se relanza en el llamador cuando ya no queda ninguna en curso.
+   */
+  void
+    parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+  /**
+   * @brief Número de hilos de trabajo activos.
+   */
+  unsigned int
+    getThreadCount() const { return static_cast<unsigned int>(m_workers.size()); }
+
+private:
+  /**
+   * @brief Bucle de cada hilo de trabajo.
+   */
+  void
+    workerLoop();
+
+private:
+  std::vector<std::thread> m_workers;        ///< Hilos de trabajo.
+  std::queue<std::function<void()>> m_tasks; ///< Cola de tareas pendientes.
+  std::mutex m_mutex;                        ///< Protege @c m_tasks y @c m_stopping.
+  std::condition_variable m_condition;       ///< Despierta a los hilos cuando hay trabajo.
+  bool m_stopping = false;                   ///< Solicitud de terminación.
+};
@@ -0,0 +1,100 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+class MeshComponent;
+
+/**
+ * @struct VertexCodecError
+ * @brief Error introducido por la cuantización, en unidades de la malla.
+ */
+struct VertexCodecError
+{
+  float maxPosition = 0.0f; ///< Mayor distancia entre posición original y decodificada.
+  float rmsPosition = 0.0f; ///< Raíz del error cuadrático medio de posición.
+  float maxTexcoord = 0.0f; ///< Mayor distancia entre UV original y decodificada.
+  float rmsTexcoord = 0.0f; ///< Raíz del error cuadrático medio de UV.
+};
+
+/**
+ * @class VertexCodec
+ * @brief Codificador CPU entre @c SimpleVertex (20 bytes) y @c CompactVertex (12 bytes).
+ *
+ * - Posición: cada eje se normaliza a [-1, 1] dentro de la caja envolvente de la
+ *   malla y se guarda como SNORM de 16 bits (@c DXGI_FORMAT_R16G16B16A16_SNORM).
+ * - UV: dos half floats (@c DXGI_FORMAT_R16G16_FLOAT).
+ *
+ * El shader reconstruye la posición con @c CBVertexDequant (ver bin/CompactVertex.fxh); la
+ * variante bin/CompactVertex.fx se crea con getInputLayout() y GeometryPool la enlaza por malla.
+ * Todas las funciones son puras y no dependen del dispositivo, por lo que pueden
+ * probarse de forma aislada.
+ */
+class
+  VertexCodec {
+public:
+  /**
+   * @brief Convierte un float de 32 bits a half (redondeo al par más cercano).
+   */
+  static uint16_t
+    floatToHalf(float value);
+
+  /**
+   * @brief Convierte un half a float de 32 bits.
+   */
+  static float
+    halfToFloat(uint16_t value);
+
+  /**
+   * @brief Calcula la descuantización para la caja [@p boundsMin, @p boundsMax].
+   *
+   * Los ejes sin extensión usan escala 1 para no dividir entre cero.
+   */
+  static CBVertexDequant
+    computeDequant(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax);
+
+  /**
+   * @brief Codifica un vértice con la descuantización dada.
+   */
+  static CompactVertex
+    encode(const SimpleVertex& vertex, const CBVertexDequant& dequant);
+
+  /**
+   * @brief Decodifica un vértice (misma operación que hace el shader).
+   */
+  static SimpleVertex
+    decode(const CompactVertex& vertex, const CBVertexDequant& dequant);
+
+  /**
+   * @brief Codifica un arreglo completo de vértices.
+   */
+  static void
+    encode(const std::vector<SimpleVertex>& vertices,
+           const CBVertexDequant& dequant,
+           std::vector<CompactVertex>& out);
+
+  /**
+   * @brief Mide el error de reconstrucción de @p encoded respecto a @p original.
+   */
+  static VertexCodecError
+    measureError(const std::vector<SimpleVertex>& original,
+                 const std::vector<CompactVertex>& encoded,
+                 const CBVertexDequant& dequant);
+
+  /**
+   * @brief Codifica los vértices de una malla importada y registra el error resultante.
+   *
+   * Usa la caja envolvente de la malla (@c computeBounds() debe haberse llamado) y llena
+   * @c m_compactVertex y @c m_dequant. A partir de ese momento @c Buffer sube la versión compacta.
+   *
+   * @param mesh       Malla a codificar.
+   * @param keepSource Si es @c false, libera @c m_vertex tras codificar.
+   * @return Error de cuantización medido.
+   */
+  static VertexCodecError
+    encodeMesh(MeshComponent& mesh, bool keepSource = true);
+
+  /**
+   * @brief Descripción del InputLayout para @c CompactVertex.
+   */
+  static std::vector<D3D11_INPUT_ELEMENT_DESC>
+    getInputLayout();
+};
@@ -1,5 +1,9 @@
 ﻿#include "BaseApp.h"
 #include "ResourceManager.h"
+#include "FileSystem.h"
+#include "ConstantBufferUploader.h"
+#include "GeometryPool.h"
+#include "VertexCodec.h"
 
 HRESULT
 BaseApp::awake() {
@@ -116,6 +120,43 @@ BaseApp::init() {
 		return hr;
 	}
 
+	// Si hay paquete de assets, las texturas se leen de él en lugar de los archivos sueltos
+	if (FAILED(FileSystem::mountPack("Assets.pcpak"))) {
+		ERROR("Main", "InitDevice", "Assets.pcpak is invalid, using loose files.");
+	}
+
+	// Constantes por draw de los actores: un buffer dinámico por registro
+	hr = ConstantBufferUploader::getInstance().init(m_device);
+	if (FAILED(hr)) {
+		ERROR("Main", "InitDevice",
+			("Failed to initialize ConstantBufferUploader. HRESULT: " + std::to_string(hr)).c_str());
+		return hr;
+	}
+
+	// Geometría estática de todos los actores en vertex/index buffers compartidos
+	hr = GeometryPool::getInstance().init(m_device, m_deviceContext);
+	if (FAILED(hr)) {
+		ERROR("Main", "InitDevice",
+			("Failed to initialize GeometryPool. HRESULT: " + std::to_string(hr)).c_str());
+		return hr;
+	}
+
+	// Carga asíncrona de texturas: placeholder mientras se decodifican en segundo plano
+	hr = m_textureLoader.init(m_device);
+	if (FAILED(hr)) {
+		ERROR("Main", "InitDevice",
+			("Failed to initialize TextureLoader. HRESULT: " + std::to_string(hr)).c_str());
+		return hr;
+	}
+
+	// Streaming de texturas: solo mips bajos al inicio, el resto según el tamaño en pantalla
+	hr = m_textureStreamer.init(m_device);
+	if (FAILED(hr)) {
+		ERROR("Main", "InitDevice",
+			("Failed to initialize TextureStreamer. HRESULT: " + std::to_string(hr)).c_str());
+		return hr;
+	}
+
 	// Load Resources -> Modelos, Texturas e Interfaz de usuario
 	std::array<std::string, 6> faces = {
 		"Skybox/cubemap_0.png", 
@@ -137,24 +178,21 @@ BaseApp::init() {
 		m_model = new Model3D("Assets/Desert.fbx", ModelType::FBX);
 		PrintStreamMeshes = m_model->GetMeshes();
 
-		std::vector<Texture> PrintStreamTextures;
-		hr = m_PrintStreamAlbedo.init(m_device, "Assets/Text", ExtensionType::PNG);
-		// Load the Texture
-		if (FAILED(hr)) {
-			ERROR("Main", "InitDevice",
-				("Failed to initialize PrintStreamAlbedo. HRESULT: " + std::to_string(hr)).c_str());
-			return hr;
-		}
-		PrintStreamTextures.push_back(m_PrintStreamAlbedo);
+		// Load the Texture (en streaming: placeholder, luego mips bajos y más detalle al acercarse)
+		m_PrintStreamAlbedo = m_textureStreamer.request("Assets/Text", ExtensionType::PNG);
 
 		m_PrintStream->setMesh(m_device, PrintStreamMeshes);
-		m_PrintStream->setTextures(PrintStreamTextures);
+		m_PrintStream->setStreamedTextures({ m_PrintStreamAlbedo });
 		m_PrintStream->setName("PrintStream");
 		m_actors.push_back(m_PrintStream);
 
+		// El importador hornea en los vértices los ejes y unidades del FBX (DirectX, metros):
+		// Desert.fbx (Y arriba, mano derecha, centímetros) llega 100 veces más pequeño y
+		// reflejado en X. La escena se ajustó con los control points crudos, así que se
+		// escala x100 y se niegan los giros en Y y Z para conservar el mismo encuadre.
 		m_PrintStream->getComponent<Transform>()->setTransform(EU::Vector3(2.0f, -4.90f, 11.60f),
-			EU::Vector3(-0.60f, 3.0f, -0.20f),
-			EU::Vector3(1.0f, 1.0f, 1.0f));
+			EU::Vector3(-0.60f, -3.0f, 0.20f),
+			EU::Vector3(100.0f, 100.0f, 100.0f));
 	}
 	else {
 		ERROR("Main", "InitDevice", "Failed to create cyber Gun Actor.");
@@ -196,6 +234,14 @@ BaseApp::init() {
 		return hr;
 	}
 
+	// Variante para mallas con CompactVertex; sin ella esas mallas no se dibujan.
+	hr = m_compactShaderProgram.init(m_device, "CompactVertex.fx", VertexCodec::getInputLayout());
+	if (FAILED(hr)) {
+		ERROR("Main", "InitDevice",
+			("Failed to initialize compact ShaderProgram. HRESULT: " + std::to_string(hr)).c_str());
+	}
+	GeometryPool::getInstance().setShaderPrograms(m_shaderProgram, m_compactShaderProgram);
+
 	// Create the constant buffers
 	hr = m_cbNeverChanges.init(m_device, sizeof(CBNeverChanges));
 	if (FAILED(hr)) {
@@ -242,6 +288,10 @@ void BaseApp::update(float deltaTime)
 			dwTimeStart = dwTimeCur;
 		t = (dwTimeCur - dwTimeStart) / 1000.0f;
 	}
+	// Nuevo frame: estadísticas de constantes y geometría del anterior
+	ConstantBufferUploader::getInstance().update();
+	GeometryPool::getInstance().update();
+
 	// Update User Interface
 	m_gui.update(m_viewport, m_window);
 	bool show_demo_window = true;
@@ -283,8 +333,17 @@ void BaseApp::update(float deltaTime)
 	m_cbChangeOnResize.update(m_deviceContext, nullptr, 0, nullptr, &cbChangesOnResize, 0, 0);
 
 
+	// Subir a GPU las texturas ya decodificadas, dentro del presupuesto del frame
+	m_textureLoader.update(m_device);
+
 	// Update Actors
+	m_sceneGraph.setCamera(m_View, m_Projection, (float)m_window.m_height);
 	m_sceneGraph.update(deltaTime, m_deviceContext);
+	m_gui.renderStats(m_sceneGraph.getCullingStats(), m_sceneGraph.getMeshletStats());
+
+	// Residencia de mips según lo que pidieron los actores visibles, dentro del presupuesto
+	m_textureStreamer.update(m_device);
+	m_gui.textureStreaming(m_textureStreamer);
 
 	//for (auto& actor : m_actors) {
 	//	actor->update(deltaTime, m_deviceContext);
@@ -294,6 +353,9 @@ void BaseApp::update(float deltaTime)
 
 void
 BaseApp::render() {
+	// ImGui enlaza sus texturas directamente en el contexto: la caché del frame anterior no vale.
+	m_deviceContext.invalidateShaderResourceCache();
+
 	// Set Render Target View
 	float ClearColor[4] = { 0.1f, 0.1f, 0.1f, 1.0f };
 	m_renderTargetView.render(m_deviceContext, m_depthStencilView, 1, ClearColor);
@@ -329,9 +391,15 @@ void
 BaseApp::destroy() {
 	if (m_deviceContext.m_deviceContext) m_deviceContext.m_deviceContext->ClearState();
 	m_sceneGraph.destroy();
+	m_textureLoader.destroy();
+	m_textureStreamer.destroy();
+	FileSystem::unmountAll();
+	ConstantBufferUploader::getInstance().destroy();
+	GeometryPool::getInstance().destroy();
 	m_cbNeverChanges.destroy();
 	m_cbChangeOnResize.destroy();
 	m_shaderProgram.destroy();
+	m_compactShaderProgram.destroy();
 	m_depthStencil.destroy();
 	m_depthStencilView.destroy();
 	m_renderTargetView.destroy();
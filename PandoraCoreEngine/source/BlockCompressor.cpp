@@ -0,0 +1,578 @@
+﻿#include "BlockCompressor.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace {
+  /**
+   * @brief Texeles de un bloque 4x4 en SoA: @c c[canal][texel], valores 0..255.
+   */
+  struct alignas(16) BlockTexels {
+    float c[4][16];
+  };
+
+  /**
+   * @brief Escritor de bits de un bloque de 128 bits (LSB primero).
+   */
+  struct BitWriter {
+    uint64_t words[2] = { 0, 0 };
+    uint32_t position = 0;
+
+    void
+    write(uint32_t value, uint32_t bits) {
+      for (uint32_t i = 0; i < bits; ++i, ++position) {
+        words[position >> 6] |= static_cast<uint64_t>((value >> i) & 1u) << (position & 63);
+      }
+    }
+  };
+
+  /**
+   * @brief Elige para cada texel la entrada más cercana de la paleta (SSE, cuatro texeles a la vez).
+   *
+   * @param block        Texeles del bloque.
+   * @param channels     Canales a comparar (empezando en @p firstChannel).
+   * @param palette      Paleta, cuatro floats por entrada.
+   * @param paletteSize  Número de entradas.
+   * @param indices      Recibe el índice elegido por texel.
+   * @return Error cuadrático total del bloque.
+   */
+  float
+  selectIndices(const BlockTexels& block, int firstChannel, int channels,
+                const float (*palette)[4], int paletteSize, uint8_t indices[16]) {
+    __m128 total = _mm_setzero_ps();
+    for (int i = 0; i < 16; i += 4) {
+      __m128 texel[4];
+      for (int c = 0; c < channels; ++c) {
+        texel[c] = _mm_load_ps(&block.c[firstChannel + c][i]);
+      }
+
+      __m128 best = _mm_set1_ps(FLT_MAX);
+      __m128i bestIndex = _mm_setzero_si128();
+      for (int p = 0; p < paletteSize; ++p) {
+        __m128 distance = _mm_setzero_ps();
+        for (int c = 0; c < channels; ++c) {
+          const __m128 diff = _mm_sub_ps(texel[c], _mm_set1_ps(palette[p][firstChannel + c]));
+          distance = _mm_add_ps(distance, _mm_mul_ps(diff, diff));
+        }
+        const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+        best = _mm_min_ps(distance, best);
+        bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(p)),
+                                 _mm_andnot_si128(closer, bestIndex));
+      }
+
+      alignas(16) int32_t chosen[4];
+      _mm_store_si128(reinterpret_cast<__m128i*>(chosen), bestIndex);
+      for (int k = 0; k < 4; ++k) {
+        indices[i + k] = static_cast<uint8_t>(chosen[k]);
+      }
+      total = _mm_add_ps(total, best);
+    }
+    alignas(16) float sums[4];
+    _mm_store_ps(sums, total);
+    return sums[0] + sums[1] + sums[2] + sums[3];
+  }
+
+  /**
+   * @brief Extremos por caja envolvente de los canales [first, first + channels).
+   */
+  void
+  boundingBoxEndpoints(const BlockTexels& block, int first, int channels, float e0[4], float e1[4]) {
+    for (int c = first; c < first + channels; ++c) {
+      e0[c] = *std::max_element(block.c[c], block.c[c] + 16);
+      e1[c] = *std::min_element(block.c[c], block.c[c] + 16);
+    }
+  }
+
+  /**
+   * @brief Extremos sobre el eje principal (PCA por iteración de potencia).
+   */
+  void
+  principalAxisEndpoints(const BlockTexels& block, int first, int channels, float e0[4], float e1[4]) {
+    float mean[4] = {};
+    for (int c = first; c < first + channels; ++c) {
+      for (int i = 0; i < 16; ++i) mean[c] += block.c[c][i];
+      mean[c] /= 16.0f;
+    }
+
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; ++i) {
+      for (int a = first; a < first + channels; ++a) {
+        for (int b = first; b < first + channels; ++b) {
+          covariance[a][b] += (block.c[a][i] - mean[a]) * (block.c[b][i] - mean[b]);
+        }
+      }
+    }
+
+    // Semilla: diagonal de la caja envolvente (evita arrancar ortogonal al eje)
+    float axis[4] = {};
+    for (int c = first; c < first + channels; ++c) {
+      axis[c] = *std::max_element(block.c[c], block.c[c] + 16) - *std::min_element(block.c[c], block.c[c] + 16);
+    }
+    for (int iteration = 0; iteration < 8; ++iteration) {
+      float next[4] = {};
+      float length = 0.0f;
+      for (int a = first; a < first + channels; ++a) {
+        for (int b = first; b < first + channels; ++b) next[a] += covariance[a][b] * axis[b];
+        length += next[a] * next[a];
+      }
+      if (length < 1e-12f) break;
+      length = 1.0f / std::sqrt(length);
+      for (int c = first; c < first + channels; ++c) axis[c] = next[c] * length;
+    }
+
+    float minProjection = FLT_MAX;
+    float maxProjection = -FLT_MAX;
+    for (int i = 0; i < 16; ++i) {
+      float projection = 0.0f;
+      for (int c = first; c < first + channels; ++c) projection += (block.c[c][i] - mean[c]) * axis[c];
+      minProjection = std::min(minProjection, projection);
+      maxProjection = std::max(maxProjection, projection);
+    }
+    for (int c = first; c < first + channels; ++c) {
+      e0[c] = std::min(std::max(mean[c] + axis[c] * maxProjection, 0.0f), 255.0f);
+      e1[c] = std::min(std::max(mean[c] + axis[c] * minProjection, 0.0f), 255.0f);
+    }
+  }
+
+  /**
+   * @brief Ajuste por mínimos cuadrados de dos extremos dados los pesos de interpolación por texel.
+   * @return @c false si el sistema es singular (todos los texeles con el mismo peso).
+   */
+  bool
+  refineEndpoints(const BlockTexels& block, int first, int channels,
+                  const float weights[16], float e0[4], float e1[4]) {
+    float a = 0.0f, b = 0.0f, c = 0.0f;
+    float x0[4] = {}, x1[4] = {};
+    for (int i = 0; i < 16; ++i) {
+      const float t = weights[i];
+      const float s = 1.0f - t;
+      a += s * s;
+      b += s * t;
+      c += t * t;
+      for (int ch = first; ch < first + channels; ++ch) {
+        x0[ch] += s * block.c[ch][i];
+        x1[ch] += t * block.c[ch][i];
+      }
+    }
+    const float determinant = a * c - b * b;
+    if (std::fabs(determinant) < 1e-6f) {
+      return false;
+    }
+    const float inverse = 1.0f / determinant;
+    for (int ch = first; ch < first + channels; ++ch) {
+      e0[ch] = std::min(std::max((c * x0[ch] - b * x1[ch]) * inverse, 0.0f), 255.0f);
+      e1[ch] = std::min(std::max((a * x1[ch] - b * x0[ch]) * inverse, 0.0f), 255.0f);
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------- BC1
+
+  uint16_t
+  pack565(const float color[4]) {
+    const uint32_t r = static_cast<uint32_t>(color[0] * (31.0f / 255.0f) + 0.5f);
+    const uint32_t g = static_cast<uint32_t>(color[1] * (63.0f / 255.0f) + 0.5f);
+    const uint32_t b = static_cast<uint32_t>(color[2] * (31.0f / 255.0f) + 0.5f);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+  }
+
+  void
+  unpack565(uint16_t packed, float color[4]) {
+    const uint32_t r = (packed >> 11) & 31;
+    const uint32_t g = (packed >> 5) & 63;
+    const uint32_t b = packed & 31;
+    color[0] = static_cast<float>((r << 3) | (r >> 2));
+    color[1] = static_cast<float>((g << 2) | (g >> 4));
+    color[2] = static_cast<float>((b << 3) | (b >> 2));
+    color[3] = 255.0f;
+  }
+
+  /**
+   * @brief Paleta BC1 de 4 colores en orden de código (c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1).
+   */
+  float
+  evaluateBC1(const BlockTexels& block, uint16_t c0, uint16_t c1, uint8_t indices[16]) {
+    float palette[4][4];
+    unpack565(c0, palette[0]);
+    unpack565(c1, palette[1]);
+    for (int c = 0; c < 4; ++c) {
+      palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+      palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+    }
+    return selectIndices(block, 0, 3, palette, 4, indices);
+  }
+
+  void
+  encodeBC1(const BlockTexels& block, CompressionQuality quality, uint8_t* out) {
+    float e0[4], e1[4];
+    if (quality == CompressionQuality::Fast) {
+      boundingBoxEndpoints(block, 0, 3, e0, e1);
+    }
+    else {
+      principalAxisEndpoints(block, 0, 3, e0, e1);
+    }
+    // Inset: los extremos exactos desperdician parte de la paleta
+    for (int c = 0; c < 3; ++c) {
+      const float inset = (e0[c] - e1[c]) / 16.0f;
+      e0[c] -= inset;
+      e1[c] += inset;
+    }
+
+    uint16_t c0 = pack565(e0);
+    uint16_t c1 = pack565(e1);
+    uint8_t indices[16];
+    float error = evaluateBC1(block, c0, c1, indices);
+
+    if (quality == CompressionQuality::High) {
+      static const float kCodeWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+      for (int iteration = 0; iteration < 2; ++iteration) {
+        float weights[16];
+        for (int i = 0; i < 16; ++i) weights[i] = kCodeWeights[indices[i]];
+        float r0[4], r1[4];
+        if (!refineEndpoints(block, 0, 3, weights, r0, r1)) break;
+        uint8_t candidate[16];
+        const uint16_t n0 = pack565(r0);
+        const uint16_t n1 = pack565(r1);
+        const float candidateError = evaluateBC1(block, n0, n1, candidate);
+        if (candidateError >= error) break;
+        c0 = n0;
+        c1 = n1;
+        error = candidateError;
+        std::copy(candidate, candidate + 16, indices);
+      }
+    }
+
+    // Modo de 4 colores: c0 > c1. Al intercambiar, los códigos 0<->1 y 2<->3 se invierten.
+    if (c0 < c1) {
+      std::swap(c0, c1);
+      for (uint8_t& index : indices) index ^= 1;
+    }
+    else if (c0 == c1) {
+      std::fill(indices, indices + 16, static_cast<uint8_t>(0));
+    }
+
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; ++i) bits |= static_cast<uint32_t>(indices[i]) << (2 * i);
+    out[0] = static_cast<uint8_t>(c0);
+    out[1] = static_cast<uint8_t>(c0 >> 8);
+    out[2] = static_cast<uint8_t>(c1);
+    out[3] = static_cast<uint8_t>(c1 >> 8);
+    std::memcpy(out + 4, &bits, 4);
+  }
+
+  // ---------------------------------------------------------------- BC4
+
+  float
+  evaluateBC4(const BlockTexels& block, int channel, int e0, int e1, uint8_t indices[16]) {
+    float palette[8][4] = {};
+    palette[0][channel] = static_cast<float>(e0);
+    palette[1][channel] = static_cast<float>(e1);
+    if (e0 > e1) {
+      for (int k = 2; k < 8; ++k) palette[k][channel] = ((8 - k) * e0 + (k - 1) * e1) / 7.0f;
+    }
+    else {
+      for (int k = 2; k < 6; ++k) palette[k][channel] = ((6 - k) * e0 + (k - 1) * e1) / 5.0f;
+      palette[6][channel] = 0.0f;
+      palette[7][channel] = 255.0f;
+    }
+    return selectIndices(block, channel, 1, palette, 8, indices);
+  }
+
+  void
+  encodeBC4(const BlockTexels& block, int channel, CompressionQuality quality, uint8_t* out) {
+    const float* values = block.c[channel];
+    const int maxValue = static_cast<int>(*std::max_element(values, values + 16) + 0.5f);
+    const int minValue = static_cast<int>(*std::min_element(values, values + 16) + 0.5f);
+
+    int best0 = maxValue;
+    int best1 = minValue;
+    uint8_t indices[16];
+    float bestError = evaluateBC4(block, channel, best0, best1, indices);
+
+    auto tryEndpoints = [&](int e0, int e1) {
+      uint8_t candidate[16];
+      const float error = evaluateBC4(block, channel, e0, e1, candidate);
+      if (error < bestError) {
+        bestError = error;
+        best0 = e0;
+        best1 = e1;
+        std::copy(candidate, candidate + 16, indices);
+      }
+    };
+
+    if (quality != CompressionQuality::Fast && bestError > 0.0f) {
+      // Modo de 6 valores: 0 y 255 exactos (máscaras de alfa) y la paleta para el resto
+      int innerMin = 255, innerMax = 0;
+      for (int i = 0; i < 16; ++i) {
+        const int value = static_cast<int>(values[i] + 0.5f);
+        if (value != 0 && value != 255) {
+          innerMin = std::min(innerMin, value);
+          innerMax = std::max(innerMax, value);
+        }
+      }
+      if (innerMin <= innerMax) {
+        tryEndpoints(innerMin, innerMax);
+      }
+      if (quality == CompressionQuality::High) {
+        const int range = maxValue - minValue;
+        for (int inset = 1; inset <= std::min(4, range / 8); ++inset) {
+          tryEndpoints(maxValue - inset, minValue + inset);
+          tryEndpoints(maxValue - inset, minValue);
+          tryEndpoints(maxValue, minValue + inset);
+        }
+      }
+    }
+
+    out[0] = static_cast<uint8_t>(best0);
+    out[1] = static_cast<uint8_t>(best1);
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; ++i) bits |= static_cast<uint64_t>(indices[i]) << (3 * i);
+    for (int i = 0; i < 6; ++i) out[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+  }
+
+  // ---------------------------------------------------------------- BC7 (modo 6)
+
+  const int kBC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+  /**
+   * @brief Cuantiza un extremo a 7 bits por canal con el p-bit dado.
+   */
+  void
+  quantizeBC7(const float endpoint[4], int pbit, int quantized[4]) {
+    for (int c = 0; c < 4; ++c) {
+      const int value = static_cast<int>(std::floor((endpoint[c] - pbit) * 0.5f + 0.5f));
+      quantized[c] = std::min(std::max(value, 0), 127);
+    }
+  }
+
+  float
+  evaluateBC7(const BlockTexels& block, const int q0[4], int p0, const int q1[4], int p1, uint8_t indices[16]) {
+    float palette[16][4];
+    for (int c = 0; c < 4; ++c) {
+      const int e0 = (q0[c] << 1) | p0;
+      const int e1 = (q1[c] << 1) | p1;
+      for (int k = 0; k < 16; ++k) {
+        palette[k][c] = static_cast<float>(((64 - kBC7Weights4[k]) * e0 + kBC7Weights4[k] * e1 + 32) >> 6);
+      }
+    }
+    return selectIndices(block, 0, 4, palette, 16, indices);
+  }
+
+  void
+  encodeBC7(const BlockTexels& block, CompressionQuality quality, uint8_t* out) {
+    float e0[4], e1[4];
+    if (quality == CompressionQuality::Fast) {
+      boundingBoxEndpoints(block, 0, 4, e0, e1);
+    }
+    else {
+      principalAxisEndpoints(block, 0, 4, e0, e1);
+    }
+
+    int best0[4], best1[4], bestP0 = 0, bestP1 = 0;
+    uint8_t indices[16];
+    float bestError = FLT_MAX;
+
+    auto tryEndpoints = [&](const float a[4], const float b[4]) {
+      for (int p0 = 0; p0 < 2; ++p0) {
+        for (int p1 = 0; p1 < 2; ++p1) {
+          if (quality == CompressionQuality::Fast && p0 != p1) continue;
+          int q0[4], q1[4];
+          uint8_t candidate[16];
+          quantizeBC7(a, p0, q0);
+          quantizeBC7(b, p1, q1);
+          const float error = evaluateBC7(block, q0, p0, q1, p1, candidate);
+          if (error < bestError) {
+            bestError = error;
+            std::copy(q0, q0 + 4, best0);
+            std::copy(q1, q1 + 4, best1);
+            bestP0 = p0;
+            bestP1 = p1;
+            std::copy(candidate, candidate + 16, indices);
+          }
+        }
+      }
+    };
+    tryEndpoints(e0, e1);
+
+    if (quality == CompressionQuality::High) {
+      for (int iteration = 0; iteration < 2 && bestError > 0.0f; ++iteration) {
+        float weights[16];
+        for (int i = 0; i < 16; ++i) weights[i] = kBC7Weights4[indices[i]] / 64.0f;
+        float r0[4], r1[4];
+        if (!refineEndpoints(block, 0, 4, weights, r0, r1)) break;
+        const float previous = bestError;
+        tryEndpoints(r0, r1);
+        if (bestError >= previous) break;
+      }
+    }
+
+    // El índice del texel 0 (ancla) se guarda con 3 bits: su bit alto debe ser 0
+    if (indices[0] & 8) {
+      std::swap(best0, best1);
+      std::swap(bestP0, bestP1);
+      for (uint8_t& index : indices) index = static_cast<uint8_t>(15 - index);
+    }
+
+    BitWriter writer;
+    writer.write(1u << 6, 7); // Modo 6
+    for (int c = 0; c < 4; ++c) {
+      writer.write(static_cast<uint32_t>(best0[c]), 7);
+      writer.write(static_cast<uint32_t>(best1[c]), 7);
+    }
+    writer.write(static_cast<uint32_t>(bestP0), 1);
+    writer.write(static_cast<uint32_t>(bestP1), 1);
+    writer.write(indices[0], 3);
+    for (int i = 1; i < 16; ++i) writer.write(indices[i], 4);
+    std::memcpy(out, writer.words, 16);
+  }
+
+  // ----------------------------------------------------------------
+
+  void
+  encodeBlock(const BlockTexels& block, BlockFormat format, CompressionQuality quality, uint8_t* out) {
+    switch (format) {
+    case BlockFormat::BC1:
+      encodeBC1(block, quality, out);
+      break;
+    case BlockFormat::BC3:
+      encodeBC4(block, 3, quality, out);
+      encodeBC1(block, quality, out + 8);
+      break;
+    case BlockFormat::BC5:
+      encodeBC4(block, 0, quality, out);
+      encodeBC4(block, 1, quality, out + 8);
+      break;
+    case BlockFormat::BC7:
+      encodeBC7(block, quality, out);
+      break;
+    default:
+      break;
+    }
+  }
+
+  uint32_t
+  getBlockBytes(DXGI_FORMAT format) {
+    switch (format) {
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+      return 8;
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+      return 16;
+    default:
+      return 0;
+    }
+  }
+}
+
+DXGI_FORMAT
+BlockCompressor::getDxgiFormat(BlockFormat format) {
+  switch (format) {
+  case BlockFormat::BC1: return DXGI_FORMAT_BC1_UNORM;
+  case BlockFormat::BC3: return DXGI_FORMAT_BC3_UNORM;
+  case BlockFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+  case BlockFormat::BC7: return DXGI_FORMAT_BC7_UNORM;
+  default:               return DXGI_FORMAT_R8G8B8A8_UNORM;
+  }
+}
+
+BlockFormat
+BlockCompressor::resolve(BlockFormat format, const MipChain& source) {
+  if (format != BlockFormat::Auto) {
+    return format;
+  }
+  if (source.levels.empty()) {
+    return BlockFormat::BC1;
+  }
+  const uint8_t* texels = source.getLevelData(0);
+  const size_t texelCount = static_cast<size_t>(source.width) * source.height;
+  for (size_t i = 0; i < texelCount; ++i) {
+    if (texels[i * 4 + 3] != 255) {
+      return BlockFormat::BC3;
+    }
+  }
+  return BlockFormat::BC1;
+}
+
+MipLevel
+BlockCompressor::describeLevel(DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t offset) {
+  MipLevel level;
+  level.width = width;
+  level.height = height;
+  level.offset = offset;
+  const uint32_t blockBytes = getBlockBytes(format);
+  if (blockBytes) {
+    level.rowPitch = std::max(1u, (width + 3) / 4) * blockBytes;
+    level.size = level.rowPitch * std::max(1u, (height + 3) / 4);
+  }
+  else {
+    level.rowPitch = width * 4;
+    level.size = level.rowPitch * height;
+  }
+  return level;
+}
+
+HRESULT
+BlockCompressor::compress(const MipChain& source,
+                          BlockFormat format,
+                          CompressionQuality quality,
+                          MipChain& out) {
+  if (source.levels.empty() || source.format != DXGI_FORMAT_R8G8B8A8_UNORM) {
+    ERROR("BlockCompressor", "compress", "Source must be an R8G8B8A8 mip chain.");
+    return E_INVALIDARG;
+  }
+  if (source.width % 4 != 0 || source.height % 4 != 0) {
+    ERROR("BlockCompressor", "compress", "Block-compressed textures need a size multiple of 4.");
+    return E_INVALIDARG;
+  }
+
+  format = resolve(format, source);
+  if (format == BlockFormat::None) {
+    out = source;
+    return S_OK;
+  }
+
+  MipChain compressed;
+  compressed.format = getDxgiFormat(format);
+  compressed.width = source.width;
+  compressed.height = source.height;
+  uint32_t totalBytes = 0;
+  for (const MipLevel& level : source.levels) {
+    compressed.levels.push_back(describeLevel(compressed.format, level.width, level.height, totalBytes));
+    totalBytes += compressed.levels.back().size;
+  }
+  compressed.data.resize(totalBytes);
+  const uint32_t blockBytes = getBlockBytes(compressed.format);
+
+  for (size_t mip = 0; mip < source.levels.size(); ++mip) {
+    const MipLevel& src = source.levels[mip];
+    const MipLevel& dst = compressed.levels[mip];
+    const uint8_t* texels = source.getLevelData(mip);
+    uint8_t* blocks = compressed.data.data() + dst.offset;
+    const uint32_t blocksX = std::max(1u, (src.width + 3) / 4);
+    const uint32_t blocksY = std::max(1u, (src.height + 3) / 4);
+
+    ThreadPool::getInstance().parallelFor(blocksY, [&](size_t by) {
+      BlockTexels block;
+      for (uint32_t bx = 0; bx < blocksX; ++bx) {
+        // Niveles menores de 4x4: se repiten los texeles del borde
+        for (uint32_t i = 0; i < 16; ++i) {
+          const uint32_t x = std::min(bx * 4 + (i & 3), src.width - 1);
+          const uint32_t y = std::min(static_cast<uint32_t>(by) * 4 + (i >> 2), src.height - 1);
+          const uint8_t* texel = texels + static_cast<size_t>(y) * src.rowPitch + x * 4;
+          for (int c = 0; c < 4; ++c) block.c[c][i] = texel[c];
+        }
+        encodeBlock(block, format, quality, blocks + by * dst.rowPitch + bx * blockBytes);
+      }
+    });
+  }
+
+  out = std::move(compressed);
+  return S_OK;
+}
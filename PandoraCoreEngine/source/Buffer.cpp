@@ -8,11 +8,11 @@ Buffer::init(Device& device, const MeshComponent& mesh, unsigned int bindFlag) {
 		ERROR("ShaderProgram", "init", "Device is null.");
 		return E_POINTER;
 	}
-	if ((bindFlag & D3D11_BIND_VERTEX_BUFFER) && mesh.m_vertex.empty()) {
+	if ((bindFlag & D3D11_BIND_VERTEX_BUFFER) && mesh.m_vertex.empty() && !mesh.hasCompactVertices()) {
 		ERROR("Buffer", "init", "Vertex buffer is empty");
 		return E_INVALIDARG;
 	}
-	if ((bindFlag & D3D11_BIND_INDEX_BUFFER) && mesh.m_index.empty()) {
+	if ((bindFlag & D3D11_BIND_INDEX_BUFFER) && mesh.getIndexCount() == 0) {
 		ERROR("Buffer", "init", "Index buffer is empty");
 		return E_INVALIDARG;
 	}
@@ -24,17 +24,26 @@ Buffer::init(Device& device, const MeshComponent& mesh, unsigned int bindFlag) {
 	desc.CPUAccessFlags = 0;
 	m_bindFlag = bindFlag;
 
-	if (bindFlag & D3D11_BIND_VERTEX_BUFFER) {
+	if ((bindFlag & D3D11_BIND_VERTEX_BUFFER) && mesh.hasCompactVertices()) {
+		// Formato compacto: requiere el InputLayout de VertexCodec::getInputLayout().
+		m_stride = sizeof(CompactVertex);
+		desc.ByteWidth = m_stride * static_cast<unsigned int>(mesh.m_compactVertex.size());
+		desc.BindFlags = (D3D11_BIND_FLAG)bindFlag;
+		data.pSysMem = mesh.m_compactVertex.data();
+	}
+	else if (bindFlag & D3D11_BIND_VERTEX_BUFFER) {
 		m_stride = sizeof(SimpleVertex);
 		desc.ByteWidth = m_stride * static_cast<unsigned int>(mesh.m_vertex.size());
 		desc.BindFlags = (D3D11_BIND_FLAG)bindFlag;
 		data.pSysMem = mesh.m_vertex.data();
 	}
 	else if (bindFlag & D3D11_BIND_INDEX_BUFFER) {
-		m_stride = sizeof(unsigned int);
-		desc.ByteWidth = m_stride * static_cast<unsigned int>(mesh.m_index.size());
+		// 16 o 32 bits segn el formato elegido al importar la malla.
+		m_stride = mesh.getIndexStride();
+		m_indexFormat = mesh.m_indexFormat;
+		desc.ByteWidth = m_stride * static_cast<unsigned int>(mesh.getIndexCount());
 		desc.BindFlags = (D3D11_BIND_FLAG)bindFlag;
-		data.pSysMem = mesh.m_index.data();
+		data.pSysMem = mesh.getIndexData();
 	}
 
 	return createBuffer(device, desc, &data);
@@ -113,7 +122,9 @@ Buffer::render(DeviceContext& deviceContext,
 		}
 		break;
 	case D3D11_BIND_INDEX_BUFFER:
-		deviceContext.m_deviceContext->IASetIndexBuffer(m_buffer, format, m_offset);
+		deviceContext.m_deviceContext->IASetIndexBuffer(m_buffer,
+			format != DXGI_FORMAT_UNKNOWN ? format : m_indexFormat,
+			m_offset);
 		break;
 	default:
 		ERROR("Buffer", "render", "Unsupported BindFlag");
@@ -124,6 +135,7 @@ Buffer::render(DeviceContext& deviceContext,
 void
 Buffer::destroy() {
 	SAFE_RELEASE(m_buffer);
+	m_indexFormat = DXGI_FORMAT_UNKNOWN;
 }
 
 HRESULT
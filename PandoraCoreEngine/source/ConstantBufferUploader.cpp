@@ -0,0 +1,93 @@
+#include "ConstantBufferUploader.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include <cstring>
+
+ConstantBufferUploader&
+ConstantBufferUploader::getInstance() {
+  static ConstantBufferUploader instance;
+  return instance;
+}
+
+HRESULT
+ConstantBufferUploader::init(Device& device) {
+  if (!device.m_device) {
+    ERROR("ConstantBufferUploader", "init", "Device is null.");
+    return E_POINTER;
+  }
+  destroy();
+
+  D3D11_BUFFER_DESC desc = {};
+  desc.Usage = D3D11_USAGE_DYNAMIC;
+  desc.ByteWidth = kMaxSize;
+  desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+  desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+  for (ID3D11Buffer*& buffer : m_buffers) {
+    HRESULT hr = device.CreateBuffer(&desc, nullptr, &buffer);
+    if (FAILED(hr)) {
+      ERROR("ConstantBufferUploader", "init", "Failed to create dynamic constant buffer");
+      destroy();
+      return hr;
+    }
+  }
+
+  m_stats = ConstantBufferUploaderStats();
+  MESSAGE("ConstantBufferUploader", "init", (std::to_string(kSlotCount) + " dynamic buffers of " +
+    std::to_string(kMaxSize) + " bytes").c_str());
+  return S_OK;
+}
+
+void
+ConstantBufferUploader::update() {
+  m_stats.writes = m_writes;
+  m_stats.bytes = m_bytes;
+  m_writes = 0;
+  m_bytes = 0;
+}
+
+void
+ConstantBufferUploader::render(DeviceContext& deviceContext,
+                               const void* data,
+                               uint32_t size,
+                               unsigned int slot,
+                               bool setPixelShader) {
+  if (!deviceContext.m_deviceContext) {
+    ERROR("ConstantBufferUploader", "render", "DeviceContext is nullptr.");
+    return;
+  }
+  if (!data || size == 0 || size > kMaxSize || slot >= kSlotCount) {
+    ERROR("ConstantBufferUploader", "render", ("Invalid constant data size " + std::to_string(size) +
+      " or slot " + std::to_string(slot)).c_str());
+    return;
+  }
+  ID3D11Buffer* buffer = m_buffers[slot];
+  if (!buffer) {
+    ERROR("ConstantBufferUploader", "render", "Uploader is not initialized.");
+    return;
+  }
+
+  D3D11_MAPPED_SUBRESOURCE mapped = {};
+  HRESULT hr = deviceContext.m_deviceContext->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+  if (FAILED(hr)) {
+    ERROR("ConstantBufferUploader", "render", "Failed to map dynamic constant buffer");
+    return;
+  }
+  std::memcpy(mapped.pData, data, size);
+  deviceContext.m_deviceContext->Unmap(buffer, 0);
+
+  deviceContext.m_deviceContext->VSSetConstantBuffers(slot, 1, &buffer);
+  if (setPixelShader) {
+    deviceContext.m_deviceContext->PSSetConstantBuffers(slot, 1, &buffer);
+  }
+  ++m_writes;
+  m_bytes += size;
+}
+
+void
+ConstantBufferUploader::destroy() {
+  for (ID3D11Buffer*& buffer : m_buffers) {
+    SAFE_RELEASE(buffer);
+  }
+  m_writes = 0;
+  m_bytes = 0;
+}
@@ -0,0 +1,258 @@
+﻿#include "DdsFile.h"
+#include "BlockCompressor.h"
+#include "MappedFile.h"
+#include "FileSystem.h"
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace {
+  constexpr uint32_t makeFourCC(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(a)) |
+      (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+      (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) |
+      (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+  }
+
+  constexpr uint32_t kDdsMagic = makeFourCC('D', 'D', 'S', ' ');
+  constexpr uint32_t kEngineMarker = makeFourCC('P', 'C', 'D', 'S');
+
+  constexpr uint32_t kFlagCaps = 0x1;
+  constexpr uint32_t kFlagHeight = 0x2;
+  constexpr uint32_t kFlagWidth = 0x4;
+  constexpr uint32_t kFlagPitch = 0x8;
+  constexpr uint32_t kFlagPixelFormat = 0x1000;
+  constexpr uint32_t kFlagMipMapCount = 0x20000;
+  constexpr uint32_t kFlagLinearSize = 0x80000;
+
+  constexpr uint32_t kPixelAlpha = 0x1;
+  constexpr uint32_t kPixelFourCC = 0x4;
+  constexpr uint32_t kPixelRgb = 0x40;
+
+  constexpr uint32_t kCapsComplex = 0x8;
+  constexpr uint32_t kCapsTexture = 0x1000;
+  constexpr uint32_t kCapsMipMap = 0x400000;
+
+  struct DdsPixelFormat {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t fourCC;
+    uint32_t rgbBitCount;
+    uint32_t rMask;
+    uint32_t gMask;
+    uint32_t bMask;
+    uint32_t aMask;
+  };
+
+  struct DdsHeader {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t pitchOrLinearSize;
+    uint32_t depth;
+    uint32_t mipMapCount;
+    uint32_t reserved1[11];  ///< [0] marca del motor, [1] versión, [2..3] clave de caché.
+    DdsPixelFormat pixelFormat;
+    uint32_t caps;
+    uint32_t caps2;
+    uint32_t caps3;
+    uint32_t caps4;
+    uint32_t reserved2;
+  };
+
+  struct DdsHeaderDx10 {
+    uint32_t dxgiFormat;
+    uint32_t resourceDimension;
+    uint32_t miscFlag;
+    uint32_t arraySize;
+    uint32_t miscFlags2;
+  };
+
+  static_assert(sizeof(DdsPixelFormat) == 32, "DdsPixelFormat layout changed");
+  static_assert(sizeof(DdsHeader) == 124, "DdsHeader layout changed");
+  static_assert(sizeof(DdsHeaderDx10) == 20, "DdsHeaderDx10 layout changed");
+
+  /**
+   * @brief Lee magia y encabezado; @c false si no es un DDS.
+   */
+  bool
+  readHeader(const void* data, size_t size, DdsHeader& header) {
+    uint32_t magic = 0;
+    if (size < sizeof(magic) + sizeof(header)) {
+      return false;
+    }
+    std::memcpy(&magic, data, sizeof(magic));
+    std::memcpy(&header, static_cast<const char*>(data) + sizeof(magic), sizeof(header));
+    return magic == kDdsMagic && header.size == sizeof(DdsHeader);
+  }
+}
+
+bool
+DdsFile::isWritable(const std::string& path) {
+  std::error_code ec;
+  if (!std::filesystem::exists(path, ec)) {
+    return true;
+  }
+  MappedFile file;
+  DdsHeader header;
+  if (FAILED(file.init(path)) || !readHeader(file.data(), file.size(), header)) {
+    return false;
+  }
+  return header.reserved1[0] == kEngineMarker;
+}
+
+bool
+DdsFile::load(const std::string& path, uint64_t key, MipChain& chain) {
+  FileSpan file;
+  if (FAILED(FileSystem::open(path, file))) {
+    return false;
+  }
+
+  DdsHeader header;
+  if (!readHeader(file.data, file.size, header)) {
+    ERROR("DdsFile", "load", ("Not a DDS file: " + path).c_str());
+    return false;
+  }
+  if (header.reserved1[0] != kEngineMarker || header.reserved1[1] != kVersion) {
+    MESSAGE("DdsFile", "load", ("DDS was not written by this engine version, rebuilding: " + path).c_str());
+    return false;
+  }
+  const uint64_t storedKey = static_cast<uint64_t>(header.reserved1[2]) |
+    (static_cast<uint64_t>(header.reserved1[3]) << 32);
+  if (storedKey != key) {
+    MESSAGE("DdsFile", "load", ("Cache is stale, rebuilding: " + path).c_str());
+    return false;
+  }
+
+  size_t dataOffset = sizeof(uint32_t) + sizeof(DdsHeader);
+  DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+  const DdsPixelFormat& pixelFormat = header.pixelFormat;
+  if ((pixelFormat.flags & kPixelFourCC) && pixelFormat.fourCC == makeFourCC('D', 'X', '1', '0')) {
+    DdsHeaderDx10 dx10;
+    if (file.size < dataOffset + sizeof(dx10)) {
+      ERROR("DdsFile", "load", ("Truncated DX10 header: " + path).c_str());
+      return false;
+    }
+    std::memcpy(&dx10, file.data + dataOffset, sizeof(dx10));
+    dataOffset += sizeof(dx10);
+    format = static_cast<DXGI_FORMAT>(dx10.dxgiFormat);
+  }
+  else if (pixelFormat.flags & kPixelFourCC) {
+    if (pixelFormat.fourCC == makeFourCC('D', 'X', 'T', '1')) format = DXGI_FORMAT_BC1_UNORM;
+    if (pixelFormat.fourCC == makeFourCC('D', 'X', 'T', '5')) format = DXGI_FORMAT_BC3_UNORM;
+  }
+  else if ((pixelFormat.flags & kPixelRgb) && pixelFormat.rgbBitCount == 32 && pixelFormat.rMask == 0x000000FF) {
+    format = DXGI_FORMAT_R8G8B8A8_UNORM;
+  }
+  if (format == DXGI_FORMAT_UNKNOWN) {
+    ERROR("DdsFile", "load", ("Unsupported DDS pixel format: " + path).c_str());
+    return false;
+  }
+
+  MipChain loaded;
+  loaded.format = format;
+  loaded.width = header.width;
+  loaded.height = header.height;
+  const uint32_t mipCount = std::max(1u, header.mipMapCount);
+  uint32_t totalBytes = 0;
+  for (uint32_t mip = 0, w = header.width, h = header.height; mip < mipCount;
+       ++mip, w = std::max(1u, w / 2), h = std::max(1u, h / 2)) {
+    loaded.levels.push_back(BlockCompressor::describeLevel(format, w, h, totalBytes));
+    totalBytes += loaded.levels.back().size;
+  }
+  if (file.size < dataOffset + totalBytes) {
+    ERROR("DdsFile", "load", ("Truncated DDS payload: " + path).c_str());
+    return false;
+  }
+  loaded.mappedData = file.data + dataOffset;
+  loaded.mappedSize = totalBytes;
+  loaded.mapping = std::move(file.mapping);
+
+  chain = std::move(loaded);
+  return true;
+}
+
+HRESULT
+DdsFile::save(const std::string& path, uint64_t key, const MipChain& chain) {
+  if (!isWritable(path)) {
+    ERROR("DdsFile", "save", ("Refusing to overwrite a DDS not written by the engine: " + path).c_str());
+    return E_ACCESSDENIED;
+  }
+
+  DdsHeader header = {};
+  header.size = sizeof(DdsHeader);
+  header.flags = kFlagCaps | kFlagHeight | kFlagWidth | kFlagPixelFormat | kFlagMipMapCount;
+  header.height = chain.height;
+  header.width = chain.width;
+  header.mipMapCount = static_cast<uint32_t>(chain.levels.size());
+  header.reserved1[0] = kEngineMarker;
+  header.reserved1[1] = kVersion;
+  header.reserved1[2] = static_cast<uint32_t>(key);
+  header.reserved1[3] = static_cast<uint32_t>(key >> 32);
+  header.pixelFormat.size = sizeof(DdsPixelFormat);
+  header.caps = kCapsTexture | (chain.levels.size() > 1 ? kCapsComplex | kCapsMipMap : 0);
+
+  bool useDx10 = false;
+  switch (chain.format) {
+  case DXGI_FORMAT_R8G8B8A8_UNORM:
+    header.flags |= kFlagPitch;
+    header.pitchOrLinearSize = chain.levels[0].rowPitch;
+    header.pixelFormat.flags = kPixelRgb | kPixelAlpha;
+    header.pixelFormat.rgbBitCount = 32;
+    header.pixelFormat.rMask = 0x000000FF;
+    header.pixelFormat.gMask = 0x0000FF00;
+    header.pixelFormat.bMask = 0x00FF0000;
+    header.pixelFormat.aMask = 0xFF000000;
+    break;
+  case DXGI_FORMAT_BC1_UNORM:
+  case DXGI_FORMAT_BC3_UNORM:
+    header.flags |= kFlagLinearSize;
+    header.pitchOrLinearSize = chain.levels[0].size;
+    header.pixelFormat.flags = kPixelFourCC;
+    header.pixelFormat.fourCC = (chain.format == DXGI_FORMAT_BC1_UNORM) ?
+      makeFourCC('D', 'X', 'T', '1') : makeFourCC('D', 'X', 'T', '5');
+    break;
+  default:
+    header.flags |= kFlagLinearSize;
+    header.pitchOrLinearSize = chain.levels[0].size;
+    header.pixelFormat.flags = kPixelFourCC;
+    header.pixelFormat.fourCC = makeFourCC('D', 'X', '1', '0');
+    useDx10 = true;
+    break;
+  }
+
+  const std::string tempPath = path + ".tmp" +
+    std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xFFFF);
+  {
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      ERROR("DdsFile", "save", ("Failed to create DDS file: " + tempPath).c_str());
+      return E_FAIL;
+    }
+    out.write(reinterpret_cast<const char*>(&kDdsMagic), sizeof(kDdsMagic));
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (useDx10) {
+      DdsHeaderDx10 dx10 = {};
+      dx10.dxgiFormat = static_cast<uint32_t>(chain.format);
+      dx10.resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+      dx10.arraySize = 1;
+      out.write(reinterpret_cast<const char*>(&dx10), sizeof(dx10));
+    }
+    out.write(reinterpret_cast<const char*>(chain.getData()), chain.getDataSize());
+    if (!out) {
+      ERROR("DdsFile", "save", ("Failed to write DDS file: " + tempPath).c_str());
+      return E_FAIL;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tempPath, path, ec);
+  if (ec) {
+    ERROR("DdsFile", "save", ("Failed to replace DDS file: " + path).c_str());
+    std::filesystem::remove(tempPath, ec);
+    return E_FAIL;
+  }
+  return S_OK;
+}
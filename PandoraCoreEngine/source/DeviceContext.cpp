@@ -3,6 +3,7 @@
 void
 DeviceContext::destroy() {
 	SAFE_RELEASE(m_deviceContext);
+	invalidateShaderResourceCache();
 }
 
 void
@@ -23,9 +24,29 @@ DeviceContext::PSSetShaderResources(unsigned int StartSlot,
 		ERROR("DeviceContext", "PSSetShaderResources", "ppShaderResourceViews is nullptr");
 		return;
 	}
+	if (StartSlot + NumViews <= kCachedShaderResourceSlots) {
+		bool changed = false;
+		for (unsigned int i = 0; i < NumViews; ++i) {
+			// Nulo tambin significa "desconocido": desenlazar siempre llega al contexto.
+			if (!ppShaderResourceViews[i] || m_boundShaderResources[StartSlot + i] != ppShaderResourceViews[i]) {
+				m_boundShaderResources[StartSlot + i] = ppShaderResourceViews[i];
+				changed = true;
+			}
+		}
+		if (!changed) {
+			return;
+		}
+	}
 	m_deviceContext->PSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
 }
 
+void
+DeviceContext::invalidateShaderResourceCache() {
+	for (ID3D11ShaderResourceView*& view : m_boundShaderResources) {
+		view = nullptr;
+	}
+}
+
 void
 DeviceContext::IASetInputLayout(ID3D11InputLayout* pInputLayout) {
 	if (!pInputLayout) {
@@ -2,6 +2,8 @@
 #include "MeshComponent.h"
 #include "Device.h"
 #include "DeviceContext.h"
+#include "ConstantBufferUploader.h"
+#include <cmath>
 
 
 Actor::Actor(Device& device) {
@@ -13,10 +15,7 @@ Actor::Actor(Device& device) {
 
 	HRESULT hr;
 	std::string classNameType = "Actor -> " + m_name;
-	hr = m_modelBuffer.init(device, sizeof(CBChangesEveryFrame));
-	if (FAILED(hr)) {
-		ERROR("Actor", classNameType.c_str(), "Failed to create new CBChangesEveryFrame");
-	}
+	// Las constantes por frame (CBChangesEveryFrame, CBVertexDequant) van al ConstantBufferUploader
 
 	// Awake
 	awake();
@@ -80,8 +79,6 @@ Actor::update(float deltaTime, DeviceContext& deviceContext) {
 	// Update the model buffer
 	m_model.mWorld = XMMatrixTranspose(getComponent<Transform>()->matrix);
 	m_model.vMeshColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-	// Update the constant buffer
-	m_modelBuffer.update(deviceContext, nullptr, 0, nullptr, &m_model, 0, 0);
 }
 
 void
@@ -97,12 +94,28 @@ Actor::render(DeviceContext& deviceContext) {
 	m_sampler.render(deviceContext, 0, 1);
 
 	deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	// Bind del CB normal (world + color), una vez para todas las mallas del actor
+	ConstantBufferUploader& constants = ConstantBufferUploader::getInstance();
+	constants.render(deviceContext, &m_model, sizeof(CBChangesEveryFrame), 2, true);
+
+	GeometryPool& geometryPool = GeometryPool::getInstance();
+
 	// Update buffer and render all components
 	for (unsigned int i = 0; i < m_meshes.size(); i++) {
-		m_vertexBuffers[i].render(deviceContext, 0, 1);
-		m_indexBuffers[i].render(deviceContext, 0, 1, false, DXGI_FORMAT_R32_UINT);
-		// Bind del CB normal (world + color)
-		m_modelBuffer.render(deviceContext, 2, 1, true);
+		// Mallas descartadas por el frustum culling de la escena (o que no entraron al pool)
+		if (!isMeshVisible(i) || !m_geometry[i].isValid()) {
+			continue;
+		}
+		// InputLayout y VS segn el formato de vrtice de la malla (su pgina del pool tiene ese stride)
+		const bool compact = m_meshes[i].hasCompactVertices();
+		if (!geometryPool.bindVertexFormat(deviceContext, compact)) {
+			continue;
+		}
+		// Mallas con vrtice compacto: descuantizacin por malla en b3 (la lee CompactVertex.fx)
+		if (compact) {
+			constants.render(deviceContext, &m_meshes[i].m_dequant, sizeof(CBVertexDequant), 3);
+		}
 
 		// Render mesh texture
 		if (m_textures.size() > 0) {
@@ -116,25 +129,181 @@ Actor::render(DeviceContext& deviceContext) {
 				}
 			}
 		}
-		deviceContext.DrawIndexed(m_meshes[i].m_numIndex, 0, 0);
+		else if (m_atlasPage) {
+			// Los actores de la misma pgina repiten este SRV: DeviceContext omite el cambio.
+			deviceContext.PSSetShaderResources(0, 1, &m_atlasPage); // Pgina de atlas -> t0
+		}
+		else if (!m_streamedTextures.empty()) {
+			m_streamedTextures[0]->render(deviceContext, 0, 1); // Albedo (niveles residentes) -> t0
+		}
+		else if (!m_asyncTextures.empty()) {
+			m_asyncTextures[0]->render(deviceContext, 0, 1); // Albedo (o placeholder) -> t0
+		}
+		// Los draws de mallas en la misma pgina del pool no vuelven a enlazar IA
+		if (i < m_meshletCulled.size() && m_meshletCulled[i]) {
+			for (const MeshletRange& range : m_meshletRanges[i]) {
+				geometryPool.render(deviceContext, m_geometry[i], range.indexStart, range.indexCount);
+			}
+			continue;
+		}
+		const MeshLod lod = m_meshes[i].getLod(getLodLevel(i));
+		geometryPool.render(deviceContext, m_geometry[i], lod.indexStart, lod.indexCount);
 	}
 }
 
 
 void
-Actor::destroy() {
-	for (auto& vertexBuffer : m_vertexBuffers) {
-		vertexBuffer.destroy();
+Actor::selectLod(const XMMATRIX& view, const XMMATRIX& projection, float viewportHeight, float maxPixelError) {
+	// Debajo de este dimetro en pantalla la malla usa siempre el nivel ms simple.
+	const float kMinPixelDiameter = 4.0f;
+
+	m_lodLevels.assign(m_meshes.size(), 0);
+	auto transform = getComponent<Transform>();
+	const XMMATRIX world = transform ? transform->matrix : XMMatrixIdentity();
+	const XMMATRIX worldView = world * view;
+
+	// Escala mxima del mundo, para llevar radios y errores a unidades de mundo.
+	XMFLOAT4X4 w;
+	XMStoreFloat4x4(&w, world);
+	const float scale = (std::max)((std::max)(
+		std::sqrt(w._11 * w._11 + w._12 * w._12 + w._13 * w._13),
+		std::sqrt(w._21 * w._21 + w._22 * w._22 + w._23 * w._23)),
+		std::sqrt(w._31 * w._31 + w._32 * w._32 + w._33 * w._33));
+
+	// Pxeles por unidad de mundo a distancia 1 (cot(fov/2) * alto / 2).
+	XMFLOAT4X4 p;
+	XMStoreFloat4x4(&p, projection);
+	const float pixelsPerUnitAtOne = p._22 * viewportHeight * 0.5f;
+
+	for (size_t i = 0; i < m_meshes.size(); ++i) {
+		const MeshComponent& mesh = m_meshes[i];
+		const size_t lodCount = mesh.getLodCount();
+		if (lodCount < 2) {
+			continue;
+		}
+
+		const XMFLOAT3 localCenter = mesh.getBoundsCenter();
+		const XMVECTOR center = XMVectorSet(localCenter.x, localCenter.y, localCenter.z, 1.0f);
+		const float radius = mesh.m_boundsRadius * scale;
+
+		// Distancia al punto ms cercano de la esfera; dentro de ella se usa el LOD 0.
+		const float nearest = XMVectorGetZ(XMVector3TransformCoord(center, worldView)) - radius;
+		if (nearest <= 1e-4f) {
+			continue;
+		}
+		const float pixelsPerUnit = pixelsPerUnitAtOne / nearest;
+
+		if (2.0f * radius * pixelsPerUnit < kMinPixelDiameter) {
+			m_lodLevels[i] = static_cast<unsigned int>(lodCount - 1);
+			continue;
+		}
+		for (size_t level = lodCount - 1; level > 0; --level) {
+			if (mesh.getLod(level).error * scale * pixelsPerUnit <= maxPixelError) {
+				m_lodLevels[i] = static_cast<unsigned int>(level);
+				break;
+			}
+		}
+	}
+}
+
+void
+Actor::updateWorldBounds() {
+	auto transform = getComponent<Transform>();
+	const XMMATRIX world = transform ? transform->matrix : XMMatrixIdentity();
+
+	m_worldBounds.resize(m_meshes.size());
+	for (size_t i = 0; i < m_meshes.size(); ++i) {
+		const MeshComponent& mesh = m_meshes[i];
+		m_worldBounds[i] = FrustumCuller::transformBounds(mesh.m_boundsMin, mesh.m_boundsMax,
+		                                                  mesh.m_boundsRadius, world);
+	}
+}
+
+void
+Actor::cullMeshlets(const FrustumCuller& frustum, const XMFLOAT3& cameraPosition, CullingStats& stats) {
+	auto transform = getComponent<Transform>();
+	const XMMATRIX world = transform ? transform->matrix : XMMatrixIdentity();
+
+	m_meshletCulled.resize(m_meshes.size(), 0);
+	m_meshletRanges.resize(m_meshes.size());
+	for (size_t i = 0; i < m_meshes.size(); ++i) {
+		const MeshComponent& mesh = m_meshes[i];
+		// Los meshlets solo cubren el LOD 0
+		if (mesh.m_meshlets.empty() || !isMeshVisible(i) || getLodLevel(i) != 0) {
+			m_meshletCulled[i] = 0;
+			continue;
+		}
+		const size_t visible = MeshletBuilder::cull(mesh.m_meshlets, world, frustum, cameraPosition,
+		                                            m_meshletRanges[i]);
+		m_meshletCulled[i] = 1;
+		stats.tested += static_cast<uint32_t>(mesh.m_meshlets.size());
+		stats.visible += static_cast<uint32_t>(visible);
+		stats.culled += static_cast<uint32_t>(mesh.m_meshlets.size() - visible);
+	}
+}
+
+void
+Actor::requestTextureMips(const XMMATRIX& view, const XMMATRIX& projection, float viewportHeight) {
+	if (m_streamedTextures.empty()) {
+		return;
+	}
+	auto transform = getComponent<Transform>();
+	const XMMATRIX world = transform ? transform->matrix : XMMatrixIdentity();
+	const XMMATRIX worldView = world * view;
+
+	XMFLOAT4X4 w;
+	XMStoreFloat4x4(&w, world);
+	const float scale = (std::max)((std::max)(
+		std::sqrt(w._11 * w._11 + w._12 * w._12 + w._13 * w._13),
+		std::sqrt(w._21 * w._21 + w._22 * w._22 + w._23 * w._23)),
+		std::sqrt(w._31 * w._31 + w._32 * w._32 + w._33 * w._33));
+
+	XMFLOAT4X4 p;
+	XMStoreFloat4x4(&p, projection);
+	const float pixelsPerUnitAtOne = p._22 * viewportHeight * 0.5f;
+
+	// Dimetro en pantalla de la malla visible ms grande del actor
+	float pixels = 0.0f;
+	bool needsFullDetail = false;
+	for (size_t i = 0; i < m_meshes.size(); ++i) {
+		if (!isMeshVisible(i)) {
+			continue;
+		}
+		const MeshComponent& mesh = m_meshes[i];
+		const XMFLOAT3 localCenter = mesh.getBoundsCenter();
+		const XMVECTOR center = XMVectorSet(localCenter.x, localCenter.y, localCenter.z, 1.0f);
+		const float radius = mesh.m_boundsRadius * scale;
+		const float nearest = XMVectorGetZ(XMVector3TransformCoord(center, worldView)) - radius;
+		if (nearest <= 1e-4f) {
+			needsFullDetail = true;
+			break;
+		}
+		pixels = (std::max)(pixels, 2.0f * radius * pixelsPerUnitAtOne / nearest);
+	}
+
+	for (EU::TSharedPointer<StreamedTexture>& texture : m_streamedTextures) {
+		if (needsFullDetail) {
+			texture->requestMip(0);
+		}
+		else {
+			texture->requestScreenSize(pixels);
+		}
 	}
+}
 
-	for (auto& indexBuffer : m_indexBuffers) {
-		indexBuffer.destroy();
+void
+Actor::destroy() {
+	for (GeometryHandle& geometry : m_geometry) {
+		GeometryPool::getInstance().remove(geometry);
 	}
+	m_geometry.clear();
 
 	for (auto& tex : m_textures) {
 		tex.destroy();
 	}
-	m_modelBuffer.destroy();
+	m_asyncTextures.clear(); // Las libera TextureLoader::destroy()
+	m_streamedTextures.clear(); // Las libera TextureStreamer::destroy()
+	m_atlasPage = nullptr; // La libera TextureAtlas::destroy()
 
 	//m_rasterizer.destroy();
 	//m_blendstate.destroy();
@@ -144,26 +313,16 @@ Actor::destroy() {
 void
 Actor::setMesh(Device& device, std::vector<MeshComponent> meshes) {
 	m_meshes = meshes;
-	HRESULT hr;
-	for (auto& mesh : m_meshes) {
-		// Crear vertex buffer
-		Buffer vertexBuffer;
-		hr = vertexBuffer.init(device, mesh, D3D11_BIND_VERTEX_BUFFER);
-		if (FAILED(hr)) {
-			ERROR("Actor", "setMesh", "Failed to create new vertexBuffer");
-		}
-		else {
-			m_vertexBuffers.push_back(vertexBuffer);
-		}
-
-		// Crear index buffer
-		Buffer indexBuffer;
-		hr = indexBuffer.init(device, mesh, D3D11_BIND_INDEX_BUFFER);
+	GeometryPool& geometryPool = GeometryPool::getInstance();
+	for (GeometryHandle& geometry : m_geometry) {
+		geometryPool.remove(geometry);
+	}
+	// Un handle por malla (invlido si fall): render() indexa m_geometry como m_meshes
+	m_geometry.assign(m_meshes.size(), GeometryHandle());
+	for (size_t i = 0; i < m_meshes.size(); ++i) {
+		HRESULT hr = geometryPool.add(m_meshes[i], m_geometry[i]);
 		if (FAILED(hr)) {
-			ERROR("Actor", "setMesh", "Failed to create new indexBuffer");
-		}
-		else {
-			m_indexBuffers.push_back(indexBuffer);
+			ERROR("Actor", "setMesh", "Failed to add mesh to GeometryPool");
 		}
 	}
 }
\ No newline at end of file
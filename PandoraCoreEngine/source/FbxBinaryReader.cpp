@@ -0,0 +1,608 @@
+﻿#include "FbxBinaryReader.h"
+#include "Inflater.h"
+#include "MappedFile.h"
+#include "MeshComponent.h"
+#include "ThreadPool.h"
+#include <cmath>
+
+namespace {
+  // "Kaydara FBX Binary  \0" seguido de 0x1A 0x00 y la versión (uint32).
+  const char kFbxMagic[] = "Kaydara FBX Binary  ";
+  const size_t kFbxMagicSize = sizeof(kFbxMagic);   // Incluye el '\0' final.
+  const size_t kFbxHeaderSize = 27;
+  const int kMaxNodeDepth = 64;
+
+  template<typename T>
+  inline T
+  readScalar(const char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+  }
+
+  template<typename S, typename T>
+  inline void
+  convertArray(const uint8_t* raw, size_t count, std::vector<T>& out) {
+    out.resize(count);
+    if constexpr (std::is_same<S, T>::value) {
+      std::memcpy(out.data(), raw, count * sizeof(T));
+      return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = static_cast<T>(readScalar<S>(reinterpret_cast<const char*>(raw) + i * sizeof(S)));
+    }
+  }
+
+  /**
+   * @brief Nombre visible de un objeto FBX ("Nombre\x00\x01Clase" -> "Nombre").
+   */
+  std::string
+  stripClassName(const std::string& name) {
+    const size_t separator = name.find(std::string("\x00\x01", 2));
+    return separator == std::string::npos ? name : name.substr(0, separator);
+  }
+}
+
+bool
+FbxAxisConversion::isValid() const {
+  auto validAxis = [](int axis) { return axis >= 0 && axis <= 2; };
+  auto validSign = [](int sign) { return sign == 1 || sign == -1; };
+  return validAxis(upAxis) && validAxis(frontAxis) && validAxis(coordAxis) &&
+         upAxis != frontAxis && upAxis != coordAxis && frontAxis != coordAxis &&
+         validSign(upAxisSign) && validSign(frontAxisSign) && validSign(coordAxisSign) &&
+         unitScaleFactor > 0.0 && std::isfinite(unitScaleFactor);
+}
+
+bool
+FbxAxisConversion::isIdentity() const {
+  // DirectX: X = -coord, Y = +up, Z = +front, en metros.
+  return upAxis == 1 && upAxisSign == 1 && frontAxis == 2 && frontAxisSign == 1 &&
+         coordAxis == 0 && coordAxisSign == -1 && unitScaleFactor == 100.0;
+}
+
+void
+FbxAxisConversion::apply(std::vector<SimpleVertex>& vertices, std::vector<unsigned int>& indices) const {
+  if (isIdentity()) {
+    return;
+  }
+
+  // Cada fila toma un solo eje del archivo: la matriz es una permutación con signo y escala.
+  const float scale = static_cast<float>(unitScaleFactor / 100.0);
+  int sourceAxis[3] = { coordAxis, upAxis, frontAxis };
+  float factor[3] = { -coordAxisSign * scale, upAxisSign * scale, frontAxisSign * scale };
+
+  for (SimpleVertex& vertex : vertices) {
+    const float source[3] = { vertex.Pos.x, vertex.Pos.y, vertex.Pos.z };
+    vertex.Pos = XMFLOAT3(source[sourceAxis[0]] * factor[0],
+                          source[sourceAxis[1]] * factor[1],
+                          source[sourceAxis[2]] * factor[2]);
+  }
+
+  // Signo del determinante: el de la permutación por el de los factores.
+  int determinant = (coordAxisSign * -1) * upAxisSign * frontAxisSign;
+  for (int i = 0; i < 3; ++i) {
+    for (int j = i + 1; j < 3; ++j) {
+      if (sourceAxis[i] > sourceAxis[j]) {
+        determinant = -determinant;
+      }
+    }
+  }
+  if (determinant < 0) {
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+      std::swap(indices[i + 1], indices[i + 2]);
+    }
+  }
+}
+
+bool
+FbxBinaryReader::isBinaryFbx(const char* data, size_t size) {
+  return data && size >= kFbxHeaderSize && std::memcmp(data, kFbxMagic, kFbxMagicSize) == 0;
+}
+
+HRESULT
+FbxBinaryReader::init(const char* data, size_t size) {
+  destroy();
+  if (!isBinaryFbx(data, size)) {
+    ERROR("FbxBinaryReader", "init", "Not a binary FBX file");
+    return E_FAIL;
+  }
+
+  m_version = readScalar<uint32_t>(data + 23);
+  if (m_version < 7000 || m_version >= 8000) {
+    ERROR("FbxBinaryReader", "init", "Unsupported FBX version " << m_version);
+    return E_FAIL;
+  }
+
+  m_begin = data;
+  m_end = data + size;
+
+  const char* cursor = data + kFbxHeaderSize;
+  while (cursor < m_end) {
+    Node node;
+    bool isNull = false;
+    if (!parseNode(cursor, node, isNull, 0)) {
+      ERROR("FbxBinaryReader", "init", "Malformed node record at offset " << (cursor - m_begin));
+      destroy();
+      return E_FAIL;
+    }
+    if (isNull) {
+      break;
+    }
+    m_root.children.push_back(std::move(node));
+  }
+
+  readGlobalSettings();
+  return S_OK;
+}
+
+HRESULT
+FbxBinaryReader::buildMeshes(std::vector<MeshComponent>& meshes) const {
+  const Node* objects = m_root.findChild("Objects");
+  if (!objects) {
+    ERROR("FbxBinaryReader", "buildMeshes", "Missing Objects node");
+    return E_FAIL;
+  }
+
+  // Nombres de los modelos, para nombrar cada malla como su nodo (igual que el SDK).
+  std::unordered_map<int64_t, std::string> modelNames;
+  for (const Node& object : objects->children) {
+    int64_t id = 0;
+    std::string name;
+    if (object.name == "Model" && object.properties.size() >= 2 &&
+        readInt64(object.properties[0], id) && readString(object.properties[1], name)) {
+      modelNames[id] = stripClassName(name);
+    }
+  }
+
+  // Conexiones objeto-objeto: geometría (hija) -> modelo (padre).
+  std::unordered_map<int64_t, int64_t> geometryToModel;
+  if (const Node* connections = m_root.findChild("Connections")) {
+    for (const Node& link : connections->children) {
+      std::string kind;
+      int64_t child = 0, parent = 0;
+      if (link.name == "C" && link.properties.size() >= 3 &&
+          readString(link.properties[0], kind) && kind == "OO" &&
+          readInt64(link.properties[1], child) && readInt64(link.properties[2], parent) &&
+          modelNames.count(parent)) {
+        geometryToModel.emplace(child, parent);
+      }
+    }
+  }
+
+  std::vector<const Node*> geometries;
+  std::vector<std::string> names;
+  for (const Node& object : objects->children) {
+    std::string geometryClass;
+    if (object.name != "Geometry" || object.properties.size() < 3 ||
+        !readString(object.properties[2], geometryClass) || geometryClass != "Mesh") {
+      continue;
+    }
+
+    int64_t id = 0;
+    std::string name;
+    readInt64(object.properties[0], id);
+    readString(object.properties[1], name);
+    auto model = geometryToModel.find(id);
+    names.push_back(model != geometryToModel.end() ? modelNames[model->second] : stripClassName(name));
+    geometries.push_back(&object);
+  }
+
+  if (geometries.empty()) {
+    ERROR("FbxBinaryReader", "buildMeshes", "No mesh geometry found");
+    return E_FAIL;
+  }
+
+  if (!m_axisConversion.isValid()) {
+    ERROR("FbxBinaryReader", "buildMeshes", "Unsupported GlobalSettings axis system");
+    return E_FAIL;
+  }
+
+  // Cada geometría escribe en su propia ranura; el árbol solo se lee.
+  std::vector<MeshComponent> slots(geometries.size());
+  std::vector<HRESULT> results(geometries.size(), E_FAIL);
+  ThreadPool::getInstance().parallelFor(geometries.size(), [&](size_t i) {
+    results[i] = buildMesh(*geometries[i], names[i], m_axisConversion, slots[i]);
+  });
+
+  size_t built = 0;
+  for (size_t i = 0; i < slots.size(); ++i) {
+    if (FAILED(results[i])) {
+      ERROR("FbxBinaryReader", "buildMeshes", "Skipping invalid geometry " << names[i].c_str());
+      continue;
+    }
+    meshes.push_back(std::move(slots[i]));
+    ++built;
+  }
+
+  MESSAGE("FbxBinaryReader", "buildMeshes", ("FBX " + std::to_string(m_version) +
+    ": " + std::to_string(built) + " of " + std::to_string(geometries.size()) + " meshes").c_str());
+  return built > 0 ? S_OK : E_FAIL;
+}
+
+HRESULT
+FbxBinaryReader::load(const std::string& fileName, std::vector<MeshComponent>& meshes) {
+  MappedFile file;
+  HRESULT hr = file.init(fileName);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  hr = init(file.data(), file.size());
+  if (SUCCEEDED(hr)) {
+    hr = buildMeshes(meshes);
+  }
+
+  // El árbol apunta a la vista proyectada; no debe sobrevivirla.
+  destroy();
+  return hr;
+}
+
+void
+FbxBinaryReader::destroy() {
+  m_root.children.clear();
+  m_begin = nullptr;
+  m_end = nullptr;
+  m_axisConversion = FbxAxisConversion();
+}
+
+void
+FbxBinaryReader::readGlobalSettings() {
+  m_axisConversion = FbxAxisConversion();
+  const Node* settings = m_root.findChild("GlobalSettings");
+  const Node* properties = settings ? settings->findChild("Properties70") : nullptr;
+  if (!properties) {
+    return;
+  }
+
+  // P: nombre, tipo, tipo de interfaz, flags, valor.
+  for (const Node& property : properties->children) {
+    std::string name;
+    if (property.name != "P" || property.properties.size() < 5 ||
+        !readString(property.properties[0], name)) {
+      continue;
+    }
+
+    const Property& value = property.properties[4];
+    int64_t integer = 0;
+    if (name == "UnitScaleFactor") {
+      readDouble(value, m_axisConversion.unitScaleFactor);
+      continue;
+    }
+    if (!readInt64(value, integer)) {
+      continue;
+    }
+    const int setting = static_cast<int>(integer);
+    if (name == "UpAxis") m_axisConversion.upAxis = setting;
+    else if (name == "UpAxisSign") m_axisConversion.upAxisSign = setting;
+    else if (name == "FrontAxis") m_axisConversion.frontAxis = setting;
+    else if (name == "FrontAxisSign") m_axisConversion.frontAxisSign = setting;
+    else if (name == "CoordAxis") m_axisConversion.coordAxis = setting;
+    else if (name == "CoordAxisSign") m_axisConversion.coordAxisSign = setting;
+  }
+}
+
+const FbxBinaryReader::Node*
+FbxBinaryReader::Node::findChild(const char* childName) const {
+  for (const Node& child : children) {
+    if (child.name == childName) {
+      return &child;
+    }
+  }
+  return nullptr;
+}
+
+bool
+FbxBinaryReader::parseNode(const char*& cursor, Node& node, bool& isNull, int depth) {
+  if (depth > kMaxNodeDepth) {
+    return false;
+  }
+
+  // A partir de la 7.5 los campos del registro son de 64 bits.
+  const bool wide = m_version >= 7500;
+  const size_t recordSize = wide ? 25 : 13;
+  if (static_cast<size_t>(m_end - cursor) < recordSize) {
+    return false;
+  }
+
+  uint64_t endOffset, propertyCount, propertyListSize;
+  if (wide) {
+    endOffset = readScalar<uint64_t>(cursor);
+    propertyCount = readScalar<uint64_t>(cursor + 8);
+    propertyListSize = readScalar<uint64_t>(cursor + 16);
+  }
+  else {
+    endOffset = readScalar<uint32_t>(cursor);
+    propertyCount = readScalar<uint32_t>(cursor + 4);
+    propertyListSize = readScalar<uint32_t>(cursor + 8);
+  }
+  const uint8_t nameLength = static_cast<uint8_t>(cursor[recordSize - 1]);
+  cursor += recordSize;
+
+  isNull = endOffset == 0;
+  if (isNull) {
+    return true;
+  }
+
+  const char* nodeEnd = m_begin + endOffset;
+  if (endOffset > static_cast<uint64_t>(m_end - m_begin) || nodeEnd < cursor + nameLength) {
+    return false;
+  }
+
+  node.name.assign(cursor, nameLength);
+  cursor += nameLength;
+
+  // Cada propiedad ocupa al menos un byte (su código de tipo).
+  if (propertyListSize > static_cast<uint64_t>(nodeEnd - cursor) || propertyCount > propertyListSize) {
+    return false;
+  }
+  const char* propertiesEnd = cursor + propertyListSize;
+  node.properties.resize(static_cast<size_t>(propertyCount));
+  for (Property& property : node.properties) {
+    if (!parseProperty(cursor, propertiesEnd, property)) {
+      return false;
+    }
+  }
+  cursor = propertiesEnd;
+
+  while (cursor < nodeEnd) {
+    Node child;
+    bool childIsNull = false;
+    if (!parseNode(cursor, child, childIsNull, depth + 1) || cursor > nodeEnd) {
+      return false;
+    }
+    if (childIsNull) {
+      break;
+    }
+    node.children.push_back(std::move(child));
+  }
+  cursor = nodeEnd;
+  return true;
+}
+
+bool
+FbxBinaryReader::parseProperty(const char*& cursor, const char* end, Property& property) {
+  if (cursor >= end) {
+    return false;
+  }
+  property.type = *cursor++;
+  const size_t available = static_cast<size_t>(end - cursor);
+
+  size_t scalarSize = 0;
+  switch (property.type) {
+  case 'C': scalarSize = 1; break;
+  case 'Y': scalarSize = 2; break;
+  case 'I': case 'F': scalarSize = 4; break;
+  case 'D': case 'L': scalarSize = 8; break;
+  case 'S': case 'R': {
+    if (available < 4) {
+      return false;
+    }
+    property.size = readScalar<uint32_t>(cursor);
+    if (property.size > available - 4) {
+      return false;
+    }
+    property.data = cursor + 4;
+    cursor += 4 + property.size;
+    return true;
+  }
+  case 'f': case 'd': case 'l': case 'i': case 'b': {
+    if (available < 12) {
+      return false;
+    }
+    property.arrayLength = readScalar<uint32_t>(cursor);
+    property.encoding = readScalar<uint32_t>(cursor + 4);
+    property.size = readScalar<uint32_t>(cursor + 8);
+    if (property.size > available - 12) {
+      return false;
+    }
+    property.data = cursor + 12;
+    cursor += 12 + property.size;
+    return true;
+  }
+  default:
+    return false;
+  }
+
+  if (available < scalarSize) {
+    return false;
+  }
+  property.data = cursor;
+  property.size = static_cast<uint32_t>(scalarSize);
+  cursor += scalarSize;
+  return true;
+}
+
+bool
+FbxBinaryReader::readString(const Property& property, std::string& out) {
+  if (property.type != 'S') {
+    return false;
+  }
+  out.assign(property.data, property.size);
+  return true;
+}
+
+bool
+FbxBinaryReader::readInt64(const Property& property, int64_t& out) {
+  switch (property.type) {
+  case 'L': out = readScalar<int64_t>(property.data); return true;
+  case 'I': out = readScalar<int32_t>(property.data); return true;
+  default: return false;
+  }
+}
+
+bool
+FbxBinaryReader::readDouble(const Property& property, double& out) {
+  switch (property.type) {
+  case 'D': out = readScalar<double>(property.data); return true;
+  case 'F': out = readScalar<float>(property.data); return true;
+  default: return false;
+  }
+}
+
+template<typename T>
+bool
+FbxBinaryReader::readArray(const Property& property, std::vector<T>& out) {
+  size_t elementSize = 0;
+  switch (property.type) {
+  case 'b': elementSize = 1; break;
+  case 'i': case 'f': elementSize = 4; break;
+  case 'l': case 'd': elementSize = 8; break;
+  default: return false;
+  }
+
+  const size_t rawSize = static_cast<size_t>(property.arrayLength) * elementSize;
+  const uint8_t* raw = reinterpret_cast<const uint8_t*>(property.data);
+  std::vector<uint8_t> inflated;
+  if (property.encoding == 1) {
+    if (FAILED(Inflater::inflateZlib(property.data, property.size, inflated, rawSize)) ||
+        inflated.size() != rawSize) {
+      return false;
+    }
+    raw = inflated.data();
+  }
+  else if (property.encoding != 0 || property.size != rawSize) {
+    return false;
+  }
+
+  const size_t count = property.arrayLength;
+  switch (property.type) {
+  case 'b': convertArray<uint8_t>(raw, count, out); break;
+  case 'i': convertArray<int32_t>(raw, count, out); break;
+  case 'f': convertArray<float>(raw, count, out); break;
+  case 'l': convertArray<int64_t>(raw, count, out); break;
+  case 'd': convertArray<double>(raw, count, out); break;
+  }
+  return true;
+}
+
+HRESULT
+FbxBinaryReader::buildMesh(const Node& geometry,
+                           const std::string& name,
+                           const FbxAxisConversion& conversion,
+                           MeshComponent& mesh) {
+  const Node* verticesNode = geometry.findChild("Vertices");
+  const Node* polygonsNode = geometry.findChild("PolygonVertexIndex");
+  std::vector<double> positions;
+  std::vector<int32_t> polygonVertices;
+  if (!verticesNode || verticesNode->properties.empty() ||
+      !polygonsNode || polygonsNode->properties.empty() ||
+      !readArray(verticesNode->properties[0], positions) ||
+      !readArray(polygonsNode->properties[0], polygonVertices)) {
+    return E_FAIL;
+  }
+  const size_t controlPointCount = positions.size() / 3;
+
+  // Primer canal de UV: se prefiere el de índice 0.
+  const Node* uvLayer = nullptr;
+  for (const Node& child : geometry.children) {
+    int64_t layerIndex = 0;
+    if (child.name == "LayerElementUV" &&
+        (!uvLayer || (!child.properties.empty() && readInt64(child.properties[0], layerIndex) && layerIndex == 0))) {
+      uvLayer = &child;
+    }
+  }
+
+  enum class UVMapping { None, ByPolygonVertex, ByControlPoint, ByPolygon, AllSame };
+  UVMapping uvMapping = UVMapping::None;
+  std::vector<double> uvs;
+  std::vector<int32_t> uvIndices;
+  if (uvLayer) {
+    const Node* mappingNode = uvLayer->findChild("MappingInformationType");
+    const Node* referenceNode = uvLayer->findChild("ReferenceInformationType");
+    const Node* uvNode = uvLayer->findChild("UV");
+    const Node* uvIndexNode = uvLayer->findChild("UVIndex");
+    std::string mapping, reference;
+    if (mappingNode && !mappingNode->properties.empty() && readString(mappingNode->properties[0], mapping) &&
+        uvNode && !uvNode->properties.empty() && readArray(uvNode->properties[0], uvs)) {
+      if (mapping == "ByPolygonVertex") uvMapping = UVMapping::ByPolygonVertex;
+      else if (mapping == "ByVertice" || mapping == "ByVertex" || mapping == "ByControlPoint") uvMapping = UVMapping::ByControlPoint;
+      else if (mapping == "ByPolygon") uvMapping = UVMapping::ByPolygon;
+      else if (mapping == "AllSame") uvMapping = UVMapping::AllSame;
+    }
+    if (referenceNode && !referenceNode->properties.empty() && readString(referenceNode->properties[0], reference) &&
+        reference != "Direct") {
+      if (!uvIndexNode || uvIndexNode->properties.empty() || !readArray(uvIndexNode->properties[0], uvIndices)) {
+        uvMapping = UVMapping::None;
+      }
+    }
+  }
+
+  auto readUV = [&](size_t controlPoint, size_t polygonVertex, size_t polygon) -> XMFLOAT2 {
+    size_t index;
+    switch (uvMapping) {
+    case UVMapping::ByPolygonVertex: index = polygonVertex; break;
+    case UVMapping::ByControlPoint: index = controlPoint; break;
+    case UVMapping::ByPolygon: index = polygon; break;
+    case UVMapping::AllSame: index = 0; break;
+    default: return XMFLOAT2(0.0f, 0.0f);
+    }
+    if (!uvIndices.empty()) {
+      if (index >= uvIndices.size() || uvIndices[index] < 0) {
+        return XMFLOAT2(0.0f, 0.0f);
+      }
+      index = static_cast<size_t>(uvIndices[index]);
+    }
+    if (index * 2 + 1 >= uvs.size()) {
+      return XMFLOAT2(0.0f, 0.0f);
+    }
+    // V invertida para DirectX, igual que la ruta del SDK.
+    return XMFLOAT2(static_cast<float>(uvs[index * 2]), 1.0f - static_cast<float>(uvs[index * 2 + 1]));
+  };
+
+  std::vector<SimpleVertex> vertices;
+  std::vector<unsigned int> indices;
+  vertices.reserve(controlPointCount);
+  indices.reserve(polygonVertices.size());
+
+  std::unordered_map<SimpleVertex, unsigned int, SimpleVertexHash, SimpleVertexEqual> weldMap;
+  weldMap.reserve(controlPointCount);
+  std::vector<unsigned int> cornerIdx;
+  size_t polygon = 0;
+
+  for (size_t pv = 0; pv < polygonVertices.size(); ++pv) {
+    // Un índice negativo (~índice) cierra el polígono.
+    const int32_t raw = polygonVertices[pv];
+    const bool lastCorner = raw < 0;
+    const size_t controlPoint = static_cast<size_t>(lastCorner ? ~raw : raw);
+    if (controlPoint >= controlPointCount) {
+      return E_FAIL;
+    }
+
+    SimpleVertex out{};
+    out.Pos = XMFLOAT3(static_cast<float>(positions[controlPoint * 3]),
+                       static_cast<float>(positions[controlPoint * 3 + 1]),
+                       static_cast<float>(positions[controlPoint * 3 + 2]));
+    out.Tex = readUV(controlPoint, pv, polygon);
+
+    auto welded = weldMap.emplace(out, static_cast<unsigned int>(vertices.size()));
+    if (welded.second) {
+      vertices.push_back(out);
+    }
+    cornerIdx.push_back(welded.first->second);
+
+    if (lastCorner) {
+      // Abanico con el mismo winding final que la ruta del SDK (que invierte siempre).
+      for (size_t k = 1; k + 1 < cornerIdx.size(); ++k) {
+        indices.push_back(cornerIdx[0]);
+        indices.push_back(cornerIdx[k]);
+        indices.push_back(cornerIdx[k + 1]);
+      }
+      cornerIdx.clear();
+      ++polygon;
+    }
+  }
+
+  if (indices.empty()) {
+    return E_FAIL;
+  }
+
+  // Después de soldar: la conversión no cambia qué esquinas son iguales.
+  conversion.apply(vertices, indices);
+
+  mesh.m_name = name;
+  mesh.m_vertex = std::move(vertices);
+  mesh.m_index = std::move(indices);
+  mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+  mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+  return S_OK;
+}
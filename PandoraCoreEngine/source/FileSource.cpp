@@ -0,0 +1,234 @@
+#include "FileSource.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+
+namespace {
+  const char kPackMagic[4] = { 'P', 'C', 'P', 'K' };
+
+  struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+  };
+
+  /**
+   * @brief Entrada de la tabla; le sigue la ruta (@c pathLength bytes).
+   */
+  struct PackEntry {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t pathLength;
+    uint32_t reserved;
+  };
+
+  static_assert(sizeof(PackHeader) == 16, "PackHeader layout changed");
+  static_assert(sizeof(PackEntry) == 24, "PackEntry layout changed");
+}
+
+std::string
+FileSource::normalizePath(const std::string& path) {
+  std::string result;
+  result.reserve(path.size());
+  for (char c : path) {
+    const char normalized = (c == '\\') ? '/' : c;
+    if (normalized == '/' && !result.empty() && result.back() == '/') {
+      continue;
+    }
+    result.push_back(normalized);
+  }
+  while (result.compare(0, 2, "./") == 0) {
+    result.erase(0, 2);
+  }
+  return result;
+}
+
+std::string
+LooseFileSource::resolve(const std::string& path) const {
+  return m_root.empty() ? path : (std::filesystem::path(m_root) / path).string();
+}
+
+HRESULT
+LooseFileSource::open(const std::string& path, FileSpan& span) const {
+  const std::string diskPath = resolve(path);
+  std::error_code ec;
+  if (!std::filesystem::is_regular_file(diskPath, ec)) {
+    return E_FAIL;
+  }
+
+  std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>();
+  HRESULT hr = mapping->init(diskPath);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  span.data = reinterpret_cast<const uint8_t*>(mapping->data());
+  span.size = mapping->size();
+  span.path = path;
+  span.mapping = std::move(mapping);
+  return S_OK;
+}
+
+bool
+LooseFileSource::exists(const std::string& path) const {
+  std::error_code ec;
+  return std::filesystem::is_regular_file(resolve(path), ec);
+}
+
+HRESULT
+PackFileSource::init(const std::string& archivePath) {
+  m_entries.clear();
+  m_mapping.reset();
+  m_archivePath = archivePath;
+
+  std::error_code ec;
+  if (!std::filesystem::is_regular_file(archivePath, ec)) {
+    return E_FAIL;
+  }
+  std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>();
+  if (FAILED(mapping->init(archivePath)) || mapping->size() < sizeof(PackHeader)) {
+    ERROR("PackFileSource", "init", ("Not a pack file: " + archivePath).c_str());
+    return E_FAIL;
+  }
+
+  PackHeader header;
+  std::memcpy(&header, mapping->data(), sizeof(header));
+  if (std::memcmp(header.magic, kPackMagic, sizeof(kPackMagic)) != 0 || header.version != kVersion) {
+    ERROR("PackFileSource", "init", ("Pack format mismatch: " + archivePath).c_str());
+    return E_FAIL;
+  }
+
+  std::unordered_map<std::string, Entry> entries;
+  entries.reserve(header.entryCount);
+  size_t offset = sizeof(header);
+  for (uint32_t i = 0; i < header.entryCount; ++i) {
+    PackEntry stored;
+    if (mapping->size() < offset + sizeof(stored)) {
+      ERROR("PackFileSource", "init", ("Truncated pack table: " + archivePath).c_str());
+      return E_FAIL;
+    }
+    std::memcpy(&stored, mapping->data() + offset, sizeof(stored));
+    offset += sizeof(stored);
+    if (mapping->size() < offset + stored.pathLength ||
+        stored.offset > mapping->size() || stored.size > mapping->size() - stored.offset) {
+      ERROR("PackFileSource", "init", ("Invalid pack entry: " + archivePath).c_str());
+      return E_FAIL;
+    }
+    entries[std::string(mapping->data() + offset, stored.pathLength)] = { stored.offset, stored.size };
+    offset += stored.pathLength;
+  }
+
+  m_entries = std::move(entries);
+  m_mapping = std::move(mapping);
+  MESSAGE("PackFileSource", "init", (std::to_string(m_entries.size()) + " files in " + archivePath).c_str());
+  return S_OK;
+}
+
+HRESULT
+PackFileSource::open(const std::string& path, FileSpan& span) const {
+  auto it = m_entries.find(path);
+  if (it == m_entries.end()) {
+    return E_FAIL;
+  }
+  span.data = reinterpret_cast<const uint8_t*>(m_mapping->data()) + it->second.offset;
+  span.size = static_cast<size_t>(it->second.size);
+  span.path = path;
+  span.mapping = m_mapping;
+  return S_OK;
+}
+
+bool
+PackFileSource::exists(const std::string& path) const {
+  return m_entries.find(path) != m_entries.end();
+}
+
+HRESULT
+PackFileSource::write(const std::string& archivePath, const std::vector<std::string>& paths) {
+  std::vector<std::string> names;
+  std::vector<MappedFile> files(paths.size());
+  names.reserve(paths.size());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    if (FAILED(files[i].init(paths[i]))) {
+      ERROR("PackFileSource", "write", ("Failed to read " + paths[i]).c_str());
+      return E_FAIL;
+    }
+    names.push_back(normalizePath(paths[i]));
+  }
+
+  // Tabla primero: el contenido empieza tras ella, alineado.
+  uint64_t offset = sizeof(PackHeader);
+  for (const std::string& name : names) {
+    offset += sizeof(PackEntry) + name.size();
+  }
+  std::vector<PackEntry> entries(paths.size());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    offset = (offset + kAlignment - 1) / kAlignment * kAlignment;
+    entries[i] = { offset, files[i].size(), static_cast<uint32_t>(names[i].size()), 0 };
+    offset += files[i].size();
+  }
+
+  std::error_code ec;
+  const std::filesystem::path parent = std::filesystem::path(archivePath).parent_path();
+  if (!parent.empty()) {
+    std::filesystem::create_directories(parent, ec);
+  }
+  const std::string tempPath = archivePath + ".tmp";
+  {
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      ERROR("PackFileSource", "write", ("Failed to create pack file: " + tempPath).c_str());
+      return E_FAIL;
+    }
+
+    PackHeader header = {};
+    std::memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+    header.version = kVersion;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (size_t i = 0; i < entries.size(); ++i) {
+      out.write(reinterpret_cast<const char*>(&entries[i]), sizeof(PackEntry));
+      out.write(names[i].data(), names[i].size());
+    }
+    const char zeros[kAlignment] = {};
+    for (size_t i = 0; i < entries.size(); ++i) {
+      out.write(zeros, static_cast<std::streamsize>(entries[i].offset - static_cast<uint64_t>(out.tellp())));
+      out.write(files[i].data(), files[i].size());
+    }
+    if (!out) {
+      ERROR("PackFileSource", "write", ("Failed to write pack file: " + tempPath).c_str());
+      return E_FAIL;
+    }
+  }
+
+  std::filesystem::rename(tempPath, archivePath, ec);
+  if (ec) {
+    ERROR("PackFileSource", "write", ("Failed to replace pack file: " + archivePath).c_str());
+    std::filesystem::remove(tempPath, ec);
+    return E_FAIL;
+  }
+  MESSAGE("PackFileSource", "write", (std::to_string(entries.size()) + " files packed into " +
+    archivePath).c_str());
+  return S_OK;
+}
+
+HRESULT
+PackFileSource::writeDirectories(const std::string& archivePath, const std::vector<std::string>& directories) {
+  std::vector<std::string> paths;
+  for (const std::string& directory : directories) {
+    std::error_code ec;
+    for (std::filesystem::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+      if (it->is_regular_file(ec)) {
+        paths.push_back(it->path().generic_string());
+      }
+    }
+    if (ec) {
+      ERROR("PackFileSource", "writeDirectories", ("Failed to list " + directory).c_str());
+      return E_FAIL;
+    }
+  }
+  // Orden estable: el mismo directorio produce el mismo paquete.
+  std::sort(paths.begin(), paths.end());
+  return write(archivePath, paths);
+}
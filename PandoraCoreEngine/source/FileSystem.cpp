@@ -0,0 +1,73 @@
+﻿#include "FileSystem.h"
+#include <filesystem>
+#include <mutex>
+
+namespace {
+  std::mutex g_sourcesMutex;                           ///< Protege la lista de orígenes.
+  std::vector<std::shared_ptr<FileSource>> g_sources;  ///< Orígenes montados, por prioridad creciente.
+  const LooseFileSource g_looseFiles;                  ///< Respaldo: directorio de trabajo.
+
+  /**
+   * @brief Copia de los orígenes montados, para no retener el mutex al proyectar.
+   */
+  std::vector<std::shared_ptr<FileSource>>
+    getSources() {
+    std::lock_guard<std::mutex> lock(g_sourcesMutex);
+    return g_sources;
+  }
+}
+
+void
+FileSystem::mount(std::shared_ptr<FileSource> source) {
+  if (!source) {
+    ERROR("FileSystem", "mount", "Source is null.");
+    return;
+  }
+  MESSAGE("FileSystem", "mount", ("Mounted " + source->getName()).c_str());
+  std::lock_guard<std::mutex> lock(g_sourcesMutex);
+  g_sources.push_back(std::move(source));
+}
+
+HRESULT
+FileSystem::mountPack(const std::string& archivePath) {
+  std::shared_ptr<PackFileSource> pack = std::make_shared<PackFileSource>();
+  std::error_code ec;
+  if (!std::filesystem::exists(archivePath, ec)) {
+    return S_FALSE;
+  }
+  HRESULT hr = pack->init(archivePath);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  mount(pack);
+  return S_OK;
+}
+
+void
+FileSystem::unmountAll() {
+  std::lock_guard<std::mutex> lock(g_sourcesMutex);
+  g_sources.clear();
+}
+
+HRESULT
+FileSystem::open(const std::string& path, FileSpan& span) {
+  const std::string normalized = FileSource::normalizePath(path);
+  const std::vector<std::shared_ptr<FileSource>> sources = getSources();
+  for (auto it = sources.rbegin(); it != sources.rend(); ++it) {
+    if (SUCCEEDED((*it)->open(normalized, span))) {
+      return S_OK;
+    }
+  }
+  return g_looseFiles.open(normalized, span);
+}
+
+bool
+FileSystem::exists(const std::string& path) {
+  const std::string normalized = FileSource::normalizePath(path);
+  for (const std::shared_ptr<FileSource>& source : getSources()) {
+    if (source->exists(normalized)) {
+      return true;
+    }
+  }
+  return g_looseFiles.exists(normalized);
+}
@@ -0,0 +1,187 @@
+﻿#include "FrustumCuller.h"
+#include <emmintrin.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  /**
+   * @brief Prueba cuatro esferas contra los seis planos; bit i = esfera i visible.
+   */
+  inline int
+  testSpheres4(const XMFLOAT4* planes,
+               const float* centerX,
+               const float* centerY,
+               const float* centerZ,
+               const float* radius) {
+    const __m128 cx = _mm_loadu_ps(centerX);
+    const __m128 cy = _mm_loadu_ps(centerY);
+    const __m128 cz = _mm_loadu_ps(centerZ);
+    const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius));
+
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < 6; ++p) {
+      __m128 distance = _mm_mul_ps(cx, _mm_set1_ps(planes[p].x));
+      distance = _mm_add_ps(distance, _mm_mul_ps(cy, _mm_set1_ps(planes[p].y)));
+      distance = _mm_add_ps(distance, _mm_mul_ps(cz, _mm_set1_ps(planes[p].z)));
+      distance = _mm_add_ps(distance, _mm_set1_ps(planes[p].w));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+    }
+    return _mm_movemask_ps(inside);
+  }
+}
+
+void
+FrustumCuller::setViewProjection(const XMMATRIX& viewProjection) {
+  XMFLOAT4X4 m;
+  XMStoreFloat4x4(&m, viewProjection);
+
+  // Columnas de la matriz: clip = (x, y, z, 1) * M.
+  const XMFLOAT4 c1(m._11, m._21, m._31, m._41);
+  const XMFLOAT4 c2(m._12, m._22, m._32, m._42);
+  const XMFLOAT4 c3(m._13, m._23, m._33, m._43);
+  const XMFLOAT4 c4(m._14, m._24, m._34, m._44);
+
+  m_planes[0] = XMFLOAT4(c4.x + c1.x, c4.y + c1.y, c4.z + c1.z, c4.w + c1.w); // Izquierdo
+  m_planes[1] = XMFLOAT4(c4.x - c1.x, c4.y - c1.y, c4.z - c1.z, c4.w - c1.w); // Derecho
+  m_planes[2] = XMFLOAT4(c4.x + c2.x, c4.y + c2.y, c4.z + c2.z, c4.w + c2.w); // Inferior
+  m_planes[3] = XMFLOAT4(c4.x - c2.x, c4.y - c2.y, c4.z - c2.z, c4.w - c2.w); // Superior
+  m_planes[4] = c3;                                                           // Cercano
+  m_planes[5] = XMFLOAT4(c4.x - c3.x, c4.y - c3.y, c4.z - c3.z, c4.w - c3.w); // Lejano
+
+  for (XMFLOAT4& plane : m_planes) {
+    const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+    if (length > 0.0f) {
+      const float inv = 1.0f / length;
+      plane.x *= inv;
+      plane.y *= inv;
+      plane.z *= inv;
+      plane.w *= inv;
+    }
+  }
+}
+
+void
+FrustumCuller::clear() {
+  m_centerX.clear();
+  m_centerY.clear();
+  m_centerZ.clear();
+  m_radius.clear();
+  m_aabbCenter.clear();
+  m_aabbExtent.clear();
+}
+
+void
+FrustumCuller::reserve(size_t count) {
+  m_centerX.reserve(count);
+  m_centerY.reserve(count);
+  m_centerZ.reserve(count);
+  m_radius.reserve(count);
+  m_aabbCenter.reserve(count);
+  m_aabbExtent.reserve(count);
+}
+
+uint32_t
+FrustumCuller::add(const BoundingVolume& volume) {
+  const uint32_t index = static_cast<uint32_t>(m_radius.size());
+  m_centerX.push_back(volume.center.x);
+  m_centerY.push_back(volume.center.y);
+  m_centerZ.push_back(volume.center.z);
+  m_radius.push_back(volume.radius);
+  m_aabbCenter.push_back(XMFLOAT3((volume.aabbMin.x + volume.aabbMax.x) * 0.5f,
+                                  (volume.aabbMin.y + volume.aabbMax.y) * 0.5f,
+                                  (volume.aabbMin.z + volume.aabbMax.z) * 0.5f));
+  m_aabbExtent.push_back(XMFLOAT3((volume.aabbMax.x - volume.aabbMin.x) * 0.5f,
+                                  (volume.aabbMax.y - volume.aabbMin.y) * 0.5f,
+                                  (volume.aabbMax.z - volume.aabbMin.z) * 0.5f));
+  return index;
+}
+
+bool
+FrustumCuller::testAabb(size_t index) const {
+  const XMFLOAT3& c = m_aabbCenter[index];
+  const XMFLOAT3& e = m_aabbExtent[index];
+  for (const XMFLOAT4& plane : m_planes) {
+    const float distance = plane.x * c.x + plane.y * c.y + plane.z * c.z + plane.w;
+    const float reach = std::fabs(plane.x) * e.x + std::fabs(plane.y) * e.y + std::fabs(plane.z) * e.z;
+    if (distance + reach < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t
+FrustumCuller::cull(std::vector<uint32_t>& visible) {
+  visible.clear();
+  const size_t count = m_radius.size();
+
+  // Las esferas que pasan se confirman con su caja.
+  auto emit = [&](size_t base, int mask) {
+    for (size_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+      if ((mask & 1) && testAabb(base + lane)) {
+        visible.push_back(static_cast<uint32_t>(base + lane));
+      }
+    }
+  };
+
+  size_t base = 0;
+  for (; base + 4 <= count; base += 4) {
+    const int mask = testSpheres4(m_planes, &m_centerX[base], &m_centerY[base],
+                                  &m_centerZ[base], &m_radius[base]);
+    emit(base, mask);
+  }
+
+  // Cola de menos de cuatro volúmenes: se copia a un bloque local.
+  if (base < count) {
+    float x[4] = {}, y[4] = {}, z[4] = {}, r[4] = {};
+    const size_t remaining = count - base;
+    for (size_t i = 0; i < remaining; ++i) {
+      x[i] = m_centerX[base + i];
+      y[i] = m_centerY[base + i];
+      z[i] = m_centerZ[base + i];
+      r[i] = m_radius[base + i];
+    }
+    const int mask = testSpheres4(m_planes, x, y, z, r) & ((1 << remaining) - 1);
+    emit(base, mask);
+  }
+
+  m_stats.tested = static_cast<uint32_t>(count);
+  m_stats.visible = static_cast<uint32_t>(visible.size());
+  m_stats.culled = m_stats.tested - m_stats.visible;
+  return visible.size();
+}
+
+BoundingVolume
+FrustumCuller::transformBounds(const XMFLOAT3& localMin,
+                               const XMFLOAT3& localMax,
+                               float localRadius,
+                               const XMMATRIX& world) {
+  XMFLOAT4X4 m;
+  XMStoreFloat4x4(&m, world);
+
+  const XMFLOAT3 c((localMin.x + localMax.x) * 0.5f,
+                   (localMin.y + localMax.y) * 0.5f,
+                   (localMin.z + localMax.z) * 0.5f);
+  const XMFLOAT3 e((localMax.x - localMin.x) * 0.5f,
+                   (localMax.y - localMin.y) * 0.5f,
+                   (localMax.z - localMin.z) * 0.5f);
+
+  BoundingVolume out;
+  out.center = XMFLOAT3(c.x * m._11 + c.y * m._21 + c.z * m._31 + m._41,
+                        c.x * m._12 + c.y * m._22 + c.z * m._32 + m._42,
+                        c.x * m._13 + c.y * m._23 + c.z * m._33 + m._43);
+
+  const XMFLOAT3 extent(
+    e.x * std::fabs(m._11) + e.y * std::fabs(m._21) + e.z * std::fabs(m._31),
+    e.x * std::fabs(m._12) + e.y * std::fabs(m._22) + e.z * std::fabs(m._32),
+    e.x * std::fabs(m._13) + e.y * std::fabs(m._23) + e.z * std::fabs(m._33));
+  out.aabbMin = XMFLOAT3(out.center.x - extent.x, out.center.y - extent.y, out.center.z - extent.z);
+  out.aabbMax = XMFLOAT3(out.center.x + extent.x, out.center.y + extent.y, out.center.z + extent.z);
+
+  const float scale = (std::max)((std::max)(
+    std::sqrt(m._11 * m._11 + m._12 * m._12 + m._13 * m._13),
+    std::sqrt(m._21 * m._21 + m._22 * m._22 + m._23 * m._23)),
+    std::sqrt(m._31 * m._31 + m._32 * m._32 + m._33 * m._33));
+  out.radius = localRadius * scale;
+  return out;
+}
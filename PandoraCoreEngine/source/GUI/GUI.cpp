@@ -5,6 +5,10 @@
 #include "DeviceContext.h"
 #include "MeshComponent.h"
 #include "ECS\Actor.h"
+#include "FrustumCuller.h"
+#include "TextureStreamer.h"
+#include "ConstantBufferUploader.h"
+#include "GeometryPool.h"
 //#include "imgui_internal.h"
 static ImGuizmo::OPERATION mCurrentGizmoOperation(ImGuizmo::TRANSLATE);
 void 
@@ -418,6 +422,92 @@ GUI::outliner(const std::vector<EU::TSharedPointer<Actor>>& actors) {
 	ImGui::End();
 }
 
+void
+GUI::renderStats(const CullingStats& cullingStats, const CullingStats& meshletStats) {
+	ImGui::Begin("Stats");
+	ImGui::Text("FPS: %.1f (%.2f ms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	ImGui::Separator();
+	ImGui::Text("Frustum culling");
+	ImGui::Text("Mallas evaluadas: %u", cullingStats.tested);
+	ImGui::Text("Visibles: %u", cullingStats.visible);
+	ImGui::Text("Descartadas: %u", cullingStats.culled);
+	ImGui::Separator();
+	ImGui::Text("Meshlets (frustum y cono de normales)");
+	ImGui::Text("Evaluados: %u", meshletStats.tested);
+	ImGui::Text("Visibles: %u", meshletStats.visible);
+	ImGui::Text("Descartados: %u", meshletStats.culled);
+	ImGui::Separator();
+	const ConstantBufferUploaderStats& constants = ConstantBufferUploader::getInstance().getStats();
+	ImGui::Text("Constantes por draw (frame anterior)");
+	ImGui::Text("Escrituras: %u (%.1f KiB)", constants.writes, constants.bytes / 1024.0f);
+	ImGui::Separator();
+	const float kMiB = 1024.0f * 1024.0f;
+	const GeometryPoolStats& geometry = GeometryPool::getInstance().getStats();
+	ImGui::Text("Geometría compartida");
+	ImGui::Text("Mallas: %u en %u páginas", geometry.meshes, geometry.pages);
+	ImGui::Text("Vértices: %.1f / %.1f MiB", geometry.vertexUsedBytes / kMiB, geometry.vertexCapacityBytes / kMiB);
+	ImGui::Text("Índices: %.1f / %.1f MiB", geometry.indexUsedBytes / kMiB, geometry.indexCapacityBytes / kMiB);
+	ImGui::Text("Fragmentación: %.0f%% (%u huecos)", geometry.fragmentation * 100.0f, geometry.freeRanges);
+	ImGui::Text("Draws: %u, enlaces IA: %u", geometry.draws, geometry.binds);
+	if (ImGui::Button("Desfragmentar")) {
+		GeometryPool::getInstance().defragment();
+	}
+	ImGui::Text("Compactaciones: %u", geometry.defragmentations);
+	ImGui::End();
+}
+
+void
+GUI::textureStreaming(TextureStreamer& streamer) {
+	const float kMiB = 1024.0f * 1024.0f;
+	const TextureStreamingStats& stats = streamer.getStats();
+
+	ImGui::Begin("Texture Streaming");
+	int budgetMiB = static_cast<int>(streamer.getBudget() / (1024 * 1024));
+	if (ImGui::SliderInt("Presupuesto (MiB)", &budgetMiB, 1, 2048)) {
+		streamer.setBudget(static_cast<uint64_t>(budgetMiB) * 1024 * 1024);
+	}
+	char overlay[64];
+	snprintf(overlay, sizeof(overlay), "%.1f / %.1f MiB", stats.residentBytes / kMiB, stats.budgetBytes / kMiB);
+	ImGui::ProgressBar(stats.budgetBytes > 0 ? static_cast<float>(stats.residentBytes) / stats.budgetBytes : 0.0f,
+		ImVec2(-1.0f, 0.0f), overlay);
+	ImGui::Text("Pedido por la escena: %.1f MiB", stats.wantedBytes / kMiB);
+	ImGui::Text("Texturas: %u (cargando: %u)", stats.textures, stats.loading);
+	ImGui::Text("Este frame: %u subidas, %u descartes", stats.uploads, stats.drops);
+
+	if (ImGui::BeginTable("StreamedTextures", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+		ImGui::TableSetupColumn("Textura");
+		ImGui::TableSetupColumn("Residente");
+		ImGui::TableSetupColumn("Pedido");
+		ImGui::TableSetupColumn("MiB");
+		ImGui::TableHeadersRow();
+		for (const EU::TSharedPointer<StreamedTexture>& texture : streamer.getTextures()) {
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(texture->getName().c_str());
+			ImGui::TableNextColumn();
+			if (texture->hasFailed()) {
+				ImGui::TextUnformatted("error");
+			}
+			else if (!texture->isLoaded()) {
+				ImGui::TextUnformatted("cargando");
+			}
+			else {
+				const uint32_t resident = texture->getResidentMip();
+				ImGui::Text("mip %u (%ux%u)", resident, texture->getMipWidth(resident), texture->getMipHeight(resident));
+				ImGui::TableNextColumn();
+				const uint32_t wanted = texture->getWantedMip();
+				ImGui::Text("mip %u (%ux%u)%s", wanted, texture->getMipWidth(wanted), texture->getMipHeight(wanted),
+					texture->getTargetMip() > wanted ? " *" : "");
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", texture->getBytesFrom(resident) / kMiB);
+			}
+		}
+		ImGui::EndTable();
+	}
+	ImGui::TextDisabled("* recortado por el presupuesto");
+	ImGui::End();
+}
+
 void
 GUI::editTransform(const XMMATRIX& view, const XMMATRIX& projection, EU::TSharedPointer<Actor> actor)
 {
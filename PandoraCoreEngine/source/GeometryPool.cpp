@@ -0,0 +1,379 @@
+﻿#include "GeometryPool.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "MeshComponent.h"
+#include "ShaderProgram.h"
+#include <algorithm>
+
+namespace {
+  HRESULT
+  createPoolBuffer(Device& device, unsigned int bindFlag, uint64_t byteWidth, ID3D11Buffer** buffer) {
+    if (byteWidth == 0 || byteWidth > 0xFFFFFFFFull) {
+      return E_INVALIDARG;
+    }
+    D3D11_BUFFER_DESC desc = {};
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.ByteWidth = static_cast<unsigned int>(byteWidth);
+    desc.BindFlags = bindFlag;
+    return device.CreateBuffer(&desc, nullptr, buffer);
+  }
+
+  /**
+   * @brief Caja de un rango de @p count elementos de @p stride bytes a partir de @p first.
+   */
+  D3D11_BOX
+  elementBox(uint32_t first, uint32_t count, unsigned int stride) {
+    D3D11_BOX box = {};
+    box.left = first * stride;
+    box.right = (first + count) * stride;
+    box.bottom = 1;
+    box.back = 1;
+    return box;
+  }
+}
+
+GeometryPool&
+GeometryPool::getInstance() {
+  static GeometryPool instance;
+  return instance;
+}
+
+HRESULT
+GeometryPool::init(Device& device, DeviceContext& deviceContext) {
+  if (!device.m_device || !deviceContext.m_deviceContext) {
+    ERROR("GeometryPool", "init", "Device or DeviceContext is null.");
+    return E_POINTER;
+  }
+  destroy();
+  m_device = &device;
+  m_deviceContext = &deviceContext;
+  return S_OK;
+}
+
+void
+GeometryPool::update() {
+  updateStats();
+  m_stats.draws = m_draws;
+  m_stats.binds = m_binds;
+  m_draws = 0;
+  m_binds = 0;
+  // ImGui y otros enlazan sus propios buffers en IA durante el frame.
+  invalidateBindings();
+}
+
+HRESULT
+GeometryPool::add(const MeshComponent& mesh, GeometryHandle& handle) {
+  if (!m_device || !m_deviceContext) {
+    ERROR("GeometryPool", "add", "Pool is not initialized.");
+    return E_FAIL;
+  }
+  const bool compact = mesh.hasCompactVertices();
+  const unsigned int vertexStride = compact ? sizeof(CompactVertex) : sizeof(SimpleVertex);
+  const uint32_t vertexCount = static_cast<uint32_t>(compact ? mesh.m_compactVertex.size() : mesh.m_vertex.size());
+  const uint32_t indexCount = static_cast<uint32_t>(mesh.getIndexCount());
+  const DXGI_FORMAT indexFormat = mesh.m_indexFormat;
+  if (vertexCount == 0 || indexCount == 0) {
+    ERROR("GeometryPool", "add", ("Mesh has no geometry: " + mesh.m_name).c_str());
+    return E_INVALIDARG;
+  }
+
+  // 1) Un hueco en una página compatible; 2) compactar una con espacio total suficiente; 3) página nueva.
+  GeometryRange range;
+  bool placed = false;
+  for (uint32_t i = 0; i < m_pages.size() && !placed; ++i) {
+    const Page& page = m_pages[i];
+    if (page.vertexStride == vertexStride && page.indexFormat == indexFormat) {
+      placed = allocate(i, vertexCount, indexCount, range);
+    }
+  }
+  for (uint32_t i = 0; i < m_pages.size() && !placed; ++i) {
+    const Page& page = m_pages[i];
+    if (page.vertexStride == vertexStride && page.indexFormat == indexFormat &&
+        page.vertices.getFree() >= vertexCount && page.indices.getFree() >= indexCount &&
+        SUCCEEDED(defragmentPage(i))) {
+      placed = allocate(i, vertexCount, indexCount, range);
+    }
+  }
+  if (!placed) {
+    uint32_t pageIndex = 0;
+    HRESULT hr = createPage(vertexStride, indexFormat, vertexCount, indexCount, pageIndex);
+    if (FAILED(hr)) {
+      return hr;
+    }
+    placed = allocate(pageIndex, vertexCount, indexCount, range);
+  }
+  if (!placed) {
+    ERROR("GeometryPool", "add", ("Failed to place mesh: " + mesh.m_name).c_str());
+    return E_FAIL;
+  }
+
+  const Page& page = m_pages[range.page];
+  const D3D11_BOX vertexBox = elementBox(range.baseVertex, vertexCount, vertexStride);
+  const D3D11_BOX indexBox = elementBox(range.startIndex, indexCount, mesh.getIndexStride());
+  m_deviceContext->UpdateSubresource(page.vertexBuffer, 0, &vertexBox,
+    compact ? static_cast<const void*>(mesh.m_compactVertex.data()) : static_cast<const void*>(mesh.m_vertex.data()),
+    0, 0);
+  m_deviceContext->UpdateSubresource(page.indexBuffer, 0, &indexBox, mesh.getIndexData(), 0, 0);
+
+  if (!m_freeIds.empty()) {
+    handle.id = m_freeIds.back();
+    m_freeIds.pop_back();
+    m_ranges[handle.id - 1] = range;
+  }
+  else {
+    m_ranges.push_back(range);
+    handle.id = static_cast<uint32_t>(m_ranges.size());
+  }
+  updateStats();
+  return S_OK;
+}
+
+void
+GeometryPool::remove(GeometryHandle& handle) {
+  if (!getRange(handle)) {
+    handle = GeometryHandle();
+    return;
+  }
+  GeometryRange& range = m_ranges[handle.id - 1];
+  Page& page = m_pages[range.page];
+  page.vertices.release(range.baseVertex);
+  page.indices.release(range.startIndex);
+  range = GeometryRange();
+  m_freeIds.push_back(handle.id);
+  handle = GeometryHandle();
+  updateStats();
+}
+
+const GeometryRange*
+GeometryPool::getRange(GeometryHandle handle) const {
+  if (!handle.isValid() || handle.id > m_ranges.size() || m_ranges[handle.id - 1].vertexCount == 0) {
+    return nullptr;
+  }
+  return &m_ranges[handle.id - 1];
+}
+
+void
+GeometryPool::setShaderPrograms(ShaderProgram& standard, ShaderProgram& compact) {
+  m_standardProgram = &standard;
+  m_compactProgram = &compact;
+  m_boundFormat = BoundFormat::None;
+}
+
+bool
+GeometryPool::bindVertexFormat(DeviceContext& deviceContext, bool compact) {
+  const BoundFormat format = compact ? BoundFormat::Compact : BoundFormat::Simple;
+  if (m_boundFormat == format) {
+    return true;
+  }
+  ShaderProgram* program = compact ? m_compactProgram : m_standardProgram;
+  if (!program || !program->m_VertexShader || !program->m_inputLayout.m_inputLayout) {
+    return false;
+  }
+  program->m_inputLayout.render(deviceContext);
+  program->render(deviceContext, VERTEX_SHADER);
+  m_boundFormat = format;
+  return true;
+}
+
+void
+GeometryPool::render(DeviceContext& deviceContext,
+                     GeometryHandle handle,
+                     uint32_t indexStart,
+                     uint32_t indexCount) {
+  const GeometryRange* range = getRange(handle);
+  if (!range) {
+    ERROR("GeometryPool", "render", "Geometry handle is not registered.");
+    return;
+  }
+  if (m_boundPage != range->page) {
+    Page& page = m_pages[range->page];
+    const unsigned int offset = 0;
+    deviceContext.IASetVertexBuffers(0, 1, &page.vertexBuffer, &page.vertexStride, &offset);
+    deviceContext.IASetIndexBuffer(page.indexBuffer, page.indexFormat, 0);
+    m_boundPage = range->page;
+    ++m_binds;
+  }
+  deviceContext.DrawIndexed(indexCount, range->startIndex + indexStart, static_cast<int>(range->baseVertex));
+  ++m_draws;
+}
+
+uint32_t
+GeometryPool::defragment() {
+  uint32_t compacted = 0;
+  for (uint32_t i = 0; i < m_pages.size(); ++i) {
+    const Page& page = m_pages[i];
+    if (page.vertices.getStats().fragmentation() > kDefragmentThreshold ||
+        page.indices.getStats().fragmentation() > kDefragmentThreshold) {
+      if (SUCCEEDED(defragmentPage(i))) {
+        ++compacted;
+      }
+    }
+  }
+  if (compacted > 0) {
+    updateStats();
+  }
+  return compacted;
+}
+
+void
+GeometryPool::destroy() {
+  for (Page& page : m_pages) {
+    SAFE_RELEASE(page.vertexBuffer);
+    SAFE_RELEASE(page.indexBuffer);
+  }
+  m_pages.clear();
+  m_ranges.clear();
+  m_freeIds.clear();
+  m_boundPage = kNoPage;
+  m_boundFormat = BoundFormat::None;
+  m_standardProgram = nullptr;
+  m_compactProgram = nullptr;
+  m_draws = 0;
+  m_binds = 0;
+  m_defragmentations = 0;
+  m_stats = GeometryPoolStats();
+  m_device = nullptr;
+  m_deviceContext = nullptr;
+}
+
+HRESULT
+GeometryPool::createPage(unsigned int vertexStride, DXGI_FORMAT indexFormat,
+                         uint32_t vertexCount, uint32_t indexCount, uint32_t& pageIndex) {
+  const unsigned int indexStride = (indexFormat == DXGI_FORMAT_R16_UINT) ? sizeof(uint16_t) : sizeof(uint32_t);
+  const uint32_t vertexCapacity = (std::max)(kVertexPageBytes / vertexStride, vertexCount);
+  const uint32_t indexCapacity = (std::max)(kIndexPageBytes / indexStride, indexCount);
+
+  Page page;
+  page.vertexStride = vertexStride;
+  page.indexFormat = indexFormat;
+  HRESULT hr = createPoolBuffer(*m_device, D3D11_BIND_VERTEX_BUFFER,
+    static_cast<uint64_t>(vertexCapacity) * vertexStride, &page.vertexBuffer);
+  if (SUCCEEDED(hr)) {
+    hr = createPoolBuffer(*m_device, D3D11_BIND_INDEX_BUFFER,
+      static_cast<uint64_t>(indexCapacity) * indexStride, &page.indexBuffer);
+  }
+  if (FAILED(hr)) {
+    ERROR("GeometryPool", "createPage", "Failed to create geometry page buffers");
+    SAFE_RELEASE(page.vertexBuffer);
+    SAFE_RELEASE(page.indexBuffer);
+    return hr;
+  }
+  page.vertices.init(vertexCapacity);
+  page.indices.init(indexCapacity);
+
+  pageIndex = static_cast<uint32_t>(m_pages.size());
+  m_pages.push_back(page);
+  MESSAGE("GeometryPool", "createPage", ("Page " + std::to_string(pageIndex) + ": " +
+    std::to_string(vertexCapacity) + " vertices, " + std::to_string(indexCapacity) + " indices").c_str());
+  return S_OK;
+}
+
+bool
+GeometryPool::allocate(uint32_t pageIndex, uint32_t vertexCount, uint32_t indexCount, GeometryRange& range) {
+  Page& page = m_pages[pageIndex];
+  uint32_t baseVertex = 0;
+  uint32_t startIndex = 0;
+  if (!page.vertices.allocate(vertexCount, baseVertex)) {
+    return false;
+  }
+  if (!page.indices.allocate(indexCount, startIndex)) {
+    page.vertices.release(baseVertex);
+    return false;
+  }
+  range.page = pageIndex;
+  range.baseVertex = baseVertex;
+  range.vertexCount = vertexCount;
+  range.startIndex = startIndex;
+  range.indexCount = indexCount;
+  return true;
+}
+
+HRESULT
+GeometryPool::defragmentPage(uint32_t pageIndex) {
+  Page& page = m_pages[pageIndex];
+  const unsigned int indexStride = (page.indexFormat == DXGI_FORMAT_R16_UINT) ? sizeof(uint16_t) : sizeof(uint32_t);
+
+  // Una copia no puede solapar origen y destino en el mismo buffer: se compacta en buffers nuevos.
+  ID3D11Buffer* vertexBuffer = nullptr;
+  ID3D11Buffer* indexBuffer = nullptr;
+  HRESULT hr = createPoolBuffer(*m_device, D3D11_BIND_VERTEX_BUFFER,
+    static_cast<uint64_t>(page.vertices.getCapacity()) * page.vertexStride, &vertexBuffer);
+  if (SUCCEEDED(hr)) {
+    hr = createPoolBuffer(*m_device, D3D11_BIND_INDEX_BUFFER,
+      static_cast<uint64_t>(page.indices.getCapacity()) * indexStride, &indexBuffer);
+  }
+  if (FAILED(hr)) {
+    ERROR("GeometryPool", "defragmentPage", "Failed to create compacted page buffers");
+    SAFE_RELEASE(vertexBuffer);
+    SAFE_RELEASE(indexBuffer);
+    return hr;
+  }
+
+  std::vector<GeometryRange*> ranges;
+  for (GeometryRange& range : m_ranges) {
+    if (range.vertexCount > 0 && range.page == pageIndex) {
+      ranges.push_back(&range);
+    }
+  }
+  page.vertices.reset();
+  page.indices.reset();
+
+  // Vértices e índices se compactan por separado, cada uno en su orden actual.
+  ID3D11DeviceContext* context = m_deviceContext->m_deviceContext;
+  std::sort(ranges.begin(), ranges.end(),
+    [](const GeometryRange* a, const GeometryRange* b) { return a->baseVertex < b->baseVertex; });
+  uint32_t cursor = 0;
+  for (GeometryRange* range : ranges) {
+    const D3D11_BOX box = elementBox(range->baseVertex, range->vertexCount, page.vertexStride);
+    context->CopySubresourceRegion(vertexBuffer, 0, cursor * page.vertexStride, 0, 0, page.vertexBuffer, 0, &box);
+    page.vertices.reserve(cursor, range->vertexCount);
+    range->baseVertex = cursor;
+    cursor += range->vertexCount;
+  }
+  std::sort(ranges.begin(), ranges.end(),
+    [](const GeometryRange* a, const GeometryRange* b) { return a->startIndex < b->startIndex; });
+  cursor = 0;
+  for (GeometryRange* range : ranges) {
+    const D3D11_BOX box = elementBox(range->startIndex, range->indexCount, indexStride);
+    context->CopySubresourceRegion(indexBuffer, 0, cursor * indexStride, 0, 0, page.indexBuffer, 0, &box);
+    page.indices.reserve(cursor, range->indexCount);
+    range->startIndex = cursor;
+    cursor += range->indexCount;
+  }
+
+  SAFE_RELEASE(page.vertexBuffer);
+  SAFE_RELEASE(page.indexBuffer);
+  page.vertexBuffer = vertexBuffer;
+  page.indexBuffer = indexBuffer;
+  if (m_boundPage == pageIndex) {
+    m_boundPage = kNoPage;
+  }
+  ++m_defragmentations;
+  MESSAGE("GeometryPool", "defragmentPage", ("Page " + std::to_string(pageIndex) + " compacted (" +
+    std::to_string(ranges.size()) + " meshes)").c_str());
+  return S_OK;
+}
+
+void
+GeometryPool::updateStats() {
+  GeometryPoolStats stats;
+  stats.pages = static_cast<uint32_t>(m_pages.size());
+  stats.meshes = static_cast<uint32_t>(m_ranges.size() - m_freeIds.size());
+  for (const Page& page : m_pages) {
+    const unsigned int indexStride = (page.indexFormat == DXGI_FORMAT_R16_UINT) ? sizeof(uint16_t) : sizeof(uint32_t);
+    const FreeListAllocatorStats vertices = page.vertices.getStats();
+    const FreeListAllocatorStats indices = page.indices.getStats();
+    stats.vertexCapacityBytes += static_cast<uint64_t>(vertices.capacity) * page.vertexStride;
+    stats.vertexUsedBytes += static_cast<uint64_t>(vertices.used) * page.vertexStride;
+    stats.indexCapacityBytes += static_cast<uint64_t>(indices.capacity) * indexStride;
+    stats.indexUsedBytes += static_cast<uint64_t>(indices.used) * indexStride;
+    stats.freeRanges += vertices.freeRanges + indices.freeRanges;
+    stats.fragmentation = (std::max)(stats.fragmentation,
+      (std::max)(vertices.fragmentation(), indices.fragmentation()));
+  }
+  stats.defragmentations = m_defragmentations;
+  // Los draws y enlaces solo cambian al cerrar el frame (update()).
+  stats.draws = m_stats.draws;
+  stats.binds = m_stats.binds;
+  m_stats = stats;
+}
@@ -0,0 +1,642 @@
+﻿#include "GltfLoader.h"
+#include "FbxBinaryReader.h"
+#include "MeshComponent.h"
+#include "ThreadPool.h"
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+
+namespace {
+  const uint32_t kGlbMagic = 0x46546C67;      // "glTF"
+  const uint32_t kGlbChunkJson = 0x4E4F534A;  // "JSON"
+  const uint32_t kGlbChunkBin = 0x004E4942;   // "BIN\0"
+  const int kGltfTriangles = 4;
+
+  enum GltfComponentType {
+    kByte = 5120,
+    kUnsignedByte = 5121,
+    kShort = 5122,
+    kUnsignedShort = 5123,
+    kUnsignedInt = 5125,
+    kFloat = 5126
+  };
+
+  template<typename T>
+  inline T
+  readScalar(const uint8_t* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+  }
+
+  size_t
+  componentSize(int componentType) {
+    switch (componentType) {
+    case kByte: case kUnsignedByte: return 1;
+    case kShort: case kUnsignedShort: return 2;
+    case kUnsignedInt: case kFloat: return 4;
+    default: return 0;
+    }
+  }
+
+  int
+  componentCount(const std::string& type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4" || type == "MAT2") return 4;
+    if (type == "MAT3") return 9;
+    if (type == "MAT4") return 16;
+    return 0;
+  }
+
+  /**
+   * @brief Valor JSON mínimo; solo lo necesario para la descripción glTF.
+   */
+  struct JsonValue {
+    enum Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> items;     ///< Elementos (Array) o valores de miembros (Object).
+    std::vector<std::string> keys;    ///< Claves de los miembros (Object).
+
+    const JsonValue*
+    find(const char* key) const {
+      for (size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] == key) {
+          return &items[i];
+        }
+      }
+      return nullptr;
+    }
+
+    // Convertir a entero un double fuera de rango (o NaN) es indefinido: esos valores usan fallback.
+    int
+    getInt(const char* key, int fallback) const {
+      const JsonValue* value = find(key);
+      return value && value->type == Number && value->number >= static_cast<double>(INT_MIN) &&
+             value->number <= static_cast<double>(INT_MAX) ? static_cast<int>(value->number) : fallback;
+    }
+
+    size_t
+    getSize(const char* key, size_t fallback) const {
+      // SIZE_MAX + 1 es potencia de dos, exacta en double (SIZE_MAX no lo es).
+      const double sizeLimit = static_cast<double>(SIZE_MAX / 2 + 1) * 2.0;
+      const JsonValue* value = find(key);
+      return value && value->type == Number && value->number >= 0.0 && value->number < sizeLimit ?
+             static_cast<size_t>(value->number) : fallback;
+    }
+
+    std::string
+    getString(const char* key) const {
+      const JsonValue* value = find(key);
+      return value && value->type == String ? value->string : std::string();
+    }
+
+    const JsonValue*
+    getArray(const char* key) const {
+      const JsonValue* value = find(key);
+      return value && value->type == Array ? value : nullptr;
+    }
+  };
+
+  /**
+   * @brief Analizador JSON recursivo descendente sobre un rango de bytes.
+   */
+  class JsonParser {
+  public:
+    JsonParser(const char* begin, const char* end) : m_cursor(begin), m_end(end) {}
+
+    bool
+    parse(JsonValue& out) {
+      if (!parseValue(out, 0)) {
+        return false;
+      }
+      skipWhitespace();
+      return m_cursor == m_end || *m_cursor == '\0';
+    }
+
+  private:
+    static const int kMaxDepth = 128;
+
+    void
+    skipWhitespace() {
+      while (m_cursor < m_end && (*m_cursor == ' ' || *m_cursor == '\t' || *m_cursor == '\n' || *m_cursor == '\r')) {
+        ++m_cursor;
+      }
+    }
+
+    bool
+    consume(const char* literal) {
+      const size_t length = std::strlen(literal);
+      if (static_cast<size_t>(m_end - m_cursor) < length || std::memcmp(m_cursor, literal, length) != 0) {
+        return false;
+      }
+      m_cursor += length;
+      return true;
+    }
+
+    bool
+    parseValue(JsonValue& out, int depth) {
+      if (depth > kMaxDepth) {
+        return false;
+      }
+      skipWhitespace();
+      if (m_cursor >= m_end) {
+        return false;
+      }
+      switch (*m_cursor) {
+      case '{': return parseObject(out, depth);
+      case '[': return parseArray(out, depth);
+      case '"': out.type = JsonValue::String; return parseString(out.string);
+      case 't': out.type = JsonValue::Bool; out.boolean = true; return consume("true");
+      case 'f': out.type = JsonValue::Bool; out.boolean = false; return consume("false");
+      case 'n': out.type = JsonValue::Null; return consume("null");
+      default: return parseNumber(out);
+      }
+    }
+
+    bool
+    parseObject(JsonValue& out, int depth) {
+      out.type = JsonValue::Object;
+      ++m_cursor;
+      skipWhitespace();
+      if (m_cursor < m_end && *m_cursor == '}') {
+        ++m_cursor;
+        return true;
+      }
+      while (m_cursor < m_end) {
+        skipWhitespace();
+        std::string key;
+        if (m_cursor >= m_end || *m_cursor != '"' || !parseString(key)) {
+          return false;
+        }
+        skipWhitespace();
+        if (m_cursor >= m_end || *m_cursor++ != ':') {
+          return false;
+        }
+        out.keys.push_back(std::move(key));
+        out.items.emplace_back();
+        if (!parseValue(out.items.back(), depth + 1)) {
+          return false;
+        }
+        skipWhitespace();
+        if (m_cursor < m_end && *m_cursor == ',') {
+          ++m_cursor;
+          continue;
+        }
+        return m_cursor < m_end && *m_cursor++ == '}';
+      }
+      return false;
+    }
+
+    bool
+    parseArray(JsonValue& out, int depth) {
+      out.type = JsonValue::Array;
+      ++m_cursor;
+      skipWhitespace();
+      if (m_cursor < m_end && *m_cursor == ']') {
+        ++m_cursor;
+        return true;
+      }
+      while (m_cursor < m_end) {
+        out.items.emplace_back();
+        if (!parseValue(out.items.back(), depth + 1)) {
+          return false;
+        }
+        skipWhitespace();
+        if (m_cursor < m_end && *m_cursor == ',') {
+          ++m_cursor;
+          continue;
+        }
+        return m_cursor < m_end && *m_cursor++ == ']';
+      }
+      return false;
+    }
+
+    bool
+    parseString(std::string& out) {
+      ++m_cursor;
+      while (m_cursor < m_end) {
+        const char c = *m_cursor++;
+        if (c == '"') {
+          return true;
+        }
+        if (c != '\\') {
+          out.push_back(c);
+          continue;
+        }
+        if (m_cursor >= m_end) {
+          return false;
+        }
+        const char escaped = *m_cursor++;
+        switch (escaped) {
+        case 'b': out.push_back('\b'); break;
+        case 'f': out.push_back('\f'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 't': out.push_back('\t'); break;
+        case 'u': {
+          // Las claves glTF son ASCII; fuera de ese rango se codifica a UTF-8 (sin pares sustitutos).
+          if (m_end - m_cursor < 4) {
+            return false;
+          }
+          const std::string hex(m_cursor, 4);
+          m_cursor += 4;
+          const unsigned long code = std::strtoul(hex.c_str(), nullptr, 16);
+          if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+          }
+          else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+          }
+          else {
+            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+          }
+          break;
+        }
+        default: out.push_back(escaped); break;
+        }
+      }
+      return false;
+    }
+
+    bool
+    parseNumber(JsonValue& out) {
+      const char* start = m_cursor;
+      while (m_cursor < m_end && (std::isdigit(static_cast<unsigned char>(*m_cursor)) ||
+             *m_cursor == '-' || *m_cursor == '+' || *m_cursor == '.' || *m_cursor == 'e' || *m_cursor == 'E')) {
+        ++m_cursor;
+      }
+      if (m_cursor == start) {
+        return false;
+      }
+      const std::string text(start, m_cursor);
+      char* parsedEnd = nullptr;
+      out.type = JsonValue::Number;
+      out.number = std::strtod(text.c_str(), &parsedEnd);
+      return parsedEnd == text.c_str() + text.size();
+    }
+
+    const char* m_cursor;
+    const char* m_end;
+  };
+}
+
+HRESULT
+GltfLoader::load(const std::string& fileName, std::vector<MeshComponent>& meshes) {
+  MappedFile file;
+  HRESULT hr = file.init(fileName);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  const size_t slash = fileName.find_last_of("/\\");
+  const std::string baseDirectory = slash == std::string::npos ? std::string() : fileName.substr(0, slash + 1);
+
+  hr = init(file.data(), file.size(), baseDirectory);
+  if (SUCCEEDED(hr)) {
+    hr = buildMeshes(meshes);
+  }
+
+  // Los accessors apuntan a la vista proyectada; no deben sobrevivirla.
+  destroy();
+  return hr;
+}
+
+HRESULT
+GltfLoader::init(const char* data, size_t size, const std::string& baseDirectory) {
+  destroy();
+  if (!data || size < 12) {
+    ERROR("GltfLoader", "init", "File too small");
+    return E_FAIL;
+  }
+
+  // GLB: cabecera de 12 bytes, bloque JSON y bloque BIN opcional. Si no, es un .gltf de texto.
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  const char* jsonBegin = data;
+  const char* jsonEnd = data + size;
+  const uint8_t* binData = nullptr;
+  size_t binSize = 0;
+  if (readScalar<uint32_t>(bytes) == kGlbMagic) {
+    const uint32_t version = readScalar<uint32_t>(bytes + 4);
+    const uint32_t length = readScalar<uint32_t>(bytes + 8);
+    if (version != 2 || length > size) {
+      ERROR("GltfLoader", "init", "Unsupported GLB version " << version);
+      return E_FAIL;
+    }
+
+    size_t offset = 12;
+    jsonBegin = nullptr;
+    while (offset + 8 <= length) {
+      const uint32_t chunkLength = readScalar<uint32_t>(bytes + offset);
+      const uint32_t chunkType = readScalar<uint32_t>(bytes + offset + 4);
+      offset += 8;
+      if (chunkLength > length - offset) {
+        ERROR("GltfLoader", "init", "Truncated GLB chunk");
+        return E_FAIL;
+      }
+      if (chunkType == kGlbChunkJson && !jsonBegin) {
+        jsonBegin = data + offset;
+        jsonEnd = jsonBegin + chunkLength;
+      }
+      else if (chunkType == kGlbChunkBin && !binData) {
+        binData = bytes + offset;
+        binSize = chunkLength;
+      }
+      offset += (chunkLength + 3) & ~size_t(3);
+    }
+    if (!jsonBegin) {
+      ERROR("GltfLoader", "init", "GLB without JSON chunk");
+      return E_FAIL;
+    }
+  }
+
+  JsonValue root;
+  if (!JsonParser(jsonBegin, jsonEnd).parse(root) || root.type != JsonValue::Object) {
+    ERROR("GltfLoader", "init", "Invalid glTF JSON");
+    return E_FAIL;
+  }
+
+  // Buffers: el que no tiene uri es el bloque BIN del GLB; el resto se proyecta del disco.
+  struct Range { const uint8_t* data; size_t size; };
+  std::vector<Range> buffers;
+  if (const JsonValue* jsonBuffers = root.getArray("buffers")) {
+    for (const JsonValue& buffer : jsonBuffers->items) {
+      const std::string uri = buffer.getString("uri");
+      const size_t byteLength = buffer.getSize("byteLength", 0);
+      if (uri.empty()) {
+        buffers.push_back({ binData, binData && byteLength <= binSize ? byteLength : 0 });
+        continue;
+      }
+      if (uri.compare(0, 5, "data:") == 0) {
+        ERROR("GltfLoader", "init", "Embedded data URIs are not supported");
+        buffers.push_back({ nullptr, 0 });
+        continue;
+      }
+      MappedFile external;
+      if (FAILED(external.init(baseDirectory + uri)) || external.size() < byteLength) {
+        ERROR("GltfLoader", "init", "Unable to map buffer " << uri.c_str());
+        buffers.push_back({ nullptr, 0 });
+        continue;
+      }
+      buffers.push_back({ reinterpret_cast<const uint8_t*>(external.data()), byteLength });
+      m_buffers.push_back(std::move(external));
+    }
+  }
+
+  std::vector<Range> views;
+  std::vector<size_t> viewStrides;
+  if (const JsonValue* jsonViews = root.getArray("bufferViews")) {
+    for (const JsonValue& view : jsonViews->items) {
+      const size_t buffer = view.getSize("buffer", SIZE_MAX);
+      const size_t offset = view.getSize("byteOffset", 0);
+      const size_t length = view.getSize("byteLength", 0);
+      const bool valid = buffer < buffers.size() && buffers[buffer].data &&
+                         offset <= buffers[buffer].size && length <= buffers[buffer].size - offset;
+      views.push_back({ valid ? buffers[buffer].data + offset : nullptr, valid ? length : 0 });
+      viewStrides.push_back(view.getSize("byteStride", 0));
+    }
+  }
+
+  // Accessors: se validan una sola vez contra su bufferView; uno inválido queda sin datos.
+  if (const JsonValue* jsonAccessors = root.getArray("accessors")) {
+    for (const JsonValue& jsonAccessor : jsonAccessors->items) {
+      Accessor accessor;
+      accessor.count = jsonAccessor.getSize("count", 0);
+      accessor.componentType = jsonAccessor.getInt("componentType", 0);
+      accessor.components = componentCount(jsonAccessor.getString("type"));
+      const JsonValue* normalized = jsonAccessor.find("normalized");
+      accessor.normalized = normalized && normalized->type == JsonValue::Bool && normalized->boolean;
+
+      const size_t view = jsonAccessor.getSize("bufferView", SIZE_MAX);
+      const size_t offset = jsonAccessor.getSize("byteOffset", 0);
+      const size_t elementSize = componentSize(accessor.componentType) * accessor.components;
+      if (view < views.size() && views[view].data && elementSize > 0 && accessor.count > 0 &&
+          !jsonAccessor.find("sparse")) {
+        accessor.stride = viewStrides[view] ? viewStrides[view] : elementSize;
+        // count y byteStride vienen del archivo: stride * (count - 1) + elementSize no debe desbordar.
+        const bool spanFits = accessor.count - 1 <= (SIZE_MAX - elementSize) / accessor.stride;
+        const size_t span = spanFits ? accessor.stride * (accessor.count - 1) + elementSize : SIZE_MAX;
+        if (spanFits && accessor.stride >= elementSize && offset <= views[view].size &&
+            span <= views[view].size - offset) {
+          accessor.data = views[view].data + offset;
+        }
+      }
+      m_accessors.push_back(accessor);
+    }
+  }
+
+  if (const JsonValue* jsonMeshes = root.getArray("meshes")) {
+    for (size_t m = 0; m < jsonMeshes->items.size(); ++m) {
+      const JsonValue& jsonMesh = jsonMeshes->items[m];
+      std::string meshName = jsonMesh.getString("name");
+      if (meshName.empty()) {
+        meshName = "mesh" + std::to_string(m);
+      }
+
+      const JsonValue* jsonPrimitives = jsonMesh.getArray("primitives");
+      if (!jsonPrimitives) {
+        continue;
+      }
+      for (size_t p = 0; p < jsonPrimitives->items.size(); ++p) {
+        const JsonValue& jsonPrimitive = jsonPrimitives->items[p];
+        const JsonValue* attributes = jsonPrimitive.find("attributes");
+        if (jsonPrimitive.getInt("mode", kGltfTriangles) != kGltfTriangles || !attributes) {
+          MESSAGE("GltfLoader", "init", ("Skipping non-triangle primitive in " + meshName).c_str());
+          continue;
+        }
+
+        Primitive primitive;
+        primitive.name = jsonPrimitives->items.size() > 1 ? meshName + "_" + std::to_string(p) : meshName;
+        primitive.position = attributes->getInt("POSITION", -1);
+        primitive.texcoord = attributes->getInt("TEXCOORD_0", -1);
+        primitive.indices = jsonPrimitive.getInt("indices", -1);
+        m_primitives.push_back(std::move(primitive));
+      }
+    }
+  }
+
+  if (m_primitives.empty()) {
+    ERROR("GltfLoader", "init", "No triangle primitives found");
+    destroy();
+    return E_FAIL;
+  }
+  return S_OK;
+}
+
+HRESULT
+GltfLoader::buildMeshes(std::vector<MeshComponent>& meshes) const {
+  // Cada primitiva escribe en su propia ranura, igual que el lector FBX nativo.
+  std::vector<MeshComponent> slots(m_primitives.size());
+  std::vector<HRESULT> results(m_primitives.size(), E_FAIL);
+  ThreadPool::getInstance().parallelFor(m_primitives.size(), [&](size_t i) {
+    results[i] = buildMesh(m_primitives[i], slots[i]);
+  });
+
+  size_t built = 0;
+  for (size_t i = 0; i < slots.size(); ++i) {
+    if (FAILED(results[i])) {
+      ERROR("GltfLoader", "buildMeshes", "Skipping invalid primitive " << m_primitives[i].name.c_str());
+      continue;
+    }
+    meshes.push_back(std::move(slots[i]));
+    ++built;
+  }
+
+  MESSAGE("GltfLoader", "buildMeshes", ("glTF: " + std::to_string(built) + " of " +
+    std::to_string(m_primitives.size()) + " primitives").c_str());
+  return built > 0 ? S_OK : E_FAIL;
+}
+
+void
+GltfLoader::destroy() {
+  m_accessors.clear();
+  m_primitives.clear();
+  m_buffers.clear();
+}
+
+float
+GltfLoader::readFloat(const Accessor& accessor, size_t index, int component) {
+  const uint8_t* p = accessor.data + index * accessor.stride;
+  switch (accessor.componentType) {
+  case kFloat: return readScalar<float>(p + component * 4);
+  case kUnsignedByte: {
+    const float value = p[component];
+    return accessor.normalized ? value / 255.0f : value;
+  }
+  case kByte: {
+    const float value = static_cast<int8_t>(p[component]);
+    return accessor.normalized ? (std::max)(value / 127.0f, -1.0f) : value;
+  }
+  case kUnsignedShort: {
+    const float value = readScalar<uint16_t>(p + component * 2);
+    return accessor.normalized ? value / 65535.0f : value;
+  }
+  case kShort: {
+    const float value = readScalar<int16_t>(p + component * 2);
+    return accessor.normalized ? (std::max)(value / 32767.0f, -1.0f) : value;
+  }
+  case kUnsignedInt: return static_cast<float>(readScalar<uint32_t>(p + component * 4));
+  default: return 0.0f;
+  }
+}
+
+uint32_t
+GltfLoader::readIndex(const Accessor& accessor, size_t index) {
+  const uint8_t* p = accessor.data + index * accessor.stride;
+  switch (accessor.componentType) {
+  case kUnsignedByte: return p[0];
+  case kUnsignedShort: return readScalar<uint16_t>(p);
+  case kUnsignedInt: return readScalar<uint32_t>(p);
+  default: return 0;
+  }
+}
+
+HRESULT
+GltfLoader::buildMesh(const Primitive& primitive, MeshComponent& mesh) const {
+  if (primitive.position < 0 || static_cast<size_t>(primitive.position) >= m_accessors.size()) {
+    return E_FAIL;
+  }
+  const Accessor& position = m_accessors[primitive.position];
+  if (!position.data || position.components != 3) {
+    return E_FAIL;
+  }
+
+  const Accessor* texcoord = nullptr;
+  if (primitive.texcoord >= 0 && static_cast<size_t>(primitive.texcoord) < m_accessors.size()) {
+    texcoord = &m_accessors[primitive.texcoord];
+    if (!texcoord->data || texcoord->components != 2 || texcoord->count != position.count) {
+      texcoord = nullptr;
+    }
+  }
+
+  const size_t vertexCount = position.count;
+  std::vector<SimpleVertex> vertices(vertexCount);
+  const bool floatPosition = position.componentType == kFloat;
+  const bool floatTexcoord = texcoord && texcoord->componentType == kFloat;
+
+  if (floatPosition && floatTexcoord && position.stride == sizeof(SimpleVertex) &&
+      texcoord->stride == sizeof(SimpleVertex) &&
+      texcoord->data == position.data + offsetof(SimpleVertex, Tex)) {
+    // El buffer ya está intercalado como SimpleVertex: copia directa.
+    std::memcpy(vertices.data(), position.data, vertexCount * sizeof(SimpleVertex));
+  }
+  else {
+    for (size_t i = 0; i < vertexCount; ++i) {
+      SimpleVertex& out = vertices[i];
+      if (floatPosition) {
+        std::memcpy(&out.Pos, position.data + i * position.stride, sizeof(XMFLOAT3));
+      }
+      else {
+        out.Pos = XMFLOAT3(readFloat(position, i, 0), readFloat(position, i, 1), readFloat(position, i, 2));
+      }
+
+      if (floatTexcoord) {
+        std::memcpy(&out.Tex, texcoord->data + i * texcoord->stride, sizeof(XMFLOAT2));
+      }
+      else if (texcoord) {
+        out.Tex = XMFLOAT2(readFloat(*texcoord, i, 0), readFloat(*texcoord, i, 1));
+      }
+      else {
+        out.Tex = XMFLOAT2(0.0f, 0.0f);
+      }
+    }
+  }
+
+  std::vector<unsigned int> indices;
+  if (primitive.indices >= 0) {
+    if (static_cast<size_t>(primitive.indices) >= m_accessors.size()) {
+      return E_FAIL;
+    }
+    const Accessor& indexAccessor = m_accessors[primitive.indices];
+    if (!indexAccessor.data || indexAccessor.components != 1 || indexAccessor.componentType == kFloat) {
+      return E_FAIL;
+    }
+
+    indices.resize(indexAccessor.count);
+    if (indexAccessor.componentType == kUnsignedInt && indexAccessor.stride == sizeof(uint32_t)) {
+      std::memcpy(indices.data(), indexAccessor.data, indices.size() * sizeof(uint32_t));
+    }
+    else {
+      for (size_t i = 0; i < indices.size(); ++i) {
+        indices[i] = readIndex(indexAccessor, i);
+      }
+    }
+    for (unsigned int index : indices) {
+      if (index >= vertexCount) {
+        return E_FAIL;
+      }
+    }
+  }
+  else {
+    // Sin índices: cada tres vértices consecutivos forman un triángulo.
+    indices.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+      indices[i] = static_cast<unsigned int>(i);
+    }
+  }
+  indices.resize(indices.size() - indices.size() % 3);
+  if (indices.empty()) {
+    return E_FAIL;
+  }
+
+  // Diestro (glTF) a zurdo (DirectX) con la misma conversión que la ruta FBX: glTF equivale
+  // a un FBX con Y arriba, +Z al frente y metros, así que X se niega y el winding se invierte.
+  FbxAxisConversion gltfAxes;
+  gltfAxes.unitScaleFactor = 100.0;
+  gltfAxes.apply(vertices, indices);
+
+  mesh.m_name = primitive.name;
+  mesh.m_vertex = std::move(vertices);
+  mesh.m_index = std::move(indices);
+  mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+  mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+  return S_OK;
+}
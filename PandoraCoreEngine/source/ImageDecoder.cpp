@@ -0,0 +1,82 @@
+﻿#include "ImageDecoder.h"
+#include "FileSystem.h"
+#include "ThreadPool.h"
+#include "stb_image.h"
+#include <chrono>
+
+void
+DecodedImage::release() {
+  if (pixels) {
+    stbi_image_free(pixels);
+    pixels = nullptr;
+  }
+}
+
+HRESULT
+ImageDecoder::decode(const std::string& path, DecodedImage& image) {
+  FileSpan file;
+  if (FAILED(FileSystem::open(path, file)) || file.size == 0) {
+    image.release();
+    image.path = path;
+    image.error = "can't open file";
+    image.width = 0;
+    image.height = 0;
+    return E_FAIL;
+  }
+  return decode(file.data, file.size, path, image);
+}
+
+HRESULT
+ImageDecoder::decode(const void* data, size_t size, const std::string& path, DecodedImage& image) {
+  image.release();
+  image.path = path;
+  image.error.clear();
+
+  stbi_set_flip_vertically_on_load_thread(0);
+  int channels = 0;
+  image.pixels = stbi_load_from_memory(static_cast<const stbi_uc*>(data), static_cast<int>(size),
+                                       &image.width, &image.height, &channels, 4); // RGBA
+  if (!image.pixels) {
+    const char* reason = stbi_failure_reason();
+    image.error = reason ? reason : "unknown error";
+    image.width = 0;
+    image.height = 0;
+    return E_FAIL;
+  }
+  return S_OK;
+}
+
+HRESULT
+ImageDecoder::decodeBatch(const std::vector<std::string>& paths,
+                          std::vector<DecodedImage>& images,
+                          double* wallMs) {
+  for (DecodedImage& image : images) {
+    image.release();
+  }
+  images.clear();
+  images.resize(paths.size());
+
+  const auto start = std::chrono::steady_clock::now();
+  ThreadPool::getInstance().parallelFor(paths.size(), [&](size_t i) {
+    decode(paths[i], images[i]);
+  });
+  const double elapsedMs = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+  if (wallMs) {
+    *wallMs = elapsedMs;
+  }
+
+  HRESULT hr = S_OK;
+  for (const DecodedImage& image : images) {
+    if (!image.pixels) {
+      ERROR("ImageDecoder", "decodeBatch",
+        ("Failed to decode " + image.path + ": " + image.error).c_str());
+      hr = E_FAIL;
+    }
+  }
+
+  MESSAGE("ImageDecoder", "decodeBatch", (std::to_string(paths.size()) + " imágenes decodificadas en " +
+    std::to_string(elapsedMs) + " ms con " +
+    std::to_string(ThreadPool::getInstance().getThreadCount() + 1) + " hilos").c_str());
+  return hr;
+}
@@ -0,0 +1,359 @@
+﻿#include "Inflater.h"
+
+namespace {
+  constexpr int kMaxBits = 15;
+  constexpr int kFastBits = 9;
+  constexpr int kMaxLitLenCodes = 288;
+  constexpr int kMaxDistCodes = 30;
+
+  const uint16_t kLengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+  const uint8_t kLengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+  const uint16_t kDistBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+  const uint8_t kDistExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+  const uint8_t kCodeLengthOrder[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+  /**
+   * @brief Tabla Huffman canónica con acceso directo para códigos cortos.
+   */
+  struct Huffman {
+    uint16_t count[kMaxBits + 1];
+    uint16_t symbol[kMaxLitLenCodes];
+    uint16_t fast[1 << kFastBits]; // símbolo | (longitud << 12); 0 = no resuelto
+
+    bool
+    build(const uint8_t* lengths, int n) {
+      std::memset(count, 0, sizeof(count));
+      std::memset(fast, 0, sizeof(fast));
+      for (int i = 0; i < n; ++i) ++count[lengths[i]];
+      count[0] = 0;
+
+      // Rechaza conjuntos sobre-suscritos; los incompletos son válidos (p. ej. un solo código).
+      int left = 1;
+      for (int len = 1; len <= kMaxBits; ++len) {
+        left <<= 1;
+        left -= count[len];
+        if (left < 0) return false;
+      }
+
+      uint16_t offsets[kMaxBits + 2];
+      offsets[1] = 0;
+      for (int len = 1; len <= kMaxBits; ++len) {
+        offsets[len + 1] = static_cast<uint16_t>(offsets[len] + count[len]);
+      }
+      for (int i = 0; i < n; ++i) {
+        if (lengths[i]) symbol[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+      }
+
+      // Tabla directa: los códigos DEFLATE se leen desde el bit menos significativo.
+      int code = 0;
+      int index = 0;
+      for (int len = 1; len <= kFastBits; ++len) {
+        for (int k = 0; k < count[len]; ++k, ++code, ++index) {
+          int reversed = 0;
+          for (int b = 0; b < len; ++b) reversed |= ((code >> b) & 1) << (len - 1 - b);
+          for (int slot = reversed; slot < (1 << kFastBits); slot += 1 << len) {
+            fast[slot] = static_cast<uint16_t>(symbol[index] | (len << 12));
+          }
+        }
+        code <<= 1;
+      }
+      return true;
+    }
+  };
+
+  /**
+   * @brief Estado de decodificación: lector de bits y salida.
+   */
+  struct InflateState {
+    const uint8_t* in;
+    const uint8_t* inEnd;
+    uint64_t bitBuffer = 0;
+    int bitCount = 0;
+    int overrun = 0; // bits de relleno leídos más allá del final
+    std::vector<uint8_t>& out;
+
+    InflateState(const uint8_t* begin, const uint8_t* end, std::vector<uint8_t>& output)
+      : in(begin), inEnd(end), out(output) {}
+
+    void
+    refill() {
+      while (bitCount <= 56) {
+        if (in < inEnd) {
+          bitBuffer |= static_cast<uint64_t>(*in++) << bitCount;
+        }
+        else {
+          overrun += 8;
+        }
+        bitCount += 8;
+      }
+    }
+
+    uint32_t
+    bits(int n) {
+      if (bitCount < n) refill();
+      const uint32_t value = static_cast<uint32_t>(bitBuffer & ((1ull << n) - 1));
+      bitBuffer >>= n;
+      bitCount -= n;
+      return value;
+    }
+
+    bool
+    truncated() const { return overrun > bitCount; }
+
+    int
+    decode(const Huffman& h) {
+      if (bitCount < kMaxBits) refill();
+      const uint16_t entry = h.fast[bitBuffer & ((1u << kFastBits) - 1)];
+      if (entry) {
+        const int len = entry >> 12;
+        bitBuffer >>= len;
+        bitCount -= len;
+        return entry & 0x0FFF;
+      }
+
+      // Códigos largos: decodificación canónica bit a bit.
+      int code = 0, first = 0, index = 0;
+      for (int len = 1; len <= kMaxBits; ++len) {
+        code |= static_cast<int>(bits(1));
+        const int count = h.count[len];
+        if (code - count < first) {
+          return h.symbol[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+      }
+      return -1;
+    }
+
+    // Vuelve a alinear a byte y devuelve los bytes completos no consumidos al flujo.
+    void
+    alignToByte() {
+      const int drop = bitCount & 7;
+      bitBuffer >>= drop;
+      bitCount -= drop;
+    }
+
+    bool
+    stored() {
+      alignToByte();
+      // Los bytes que aún están en el buffer de bits se leen primero.
+      uint8_t header[4];
+      for (int i = 0; i < 4; ++i) header[i] = static_cast<uint8_t>(bits(8));
+      const uint16_t len = static_cast<uint16_t>(header[0] | (header[1] << 8));
+      const uint16_t nlen = static_cast<uint16_t>(header[2] | (header[3] << 8));
+      if (len != static_cast<uint16_t>(~nlen) || truncated()) return false;
+
+      size_t remaining = len;
+      while (remaining && bitCount - overrun >= 8) {
+        out.push_back(static_cast<uint8_t>(bits(8)));
+        --remaining;
+      }
+      if (static_cast<size_t>(inEnd - in) < remaining) return false;
+      out.insert(out.end(), in, in + remaining);
+      in += remaining;
+      return true;
+    }
+
+    bool
+    codes(const Huffman& lenCodes, const Huffman& distCodes) {
+      for (;;) {
+        int sym = decode(lenCodes);
+        if (sym < 0 || truncated()) return false;
+        if (sym < 256) {
+          out.push_back(static_cast<uint8_t>(sym));
+          continue;
+        }
+        if (sym == 256) return true;
+
+        sym -= 257;
+        if (sym >= 29) return false;
+        const size_t length = kLengthBase[sym] + bits(kLengthExtra[sym]);
+
+        const int distSym = decode(distCodes);
+        if (distSym < 0 || distSym >= kMaxDistCodes) return false;
+        const size_t distance = kDistBase[distSym] + bits(kDistExtra[distSym]);
+        if (distance > out.size() || truncated()) return false;
+
+        // Copia byte a byte: la referencia puede solaparse con lo que se escribe.
+        size_t from = out.size() - distance;
+        for (size_t i = 0; i < length; ++i) {
+          out.push_back(out[from + i]);
+        }
+      }
+    }
+
+    bool
+    fixed() {
+      // Inicialización estática segura entre hilos (C++11).
+      struct FixedTables {
+        Huffman lenCodes, distCodes;
+        FixedTables() {
+          uint8_t lengths[kMaxLitLenCodes];
+          int i = 0;
+          for (; i < 144; ++i) lengths[i] = 8;
+          for (; i < 256; ++i) lengths[i] = 9;
+          for (; i < 280; ++i) lengths[i] = 7;
+          for (; i < 288; ++i) lengths[i] = 8;
+          lenCodes.build(lengths, kMaxLitLenCodes);
+          for (i = 0; i < kMaxDistCodes; ++i) lengths[i] = 5;
+          distCodes.build(lengths, kMaxDistCodes);
+        }
+      };
+      static const FixedTables tables;
+      return codes(tables.lenCodes, tables.distCodes);
+    }
+
+    bool
+    dynamic() {
+      const int nlen = static_cast<int>(bits(5)) + 257;
+      const int ndist = static_cast<int>(bits(5)) + 1;
+      const int ncode = static_cast<int>(bits(4)) + 4;
+      if (nlen > 286 || ndist > kMaxDistCodes) return false;
+
+      uint8_t lengths[320] = {};
+      for (int i = 0; i < ncode; ++i) {
+        lengths[kCodeLengthOrder[i]] = static_cast<uint8_t>(bits(3));
+      }
+      Huffman lenLenCodes;
+      if (!lenLenCodes.build(lengths, 19)) return false;
+
+      int index = 0;
+      while (index < nlen + ndist) {
+        int sym = decode(lenLenCodes);
+        if (sym < 0 || truncated()) return false;
+        if (sym < 16) {
+          lengths[index++] = static_cast<uint8_t>(sym);
+          continue;
+        }
+        uint8_t value = 0;
+        int repeat = 0;
+        if (sym == 16) {
+          if (index == 0) return false;
+          value = lengths[index - 1];
+          repeat = 3 + static_cast<int>(bits(2));
+        }
+        else if (sym == 17) {
+          repeat = 3 + static_cast<int>(bits(3));
+        }
+        else {
+          repeat = 11 + static_cast<int>(bits(7));
+        }
+        if (index + repeat > nlen + ndist) return false;
+        while (repeat--) lengths[index++] = value;
+      }
+      if (lengths[256] == 0) return false;
+
+      Huffman lenCodes, distCodes;
+      if (!lenCodes.build(lengths, nlen)) return false;
+      if (!distCodes.build(lengths + nlen, ndist)) return false;
+      return codes(lenCodes, distCodes);
+    }
+
+    // Bytes de entrada realmente consumidos (descontando lo que quedó en el buffer de bits).
+    size_t
+    consumed(const uint8_t* begin) const {
+      const size_t buffered = static_cast<size_t>((bitCount - overrun) > 0 ? (bitCount - overrun) / 8 : 0);
+      return static_cast<size_t>(in - begin) - buffered;
+    }
+  };
+
+  uint32_t
+  adler32(const uint8_t* data, size_t size) {
+    uint32_t a = 1, b = 0;
+    while (size) {
+      // 5552 es el mayor bloque que no desborda 32 bits antes del módulo.
+      size_t block = (std::min)(size, static_cast<size_t>(5552));
+      size -= block;
+      while (block--) {
+        a += *data++;
+        b += a;
+      }
+      a %= 65521u;
+      b %= 65521u;
+    }
+    return (b << 16) | a;
+  }
+}
+
+HRESULT
+Inflater::inflateRaw(const void* data,
+                     size_t size,
+                     std::vector<uint8_t>& out,
+                     size_t* consumed) {
+  const uint8_t* begin = static_cast<const uint8_t*>(data);
+  InflateState state(begin, begin + size, out);
+
+  bool last = false;
+  while (!last) {
+    last = state.bits(1) != 0;
+    const uint32_t type = state.bits(2);
+    bool ok = false;
+    switch (type) {
+    case 0: ok = state.stored(); break;
+    case 1: ok = state.fixed(); break;
+    case 2: ok = state.dynamic(); break;
+    default: ok = false; break;
+    }
+    if (!ok || state.truncated()) {
+      ERROR("Inflater", "inflateRaw", "Corrupt or truncated DEFLATE stream");
+      return E_FAIL;
+    }
+  }
+
+  if (consumed) {
+    state.alignToByte();
+    *consumed = state.consumed(begin);
+  }
+  return S_OK;
+}
+
+HRESULT
+Inflater::inflateZlib(const void* data,
+                      size_t size,
+                      std::vector<uint8_t>& out,
+                      size_t expectedSize) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  if (size < 6) {
+    ERROR("Inflater", "inflateZlib", "zlib stream too short");
+    return E_FAIL;
+  }
+  const uint8_t cmf = bytes[0];
+  const uint8_t flg = bytes[1];
+  if ((cmf & 0x0F) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) {
+    ERROR("Inflater", "inflateZlib", "Unsupported zlib header");
+    return E_FAIL;
+  }
+
+  out.clear();
+  out.reserve(expectedSize);
+
+  size_t consumed = 0;
+  HRESULT hr = inflateRaw(bytes + 2, size - 2, out, &consumed);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  const size_t trailer = 2 + consumed;
+  if (trailer + 4 <= size) {
+    const uint32_t expected = (static_cast<uint32_t>(bytes[trailer]) << 24) |
+                              (static_cast<uint32_t>(bytes[trailer + 1]) << 16) |
+                              (static_cast<uint32_t>(bytes[trailer + 2]) << 8) |
+                              static_cast<uint32_t>(bytes[trailer + 3]);
+    if (adler32(out.data(), out.size()) != expected) {
+      ERROR("Inflater", "inflateZlib", "Adler-32 checksum mismatch");
+      return E_FAIL;
+    }
+  }
+  return S_OK;
+}
@@ -0,0 +1,89 @@
+﻿#include "MappedFile.h"
+
+MappedFile&
+MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    destroy();
+    m_file = other.m_file;
+    m_mapping = other.m_mapping;
+    m_data = other.m_data;
+    m_size = other.m_size;
+    other.m_file = INVALID_HANDLE_VALUE;
+    other.m_mapping = nullptr;
+    other.m_data = nullptr;
+    other.m_size = 0;
+  }
+  return *this;
+}
+
+HRESULT
+MappedFile::init(const std::string& fileName) {
+  if (fileName.empty()) {
+    ERROR("MappedFile", "init", "File name cannot be empty.");
+    return E_INVALIDARG;
+  }
+  destroy();
+
+  m_file = CreateFileA(fileName.c_str(),
+                       GENERIC_READ,
+                       FILE_SHARE_READ,
+                       nullptr,
+                       OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                       nullptr);
+  if (m_file == INVALID_HANDLE_VALUE) {
+    ERROR("MappedFile", "init", ("Failed to open file: " + fileName).c_str());
+    return E_FAIL;
+  }
+
+  LARGE_INTEGER fileSize = {};
+  if (!GetFileSizeEx(m_file, &fileSize)) {
+    ERROR("MappedFile", "init", ("Failed to query file size: " + fileName).c_str());
+    destroy();
+    return E_FAIL;
+  }
+  if (static_cast<ULONGLONG>(fileSize.QuadPart) > static_cast<ULONGLONG>(SIZE_MAX)) {
+    ERROR("MappedFile", "init", ("File too large for address space: " + fileName).c_str());
+    destroy();
+    return E_FAIL;
+  }
+
+  m_size = static_cast<size_t>(fileSize.QuadPart);
+  if (m_size == 0) {
+    // CreateFileMapping no admite archivos vacíos; se deja abierto sin vista.
+    return S_OK;
+  }
+
+  m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!m_mapping) {
+    ERROR("MappedFile", "init", ("Failed to create file mapping: " + fileName).c_str());
+    destroy();
+    return E_FAIL;
+  }
+
+  m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!m_data) {
+    ERROR("MappedFile", "init", ("Failed to map view of file: " + fileName).c_str());
+    destroy();
+    return E_FAIL;
+  }
+
+  return S_OK;
+}
+
+void
+MappedFile::destroy() {
+  if (m_data) {
+    UnmapViewOfFile(m_data);
+    m_data = nullptr;
+  }
+  if (m_mapping) {
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+  }
+  if (m_file != INVALID_HANDLE_VALUE) {
+    CloseHandle(m_file);
+    m_file = INVALID_HANDLE_VALUE;
+  }
+  m_size = 0;
+}
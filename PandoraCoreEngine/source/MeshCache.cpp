@@ -0,0 +1,238 @@
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include "ContentHash.h"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+  const char kMagic[4] = { 'P', 'C', 'M', 'S' };
+
+  struct MeshCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t meshCount;
+    uint32_t reserved;
+  };
+
+  struct MeshCacheEntry {
+    uint32_t nameLength;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexStride;
+    XMFLOAT3 boundsMin;
+    XMFLOAT3 boundsMax;
+    uint32_t lodCount;
+    float boundsRadius;
+    uint32_t meshletCount;
+    uint32_t reserved;
+  };
+
+  static_assert(sizeof(MeshCacheHeader) == 24, "MeshCacheHeader layout changed");
+  static_assert(sizeof(MeshCacheEntry) == 56, "MeshCacheEntry layout changed");
+  static_assert(sizeof(SimpleVertex) % 4 == 0, "SimpleVertex must keep 4-byte alignment");
+  static_assert(sizeof(MeshLod) == 12, "MeshLod layout changed");
+  static_assert(sizeof(Meshlet) == 40, "Meshlet layout changed");
+
+  inline size_t
+  align4(size_t value) {
+    return (value + 3) & ~static_cast<size_t>(3);
+  }
+}
+
+bool
+MeshCache::computeKey(const std::string& sourcePath,
+                      const std::string& importerSettings,
+                      uint64_t& outKey) {
+  MappedFile file;
+  if (FAILED(file.init(sourcePath))) {
+    return false;
+  }
+  outKey = computeKey(file.data(), file.size(), importerSettings);
+  return true;
+}
+
+uint64_t
+MeshCache::computeKey(const void* sourceData,
+                      size_t sourceSize,
+                      const std::string& importerSettings) {
+  const uint64_t contentHash = ContentHash::hashBytes(sourceData, sourceSize);
+  const uint64_t settingsHash = ContentHash::hashString(importerSettings, contentHash);
+  return ContentHash::hashBytes(&kVersion, sizeof(kVersion), settingsHash);
+}
+
+bool
+MeshCache::load(const std::string& cachePath,
+                uint64_t key,
+                std::vector<MeshComponent>& meshes) {
+  std::error_code ec;
+  if (!std::filesystem::exists(cachePath, ec)) {
+    return false;
+  }
+
+  MappedFile file;
+  if (FAILED(file.init(cachePath))) {
+    return false;
+  }
+
+  const char* cursor = file.data();
+  const char* end = file.data() + file.size();
+  if (file.size() < sizeof(MeshCacheHeader)) {
+    ERROR("MeshCache", "load", ("Truncated cache file: " + cachePath).c_str());
+    return false;
+  }
+
+  MeshCacheHeader header;
+  std::memcpy(&header, cursor, sizeof(header));
+  cursor += sizeof(header);
+
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+    MESSAGE("MeshCache", "load", ("Cache format mismatch, reimporting: " + cachePath).c_str());
+    return false;
+  }
+  if (header.key != key) {
+    MESSAGE("MeshCache", "load", ("Cache is stale, reimporting: " + cachePath).c_str());
+    return false;
+  }
+
+  std::vector<MeshComponent> loaded(header.meshCount);
+  for (MeshComponent& mesh : loaded) {
+    MeshCacheEntry entry;
+    if (static_cast<size_t>(end - cursor) < sizeof(entry)) {
+      ERROR("MeshCache", "load", ("Truncated mesh entry: " + cachePath).c_str());
+      return false;
+    }
+    std::memcpy(&entry, cursor, sizeof(entry));
+    cursor += sizeof(entry);
+
+    if (entry.indexStride != sizeof(uint16_t) && entry.indexStride != sizeof(unsigned int)) {
+      ERROR("MeshCache", "load", ("Invalid index stride: " + cachePath).c_str());
+      return false;
+    }
+
+    const size_t nameBytes = align4(entry.nameLength);
+    const size_t vertexBytes = static_cast<size_t>(entry.vertexCount) * sizeof(SimpleVertex);
+    const size_t indexBytes = static_cast<size_t>(entry.indexCount) * entry.indexStride;
+    const size_t lodBytes = static_cast<size_t>(entry.lodCount) * sizeof(MeshLod);
+    const size_t meshletBytes = static_cast<size_t>(entry.meshletCount) * sizeof(Meshlet);
+    if (static_cast<size_t>(end - cursor) <
+        nameBytes + vertexBytes + align4(indexBytes) + lodBytes + meshletBytes) {
+      ERROR("MeshCache", "load", ("Truncated mesh payload: " + cachePath).c_str());
+      return false;
+    }
+
+    mesh.m_name.assign(cursor, entry.nameLength);
+    cursor += nameBytes;
+
+    mesh.m_vertex.resize(entry.vertexCount);
+    if (vertexBytes) std::memcpy(mesh.m_vertex.data(), cursor, vertexBytes);
+    cursor += vertexBytes;
+
+    if (entry.indexStride == sizeof(uint16_t)) {
+      mesh.m_indexFormat = DXGI_FORMAT_R16_UINT;
+      mesh.m_index16.resize(entry.indexCount);
+      if (indexBytes) std::memcpy(mesh.m_index16.data(), cursor, indexBytes);
+    }
+    else {
+      mesh.m_indexFormat = DXGI_FORMAT_R32_UINT;
+      mesh.m_index.resize(entry.indexCount);
+      if (indexBytes) std::memcpy(mesh.m_index.data(), cursor, indexBytes);
+    }
+    cursor += align4(indexBytes);
+
+    mesh.m_lods.resize(entry.lodCount);
+    if (lodBytes) std::memcpy(mesh.m_lods.data(), cursor, lodBytes);
+    cursor += lodBytes;
+    for (const MeshLod& lod : mesh.m_lods) {
+      if (static_cast<uint64_t>(lod.indexStart) + lod.indexCount > entry.indexCount) {
+        ERROR("MeshCache", "load", ("Invalid LOD range: " + cachePath).c_str());
+        return false;
+      }
+    }
+
+    mesh.m_meshlets.resize(entry.meshletCount);
+    if (meshletBytes) std::memcpy(mesh.m_meshlets.data(), cursor, meshletBytes);
+    cursor += meshletBytes;
+    for (const Meshlet& meshlet : mesh.m_meshlets) {
+      if (static_cast<uint64_t>(meshlet.indexStart) + meshlet.indexCount > entry.indexCount) {
+        ERROR("MeshCache", "load", ("Invalid meshlet range: " + cachePath).c_str());
+        return false;
+      }
+    }
+
+    mesh.m_numVertex = static_cast<int>(entry.vertexCount);
+    mesh.m_numIndex = static_cast<int>(entry.indexCount);
+    mesh.m_boundsMin = entry.boundsMin;
+    mesh.m_boundsMax = entry.boundsMax;
+    mesh.m_boundsRadius = entry.boundsRadius;
+  }
+
+  meshes = std::move(loaded);
+  MESSAGE("MeshCache", "load", ("Loaded " + std::to_string(meshes.size()) +
+    " meshes from cache: " + cachePath).c_str());
+  return true;
+}
+
+HRESULT
+MeshCache::save(const std::string& cachePath,
+                uint64_t key,
+                const std::vector<MeshComponent>& meshes) {
+  const std::string tempPath = cachePath + ".tmp";
+  {
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      ERROR("MeshCache", "save", ("Failed to create cache file: " + tempPath).c_str());
+      return E_FAIL;
+    }
+
+    MeshCacheHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.key = key;
+    header.meshCount = static_cast<uint32_t>(meshes.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const char padding[4] = {};
+    for (const MeshComponent& mesh : meshes) {
+      MeshCacheEntry entry = {};
+      entry.nameLength = static_cast<uint32_t>(mesh.m_name.size());
+      entry.vertexCount = static_cast<uint32_t>(mesh.m_vertex.size());
+      entry.indexCount = static_cast<uint32_t>(mesh.getIndexCount());
+      entry.indexStride = mesh.getIndexStride();
+      entry.boundsMin = mesh.m_boundsMin;
+      entry.boundsMax = mesh.m_boundsMax;
+      entry.lodCount = static_cast<uint32_t>(mesh.m_lods.size());
+      entry.boundsRadius = mesh.m_boundsRadius;
+      entry.meshletCount = static_cast<uint32_t>(mesh.m_meshlets.size());
+      out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+
+      out.write(mesh.m_name.data(), mesh.m_name.size());
+      out.write(padding, align4(mesh.m_name.size()) - mesh.m_name.size());
+      out.write(reinterpret_cast<const char*>(mesh.m_vertex.data()),
+                mesh.m_vertex.size() * sizeof(SimpleVertex));
+      const size_t indexBytes = mesh.getIndexCount() * mesh.getIndexStride();
+      out.write(reinterpret_cast<const char*>(mesh.getIndexData()), indexBytes);
+      out.write(padding, align4(indexBytes) - indexBytes);
+      out.write(reinterpret_cast<const char*>(mesh.m_lods.data()), mesh.m_lods.size() * sizeof(MeshLod));
+      out.write(reinterpret_cast<const char*>(mesh.m_meshlets.data()),
+                mesh.m_meshlets.size() * sizeof(Meshlet));
+    }
+
+    if (!out) {
+      ERROR("MeshCache", "save", ("Failed to write cache file: " + tempPath).c_str());
+      return E_FAIL;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tempPath, cachePath, ec);
+  if (ec) {
+    ERROR("MeshCache", "save", ("Failed to replace cache file: " + cachePath).c_str());
+    std::filesystem::remove(tempPath, ec);
+    return E_FAIL;
+  }
+
+  MESSAGE("MeshCache", "save", ("Wrote " + std::to_string(meshes.size()) +
+    " meshes to cache: " + cachePath).c_str());
+  return S_OK;
+}
@@ -0,0 +1,399 @@
+﻿#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  // Parámetros del algoritmo de Forsyth ("Linear-Speed Vertex Cache Optimisation").
+  constexpr unsigned int kForsythCacheSize = 32;
+  constexpr float kCacheDecayPower = 1.5f;
+  constexpr float kLastTriScore = 0.75f;
+  constexpr float kValenceBoostScale = 2.0f;
+  constexpr float kValenceBoostPower = 0.5f;
+
+  // Caché FIFO usada para medir y para cortar clústeres (hardware típico).
+  constexpr unsigned int kFifoCacheSize = 16;
+
+  float
+  forsythVertexScore(int cachePosition, unsigned int remainingTriangles) {
+    if (remainingTriangles == 0) {
+      return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+      if (cachePosition < 3) {
+        // Los vértices del último triángulo reciben un valor fijo para no favorecer tiras largas.
+        score = kLastTriScore;
+      }
+      else {
+        const float scaler = 1.0f / (kForsythCacheSize - 3);
+        score = std::pow(1.0f - (cachePosition - 3) * scaler, kCacheDecayPower);
+      }
+    }
+
+    // Favorece vértices con pocos triángulos pendientes para no dejarlos aislados.
+    score += kValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -kValenceBoostPower);
+    return score;
+  }
+
+  /**
+   * @brief Simulador de caché FIFO basado en marcas de tiempo.
+   */
+  struct FifoCache {
+    std::vector<unsigned int> stamps;
+    unsigned int time;
+    unsigned int size;
+
+    FifoCache(size_t vertexCount, unsigned int cacheSize)
+      : stamps(vertexCount, 0), time(cacheSize + 1), size(cacheSize) {}
+
+    bool
+    access(unsigned int vertex) {
+      if (time - stamps[vertex] > size) {
+        stamps[vertex] = time++;
+        return true;
+      }
+      return false;
+    }
+
+    void
+    reset() { time += size + 1; }
+  };
+
+  XMFLOAT3
+  sub3(const XMFLOAT3& a, const XMFLOAT3& b) {
+    return XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z);
+  }
+
+  XMFLOAT3
+  cross3(const XMFLOAT3& a, const XMFLOAT3& b) {
+    return XMFLOAT3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+  }
+}
+
+HRESULT
+MeshOptimizer::optimize(MeshComponent& mesh, bool reduceOverdraw) {
+  if (mesh.m_index.size() % 3 != 0) {
+    ERROR("MeshOptimizer", "optimize", ("Index count is not a multiple of 3: " + mesh.m_name).c_str());
+    return E_INVALIDARG;
+  }
+  for (unsigned int index : mesh.m_index) {
+    if (index >= mesh.m_vertex.size()) {
+      ERROR("MeshOptimizer", "optimize", ("Index out of range in mesh: " + mesh.m_name).c_str());
+      return E_INVALIDARG;
+    }
+  }
+  if (mesh.m_index.empty()) {
+    return S_OK;
+  }
+
+  const VertexCacheStats before = analyzeVertexCache(mesh.m_index, mesh.m_vertex.size());
+
+  optimizeVertexCache(mesh.m_index, mesh.m_vertex.size());
+  if (reduceOverdraw) {
+    optimizeOverdraw(mesh.m_index, mesh.m_vertex);
+  }
+  optimizeVertexFetch(mesh.m_vertex, mesh.m_index);
+
+  mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+  mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+
+  const VertexCacheStats after = analyzeVertexCache(mesh.m_index, mesh.m_vertex.size());
+  MESSAGE("MeshOptimizer", "optimize", (mesh.m_name +
+    " ACMR " + std::to_string(before.acmr) + " -> " + std::to_string(after.acmr) +
+    ", ATVR " + std::to_string(before.atvr) + " -> " + std::to_string(after.atvr)).c_str());
+  return S_OK;
+}
+
+void
+MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+  const size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0 || vertexCount == 0) {
+    return;
+  }
+
+  // 1) Adyacencia vértice -> triángulos. Los triángulos vivos de v ocupan
+  //    adjacency[offsets[v], offsets[v] + remaining[v]).
+  std::vector<unsigned int> remaining(vertexCount, 0);
+  for (unsigned int index : indices) {
+    ++remaining[index];
+  }
+  std::vector<unsigned int> offsets(vertexCount + 1, 0);
+  for (size_t v = 0; v < vertexCount; ++v) {
+    offsets[v + 1] = offsets[v] + remaining[v];
+  }
+  std::vector<unsigned int> adjacency(indices.size());
+  {
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; ++t) {
+      for (size_t k = 0; k < 3; ++k) {
+        adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>(t);
+      }
+    }
+  }
+
+  // 2) Puntuaciones iniciales.
+  std::vector<int> cachePosition(vertexCount, -1);
+  std::vector<float> vertexScore(vertexCount);
+  for (size_t v = 0; v < vertexCount; ++v) {
+    vertexScore[v] = forsythVertexScore(-1, remaining[v]);
+  }
+  std::vector<float> triangleScore(triangleCount);
+  std::vector<char> emitted(triangleCount, 0);
+  int best = -1;
+  float bestScore = -1.0f;
+  for (size_t t = 0; t < triangleCount; ++t) {
+    triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] +
+                       vertexScore[indices[t * 3 + 2]];
+    if (triangleScore[t] > bestScore) {
+      bestScore = triangleScore[t];
+      best = static_cast<int>(t);
+    }
+  }
+
+  // 3) Emisión voraz del mejor triángulo entre los adyacentes a la caché.
+  std::vector<unsigned int> output;
+  output.reserve(indices.size());
+  std::vector<unsigned int> cache;
+  std::vector<unsigned int> nextCache;
+  cache.reserve(kForsythCacheSize + 3);
+  nextCache.reserve(kForsythCacheSize + 3);
+  size_t scanCursor = 0;
+
+  for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+    if (best < 0) {
+      // La caché no toca triángulos pendientes: se continúa con el siguiente en orden original.
+      while (emitted[scanCursor]) ++scanCursor;
+      best = static_cast<int>(scanCursor);
+    }
+
+    const unsigned int* triangle = &indices[static_cast<size_t>(best) * 3];
+    output.insert(output.end(), triangle, triangle + 3);
+    emitted[best] = 1;
+
+    nextCache.clear();
+    for (size_t k = 0; k < 3; ++k) {
+      const unsigned int v = triangle[k];
+
+      unsigned int* live = &adjacency[offsets[v]];
+      for (unsigned int j = 0; j < remaining[v]; ++j) {
+        if (live[j] == static_cast<unsigned int>(best)) {
+          live[j] = live[remaining[v] - 1];
+          break;
+        }
+      }
+      --remaining[v];
+
+      if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end()) {
+        nextCache.push_back(v);
+      }
+    }
+    for (unsigned int v : cache) {
+      if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+        nextCache.push_back(v);
+      }
+    }
+
+    // Actualiza posiciones (los que salen de la caché quedan en -1) y puntuaciones.
+    for (size_t i = 0; i < nextCache.size(); ++i) {
+      const unsigned int v = nextCache[i];
+      cachePosition[v] = (i < kForsythCacheSize) ? static_cast<int>(i) : -1;
+
+      const float score = forsythVertexScore(cachePosition[v], remaining[v]);
+      const float delta = score - vertexScore[v];
+      vertexScore[v] = score;
+      for (unsigned int j = 0; j < remaining[v]; ++j) {
+        triangleScore[adjacency[offsets[v] + j]] += delta;
+      }
+    }
+    if (nextCache.size() > kForsythCacheSize) {
+      nextCache.resize(kForsythCacheSize);
+    }
+    cache.swap(nextCache);
+
+    best = -1;
+    bestScore = -1.0f;
+    for (unsigned int v : cache) {
+      for (unsigned int j = 0; j < remaining[v]; ++j) {
+        const unsigned int t = adjacency[offsets[v] + j];
+        if (triangleScore[t] > bestScore) {
+          bestScore = triangleScore[t];
+          best = static_cast<int>(t);
+        }
+      }
+    }
+  }
+
+  indices.swap(output);
+}
+
+void
+MeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& indices,
+                                const std::vector<SimpleVertex>& vertices,
+                                float threshold) {
+  const size_t triangleCount = indices.size() / 3;
+  if (triangleCount < 2) {
+    return;
+  }
+
+  // 1) Límites duros: triángulos con tres fallos, donde la caché ya se reinició.
+  std::vector<size_t> hardClusters;
+  {
+    FifoCache cache(vertices.size(), kFifoCacheSize);
+    for (size_t t = 0; t < triangleCount; ++t) {
+      unsigned int misses = 0;
+      for (size_t k = 0; k < 3; ++k) {
+        misses += cache.access(indices[t * 3 + k]) ? 1 : 0;
+      }
+      if (t == 0 || misses == 3) {
+        hardClusters.push_back(t);
+      }
+    }
+  }
+  hardClusters.push_back(triangleCount);
+
+  // 2) Límites suaves: se parte un clúster cuando su ACMR acumulado ya está
+  //    dentro del umbral respecto al ACMR del clúster completo.
+  std::vector<size_t> clusters;
+  {
+    FifoCache cache(vertices.size(), kFifoCacheSize);
+    for (size_t c = 0; c + 1 < hardClusters.size(); ++c) {
+      const size_t start = hardClusters[c];
+      const size_t end = hardClusters[c + 1];
+
+      cache.reset();
+      unsigned int clusterMisses = 0;
+      for (size_t i = start * 3; i < end * 3; ++i) {
+        clusterMisses += cache.access(indices[i]) ? 1 : 0;
+      }
+      const float clusterThreshold = threshold * clusterMisses / static_cast<float>(end - start);
+
+      cache.reset();
+      size_t runStart = start;
+      unsigned int runMisses = 0;
+      clusters.push_back(start);
+      for (size_t t = start; t < end; ++t) {
+        for (size_t k = 0; k < 3; ++k) {
+          runMisses += cache.access(indices[t * 3 + k]) ? 1 : 0;
+        }
+        const size_t runSize = t - runStart + 1;
+        if (t + 1 < end && runMisses <= clusterThreshold * runSize) {
+          clusters.push_back(t + 1);
+          runStart = t + 1;
+          runMisses = 0;
+          cache.reset();
+        }
+      }
+    }
+  }
+  clusters.push_back(triangleCount);
+
+  // 3) Centroide y normal ponderados por área de la malla y de cada clúster.
+  XMFLOAT3 meshCentroid(0.0f, 0.0f, 0.0f);
+  float meshArea = 0.0f;
+  const size_t clusterCount = clusters.size() - 1;
+  std::vector<XMFLOAT3> clusterCentroid(clusterCount, XMFLOAT3(0.0f, 0.0f, 0.0f));
+  std::vector<XMFLOAT3> clusterNormal(clusterCount, XMFLOAT3(0.0f, 0.0f, 0.0f));
+  std::vector<float> clusterArea(clusterCount, 0.0f);
+
+  for (size_t c = 0; c < clusterCount; ++c) {
+    for (size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+      const XMFLOAT3& p0 = vertices[indices[t * 3]].Pos;
+      const XMFLOAT3& p1 = vertices[indices[t * 3 + 1]].Pos;
+      const XMFLOAT3& p2 = vertices[indices[t * 3 + 2]].Pos;
+
+      // Con la convención horaria de D3D, cross(p1 - p0, p2 - p0) apunta hacia afuera.
+      const XMFLOAT3 n = cross3(sub3(p1, p0), sub3(p2, p0));
+      const float area = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+      const XMFLOAT3 center((p0.x + p1.x + p2.x) / 3.0f,
+                            (p0.y + p1.y + p2.y) / 3.0f,
+                            (p0.z + p1.z + p2.z) / 3.0f);
+
+      clusterCentroid[c].x += center.x * area;
+      clusterCentroid[c].y += center.y * area;
+      clusterCentroid[c].z += center.z * area;
+      clusterNormal[c].x += n.x;
+      clusterNormal[c].y += n.y;
+      clusterNormal[c].z += n.z;
+      clusterArea[c] += area;
+    }
+    meshCentroid.x += clusterCentroid[c].x;
+    meshCentroid.y += clusterCentroid[c].y;
+    meshCentroid.z += clusterCentroid[c].z;
+    meshArea += clusterArea[c];
+  }
+  if (meshArea > 0.0f) {
+    meshCentroid = XMFLOAT3(meshCentroid.x / meshArea, meshCentroid.y / meshArea, meshCentroid.z / meshArea);
+  }
+
+  // 4) Clústeres más "exteriores" primero: ocluyen a los interiores y evitan overdraw.
+  std::vector<float> sortKey(clusterCount, 0.0f);
+  for (size_t c = 0; c < clusterCount; ++c) {
+    const XMFLOAT3& n = clusterNormal[c];
+    const float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+    if (clusterArea[c] <= 0.0f || length <= 0.0f) {
+      continue;
+    }
+    const float inv = 1.0f / clusterArea[c];
+    const XMFLOAT3 offset(clusterCentroid[c].x * inv - meshCentroid.x,
+                          clusterCentroid[c].y * inv - meshCentroid.y,
+                          clusterCentroid[c].z * inv - meshCentroid.z);
+    sortKey[c] = (offset.x * n.x + offset.y * n.y + offset.z * n.z) / length;
+  }
+
+  std::vector<size_t> order(clusterCount);
+  for (size_t c = 0; c < clusterCount; ++c) order[c] = c;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return sortKey[a] > sortKey[b];
+  });
+
+  std::vector<unsigned int> output;
+  output.reserve(indices.size());
+  for (size_t c : order) {
+    output.insert(output.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+  }
+  indices.swap(output);
+}
+
+void
+MeshOptimizer::optimizeVertexFetch(std::vector<SimpleVertex>& vertices, std::vector<unsigned int>& indices) {
+  const unsigned int kUnassigned = static_cast<unsigned int>(-1);
+  std::vector<unsigned int> remap(vertices.size(), kUnassigned);
+  std::vector<SimpleVertex> reordered;
+  reordered.reserve(vertices.size());
+
+  for (unsigned int& index : indices) {
+    if (remap[index] == kUnassigned) {
+      remap[index] = static_cast<unsigned int>(reordered.size());
+      reordered.push_back(vertices[index]);
+    }
+    index = remap[index];
+  }
+
+  vertices.swap(reordered);
+}
+
+VertexCacheStats
+MeshOptimizer::analyzeVertexCache(const std::vector<unsigned int>& indices,
+                                  size_t vertexCount,
+                                  unsigned int cacheSize) {
+  VertexCacheStats stats;
+  if (indices.size() < 3 || vertexCount == 0) {
+    return stats;
+  }
+
+  FifoCache cache(vertexCount, cacheSize);
+  size_t misses = 0;
+  for (unsigned int index : indices) {
+    misses += cache.access(index) ? 1 : 0;
+  }
+
+  size_t uniqueVertices = 0;
+  for (unsigned int stamp : cache.stamps) {
+    uniqueVertices += (stamp != 0) ? 1 : 0;
+  }
+
+  stats.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+  stats.atvr = static_cast<float>(misses) / static_cast<float>(uniqueVertices);
+  return stats;
+}
@@ -0,0 +1,438 @@
+﻿#include "MeshSimplifier.h"
+#include "MeshComponent.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  const double kBorderWeight = 10.0;
+
+  /**
+   * @brief Cuádrica simétrica (A, b, c) acumulada con su peso total.
+   */
+  struct Quadric {
+    double a00 = 0, a11 = 0, a22 = 0, a01 = 0, a02 = 0, a12 = 0;
+    double b0 = 0, b1 = 0, b2 = 0, c = 0;
+    double w = 0;
+
+    void
+    addPlane(double nx, double ny, double nz, double d, double weight) {
+      a00 += nx * nx * weight; a11 += ny * ny * weight; a22 += nz * nz * weight;
+      a01 += nx * ny * weight; a02 += nx * nz * weight; a12 += ny * nz * weight;
+      b0 += nx * d * weight; b1 += ny * d * weight; b2 += nz * d * weight;
+      c += d * d * weight;
+      w += weight;
+    }
+
+    void
+    add(const Quadric& q) {
+      a00 += q.a00; a11 += q.a11; a22 += q.a22;
+      a01 += q.a01; a02 += q.a02; a12 += q.a12;
+      b0 += q.b0; b1 += q.b1; b2 += q.b2;
+      c += q.c; w += q.w;
+    }
+
+    /**
+     * @brief Distancia cuadrática media de @p p a los planos acumulados.
+     */
+    double
+    evaluate(const XMFLOAT3& p) const {
+      const double x = p.x, y = p.y, z = p.z;
+      const double r = a00 * x * x + a11 * y * y + a22 * z * z +
+                       2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                       2.0 * (b0 * x + b1 * y + b2 * z) + c;
+      return w > 0.0 ? std::fabs(r) / w : 0.0;
+    }
+  };
+
+  struct Vec3 {
+    double x, y, z;
+  };
+
+  inline Vec3
+  sub(const XMFLOAT3& a, const XMFLOAT3& b) {
+    return { double(a.x) - b.x, double(a.y) - b.y, double(a.z) - b.z };
+  }
+
+  inline Vec3
+  cross(const Vec3& a, const Vec3& b) {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+  }
+
+  inline double
+  dot(const Vec3& a, const Vec3& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+  }
+
+  inline double
+  length(const Vec3& a) {
+    return std::sqrt(dot(a, a));
+  }
+
+  struct PositionHash {
+    size_t operator()(const XMFLOAT3& p) const {
+      uint32_t bits[3];
+      std::memcpy(bits, &p, sizeof(bits));
+      uint64_t h = 14695981039346656037ull;
+      for (uint32_t word : bits) {
+        h = (h ^ word) * 1099511628211ull;
+      }
+      return static_cast<size_t>(h ^ (h >> 32));
+    }
+  };
+
+  struct PositionEqual {
+    bool operator()(const XMFLOAT3& a, const XMFLOAT3& b) const {
+      return std::memcmp(&a, &b, sizeof(XMFLOAT3)) == 0;
+    }
+  };
+
+  inline uint64_t
+  edgeKey(unsigned int a, unsigned int b) {
+    return (static_cast<uint64_t>(a) << 32) | b;
+  }
+
+  enum VertexKind : uint8_t {
+    kManifold,  ///< Interior; puede colapsar en cualquier dirección.
+    kBorder,    ///< En un borde abierto; solo colapsa a lo largo del borde.
+    kLocked     ///< Arista no manifold; nunca se elimina.
+  };
+
+  struct Collapse {
+    unsigned int from;
+    unsigned int to;
+    double cost;
+  };
+}
+
+size_t
+MeshSimplifier::simplify(const std::vector<SimpleVertex>& vertices,
+                         const std::vector<unsigned int>& indices,
+                         size_t targetIndexCount,
+                         float targetError,
+                         std::vector<unsigned int>& out,
+                         float* resultError) {
+  out = indices;
+  if (resultError) {
+    *resultError = 0.0f;
+  }
+  const size_t vertexCount = vertices.size();
+  if (indices.size() % 3 != 0 || indices.size() <= targetIndexCount || vertexCount == 0) {
+    return out.size();
+  }
+
+  // 1) Clases de posición: vértices en la misma posición (costuras de UV) son "cuñas" de una clase.
+  std::vector<unsigned int> classOf(vertexCount);
+  std::vector<XMFLOAT3> classPosition;
+  {
+    std::unordered_map<XMFLOAT3, unsigned int, PositionHash, PositionEqual> classes;
+    classes.reserve(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+      auto inserted = classes.emplace(vertices[v].Pos, static_cast<unsigned int>(classPosition.size()));
+      if (inserted.second) {
+        classPosition.push_back(vertices[v].Pos);
+      }
+      classOf[v] = inserted.first->second;
+    }
+  }
+  const size_t classCount = classPosition.size();
+
+  // 2) Cuádricas por clase: planos de los triángulos ponderados por área.
+  std::vector<Quadric> quadrics(classCount);
+  for (size_t t = 0; t + 2 < out.size(); t += 3) {
+    const unsigned int c0 = classOf[out[t]], c1 = classOf[out[t + 1]], c2 = classOf[out[t + 2]];
+    const Vec3 n = cross(sub(classPosition[c1], classPosition[c0]), sub(classPosition[c2], classPosition[c0]));
+    const double area2 = length(n);
+    if (area2 <= 0.0) {
+      continue;
+    }
+    const Vec3 u = { n.x / area2, n.y / area2, n.z / area2 };
+    const double d = -(u.x * classPosition[c0].x + u.y * classPosition[c0].y + u.z * classPosition[c0].z);
+    quadrics[c0].addPlane(u.x, u.y, u.z, d, area2 * 0.5);
+    quadrics[c1].addPlane(u.x, u.y, u.z, d, area2 * 0.5);
+    quadrics[c2].addPlane(u.x, u.y, u.z, d, area2 * 0.5);
+  }
+
+  // Planos perpendiculares en los bordes abiertos para conservar la silueta.
+  {
+    std::unordered_map<uint64_t, uint32_t> edges;
+    edges.reserve(out.size());
+    for (size_t i = 0; i < out.size(); ++i) {
+      const size_t t = i - i % 3;
+      const unsigned int a = classOf[out[i]];
+      const unsigned int b = classOf[out[t + (i + 1) % 3]];
+      ++edges[edgeKey(a, b)];
+    }
+    for (size_t t = 0; t + 2 < out.size(); t += 3) {
+      const unsigned int c[3] = { classOf[out[t]], classOf[out[t + 1]], classOf[out[t + 2]] };
+      const Vec3 n = cross(sub(classPosition[c[1]], classPosition[c[0]]), sub(classPosition[c[2]], classPosition[c[0]]));
+      for (int e = 0; e < 3; ++e) {
+        const unsigned int a = c[e], b = c[(e + 1) % 3];
+        if (edges.count(edgeKey(b, a))) {
+          continue;
+        }
+        const Vec3 edge = sub(classPosition[b], classPosition[a]);
+        Vec3 p = cross(edge, n);
+        const double plen = length(p);
+        if (plen <= 0.0) {
+          continue;
+        }
+        p = { p.x / plen, p.y / plen, p.z / plen };
+        const double d = -(p.x * classPosition[a].x + p.y * classPosition[a].y + p.z * classPosition[a].z);
+        const double weight = dot(edge, edge) * kBorderWeight;
+        quadrics[a].addPlane(p.x, p.y, p.z, d, weight);
+        quadrics[b].addPlane(p.x, p.y, p.z, d, weight);
+      }
+    }
+  }
+
+  const double errorLimit = static_cast<double>(targetError) * targetError;
+  const size_t targetTriangles = targetIndexCount / 3;
+  double maxCost = 0.0;
+
+  std::vector<unsigned int> vertexRemap(vertexCount);
+  for (size_t v = 0; v < vertexCount; ++v) {
+    vertexRemap[v] = static_cast<unsigned int>(v);
+  }
+  auto resolve = [&vertexRemap](unsigned int v) {
+    while (vertexRemap[v] != v) {
+      v = vertexRemap[v];
+    }
+    return v;
+  };
+
+  std::vector<unsigned int> adjacencyOffset(classCount + 1);
+  std::vector<unsigned int> adjacency;
+  std::vector<uint8_t> kind(classCount);
+  std::vector<uint8_t> locked(classCount);
+  std::vector<Collapse> candidates;
+  std::unordered_map<uint64_t, uint32_t> edges;
+  std::vector<std::pair<unsigned int, unsigned int>> wedgePairs;
+  std::vector<unsigned int> fromWedges;
+
+  while (out.size() / 3 > targetTriangles) {
+    const size_t triangleCount = out.size() / 3;
+
+    // 3) Adyacencia clase -> triángulos (CSR) y clasificación de aristas.
+    std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0u);
+    for (unsigned int v : out) {
+      ++adjacencyOffset[classOf[v] + 1];
+    }
+    for (size_t c = 0; c < classCount; ++c) {
+      adjacencyOffset[c + 1] += adjacencyOffset[c];
+    }
+    adjacency.resize(out.size());
+    {
+      std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+      for (size_t i = 0; i < out.size(); ++i) {
+        adjacency[fill[classOf[out[i]]]++] = static_cast<unsigned int>(i / 3);
+      }
+    }
+
+    edges.clear();
+    for (size_t i = 0; i < out.size(); ++i) {
+      const size_t t = i - i % 3;
+      ++edges[edgeKey(classOf[out[i]], classOf[out[t + (i + 1) % 3]])];
+    }
+    std::fill(kind.begin(), kind.end(), static_cast<uint8_t>(kManifold));
+    for (const auto& edge : edges) {
+      const unsigned int a = static_cast<unsigned int>(edge.first >> 32);
+      const unsigned int b = static_cast<unsigned int>(edge.first & 0xFFFFFFFFu);
+      if (edge.second > 1) {
+        kind[a] = kind[b] = kLocked;
+      }
+      else if (!edges.count(edgeKey(b, a))) {
+        if (kind[a] != kLocked) kind[a] = kBorder;
+        if (kind[b] != kLocked) kind[b] = kBorder;
+      }
+    }
+    auto isBorderEdge = [&](unsigned int a, unsigned int b) {
+      return !edges.count(edgeKey(a, b)) || !edges.count(edgeKey(b, a));
+    };
+    auto canCollapse = [&](unsigned int from, unsigned int to) {
+      return kind[from] == kManifold || (kind[from] == kBorder && isBorderEdge(from, to));
+    };
+
+    // 4) Candidatos: la dirección más barata de cada arista.
+    candidates.clear();
+    for (size_t i = 0; i < out.size(); ++i) {
+      const size_t t = i - i % 3;
+      const unsigned int a = classOf[out[i]];
+      const unsigned int b = classOf[out[t + (i + 1) % 3]];
+      if (a == b || (a > b && edges.count(edgeKey(b, a)))) {
+        continue;
+      }
+      const double costAB = canCollapse(a, b) ? quadrics[a].evaluate(classPosition[b]) : HUGE_VAL;
+      const double costBA = canCollapse(b, a) ? quadrics[b].evaluate(classPosition[a]) : HUGE_VAL;
+      if (costAB <= costBA && costAB < HUGE_VAL) {
+        candidates.push_back({ a, b, costAB });
+      }
+      else if (costBA < HUGE_VAL) {
+        candidates.push_back({ b, a, costBA });
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Collapse& l, const Collapse& r) { return l.cost < r.cost; });
+
+    // 5) Aplica colapsos en orden de costo; los extremos quedan bloqueados hasta la siguiente pasada.
+    std::fill(locked.begin(), locked.end(), static_cast<uint8_t>(0));
+    size_t remaining = triangleCount;
+    size_t applied = 0;
+    for (const Collapse& collapse : candidates) {
+      if (collapse.cost > errorLimit || remaining <= targetTriangles) {
+        break;
+      }
+      if (locked[collapse.from] || locked[collapse.to]) {
+        continue;
+      }
+
+      // Cuñas: cada cuña de "from" que aparece en un triángulo con "to" debe tener un único destino.
+      wedgePairs.clear();
+      fromWedges.clear();
+      bool valid = true;
+      for (unsigned int k = adjacencyOffset[collapse.from]; k < adjacencyOffset[collapse.from + 1] && valid; ++k) {
+        const size_t t = static_cast<size_t>(adjacency[k]) * 3;
+        const unsigned int v[3] = { resolve(out[t]), resolve(out[t + 1]), resolve(out[t + 2]) };
+        const unsigned int c[3] = { classOf[v[0]], classOf[v[1]], classOf[v[2]] };
+        if (c[0] == c[1] || c[1] == c[2] || c[0] == c[2]) {
+          continue;
+        }
+
+        int fromCorner = -1, toCorner = -1;
+        for (int j = 0; j < 3; ++j) {
+          if (c[j] == collapse.from) fromCorner = j;
+          if (c[j] == collapse.to) toCorner = j;
+        }
+        if (fromCorner < 0) {
+          continue;
+        }
+        fromWedges.push_back(v[fromCorner]);
+        if (toCorner >= 0) {
+          wedgePairs.emplace_back(v[fromCorner], v[toCorner]);
+          continue;
+        }
+
+        // Triángulo que sobrevive: no debe invertirse al mover el vértice.
+        const XMFLOAT3& p1 = classPosition[c[(fromCorner + 1) % 3]];
+        const XMFLOAT3& p2 = classPosition[c[(fromCorner + 2) % 3]];
+        const Vec3 before = cross(sub(p1, classPosition[collapse.from]), sub(p2, classPosition[collapse.from]));
+        const Vec3 after = cross(sub(p1, classPosition[collapse.to]), sub(p2, classPosition[collapse.to]));
+        if (dot(before, after) <= 1e-2 * length(before) * length(after)) {
+          valid = false;
+        }
+      }
+      if (!valid || wedgePairs.empty()) {
+        continue;
+      }
+      for (size_t i = 0; i < wedgePairs.size() && valid; ++i) {
+        for (size_t j = i + 1; j < wedgePairs.size(); ++j) {
+          if (wedgePairs[i].first == wedgePairs[j].first && wedgePairs[i].second != wedgePairs[j].second) {
+            valid = false;
+            break;
+          }
+        }
+      }
+      if (!valid) {
+        continue;
+      }
+
+      // Una cuña de "from" que no toca la arista (p. ej. colapso a través de una costura) no tiene destino.
+      for (unsigned int wedge : fromWedges) {
+        bool paired = false;
+        for (const auto& pair : wedgePairs) {
+          paired |= pair.first == wedge;
+        }
+        if (!paired) {
+          valid = false;
+          break;
+        }
+      }
+      if (!valid) {
+        continue;
+      }
+
+      for (const auto& pair : wedgePairs) {
+        vertexRemap[pair.first] = pair.second;
+      }
+      quadrics[collapse.to].add(quadrics[collapse.from]);
+      locked[collapse.from] = locked[collapse.to] = 1;
+      maxCost = (std::max)(maxCost, collapse.cost);
+      remaining -= (kind[collapse.from] == kBorder) ? 1 : 2;
+      ++applied;
+    }
+
+    if (applied == 0) {
+      break;
+    }
+
+    // 6) Reescribe los índices y descarta los triángulos degenerados.
+    size_t write = 0;
+    for (size_t t = 0; t + 2 < out.size(); t += 3) {
+      const unsigned int v0 = resolve(out[t]), v1 = resolve(out[t + 1]), v2 = resolve(out[t + 2]);
+      if (classOf[v0] == classOf[v1] || classOf[v1] == classOf[v2] || classOf[v0] == classOf[v2]) {
+        continue;
+      }
+      out[write++] = v0;
+      out[write++] = v1;
+      out[write++] = v2;
+    }
+    out.resize(write);
+  }
+
+  if (resultError) {
+    *resultError = static_cast<float>(std::sqrt(maxCost));
+  }
+  return out.size();
+}
+
+void
+MeshSimplifier::buildLods(MeshComponent& mesh, const LodChainDesc& desc) {
+  mesh.m_lods.clear();
+  if (desc.triangleRatios.empty() || mesh.m_index.empty() || mesh.m_indexFormat != DXGI_FORMAT_R32_UINT) {
+    return;
+  }
+
+  const Vec3 extent = sub(mesh.m_boundsMax, mesh.m_boundsMin);
+  const float errorLimit = static_cast<float>(desc.maxError * length(extent));
+  const size_t baseCount = mesh.m_index.size();
+
+  std::vector<unsigned int> chain = mesh.m_index;
+  std::vector<MeshLod> lods = { { 0u, static_cast<uint32_t>(baseCount), 0.0f } };
+  std::vector<unsigned int> previous = mesh.m_index;
+  std::vector<unsigned int> level;
+  float accumulatedError = 0.0f;
+
+  for (float ratio : desc.triangleRatios) {
+    const size_t target = static_cast<size_t>(baseCount * ratio) / 3 * 3;
+    if (target < 3) {
+      break;
+    }
+
+    float error = 0.0f;
+    simplify(mesh.m_vertex, previous, target, errorLimit, level, &error);
+    if (level.empty() || level.size() * 10 > previous.size() * 9) {
+      break;
+    }
+
+    MeshOptimizer::optimizeVertexCache(level, mesh.m_vertex.size());
+    accumulatedError += error;
+    lods.push_back({ static_cast<uint32_t>(chain.size()), static_cast<uint32_t>(level.size()), accumulatedError });
+    chain.insert(chain.end(), level.begin(), level.end());
+    previous.swap(level);
+  }
+
+  if (lods.size() < 2) {
+    return;
+  }
+
+  std::ostringstream summary;
+  summary << mesh.m_name << " LODs:";
+  for (const MeshLod& lod : lods) {
+    summary << " " << lod.indexCount / 3 << " tris (err " << lod.error << ")";
+  }
+  MESSAGE("MeshSimplifier", "buildLods", summary.str().c_str());
+
+  mesh.m_index.swap(chain);
+  mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+  mesh.m_lods = std::move(lods);
+}
@@ -0,0 +1,329 @@
+﻿#include "MeshletBuilder.h"
+#include "MeshComponent.h"
+#include "FrustumCuller.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  const uint8_t kNotInMeshlet = 0xff;
+
+  /**
+   * @brief Estado del clúster que se está construyendo.
+   */
+  struct MeshletState {
+    std::vector<uint32_t> vertices;   ///< Vértices únicos (índices de la malla).
+    std::vector<uint32_t> triangles;  ///< Triángulos (índice de triángulo del LOD 0).
+    XMFLOAT3 centroidSum = XMFLOAT3(0.0f, 0.0f, 0.0f);
+  };
+
+  inline XMFLOAT3
+  triangleCentroid(const std::vector<SimpleVertex>& vertices, const unsigned int* tri) {
+    const XMFLOAT3& a = vertices[tri[0]].Pos;
+    const XMFLOAT3& b = vertices[tri[1]].Pos;
+    const XMFLOAT3& c = vertices[tri[2]].Pos;
+    return XMFLOAT3((a.x + b.x + c.x) / 3.0f, (a.y + b.y + c.y) / 3.0f, (a.z + b.z + c.z) / 3.0f);
+  }
+
+  /**
+   * @brief Calcula esfera y cono de normales del clúster y lo agrega a @p meshlets.
+   */
+  void
+  emitMeshlet(const std::vector<SimpleVertex>& vertices,
+              const unsigned int* indices,
+              const MeshletState& state,
+              uint32_t indexStart,
+              std::vector<Meshlet>& meshlets) {
+    Meshlet meshlet = {};
+    meshlet.indexStart = indexStart;
+    meshlet.indexCount = static_cast<uint32_t>(state.triangles.size() * 3);
+
+    // Esfera centrada en la caja de los vértices del clúster.
+    XMFLOAT3 lo = vertices[state.vertices[0]].Pos;
+    XMFLOAT3 hi = lo;
+    for (uint32_t v : state.vertices) {
+      const XMFLOAT3& p = vertices[v].Pos;
+      lo.x = (std::min)(lo.x, p.x); lo.y = (std::min)(lo.y, p.y); lo.z = (std::min)(lo.z, p.z);
+      hi.x = (std::max)(hi.x, p.x); hi.y = (std::max)(hi.y, p.y); hi.z = (std::max)(hi.z, p.z);
+    }
+    meshlet.center = XMFLOAT3((lo.x + hi.x) * 0.5f, (lo.y + hi.y) * 0.5f, (lo.z + hi.z) * 0.5f);
+    float radiusSq = 0.0f;
+    for (uint32_t v : state.vertices) {
+      const XMFLOAT3& p = vertices[v].Pos;
+      const float dx = p.x - meshlet.center.x, dy = p.y - meshlet.center.y, dz = p.z - meshlet.center.z;
+      radiusSq = (std::max)(radiusSq, dx * dx + dy * dy + dz * dz);
+    }
+    meshlet.radius = std::sqrt(radiusSq);
+
+    // Cono: eje = promedio de normales unitarias; apertura = normal más alejada del eje.
+    std::vector<XMFLOAT3> normals;
+    normals.reserve(state.triangles.size());
+    XMFLOAT3 axis(0.0f, 0.0f, 0.0f);
+    for (uint32_t t : state.triangles) {
+      const unsigned int* tri = indices + t * 3;
+      const XMFLOAT3& a = vertices[tri[0]].Pos;
+      const XMFLOAT3& b = vertices[tri[1]].Pos;
+      const XMFLOAT3& c = vertices[tri[2]].Pos;
+      const float e1x = b.x - a.x, e1y = b.y - a.y, e1z = b.z - a.z;
+      const float e2x = c.x - a.x, e2y = c.y - a.y, e2z = c.z - a.z;
+      XMFLOAT3 n(e1y * e2z - e1z * e2y, e1z * e2x - e1x * e2z, e1x * e2y - e1y * e2x);
+      const float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+      if (length <= 0.0f) {
+        continue;
+      }
+      n.x /= length; n.y /= length; n.z /= length;
+      normals.push_back(n);
+      axis.x += n.x; axis.y += n.y; axis.z += n.z;
+    }
+
+    meshlet.coneAxis = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    meshlet.coneCutoff = 1.0f;
+    const float axisLength = std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+    if (axisLength > 0.0f) {
+      axis.x /= axisLength; axis.y /= axisLength; axis.z /= axisLength;
+      float minDot = 1.0f;
+      for (const XMFLOAT3& n : normals) {
+        minDot = (std::min)(minDot, n.x * axis.x + n.y * axis.y + n.z * axis.z);
+      }
+      meshlet.coneAxis = axis;
+      // Con un cono de más de ~84 grados el clúster nunca queda completamente de espaldas.
+      if (minDot > 0.1f) {
+        meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+      }
+    }
+    meshlets.push_back(meshlet);
+  }
+}
+
+void
+MeshletBuilder::build(MeshComponent& mesh) {
+  mesh.m_meshlets.clear();
+  if (mesh.m_indexFormat != DXGI_FORMAT_R32_UINT || mesh.m_vertex.empty() || mesh.m_index.empty()) {
+    return;
+  }
+
+  const MeshLod lod0 = mesh.getLod(0);
+  const size_t triangleCount = lod0.indexCount / 3;
+  const size_t vertexCount = mesh.m_vertex.size();
+  if (triangleCount == 0) {
+    return;
+  }
+  const std::vector<SimpleVertex>& vertices = mesh.m_vertex;
+  const unsigned int* indices = mesh.m_index.data() + lod0.indexStart;
+
+  // Adyacencia vértice -> triángulos (CSR). liveCount[v] se reduce al emitir triángulos.
+  std::vector<uint32_t> offsets(vertexCount + 1, 0);
+  for (size_t i = 0; i < triangleCount * 3; ++i) {
+    ++offsets[indices[i] + 1];
+  }
+  for (size_t v = 0; v < vertexCount; ++v) {
+    offsets[v + 1] += offsets[v];
+  }
+  std::vector<uint32_t> adjacency(triangleCount * 3);
+  std::vector<uint32_t> liveCount(vertexCount, 0);
+  for (size_t t = 0; t < triangleCount; ++t) {
+    for (int k = 0; k < 3; ++k) {
+      const unsigned int v = indices[t * 3 + k];
+      adjacency[offsets[v] + liveCount[v]++] = static_cast<uint32_t>(t);
+    }
+  }
+
+  std::vector<uint8_t> emitted(triangleCount, 0);
+  std::vector<uint8_t> localIndex(vertexCount, kNotInMeshlet);
+  std::vector<unsigned int> reordered;
+  reordered.reserve(triangleCount * 3);
+  std::vector<unsigned int> local;
+  local.reserve(kMaxTriangles * 3);
+
+  MeshletState state;
+  state.vertices.reserve(kMaxVertices);
+  state.triangles.reserve(kMaxTriangles);
+
+  auto flush = [&]() {
+    if (state.triangles.empty()) {
+      return;
+    }
+    emitMeshlet(vertices, indices, state,
+                lod0.indexStart + static_cast<uint32_t>(reordered.size()), mesh.m_meshlets);
+    // El orden de crecimiento rompe la localidad de caché; se reoptimiza dentro del clúster
+    // con índices locales (a lo sumo kMaxVertices vértices).
+    local.clear();
+    for (uint32_t t : state.triangles) {
+      for (int k = 0; k < 3; ++k) {
+        local.push_back(localIndex[indices[t * 3 + k]]);
+      }
+    }
+    MeshOptimizer::optimizeVertexCache(local, state.vertices.size());
+    for (unsigned int l : local) {
+      reordered.push_back(state.vertices[l]);
+    }
+    for (uint32_t v : state.vertices) {
+      localIndex[v] = kNotInMeshlet;
+    }
+    state.vertices.clear();
+    state.triangles.clear();
+    state.centroidSum = XMFLOAT3(0.0f, 0.0f, 0.0f);
+  };
+
+  auto newVertexCount = [&](size_t t) {
+    const unsigned int* tri = indices + t * 3;
+    return (localIndex[tri[0]] == kNotInMeshlet) + (localIndex[tri[1]] == kNotInMeshlet) +
+           (localIndex[tri[2]] == kNotInMeshlet);
+  };
+
+  size_t seed = 0;
+  for (size_t done = 0; done < triangleCount; ) {
+    if (state.triangles.size() == kMaxTriangles) {
+      flush();
+    }
+
+    // Vecino que agrega menos vértices nuevos y, a igualdad, queda más cerca del centro.
+    size_t best = triangleCount;
+    if (!state.triangles.empty()) {
+      const float inv = 1.0f / static_cast<float>(state.triangles.size());
+      const XMFLOAT3 center(state.centroidSum.x * inv, state.centroidSum.y * inv, state.centroidSum.z * inv);
+      int bestExtra = 4;
+      float bestDistance = 0.0f;
+      for (uint32_t v : state.vertices) {
+        for (uint32_t k = 0; k < liveCount[v]; ++k) {
+          const uint32_t t = adjacency[offsets[v] + k];
+          const int extra = newVertexCount(t);
+          if (state.vertices.size() + extra > kMaxVertices || extra > bestExtra) {
+            continue;
+          }
+          const XMFLOAT3 c = triangleCentroid(vertices, indices + t * 3);
+          const float dx = c.x - center.x, dy = c.y - center.y, dz = c.z - center.z;
+          const float distance = dx * dx + dy * dy + dz * dz;
+          if (extra < bestExtra || distance < bestDistance) {
+            best = t;
+            bestExtra = extra;
+            bestDistance = distance;
+          }
+        }
+      }
+      if (best == triangleCount) {
+        flush();
+        continue;
+      }
+    }
+    else {
+      while (emitted[seed]) {
+        ++seed;
+      }
+      best = seed;
+    }
+
+    // Agrega el triángulo y lo retira de las listas de adyacencia de sus vértices.
+    const unsigned int* tri = indices + best * 3;
+    for (int k = 0; k < 3; ++k) {
+      const unsigned int v = tri[k];
+      if (localIndex[v] == kNotInMeshlet) {
+        localIndex[v] = static_cast<uint8_t>(state.vertices.size());
+        state.vertices.push_back(v);
+      }
+      uint32_t* list = adjacency.data() + offsets[v];
+      for (uint32_t j = 0; j < liveCount[v]; ++j) {
+        if (list[j] == best) {
+          list[j] = list[--liveCount[v]];
+          break;
+        }
+      }
+    }
+    const XMFLOAT3 c = triangleCentroid(vertices, tri);
+    state.centroidSum.x += c.x;
+    state.centroidSum.y += c.y;
+    state.centroidSum.z += c.z;
+    state.triangles.push_back(static_cast<uint32_t>(best));
+    emitted[best] = 1;
+    ++done;
+  }
+  flush();
+
+  std::copy(reordered.begin(), reordered.end(), mesh.m_index.begin() + lod0.indexStart);
+
+  MESSAGE("MeshletBuilder", "build", (mesh.m_name + ": " + std::to_string(mesh.m_meshlets.size()) +
+    " meshlets, " + std::to_string(triangleCount) + " triángulos").c_str());
+}
+
+size_t
+MeshletBuilder::cull(const std::vector<Meshlet>& meshlets,
+                     const XMMATRIX& world,
+                     const FrustumCuller& frustum,
+                     const XMFLOAT3& cameraPosition,
+                     std::vector<MeshletRange>& ranges) {
+  ranges.clear();
+  XMFLOAT4X4 w;
+  XMStoreFloat4x4(&w, world);
+
+  // Planos en espacio local: p_local = W * p. La distancia resultante sigue en unidades de mundo.
+  const XMFLOAT4* worldPlanes = frustum.getPlanes();
+  XMFLOAT4 planes[6];
+  for (int p = 0; p < 6; ++p) {
+    const XMFLOAT4& q = worldPlanes[p];
+    planes[p] = XMFLOAT4(w._11 * q.x + w._12 * q.y + w._13 * q.z + w._14 * q.w,
+                         w._21 * q.x + w._22 * q.y + w._23 * q.z + w._24 * q.w,
+                         w._31 * q.x + w._32 * q.y + w._33 * q.z + w._34 * q.w,
+                         w._41 * q.x + w._42 * q.y + w._43 * q.z + w._44 * q.w);
+  }
+
+  const float sx = std::sqrt(w._11 * w._11 + w._12 * w._12 + w._13 * w._13);
+  const float sy = std::sqrt(w._21 * w._21 + w._22 * w._22 + w._23 * w._23);
+  const float sz = std::sqrt(w._31 * w._31 + w._32 * w._32 + w._33 * w._33);
+  const float scale = (std::max)((std::max)(sx, sy), sz);
+  const float minScale = (std::min)((std::min)(sx, sy), sz);
+  const float determinant = w._11 * (w._22 * w._33 - w._23 * w._32) -
+                            w._12 * (w._21 * w._33 - w._23 * w._31) +
+                            w._13 * (w._21 * w._32 - w._22 * w._31);
+  const bool coneTest = determinant > 0.0f && scale - minScale <= scale * 1e-3f;
+  const float invScale = scale > 0.0f ? 1.0f / scale : 0.0f;
+
+  size_t visible = 0;
+  for (const Meshlet& m : meshlets) {
+    const float radius = m.radius * scale;
+
+    bool inside = true;
+    for (int p = 0; p < 6 && inside; ++p) {
+      inside = planes[p].x * m.center.x + planes[p].y * m.center.y +
+               planes[p].z * m.center.z + planes[p].w >= -radius;
+    }
+    if (!inside) {
+      continue;
+    }
+
+    if (coneTest && m.coneCutoff < 1.0f) {
+      const float cx = m.center.x * w._11 + m.center.y * w._21 + m.center.z * w._31 + w._41;
+      const float cy = m.center.x * w._12 + m.center.y * w._22 + m.center.z * w._32 + w._42;
+      const float cz = m.center.x * w._13 + m.center.y * w._23 + m.center.z * w._33 + w._43;
+      const float ax = (m.coneAxis.x * w._11 + m.coneAxis.y * w._21 + m.coneAxis.z * w._31) * invScale;
+      const float ay = (m.coneAxis.x * w._12 + m.coneAxis.y * w._22 + m.coneAxis.z * w._32) * invScale;
+      const float az = (m.coneAxis.x * w._13 + m.coneAxis.y * w._23 + m.coneAxis.z * w._33) * invScale;
+      const float vx = cx - cameraPosition.x, vy = cy - cameraPosition.y, vz = cz - cameraPosition.z;
+      const float distance = std::sqrt(vx * vx + vy * vy + vz * vz);
+      // Todo el clúster mira en la dirección opuesta a la cámara.
+      if (vx * ax + vy * ay + vz * az >= m.coneCutoff * distance + radius) {
+        continue;
+      }
+    }
+
+    ++visible;
+    // Los clústeres están en orden de índice: un hueco corto se dibuja en vez de partir el draw.
+    if (!ranges.empty()) {
+      MeshletRange& last = ranges.back();
+      const uint32_t end = last.indexStart + last.indexCount;
+      if (m.indexStart >= end && m.indexStart - end <= kMaxRangeGap) {
+        last.indexCount = m.indexStart + m.indexCount - last.indexStart;
+        continue;
+      }
+    }
+    ranges.push_back({ m.indexStart, m.indexCount });
+  }
+
+  // Demasiados draws pequeños: uno solo del primer al último clúster visible.
+  if (ranges.size() > kMaxRanges) {
+    const uint32_t first = ranges.front().indexStart;
+    const uint32_t end = ranges.back().indexStart + ranges.back().indexCount;
+    ranges.resize(1);
+    ranges[0] = { first, end - first };
+  }
+  return visible;
+}
@@ -0,0 +1,352 @@
+﻿#include "MipGenerator.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <emmintrin.h>
+
+namespace {
+  constexpr float kKaiserWidth = 3.0f;  ///< Ancho total del filtro en píxeles del nivel destino.
+  constexpr float kKaiserAlpha = 4.0f;  ///< Forma de la ventana (mayor = menos rizado, más suave).
+  constexpr size_t kRowsPerTask = 16;   ///< Filas por iteración de parallelFor.
+
+  /**
+   * @brief Tablas de conversión sRGB <-> lineal para texeles de 8 bits.
+   */
+  struct SrgbTables {
+    static constexpr int kGuessSize = 4096;
+
+    float toLinear[256];
+    float thresholds[256];           ///< Punto medio lineal entre los códigos k y k+1 (el último es +inf).
+    uint8_t guess[kGuessSize + 1];   ///< Código sRGB de j / kGuessSize; a lo sumo a uno del exacto.
+
+    SrgbTables() {
+      for (int i = 0; i < 256; ++i) {
+        const double c = i / 255.0;
+        toLinear[i] = static_cast<float>(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+      }
+      for (int i = 0; i < 255; ++i) {
+        const double c = (i + 0.5) / 255.0;
+        thresholds[i] = static_cast<float>(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+      }
+      thresholds[255] = std::numeric_limits<float>::infinity();
+      for (int j = 0; j <= kGuessSize; ++j) {
+        guess[j] = encode(static_cast<float>(j) / kGuessSize, 0);
+      }
+    }
+
+    /**
+     * @brief Código sRGB de 8 bits más cercano a un valor lineal (redondeo exacto).
+     */
+    uint8_t
+    encode(float value, int code) const {
+      while (code < 255 && value >= thresholds[code]) ++code;
+      while (code > 0 && value < thresholds[code - 1]) --code;
+      return static_cast<uint8_t>(code);
+    }
+
+    uint8_t
+    encode(float value) const {
+      const float clamped = std::min(std::max(value, 0.0f), 1.0f);
+      return encode(clamped, guess[static_cast<int>(clamped * kGuessSize + 0.5f)]);
+    }
+  };
+
+  const SrgbTables&
+  getSrgbTables() {
+    static const SrgbTables tables;
+    return tables;
+  }
+
+  /**
+   * @brief Pesos de un eje: para cada píxel destino, un rango contiguo de píxeles fuente.
+   */
+  struct AxisTaps {
+    std::vector<uint32_t> start;   ///< Primer píxel fuente.
+    std::vector<uint32_t> count;   ///< Número de píxeles fuente.
+    std::vector<uint32_t> offset;  ///< Primer peso en @c weights.
+    std::vector<float> weights;
+  };
+
+  double
+  besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    const double halfX = x * 0.5;
+    for (int k = 1; k < 32; ++k) {
+      term *= (halfX / k) * (halfX / k);
+      sum += term;
+      if (term < sum * 1e-12) {
+        break;
+      }
+    }
+    return sum;
+  }
+
+  double
+  kaiser(double t) {
+    const double halfWidth = kKaiserWidth * 0.5;
+    const double u = t / halfWidth;
+    if (u <= -1.0 || u >= 1.0) {
+      return 0.0;
+    }
+    const double sinc = (std::fabs(t) < 1e-9) ? 1.0 : std::sin(XM_PI * t) / (XM_PI * t);
+    return sinc * besselI0(kKaiserAlpha * std::sqrt(1.0 - u * u)) / besselI0(kKaiserAlpha);
+  }
+
+  /**
+   * @brief Calcula los pesos normalizados de un eje (bordes con clamp).
+   */
+  AxisTaps
+  buildTaps(uint32_t srcLength, uint32_t dstLength, MipFilter filter) {
+    AxisTaps taps;
+    taps.start.resize(dstLength);
+    taps.count.resize(dstLength);
+    taps.offset.resize(dstLength);
+
+    const double scale = static_cast<double>(srcLength) / dstLength;
+    const double radius = (filter == MipFilter::Box) ? scale * 0.5 : kKaiserWidth * 0.5 * scale;
+    std::vector<double> local;
+
+    for (uint32_t x = 0; x < dstLength; ++x) {
+      const double center = (x + 0.5) * scale;
+      const int first = static_cast<int>(std::floor(center - radius));
+      const int last = static_cast<int>(std::ceil(center + radius));
+      const int lo = std::max(first, 0);
+      const int hi = std::min(last, static_cast<int>(srcLength) - 1);
+      local.assign(static_cast<size_t>(hi - lo + 1), 0.0);
+
+      double total = 0.0;
+      for (int i = first; i <= last; ++i) {
+        double weight;
+        if (filter == MipFilter::Box) {
+          // Cobertura del píxel fuente [i, i+1] dentro del área del píxel destino
+          weight = std::min<double>(i + 1, center + radius) - std::max<double>(i, center - radius);
+        }
+        else {
+          weight = kaiser((i + 0.5 - center) / scale);
+        }
+        if (weight <= 0.0 && filter == MipFilter::Box) {
+          continue;
+        }
+        local[std::min(std::max(i, lo), hi) - lo] += weight;
+        total += weight;
+      }
+
+      // Recortar los pesos nulos de los extremos
+      size_t begin = 0;
+      size_t end = local.size();
+      while (begin + 1 < end && local[begin] == 0.0) ++begin;
+      while (end > begin + 1 && local[end - 1] == 0.0) --end;
+
+      taps.start[x] = static_cast<uint32_t>(lo + begin);
+      taps.count[x] = static_cast<uint32_t>(end - begin);
+      taps.offset[x] = static_cast<uint32_t>(taps.weights.size());
+      for (size_t i = begin; i < end; ++i) {
+        taps.weights.push_back(static_cast<float>(local[i] / total));
+      }
+    }
+    return taps;
+  }
+
+  void
+  forRowBlocks(uint32_t rows, const std::function<void(uint32_t, uint32_t)>& body) {
+    const size_t blocks = (rows + kRowsPerTask - 1) / kRowsPerTask;
+    ThreadPool::getInstance().parallelFor(blocks, [&](size_t block) {
+      const uint32_t begin = static_cast<uint32_t>(block * kRowsPerTask);
+      body(begin, std::min<uint32_t>(rows, begin + static_cast<uint32_t>(kRowsPerTask)));
+    });
+  }
+
+  /**
+   * @brief Promedio 2x2 directo (dimensiones fuente pares).
+   */
+  void
+  downsampleBox2x2(const float* src, uint32_t srcWidth, float* dst, uint32_t dstWidth, uint32_t dstHeight) {
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    forRowBlocks(dstHeight, [&](uint32_t begin, uint32_t end) {
+      for (uint32_t y = begin; y < end; ++y) {
+        const float* row0 = src + static_cast<size_t>(2 * y) * srcWidth * 4;
+        const float* row1 = row0 + static_cast<size_t>(srcWidth) * 4;
+        float* out = dst + static_cast<size_t>(y) * dstWidth * 4;
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+          const __m128 a = _mm_loadu_ps(row0 + x * 8);
+          const __m128 b = _mm_loadu_ps(row0 + x * 8 + 4);
+          const __m128 c = _mm_loadu_ps(row1 + x * 8);
+          const __m128 d = _mm_loadu_ps(row1 + x * 8 + 4);
+          _mm_storeu_ps(out + x * 4, _mm_mul_ps(_mm_add_ps(_mm_add_ps(a, b), _mm_add_ps(c, d)), quarter));
+        }
+      }
+    });
+  }
+
+  /**
+   * @brief Reducción separable genérica: filas con @p horizontal, luego columnas con @p vertical.
+   */
+  void
+  downsampleSeparable(const float* src, uint32_t srcWidth, uint32_t srcHeight,
+                      float* dst, uint32_t dstWidth, uint32_t dstHeight,
+                      const AxisTaps& horizontal, const AxisTaps& vertical,
+                      std::vector<float>& scratch) {
+    scratch.resize(static_cast<size_t>(dstWidth) * srcHeight * 4);
+    float* temp = scratch.data();
+
+    forRowBlocks(srcHeight, [&](uint32_t begin, uint32_t end) {
+      for (uint32_t y = begin; y < end; ++y) {
+        const float* row = src + static_cast<size_t>(y) * srcWidth * 4;
+        float* out = temp + static_cast<size_t>(y) * dstWidth * 4;
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+          const float* weights = &horizontal.weights[horizontal.offset[x]];
+          const float* texel = row + static_cast<size_t>(horizontal.start[x]) * 4;
+          __m128 acc = _mm_setzero_ps();
+          for (uint32_t t = 0; t < horizontal.count[x]; ++t) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(texel + t * 4), _mm_set1_ps(weights[t])));
+          }
+          _mm_storeu_ps(out + x * 4, acc);
+        }
+      }
+    });
+
+    forRowBlocks(dstHeight, [&](uint32_t begin, uint32_t end) {
+      for (uint32_t y = begin; y < end; ++y) {
+        float* out = dst + static_cast<size_t>(y) * dstWidth * 4;
+        const float* weights = &vertical.weights[vertical.offset[y]];
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+          _mm_storeu_ps(out + x * 4, _mm_setzero_ps());
+        }
+        for (uint32_t t = 0; t < vertical.count[y]; ++t) {
+          const float* row = temp + static_cast<size_t>(vertical.start[y] + t) * dstWidth * 4;
+          const __m128 weight = _mm_set1_ps(weights[t]);
+          for (uint32_t x = 0; x < dstWidth; ++x) {
+            _mm_storeu_ps(out + x * 4,
+              _mm_add_ps(_mm_loadu_ps(out + x * 4), _mm_mul_ps(_mm_loadu_ps(row + x * 4), weight)));
+          }
+        }
+      }
+    });
+  }
+
+  /**
+   * @brief Cuantiza un nivel en punto flotante a RGBA8.
+   */
+  void
+  quantize(const float* src, size_t texelCount, bool srgb, uint8_t* dst) {
+    if (!srgb) {
+      const __m128 zero = _mm_setzero_ps();
+      const __m128 one = _mm_set1_ps(1.0f);
+      const __m128 scale = _mm_set1_ps(255.0f);
+      const __m128 half = _mm_set1_ps(0.5f);
+      for (size_t i = 0; i < texelCount; ++i) {
+        __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i * 4), zero), one);
+        __m128i codes = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half));
+        codes = _mm_packs_epi32(codes, codes);
+        codes = _mm_packus_epi16(codes, codes);
+        const int packed = _mm_cvtsi128_si32(codes);
+        std::memcpy(dst + i * 4, &packed, 4);
+      }
+      return;
+    }
+
+    const SrgbTables& tables = getSrgbTables();
+    for (size_t i = 0; i < texelCount; ++i) {
+      dst[i * 4 + 0] = tables.encode(src[i * 4 + 0]);
+      dst[i * 4 + 1] = tables.encode(src[i * 4 + 1]);
+      dst[i * 4 + 2] = tables.encode(src[i * 4 + 2]);
+      const float alpha = std::min(std::max(src[i * 4 + 3], 0.0f), 1.0f);
+      dst[i * 4 + 3] = static_cast<uint8_t>(alpha * 255.0f + 0.5f);
+    }
+  }
+}
+
+uint32_t
+MipGenerator::getMipCount(uint32_t width, uint32_t height) {
+  uint32_t count = 1;
+  while (width > 1 || height > 1) {
+    width = std::max(1u, width / 2);
+    height = std::max(1u, height / 2);
+    ++count;
+  }
+  return count;
+}
+
+HRESULT
+MipGenerator::generate(const unsigned char* pixels,
+                       uint32_t width,
+                       uint32_t height,
+                       const MipSettings& settings,
+                       MipChain& chain) {
+  if (!pixels || width == 0 || height == 0) {
+    ERROR("MipGenerator", "generate", "Pixel data is empty.");
+    return E_INVALIDARG;
+  }
+
+  chain.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+  chain.width = width;
+  chain.height = height;
+  chain.levels.clear();
+  chain.mapping.reset();
+  chain.mappedData = nullptr;
+  chain.mappedSize = 0;
+
+  // Distribución de todos los niveles
+  size_t totalBytes = 0;
+  for (uint32_t w = width, h = height;; w = std::max(1u, w / 2), h = std::max(1u, h / 2)) {
+    MipLevel level;
+    level.width = w;
+    level.height = h;
+    level.rowPitch = w * 4;
+    level.offset = static_cast<uint32_t>(totalBytes);
+    level.size = level.rowPitch * h;
+    chain.levels.push_back(level);
+    totalBytes += level.size;
+    if (w == 1 && h == 1) {
+      break;
+    }
+  }
+  chain.data.resize(totalBytes);
+  std::memcpy(chain.data.data(), pixels, chain.levels[0].size);
+
+  // Nivel 0 en punto flotante (lineal si es sRGB)
+  const size_t texelCount = static_cast<size_t>(width) * height;
+  std::vector<float> current(texelCount * 4);
+  std::vector<float> next;
+  std::vector<float> scratch;
+  const SrgbTables& tables = getSrgbTables();
+  for (size_t i = 0; i < texelCount; ++i) {
+    const unsigned char* texel = pixels + i * 4;
+    float* out = &current[i * 4];
+    if (settings.srgb) {
+      out[0] = tables.toLinear[texel[0]];
+      out[1] = tables.toLinear[texel[1]];
+      out[2] = tables.toLinear[texel[2]];
+    }
+    else {
+      out[0] = texel[0] * (1.0f / 255.0f);
+      out[1] = texel[1] * (1.0f / 255.0f);
+      out[2] = texel[2] * (1.0f / 255.0f);
+    }
+    out[3] = texel[3] * (1.0f / 255.0f);
+  }
+
+  for (size_t mip = 1; mip < chain.levels.size(); ++mip) {
+    const MipLevel& src = chain.levels[mip - 1];
+    const MipLevel& dst = chain.levels[mip];
+    next.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+
+    if (settings.filter == MipFilter::Box && src.width % 2 == 0 && src.height % 2 == 0) {
+      downsampleBox2x2(current.data(), src.width, next.data(), dst.width, dst.height);
+    }
+    else {
+      const AxisTaps horizontal = buildTaps(src.width, dst.width, settings.filter);
+      const AxisTaps vertical = buildTaps(src.height, dst.height, settings.filter);
+      downsampleSeparable(current.data(), src.width, src.height,
+                          next.data(), dst.width, dst.height,
+                          horizontal, vertical, scratch);
+    }
+
+    quantize(next.data(), static_cast<size_t>(dst.width) * dst.height, settings.srgb,
+             chain.data.data() + dst.offset);
+    current.swap(next);
+  }
+  return S_OK;
+}
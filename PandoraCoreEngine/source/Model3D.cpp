@@ -1,13 +1,69 @@
 #include "Model3D.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "VertexCodec.h"
+#include "FbxBinaryReader.h"
+#include "GltfLoader.h"
+#include "MeshletBuilder.h"
+#include "ThreadPool.h"
+#include "ModelLoader.h"
+
+namespace {
+  /**
+   * @brief Descripcin de las opciones del importador FBX; forma parte de la clave de cach.
+   *
+   * Debe actualizarse cuando cambie cualquier paso que altere los vrtices o ndices generados.
+   */
+  const char* kFbxImporterSettings = "fbx;native-bin;baked-dx-axis;baked-m-units;triangulate;flip-winding;weld;opt-vcache-overdraw-fetch";
+
+  /**
+   * @brief Opciones del importador glTF/GLB para la clave de cach.
+   */
+  const char* kGltfImporterSettings = "gltf;local-space;lh-negate-x;opt-vcache-overdraw-fetch";
+
+  /**
+   * @brief Ejes y unidades de la escena importada, en la forma de @c GlobalSettings.
+   *
+   * Debe leerse antes de @c ConvertScene, que solo corrige las transformaciones de los
+   * nodos de primer nivel y deja los control points en el sistema original.
+   */
+  FbxAxisConversion
+  readAxisConversion(FbxScene* scene) {
+    const FbxAxisSystem& axisSystem = scene->GetGlobalSettings().GetAxisSystem();
+    FbxAxisConversion conversion;
+
+    int upSign = 1;
+    const int up = axisSystem.GetUpVector(upSign) - FbxAxisSystem::eXAxis;
+    conversion.upAxis = up;
+    conversion.upAxisSign = upSign < 0 ? -1 : 1;
+
+    // Paridad par: el primero de los dos ejes restantes; impar: el segundo.
+    int frontSign = 1;
+    const bool even = axisSystem.GetFrontVector(frontSign) == FbxAxisSystem::eParityEven;
+    const int first = up == 0 ? 1 : 0;
+    const int second = up == 2 ? 1 : 2;
+    conversion.frontAxis = even ? first : second;
+    conversion.frontAxisSign = frontSign < 0 ? -1 : 1;
+    conversion.coordAxis = 3 - conversion.upAxis - conversion.frontAxis;
+
+    // Mano derecha: (coord, arriba, frente) con sus signos forma una base directa.
+    const bool cyclic = (conversion.coordAxis + 1) % 3 == conversion.upAxis;
+    int coordSign = conversion.upAxisSign * conversion.frontAxisSign * (cyclic ? 1 : -1);
+    if (axisSystem.GetCoorSystem() == FbxAxisSystem::eLeftHanded) {
+      coordSign = -coordSign;
+    }
+    conversion.coordAxisSign = coordSign;
+    conversion.unitScaleFactor = scene->GetGlobalSettings().GetSystemUnit().GetScaleFactor();
+    return conversion;
+  }
+}
 
 bool
 Model3D::load(const std::string& path) {
   SetPath(path);
   SetState(ResourceState::Loading);
 
-  init();
-
-  bool success = true; // Cambia esto segn el resultado real.
+  bool success = init();
 
   SetState(success ? ResourceState::Loaded : ResourceState::Failed);
   return success;
@@ -15,9 +71,79 @@ Model3D::load(const std::string& path) {
 
 bool Model3D::init()
 {
-  // Inicializar recursos GPU, buffers, etc.
-  LoadFBXModel(m_filePath);
-  return false;
+  // OBJ: ModelLoader tiene su propia cach, optimizacin, LODs y meshlets.
+  if (m_modelType == ModelType::OBJ) {
+    ModelLoader loader;
+    loader.setCompactVertices(m_compactVertices);
+    loader.setLodChain(m_lodChain);
+    MeshComponent mesh;
+    if (FAILED(loader.init(mesh, m_filePath))) {
+      ERROR("Model3D", "init", "Unable to load OBJ model " << m_filePath.c_str());
+      m_meshes.clear();
+      return false;
+    }
+    m_name = m_filePath;
+    m_meshes.clear();
+    m_meshes.push_back(std::move(mesh));
+    return true;
+  }
+
+  // Si existe una cach vlida para este archivo se omite el importador por completo.
+  const bool isGltf = m_modelType == ModelType::GLTF;
+  const std::string cachePath = MeshCache::getCachePath(m_filePath);
+  uint64_t cacheKey = 0;
+  const std::string settings = std::string(isGltf ? kGltfImporterSettings : kFbxImporterSettings) +
+                               ";" + m_lodChain.toString();
+  const bool hasKey = MeshCache::computeKey(m_filePath, settings, cacheKey);
+  if (!hasKey || !MeshCache::load(cachePath, cacheKey, m_meshes)) {
+    if (isGltf) {
+      GltfLoader loader;
+      if (FAILED(loader.load(m_filePath, m_meshes))) {
+        ERROR("Model3D", "init", "Unable to load glTF model " << m_filePath.c_str());
+        m_meshes.clear();
+      }
+    }
+    else {
+      // Los FBX binarios se leen sin el SDK; los ASCII o los que el lector no entienda usan el SDK.
+      FbxBinaryReader reader;
+      if (SUCCEEDED(reader.load(m_filePath, m_meshes))) {
+        m_name = m_filePath;
+      }
+      else {
+        m_meshes.clear();
+        LoadFBXModel(m_filePath);
+      }
+    }
+
+    // Postproceso comn a ambas rutas; cada malla es independiente.
+    ThreadPool::getInstance().parallelFor(m_meshes.size(), [this](size_t i) {
+      MeshComponent& mesh = m_meshes[i];
+      // Con ndices invlidos la malla se conserva sin optimizar y sin LODs ni meshlets,
+      // que suponen tringulos vlidos.
+      const bool optimized = SUCCEEDED(MeshOptimizer::optimize(mesh));
+      if (!optimized) {
+        MESSAGE("Model3D", "init", ("Keeping unoptimized mesh: " + mesh.m_name).c_str());
+      }
+      mesh.computeBounds();
+      if (optimized) {
+        MeshSimplifier::buildLods(mesh, m_lodChain);
+        MeshletBuilder::build(mesh);
+      }
+      mesh.compactIndices();
+    });
+
+    if (hasKey && !m_meshes.empty()) {
+      MeshCache::save(cachePath, cacheKey, m_meshes);
+    }
+  }
+
+  // La codificacin compacta es barata; se aplica despus de la cach para que esta siga siendo nica.
+  if (m_compactVertices) {
+    for (MeshComponent& mesh : m_meshes) {
+      VertexCodec::encodeMesh(mesh, false);
+    }
+  }
+  return !m_meshes.empty();
 }
 
 void Model3D::unload()
@@ -96,6 +222,12 @@ Model3D::LoadFBXModel(const std::string& filePath) {
       m_name = lImporter->GetFileName();
     }
 
+    const FbxAxisConversion axisConversion = readAxisConversion(lScene);
+    if (!axisConversion.isValid()) {
+      ERROR("ModelLoader", "FbxScene::GetGlobalSettings()", "Unsupported FBX axis system");
+      lImporter->Destroy();
+      return std::vector<MeshComponent>();
+    }
     FbxAxisSystem::DirectX.ConvertScene(lScene);
     FbxSystemUnit::m.ConvertScene(lScene);
     FbxGeometryConverter gc(lSdkManager);
@@ -110,8 +242,35 @@ Model3D::LoadFBXModel(const std::string& filePath) {
 
     if (lRootNode) {
       MESSAGE("ModelLoader", "ModelLoader", "Processing model from the scene root node.");
+
+      // Fase 1 (serie, el SDK no es seguro entre hilos): recolecta los nodos con malla
+      // y copia su geometra a snapshots de solo lectura.
+      std::vector<FbxNode*> meshNodes;
       for (int i = 0; i < lRootNode->GetChildCount(); i++) {
-        ProcessFBXNode(lRootNode->GetChild(i));
+        ProcessFBXNode(lRootNode->GetChild(i), meshNodes);
+      }
+
+      std::vector<FbxMeshSnapshot> snapshots(meshNodes.size());
+      std::vector<char> valid(meshNodes.size(), 0);
+      for (size_t i = 0; i < meshNodes.size(); ++i) {
+        valid[i] = SnapshotFBXMesh(meshNodes[i], snapshots[i]);
+        snapshots[i].axisConversion = axisConversion;
+      }
+
+      // Fase 2 (paralela): cada snapshot se convierte en su propia ranura, por lo que el
+      // orden de salida es el mismo que el del recorrido del rbol.
+      std::vector<MeshComponent> slots(snapshots.size());
+      ThreadPool::getInstance().parallelFor(snapshots.size(), [&](size_t i) {
+        if (valid[i]) {
+          ProcessFBXMesh(snapshots[i], slots[i]);
+        }
+        snapshots[i] = FbxMeshSnapshot();
+      });
+
+      for (size_t i = 0; i < slots.size(); ++i) {
+        if (valid[i]) {
+          m_meshes.push_back(std::move(slots[i]));
+        }
       }
       return m_meshes;
     }
@@ -125,24 +284,24 @@ Model3D::LoadFBXModel(const std::string& filePath) {
 }
 
 void
-Model3D::ProcessFBXNode(FbxNode* node) {
-  // 01. Process all the node's meshes
+Model3D::ProcessFBXNode(FbxNode* node, std::vector<FbxNode*>& meshNodes) {
+  // 01. Collect the node if it holds a mesh
   if (node->GetNodeAttribute()) {
     if (node->GetNodeAttribute()->GetAttributeType() == FbxNodeAttribute::eMesh) {
-      ProcessFBXMesh(node);
+      meshNodes.push_back(node);
     }
   }
 
   // 02. Recursively process each child node
   for (int i = 0; i < node->GetChildCount(); i++) {
-    ProcessFBXNode(node->GetChild(i));
+    ProcessFBXNode(node->GetChild(i), meshNodes);
   }
 }
 
-void
-Model3D::ProcessFBXMesh(FbxNode* node) {
+bool
+Model3D::SnapshotFBXMesh(FbxNode* node, FbxMeshSnapshot& snapshot) {
   FbxMesh* mesh = node->GetMesh();
-  if (!mesh) return;
+  if (!mesh) return false;
 
   // --- Asegura normales/tangentes en el FBX ---
   if (mesh->GetElementNormalCount() == 0)
@@ -157,89 +316,127 @@ Model3D::ProcessFBXMesh(FbxNode* node) {
   if (mesh->GetElementTangentCount() == 0 && uvSetName)
     mesh->GenerateTangentsData(uvSetName);
 
+  snapshot.name = node->GetName();
+
+  // Posiciones (espacio local)
+  const int controlPointCount = mesh->GetControlPointsCount();
+  const FbxVector4* controlPoints = mesh->GetControlPoints();
+  snapshot.controlPoints.resize(controlPointCount);
+  for (int i = 0; i < controlPointCount; ++i) {
+    snapshot.controlPoints[i] = { (float)controlPoints[i][0], (float)controlPoints[i][1], (float)controlPoints[i][2] };
+  }
+
+  // Topologa: tamao de cada polgono y control point de cada esquina
+  const int polygonCount = mesh->GetPolygonCount();
+  snapshot.polygonSizes.resize(polygonCount);
+  for (int p = 0; p < polygonCount; ++p) {
+    snapshot.polygonSizes[p] = mesh->GetPolygonSize(p);
+  }
+  const int* polygonVertices = mesh->GetPolygonVertices();
+  snapshot.polygonVertices.assign(polygonVertices, polygonVertices + mesh->GetPolygonVertexCount());
+
+  // UV: se copian los arreglos del primer canal; se resuelven por esquina en la fase paralela
   const FbxGeometryElementUV* uvElem = (mesh->GetElementUVCount() > 0) ? mesh->GetElementUV(0) : nullptr;
-  const FbxGeometryElementTangent* tanElem = (mesh->GetElementTangentCount() > 0) ? mesh->GetElementTangent(0) : nullptr;
-  const FbxGeometryElementBinormal* binElem = (mesh->GetElementBinormalCount() > 0) ? mesh->GetElementBinormal(0) : nullptr;
+  if (uvElem && uvSetName) {
+    using E = FbxGeometryElement;
+    snapshot.uvByControlPoint = uvElem->GetMappingMode() == E::eByControlPoint;
+    const auto& direct = uvElem->GetDirectArray();
+    snapshot.uvDirect.resize(direct.GetCount());
+    for (int i = 0; i < direct.GetCount(); ++i) {
+      const FbxVector2 uv = direct.GetAt(i);
+      snapshot.uvDirect[i] = { (float)uv[0], (float)uv[1] };
+    }
+    if (uvElem->GetReferenceMode() != E::eDirect) {
+      const auto& index = uvElem->GetIndexArray();
+      snapshot.uvIndex.resize(index.GetCount());
+      for (int i = 0; i < index.GetCount(); ++i) {
+        snapshot.uvIndex[i] = index.GetAt(i);
+      }
+    }
+  }
+
+  // --- Autodetecta espejo global del nodo y corrige de forma CONSISTENTE ---
+  bool autoDetectMirror = true;
+  bool forceFlipWinding = true; // pon true si quieres forzar flip aunque no haya espejo
+
+  bool mirrored = true;
+  if (autoDetectMirror) {
+    // world = global * geometric (aunque no lo horneamos a vrtices, lo usamos para detectar espejo)
+    FbxAMatrix geo;
+    geo.SetT(node->GetGeometricTranslation(FbxNode::eSourcePivot));
+    geo.SetR(node->GetGeometricRotation(FbxNode::eSourcePivot));
+    geo.SetS(node->GetGeometricScaling(FbxNode::eSourcePivot));
+    FbxAMatrix world = node->EvaluateGlobalTransform() * geo;
+
+    // El signo del producto de escalas indica espejo
+    FbxVector4 S = world.GetS();
+    double detScale = S[0] * S[1] * S[2];
+    mirrored = (detScale < 0.0);
+  }
+  snapshot.flipWinding = mirrored || forceFlipWinding;
+  return true;
+}
 
+void
+Model3D::ProcessFBXMesh(const FbxMeshSnapshot& snapshot, MeshComponent& mc) {
   std::vector<SimpleVertex>       vertices;
   std::vector<unsigned int> indices;
-  vertices.reserve(mesh->GetPolygonCount() * 3);
-  indices.reserve(mesh->GetPolygonCount() * 3);
-
-  // Helpers de lectura (control point vs. polygon-vertex)
-  auto readV2 = [](const FbxGeometryElementUV* elem, int cpIdx, int pvIdx) -> FbxVector2 {
-    if (!elem) return FbxVector2(0, 0);
-    using E = FbxGeometryElement;
-    int idx;
-    if (elem->GetMappingMode() == E::eByControlPoint)
-      idx = (elem->GetReferenceMode() == E::eIndexToDirect) ? elem->GetIndexArray().GetAt(cpIdx) : cpIdx;
-    else
-      idx = (elem->GetReferenceMode() == E::eIndexToDirect) ? elem->GetIndexArray().GetAt(pvIdx) : pvIdx;
-    return elem->GetDirectArray().GetAt(idx);
-    };
-  auto readV4 = [](auto* elem, int cpIdx, int pvIdx) -> FbxVector4 {
-    if (!elem) return FbxVector4(0, 0, 0, 0);
-    using E = FbxGeometryElement;
-    int idx;
-    if (elem->GetMappingMode() == E::eByControlPoint)
-      idx = (elem->GetReferenceMode() == E::eIndexToDirect) ? elem->GetIndexArray().GetAt(cpIdx) : cpIdx;
-    else
-      idx = (elem->GetReferenceMode() == E::eIndexToDirect) ? elem->GetIndexArray().GetAt(pvIdx) : pvIdx;
-    return elem->GetDirectArray().GetAt(idx);
+  vertices.reserve(snapshot.controlPoints.size());
+  indices.reserve(snapshot.polygonSizes.size() * 3);
+
+  // Soldadura de esquinas: las esquinas idnticas (bit a bit) comparten vrtice.
+  std::unordered_map<SimpleVertex, unsigned int, SimpleVertexHash, SimpleVertexEqual> weldMap;
+  weldMap.reserve(snapshot.controlPoints.size());
+  size_t cornerCount = 0;
+
+  // Scratch por polgono reutilizado entre iteraciones.
+  std::vector<unsigned> cornerIdx;
+
+  // Lectura de UV (control point vs. polygon-vertex)
+  const bool hasUV = !snapshot.uvDirect.empty();
+  auto readUV = [&snapshot](int cpIdx, int pvIdx) -> XMFLOAT2 {
+    int idx = snapshot.uvByControlPoint ? cpIdx : pvIdx;
+    if (!snapshot.uvIndex.empty())
+      idx = (idx >= 0 && idx < (int)snapshot.uvIndex.size()) ? snapshot.uvIndex[idx] : -1;
+    if (idx < 0 || idx >= (int)snapshot.uvDirect.size())
+      return XMFLOAT2(0.0f, 0.0f);
+    return snapshot.uvDirect[idx];
     };
 
   // --- Construccin por esquina (corner) ---
-  for (int p = 0; p < mesh->GetPolygonCount(); ++p)
+  int pvIndex = 0;
+  for (size_t p = 0; p < snapshot.polygonSizes.size(); ++p)
   {
-    const int polySize = mesh->GetPolygonSize(p);
-    std::vector<unsigned> cornerIdx; cornerIdx.reserve(polySize);
+    const int polySize = snapshot.polygonSizes[p];
+    cornerIdx.clear();
 
-    for (int v = 0; v < polySize; ++v)
+    for (int v = 0; v < polySize; ++v, ++pvIndex)
     {
-      const int cpIndex = mesh->GetPolygonVertex(p, v);
-      const int pvIndex = mesh->GetPolygonVertexIndex(p) + v;
+      const int cpIndex = snapshot.polygonVertices[pvIndex];
 
       SimpleVertex out{};
 
       // Posicin (espacio local)
-      FbxVector4 P = mesh->GetControlPointAt(cpIndex);
-      out.Pos = { (float)P[0], (float)P[1], (float)P[2] };
-
-      // Normal por esquina
-      //FbxVector4 N(0, 1, 0, 0);
-      //mesh->GetPolygonVertexNormal(p, v, N);
-      //N.Normalize();
-      //out.Normal = { (float)N[0], (float)N[1], (float)N[2] };
+      out.Pos = snapshot.controlPoints[cpIndex];
 
       // UV (invertir V para DX)
-      if (uvElem && uvSetName) {
-        int uvIdx = mesh->GetTextureUVIndex(p, v);
-        FbxVector2 uv = (uvIdx >= 0) ? uvElem->GetDirectArray().GetAt(uvIdx)
-          : readV2(uvElem, cpIndex, pvIndex);
-        out.Tex = { (float)uv[0], 1.0f - (float)uv[1] };
+      if (hasUV) {
+        XMFLOAT2 uv = readUV(cpIndex, pvIndex);
+        out.Tex = { uv.x, 1.0f - uv.y };
       }
       else {
         out.Tex = { 0.0f, 0.0f };
       }
 
-      // Tangente / Bitangente si existen
-      //if (tanElem) {
-      //  FbxVector4 T = readV4(tanElem, cpIndex, pvIndex);
-      //  out.Tangent = { (float)T[0], (float)T[1], (float)T[2] };
-      //}
-      //else out.Tangent = { 0,0,0 };
-      //
-      //if (binElem) {
-      //  FbxVector4 B = readV4(binElem, cpIndex, pvIndex);
-      //  out.Bitangent = { (float)B[0], (float)B[1], (float)B[2] };
-      //}
-      //else out.Bitangent = { 0,0,0 };
-
-      cornerIdx.push_back((unsigned)vertices.size());
-      vertices.push_back(out);
+      ++cornerCount;
+      auto welded = weldMap.emplace(out, (unsigned)vertices.size());
+      if (welded.second) {
+        vertices.push_back(out);
+      }
+      cornerIdx.push_back(welded.first->second);
     }
 
-    // Triangula en fan (CW por defecto)
+    // Triangula en fan (CW por defecto)
     for (int k = 1; k + 1 < polySize; ++k) {
       indices.push_back(cornerIdx[0]);
       indices.push_back(cornerIdx[k + 1]);
@@ -283,26 +480,7 @@ Model3D::ProcessFBXMesh(FbxNode* node) {
   //  }
   //}
 
-  // --- Autodetecta espejo global del nodo y corrige de forma CONSISTENTE ---
-  bool autoDetectMirror = true;
-  bool forceFlipWinding = true; // pon true si quieres forzar flip aunque no haya espejo
-
-  bool mirrored = true;
-  if (autoDetectMirror) {
-    // world = global * geometric (aunque no lo horneamos a vrtices, lo usamos para detectar espejo)
-    FbxAMatrix geo;
-    geo.SetT(node->GetGeometricTranslation(FbxNode::eSourcePivot));
-    geo.SetR(node->GetGeometricRotation(FbxNode::eSourcePivot));
-    geo.SetS(node->GetGeometricScaling(FbxNode::eSourcePivot));
-    FbxAMatrix world = node->EvaluateGlobalTransform() * geo;
-
-    // El signo del producto de escalas indica espejo
-    FbxVector4 S = world.GetS();
-    double detScale = S[0] * S[1] * S[2];
-    mirrored = (detScale < 0.0);
-  }
-
-  if (mirrored || forceFlipWinding) {
+  if (snapshot.flipWinding) {
     // 1) Flip global del winding (todas las caras)
     for (size_t i = 0; i + 2 < indices.size(); i += 3)
       std::swap(indices[i + 1], indices[i + 2]);
@@ -315,6 +493,9 @@ Model3D::ProcessFBXMesh(FbxNode* node) {
     //}
   }
 
+  // Ejes y unidades del archivo al sistema del motor, igual que FbxBinaryReader.
+  snapshot.axisConversion.apply(vertices, indices);
+
   // --- Ortonormaliza TBN por vrtice ---
   //auto dot3 = [](const EU::Vector3& a, const EU::Vector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; };
   //auto norm3 = [](EU::Vector3& v) { float l = std::sqrt(EU::EMax(1e-20f, v.x * v.x + v.y * v.y + v.z * v.z)); v.x /= l; v.y /= l; v.z /= l; };
@@ -336,14 +517,19 @@ Model3D::ProcessFBXMesh(FbxNode* node) {
   //  norm3(v.Bitangent);
   //}
 
+  if (cornerCount > 0) {
+    MESSAGE("Model3D", "ProcessFBXMesh", (snapshot.name +
+      " esquinas " + std::to_string(cornerCount) + " -> vertices " + std::to_string(vertices.size()) +
+      " (reduccion " + std::to_string(static_cast<double>(cornerCount) / (std::max)(vertices.size(), size_t(1))) +
+      "x)").c_str());
+  }
+
   // --- Empaqueta ---
-  MeshComponent mc;
-  mc.m_name = node->GetName();
+  mc.m_name = snapshot.name;
   mc.m_vertex = std::move(vertices);
   mc.m_index = std::move(indices);
   mc.m_numVertex = (int)mc.m_vertex.size();
   mc.m_numIndex = (int)mc.m_index.size();
-  m_meshes.push_back(std::move(mc));
 }
 
 void Model3D::ProcessFBXMaterials(FbxSurfaceMaterial* material)
@@ -0,0 +1,1663 @@
+﻿#include "SelfTest.h"
+#include "BlockCompressor.h"
+#include "DdsFile.h"
+#include "FbxBinaryReader.h"
+#include "FrustumCuller.h"
+#include "GltfLoader.h"
+#include "MeshletBuilder.h"
+#include "MipGenerator.h"
+#include "ModelLoader.h"
+#include "ObjTokenizer.h"
+#include "TextureAtlas.h"
+#include "MeshCache.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
+#include "VertexCodec.h"
+#include <psapi.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+  /**
+   * @brief Resultado de la ejecución: @c SelfTest.log y salida de depuración.
+   */
+  class
+    Report {
+  public:
+    explicit Report(const std::string& path) : m_file(path, std::ios::trunc) {}
+
+    void
+      line(const std::string& text) {
+      m_file << text << std::endl;
+      OutputDebugStringA((text + "\n").c_str());
+    }
+
+    void
+      check(bool ok, const std::string& what) {
+      if (!ok) {
+        ++m_failures;
+      }
+      line(std::string(ok ? "  [OK]    " : "  [FALLA] ") + what);
+    }
+
+    int
+      getFailures() const { return m_failures; }
+
+  private:
+    std::ofstream m_file;
+    int m_failures = 0;
+  };
+
+  struct TestEntry {
+    const char* name;
+    std::function<void(Report&)> run;
+    bool benchmark;  ///< Solo con "-bench".
+  };
+
+  using Clock = std::chrono::steady_clock;
+
+  double
+  elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  }
+
+  /**
+   * @brief Pico del conjunto de trabajo del proceso en MiB (solo crece durante la ejecución).
+   */
+  double
+  peakMemoryMiB() {
+    PROCESS_MEMORY_COUNTERS counters = {};
+    counters.cb = sizeof(counters);
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+      return 0.0;
+    }
+    return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+  }
+
+  std::string
+  format(const char* pattern, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, pattern);
+    vsnprintf(buffer, sizeof(buffer), pattern, args);
+    va_end(args);
+    return buffer;
+  }
+
+  std::string
+  tempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+  }
+
+  //------------------------------------------------------------------------------------
+  // OBJ (ModelLoader)
+  //------------------------------------------------------------------------------------
+
+  /**
+   * @brief Escribe una rejilla de @p cellsX x @p cellsY celdas (dos triángulos cada una).
+   *
+   * Cada vértice tiene su propia UV y todos comparten una normal, así que la soldadura
+   * correcta deja exactamente (cellsX + 1) * (cellsY + 1) vértices.
+   */
+  bool
+  writeGridObj(const std::string& path, unsigned int cellsX, unsigned int cellsY) {
+    FILE* file = nullptr;
+    if (fopen_s(&file, path.c_str(), "wb") != 0 || !file) {
+      return false;
+    }
+    std::vector<char> buffer(1 << 20);
+    setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+    for (unsigned int y = 0; y <= cellsY; ++y) {
+      for (unsigned int x = 0; x <= cellsX; ++x) {
+        fprintf(file, "v %u %.3f %u\n", x, 0.01f * static_cast<float>((x * 7 + y * 13) % 100), y);
+      }
+    }
+    for (unsigned int y = 0; y <= cellsY; ++y) {
+      for (unsigned int x = 0; x <= cellsX; ++x) {
+        fprintf(file, "vt %.5f %.5f\n", x / static_cast<float>(cellsX), y / static_cast<float>(cellsY));
+      }
+    }
+    fprintf(file, "vn 0 1 0\n");
+    for (unsigned int y = 0; y < cellsY; ++y) {
+      for (unsigned int x = 0; x < cellsX; ++x) {
+        const unsigned int a = y * (cellsX + 1) + x + 1;
+        const unsigned int b = a + 1;
+        const unsigned int c = a + cellsX + 1;
+        const unsigned int d = c + 1;
+        fprintf(file, "f %u/%u/1 %u/%u/1 %u/%u/1\n", a, a, b, b, d, d);
+        fprintf(file, "f %u/%u/1 %u/%u/1 %u/%u/1\n", a, a, d, d, c, c);
+      }
+    }
+    const bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+  }
+
+  /**
+   * @brief Carga un OBJ sin caché ni LODs, como lo mide el benchmark.
+   */
+  HRESULT
+  loadObj(const std::string& path, unsigned int threadCount, MeshComponent& mesh, ModelLoadStats& stats) {
+    std::error_code ec;
+    std::filesystem::remove(MeshCache::getCachePath(path), ec);
+    ModelLoader loader;
+    loader.setThreadCount(threadCount);
+    LodChainDesc noLods;
+    noLods.triangleRatios.clear();
+    loader.setLodChain(noLods);
+    HRESULT hr = loader.init(mesh, path);
+    stats = loader.getLastLoadStats();
+    std::filesystem::remove(MeshCache::getCachePath(path), ec);
+    return hr;
+  }
+
+  /**
+   * @brief Soldadura de referencia: la búsqueda lineal que ModelLoader usaba antes.
+   *
+   * @return Número de vértices únicos; @p corners recibe el total de esquinas.
+   */
+  size_t
+  weldLinear(const std::string& path, size_t& corners) {
+    std::ifstream in(path, std::ios::binary);
+    const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    ObjGeometry geometry;
+    ObjTokenizer tokenizer;
+    tokenizer.parse(text.data(), text.data() + text.size(), geometry);
+    std::vector<VertexData> unique;
+    for (const VertexData& corner : geometry.corners) {
+      bool found = false;
+      for (const VertexData& existing : unique) {
+        if (existing == corner) {
+          found = true;
+          break;
+        }
+      }
+      if (!found) {
+        unique.push_back(corner);
+      }
+    }
+    corners = geometry.corners.size();
+    return unique.size();
+  }
+
+  /**
+   * @brief Suma de las posiciones de todas las esquinas: no depende del orden de los triángulos.
+   */
+  double
+  cornerChecksum(const MeshComponent& mesh) {
+    double sum = 0.0;
+    for (size_t i = 0; i < mesh.getIndexCount(); ++i) {
+      const unsigned int index = (mesh.m_indexFormat == DXGI_FORMAT_R16_UINT) ? mesh.m_index16[i] : mesh.m_index[i];
+      const SimpleVertex& v = mesh.m_vertex[index];
+      sum += v.Pos.x + 2.0 * v.Pos.y + 3.0 * v.Pos.z + v.Tex.x + v.Tex.y;
+    }
+    return sum;
+  }
+
+  void
+  testObjWelding(Report& report) {
+    const std::string path = tempPath("pc_selftest_weld.obj");
+    const unsigned int cells = 40;
+    report.check(writeGridObj(path, cells, cells), "Rejilla OBJ de prueba escrita");
+
+    MeshComponent mesh;
+    ModelLoadStats stats;
+    report.check(SUCCEEDED(loadObj(path, 1, mesh, stats)), "ModelLoader::init carga la rejilla");
+    size_t corners = 0;
+    const size_t reference = weldLinear(path, corners);
+    report.check(reference == (cells + 1) * (cells + 1), format("Referencia lineal: %zu vértices únicos", reference));
+    report.check(static_cast<size_t>(mesh.m_numVertex) == reference,
+      format("Soldadura por hash: %d vértices (referencia %zu)", mesh.m_numVertex, reference));
+    report.check(mesh.getIndexCount() == corners, format("Índices: %zu (esquinas %zu)", mesh.getIndexCount(), corners));
+
+    // Mismo resultado que la referencia, ignorando el orden que deja MeshOptimizer.
+    double expected = 0.0;
+    for (unsigned int y = 0; y < cells; ++y) {
+      for (unsigned int x = 0; x < cells; ++x) {
+        const unsigned int cornersOfCell[6][2] = { { x, y }, { x + 1, y }, { x + 1, y + 1 },
+                                                   { x, y }, { x + 1, y + 1 }, { x, y + 1 } };
+        for (const auto& c : cornersOfCell) {
+          const float height = 0.01f * static_cast<float>((c[0] * 7 + c[1] * 13) % 100);
+          expected += c[0] + 2.0 * height + 3.0 * c[1] +
+                      static_cast<float>(c[0] / static_cast<float>(cells)) +
+                      static_cast<float>(c[1] / static_cast<float>(cells));
+        }
+      }
+    }
+    const double checksum = cornerChecksum(mesh);
+    report.check(std::abs(checksum - expected) < 1e-3 * std::abs(expected),
+      format("Posiciones y UVs de todas las esquinas (%.3f vs %.3f)", checksum, expected));
+
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+  }
+
+  void
+  benchObjWelding(Report& report) {
+    // Caras (triángulos) por archivo, en orden creciente: el pico de memoria del proceso solo crece.
+    const unsigned int faceCounts[] = { 10000, 100000, 1000000, 5000000 };
+    const unsigned int kLinearReferenceMaxFaces = 100000;
+    report.line("  caras     MiB OBJ  parseo ms  soldadura ms  total ms  vértices  pico MiB  lineal ms");
+    for (unsigned int faces : faceCounts) {
+      const unsigned int side = static_cast<unsigned int>(std::sqrt(faces / 2.0) + 0.5);
+      const std::string path = tempPath("pc_bench_weld.obj");
+      if (!writeGridObj(path, side, side)) {
+        report.check(false, format("No se pudo escribir %s", path.c_str()));
+        return;
+      }
+      std::error_code ec;
+      const double fileMiB = std::filesystem::file_size(path, ec) / (1024.0 * 1024.0);
+
+      MeshComponent mesh;
+      ModelLoadStats stats;
+      const HRESULT hr = loadObj(path, 1, mesh, stats);
+      const double peak = peakMemoryMiB();
+      const int vertices = mesh.m_numVertex;
+      mesh = MeshComponent();
+
+      std::string linear = "-";
+      if (faces <= kLinearReferenceMaxFaces) {
+        size_t corners = 0;
+        const Clock::time_point start = Clock::now();
+        weldLinear(path, corners);
+        linear = format("%.0f", elapsedMs(start));
+      }
+      report.line(format("  %-8u  %8.1f  %9.1f  %12.1f  %8.1f  %8d  %8.1f  %9s", side * side * 2, fileMiB,
+        stats.parseMs, stats.weldMs, stats.totalMs, vertices, peak, linear.c_str()));
+      report.check(SUCCEEDED(hr), format("Carga de %u caras", side * side * 2));
+      std::filesystem::remove(path, ec);
+    }
+  }
+
+  void
+  testObjParallelParse(Report& report) {
+    const std::string path = tempPath("pc_selftest_parallel.obj");
+    report.check(writeGridObj(path, 60, 60), "Rejilla OBJ de prueba escrita");
+    MeshComponent serial;
+    ModelLoadStats stats;
+    report.check(SUCCEEDED(loadObj(path, 1, serial, stats)), "Carga en serie");
+    const double reference = cornerChecksum(serial);
+
+    // 7 y 32 fragmentos: el segundo supera el pool compartido y usa uno propio.
+    for (unsigned int threads : { 7u, 32u }) {
+      MeshComponent mesh;
+      const bool loaded = SUCCEEDED(loadObj(path, threads, mesh, stats));
+      report.check(loaded && stats.chunks == threads &&
+                   mesh.m_numVertex == serial.m_numVertex &&
+                   mesh.getIndexCount() == serial.getIndexCount() &&
+                   cornerChecksum(mesh) == reference,
+        format("%u hilos: mismo resultado que en serie (%u fragmentos)", threads, stats.chunks));
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+  }
+
+  void
+  benchObjParallelParse(Report& report) {
+    const std::string path = tempPath("pc_bench_parallel.obj");
+    if (!writeGridObj(path, 707, 707)) {
+      report.check(false, format("No se pudo escribir %s", path.c_str()));
+      return;
+    }
+    report.line(format("  %u núcleos lógicos; ~1M caras", std::thread::hardware_concurrency()));
+    report.line("  hilos  fragmentos  parseo ms  aceleración");
+    double serialMs = 0.0;
+    for (unsigned int threads : { 1u, 2u, 4u, 8u, 16u, 32u }) {
+      // Mejor de tres para que el primer acceso al archivo no cuente.
+      double best = 0.0;
+      unsigned int chunks = 0;
+      for (int run = 0; run < 3; ++run) {
+        MeshComponent mesh;
+        ModelLoadStats stats;
+        if (FAILED(loadObj(path, threads, mesh, stats))) {
+          report.check(false, format("Carga con %u hilos", threads));
+          break;
+        }
+        best = (run == 0) ? stats.parseMs : (std::min)(best, stats.parseMs);
+        chunks = stats.chunks;
+      }
+      if (threads == 1) {
+        serialMs = best;
+      }
+      report.line(format("  %5u  %10u  %9.1f  %10.2fx", threads, chunks, best,
+        best > 0.0 ? serialMs / best : 0.0));
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+  }
+
+  //------------------------------------------------------------------------------------
+  // Excepciones en parallelFor (ThreadPool)
+  //------------------------------------------------------------------------------------
+
+  void
+  testThreadPoolExceptions(Report& report) {
+    ThreadPool pool(4);
+    const size_t kCount = 10000;
+    auto calls = std::make_shared<std::atomic<size_t>>(0);
+    bool caught = false;
+    try {
+      std::vector<int> scratch(kCount, 0);  // Local capturado por referencia, como en los cargadores.
+      pool.parallelFor(kCount, [&](size_t i) {
+        ++*calls;
+        scratch[i] = 1;
+        if (i == kCount / 4) {
+          throw std::runtime_error("fallo en la iteración");
+        }
+      });
+    }
+    catch (const std::runtime_error&) {
+      caught = true;
+    }
+    const size_t callsAtReturn = calls->load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    report.check(caught, "La excepción de body llega al llamador");
+    report.check(calls->load() == callsAtReturn && callsAtReturn <= kCount,
+      format("Ninguna iteración corre después de volver (%zu de %zu ejecutadas)", callsAtReturn, kCount));
+
+    std::atomic<size_t> sum{ 0 };
+    pool.parallelFor(kCount, [&](size_t i) { sum += i; });
+    report.check(sum == kCount * (kCount - 1) / 2, "El pool sigue funcionando después");
+  }
+
+  //------------------------------------------------------------------------------------
+  // Vértice compacto (VertexCodec)
+  //------------------------------------------------------------------------------------
+
+  void
+  testVertexCodec(Report& report) {
+    // Todos los half (salvo NaN) sobreviven la ida y vuelta por float exactamente.
+    unsigned int halfMismatches = 0;
+    for (uint32_t bits = 0; bits <= 0xFFFFu; ++bits) {
+      const uint16_t half = static_cast<uint16_t>(bits);
+      const float value = VertexCodec::halfToFloat(half);
+      const bool isNaN = (half & 0x7C00u) == 0x7C00u && (half & 0x3FFu) != 0;
+      const uint16_t back = VertexCodec::floatToHalf(value);
+      if (isNaN ? !(value != value) || (back & 0x7C00u) != 0x7C00u || (back & 0x3FFu) == 0 : back != half) {
+        ++halfMismatches;
+      }
+    }
+    report.check(halfMismatches == 0, format("half -> float -> half en los 65536 valores (%u diferencias)", halfMismatches));
+    report.check(VertexCodec::floatToHalf(1.0f) == 0x3C00u && VertexCodec::floatToHalf(-2.0f) == 0xC000u &&
+                 VertexCodec::floatToHalf(65504.0f) == 0x7BFFu && VertexCodec::floatToHalf(65520.0f) == 0x7C00u &&
+                 VertexCodec::floatToHalf(std::ldexp(1.0f, -24)) == 0x0001u,
+      "Valores conocidos de half (1, -2, máximo, desborde a Inf, menor subnormal)");
+
+    // Mismo generador en todas las plataformas para que la prueba sea reproducible.
+    uint32_t seed = 12345u;
+    auto random01 = [&seed]() {
+      seed = seed * 1664525u + 1013904223u;
+      return (seed >> 8) / 16777216.0f;
+    };
+
+    float worstHalf = 0.0f;
+    for (int i = 0; i < 100000; ++i) {
+      const float value = (random01() * 2.0f - 1.0f) * 1000.0f;
+      if (std::abs(value) < 1e-3f) {
+        continue;
+      }
+      const float back = VertexCodec::halfToFloat(VertexCodec::floatToHalf(value));
+      worstHalf = (std::max)(worstHalf, std::abs(back - value) / std::abs(value));
+    }
+    report.check(worstHalf <= std::ldexp(1.0f, -11), format("Error relativo de float -> half: %g (límite 2^-11)", worstHalf));
+
+    // Malla con un eje sin extensión (escala 1) y cajas fuera del origen.
+    MeshComponent mesh;
+    mesh.m_name = "SelfTest";
+    for (int i = 0; i < 5000; ++i) {
+      SimpleVertex v;
+      v.Pos = XMFLOAT3(-3.0f + 8.0f * random01(), 0.001f * random01(), 10.0f);
+      v.Tex = XMFLOAT2(random01(), random01());
+      mesh.m_vertex.push_back(v);
+    }
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.computeBounds();
+    const std::vector<SimpleVertex> original = mesh.m_vertex;
+    const CBVertexDequant dequant = VertexCodec::computeDequant(mesh.m_boundsMin, mesh.m_boundsMax);
+
+    // Cada eje se cuantiza a 2^16 - 1 pasos de su caja: el error no pasa de medio paso.
+    const float stepX = dequant.vPosScale.x / 32767.0f, stepY = dequant.vPosScale.y / 32767.0f;
+    bool withinStep = true;
+    float worstUv = 0.0f;
+    for (const SimpleVertex& v : original) {
+      const SimpleVertex decoded = VertexCodec::decode(VertexCodec::encode(v, dequant), dequant);
+      withinStep = withinStep &&
+        std::abs(decoded.Pos.x - v.Pos.x) <= 0.5f * stepX + 1e-6f &&
+        std::abs(decoded.Pos.y - v.Pos.y) <= 0.5f * stepY + 1e-6f &&
+        std::abs(decoded.Pos.z - v.Pos.z) <= 1e-6f;
+      worstUv = (std::max)(worstUv, (std::max)(std::abs(decoded.Tex.x - v.Tex.x), std::abs(decoded.Tex.y - v.Tex.y)));
+    }
+    report.check(withinStep, format("Posición decodificada a menos de medio paso SNORM16 (paso x %g, y %g)", stepX, stepY));
+    report.check(worstUv <= 1.0f / 2048.0f, format("UV decodificada: error máximo %g (límite 1/2048)", worstUv));
+
+    const VertexCodecError error = VertexCodec::encodeMesh(mesh, false);
+    report.check(mesh.m_vertex.empty() && mesh.hasCompactVertices() && mesh.m_compactVertex.size() == original.size(),
+      "encodeMesh(mesh, false) deja solo los vértices compactos");
+    const VertexCodecError measured = VertexCodec::measureError(original, mesh.m_compactVertex, mesh.m_dequant);
+    report.check(measured.maxPosition == error.maxPosition && measured.maxPosition <= 0.5f * std::sqrt(stepX * stepX + stepY * stepY) + 1e-6f,
+      format("Error de posición de la malla: máx %g, rms %g", error.maxPosition, error.rmsPosition));
+
+    const std::vector<D3D11_INPUT_ELEMENT_DESC> layout = VertexCodec::getInputLayout();
+    report.check(sizeof(CompactVertex) == 12 && layout.size() == 2 &&
+                 layout[0].Format == DXGI_FORMAT_R16G16B16A16_SNORM && layout[0].AlignedByteOffset == 0 &&
+                 layout[1].Format == DXGI_FORMAT_R16G16_FLOAT && layout[1].AlignedByteOffset == 8,
+      "InputLayout de CompactVertex coincide con la estructura (12 bytes)");
+  }
+
+  //------------------------------------------------------------------------------------
+  // glTF (GltfLoader)
+  //------------------------------------------------------------------------------------
+
+  /**
+   * @brief Arma un GLB en memoria con un bloque JSON y un bloque BIN.
+   */
+  std::vector<char>
+  makeGlb(const std::string& json, const std::vector<uint8_t>& bin) {
+    auto append32 = [](std::vector<char>& out, uint32_t value) {
+      out.insert(out.end(), reinterpret_cast<const char*>(&value), reinterpret_cast<const char*>(&value) + 4);
+    };
+    std::string paddedJson = json;
+    paddedJson.resize((paddedJson.size() + 3) & ~size_t(3), ' ');
+    std::vector<uint8_t> paddedBin = bin;
+    paddedBin.resize((paddedBin.size() + 3) & ~size_t(3), 0);
+
+    std::vector<char> glb;
+    append32(glb, 0x46546C67);  // "glTF"
+    append32(glb, 2);
+    append32(glb, static_cast<uint32_t>(12 + 8 + paddedJson.size() + 8 + paddedBin.size()));
+    append32(glb, static_cast<uint32_t>(paddedJson.size()));
+    append32(glb, 0x4E4F534A);  // "JSON"
+    glb.insert(glb.end(), paddedJson.begin(), paddedJson.end());
+    append32(glb, static_cast<uint32_t>(paddedBin.size()));
+    append32(glb, 0x004E4942);  // "BIN\0"
+    glb.insert(glb.end(), paddedBin.begin(), paddedBin.end());
+    return glb;
+  }
+
+  /**
+   * @brief JSON de un triángulo: POSITION (3 x float3) en 0..35 e índices uint16 en 36..41.
+   */
+  std::string
+  triangleGltfJson(const std::string& positionCount, const std::string& positionStride) {
+    return "{\"asset\":{\"version\":\"2.0\"},\"buffers\":[{\"byteLength\":44}],"
+           "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":36" + positionStride + "},"
+           "{\"buffer\":0,\"byteOffset\":36,\"byteLength\":6}],"
+           "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":" + positionCount +
+           ",\"type\":\"VEC3\"},{\"bufferView\":1,\"componentType\":5123,\"count\":3,\"type\":\"SCALAR\"}],"
+           "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0},\"indices\":1}]}]}";
+  }
+
+  void
+  testGltfLoader(Report& report) {
+    const float positions[9] = { 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 2.0f, 0.0f, 1.0f, 3.0f };
+    const uint16_t indices[3] = { 0, 1, 2 };
+    std::vector<uint8_t> bin(44, 0);
+    std::memcpy(bin.data(), positions, sizeof(positions));
+    std::memcpy(bin.data() + 36, indices, sizeof(indices));
+
+    {
+      const std::vector<char> glb = makeGlb(triangleGltfJson("3", ""), bin);
+      GltfLoader loader;
+      std::vector<MeshComponent> meshes;
+      const bool loaded = SUCCEEDED(loader.init(glb.data(), glb.size())) && SUCCEEDED(loader.buildMeshes(meshes)) &&
+                          meshes.size() == 1 && meshes[0].m_vertex.size() == 3 && meshes[0].m_index.size() == 3;
+      report.check(loaded, "GLB de un triángulo");
+      if (loaded) {
+        const MeshComponent& mesh = meshes[0];
+        report.check(mesh.m_vertex[1].Pos.x == -1.0f && mesh.m_vertex[2].Pos.y == 1.0f &&
+                     mesh.m_vertex[0].Pos.z == 1.0f && mesh.m_vertex[1].Pos.z == 2.0f && mesh.m_vertex[2].Pos.z == 3.0f,
+          "Posiciones a zurdo: X negada como en FBX, Y y Z intactas");
+        report.check(mesh.m_index[0] == 0 && mesh.m_index[1] == 2 && mesh.m_index[2] == 1,
+          format("Winding invertido: %u %u %u (esperado 0 2 1)", mesh.m_index[0], mesh.m_index[1], mesh.m_index[2]));
+      }
+    }
+
+    // Valores del JSON que no caben en size_t o cuyo tramo desborda: la primitiva se descarta sin leer fuera.
+    const char* hostile[][2] = {
+      { "1e300", "" },                                           // count fuera de rango de size_t
+      { "-1", "" },                                              // count negativo
+      { "4611686018427387904", ",\"byteStride\":1024" },         // 2^62 * 1024 desborda
+      { "3", ",\"byteStride\":1e30" },                           // byteStride fuera de rango
+    };
+    for (const auto& values : hostile) {
+      const std::vector<char> glb = makeGlb(triangleGltfJson(values[0], values[1]), bin);
+      GltfLoader loader;
+      std::vector<MeshComponent> meshes;
+      const bool rejected = FAILED(loader.init(glb.data(), glb.size())) || FAILED(loader.buildMeshes(meshes));
+      const bool defaulted = !rejected && meshes.size() == 1 && meshes[0].m_vertex.size() == 3;
+      report.check(rejected || defaulted, format("count %s%s: rechazado o con valor por defecto", values[0], values[1]));
+    }
+  }
+
+  //------------------------------------------------------------------------------------
+  // FBX binario (FbxBinaryReader)
+  //------------------------------------------------------------------------------------
+
+  /**
+   * @brief Nodo de un FBX binario 7.4 a serializar con writeFbxNode().
+   */
+  struct FbxNodeBytes {
+    std::string name;
+    std::vector<char> properties;
+    uint32_t propertyCount = 0;
+    std::vector<FbxNodeBytes> children;
+
+    template<typename T>
+    FbxNodeBytes&
+      scalar(char type, T value) {
+      properties.push_back(type);
+      properties.insert(properties.end(), reinterpret_cast<const char*>(&value), reinterpret_cast<const char*>(&value) + sizeof(T));
+      ++propertyCount;
+      return *this;
+    }
+
+    FbxNodeBytes&
+      string(const std::string& value) {
+      scalar('S', static_cast<uint32_t>(value.size()));
+      properties.insert(properties.end(), value.begin(), value.end());
+      return *this;
+    }
+
+    template<typename T>
+    FbxNodeBytes&
+      array(char type, const std::vector<T>& values) {
+      scalar(type, static_cast<uint32_t>(values.size()));
+      const uint32_t header[2] = { 0, static_cast<uint32_t>(values.size() * sizeof(T)) };  // Sin comprimir.
+      properties.insert(properties.end(), reinterpret_cast<const char*>(header), reinterpret_cast<const char*>(header) + 8);
+      properties.insert(properties.end(), reinterpret_cast<const char*>(values.data()),
+                        reinterpret_cast<const char*>(values.data()) + values.size() * sizeof(T));
+      return *this;
+    }
+  };
+
+  /**
+   * @brief Escribe @p node al final de @p out; los offsets son absolutos dentro de @p out.
+   */
+  void
+  writeFbxNode(std::vector<char>& out, const FbxNodeBytes& node) {
+    const size_t start = out.size();
+    out.resize(start + 12, 0);
+    out.push_back(static_cast<char>(node.name.size()));
+    out.insert(out.end(), node.name.begin(), node.name.end());
+    out.insert(out.end(), node.properties.begin(), node.properties.end());
+    for (const FbxNodeBytes& child : node.children) {
+      writeFbxNode(out, child);
+    }
+    if (!node.children.empty()) {
+      out.resize(out.size() + 13, 0);  // Registro nulo que cierra la lista de hijos.
+    }
+    const uint32_t record[3] = { static_cast<uint32_t>(out.size()), node.propertyCount,
+                                 static_cast<uint32_t>(node.properties.size()) };
+    std::memcpy(out.data() + start, record, sizeof(record));
+  }
+
+  /**
+   * @brief FBX 7400 con un triángulo y los ejes y unidades indicados en @c GlobalSettings.
+   */
+  std::vector<char>
+  makeTriangleFbx(const FbxAxisConversion& axes) {
+    FbxNodeBytes properties;
+    properties.name = "Properties70";
+    auto addSetting = [&](const char* name, int value) {
+      FbxNodeBytes p;
+      p.name = "P";
+      p.string(name).string("int").string("Integer").string("").scalar('I', static_cast<int32_t>(value));
+      properties.children.push_back(p);
+    };
+    addSetting("UpAxis", axes.upAxis);
+    addSetting("UpAxisSign", axes.upAxisSign);
+    addSetting("FrontAxis", axes.frontAxis);
+    addSetting("FrontAxisSign", axes.frontAxisSign);
+    addSetting("CoordAxis", axes.coordAxis);
+    addSetting("CoordAxisSign", axes.coordAxisSign);
+    FbxNodeBytes unit;
+    unit.name = "P";
+    unit.string("UnitScaleFactor").string("double").string("Number").string("").scalar('D', axes.unitScaleFactor);
+    properties.children.push_back(unit);
+
+    FbxNodeBytes settings;
+    settings.name = "GlobalSettings";
+    settings.children.push_back(properties);
+
+    FbxNodeBytes vertices;
+    vertices.name = "Vertices";
+    vertices.array('d', std::vector<double>{ 0.0, 0.0, 0.0, 100.0, 0.0, 0.0, 0.0, 200.0, 300.0 });
+    FbxNodeBytes polygons;
+    polygons.name = "PolygonVertexIndex";
+    polygons.array('i', std::vector<int32_t>{ 0, 1, ~2 });
+
+    FbxNodeBytes geometry;
+    geometry.name = "Geometry";
+    geometry.scalar('L', int64_t(1)).string(std::string("Tri\x00\x01Geometry", 13)).string("Mesh");
+    geometry.children.push_back(vertices);
+    geometry.children.push_back(polygons);
+
+    FbxNodeBytes objects;
+    objects.name = "Objects";
+    objects.children.push_back(geometry);
+
+    std::vector<char> fbx(27, 0);
+    std::memcpy(fbx.data(), "Kaydara FBX Binary  \0\x1A\0", 23);
+    const uint32_t version = 7400;
+    std::memcpy(fbx.data() + 23, &version, 4);
+    writeFbxNode(fbx, settings);
+    writeFbxNode(fbx, objects);
+    fbx.resize(fbx.size() + 13, 0);
+    return fbx;
+  }
+
+  void
+  testFbxAxisConversion(Report& report) {
+    struct Case {
+      const char* name;
+      FbxAxisConversion axes;
+      XMFLOAT3 expected[3];
+      bool swapped;
+    };
+    // Triángulo del archivo: (0,0,0), (100,0,0), (0,200,300).
+    const Case cases[] = {
+      { "Y arriba, mano derecha, cm (Maya)", { 1, 1, 2, 1, 0, 1, 1.0 },
+        { { 0, 0, 0 }, { -1, 0, 0 }, { 0, 2, 3 } }, true },
+      { "Z arriba, mano derecha, pulgadas (3ds Max)", { 2, 1, 1, -1, 0, 1, 2.54 },
+        { { 0, 0, 0 }, { -2.54f, 0, 0 }, { 0, 7.62f, -5.08f } }, true },
+      { "Sistema del motor (DirectX, m)", { 1, 1, 2, 1, 0, -1, 100.0 },
+        { { 0, 0, 0 }, { 100, 0, 0 }, { 0, 200, 300 } }, false },
+    };
+
+    for (const Case& test : cases) {
+      const std::vector<char> fbx = makeTriangleFbx(test.axes);
+      FbxBinaryReader reader;
+      std::vector<MeshComponent> meshes;
+      const bool loaded = SUCCEEDED(reader.init(fbx.data(), fbx.size())) && SUCCEEDED(reader.buildMeshes(meshes)) &&
+                          meshes.size() == 1 && meshes[0].m_vertex.size() == 3 && meshes[0].m_index.size() == 3;
+      report.check(loaded, format("%s: carga", test.name));
+      if (!loaded) {
+        continue;
+      }
+
+      const MeshComponent& mesh = meshes[0];
+      double error = 0.0;
+      for (int i = 0; i < 3; ++i) {
+        const XMFLOAT3& p = mesh.m_vertex[i].Pos;
+        error = (std::max)(error, static_cast<double>(std::fabs(p.x - test.expected[i].x) +
+                                                      std::fabs(p.y - test.expected[i].y) +
+                                                      std::fabs(p.z - test.expected[i].z)));
+      }
+      report.check(error < 1e-4, format("%s: posiciones (error %.2g)", test.name, error));
+      const bool swapped = mesh.m_index[1] == 2 && mesh.m_index[2] == 1;
+      report.check(mesh.m_index[0] == 0 && swapped == test.swapped,
+        format("%s: winding %u %u %u", test.name, mesh.m_index[0], mesh.m_index[1], mesh.m_index[2]));
+    }
+
+    // Ejes repetidos: la ruta nativa se niega y Model3D recurre al SDK.
+    const std::vector<char> fbx = makeTriangleFbx({ 1, 1, 1, 1, 0, 1, 1.0 });
+    FbxBinaryReader reader;
+    std::vector<MeshComponent> meshes;
+    report.check(SUCCEEDED(reader.init(fbx.data(), fbx.size())) && FAILED(reader.buildMeshes(meshes)) && meshes.empty(),
+      "GlobalSettings inválido: buildMeshes() falla");
+  }
+
+  //------------------------------------------------------------------------------------
+  // Frustum culling (FrustumCuller)
+  //------------------------------------------------------------------------------------
+
+  /**
+   * @brief Volúmenes aleatorios en un cubo de lado 1000 centrado en la cámara.
+   */
+  std::vector<BoundingVolume>
+  makeRandomVolumes(size_t count, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> halfSize(0.1f, 8.0f);
+    std::vector<BoundingVolume> volumes(count);
+    for (BoundingVolume& volume : volumes) {
+      volume.center = XMFLOAT3(position(random), position(random), position(random));
+      const XMFLOAT3 e(halfSize(random), halfSize(random), halfSize(random));
+      volume.aabbMin = XMFLOAT3(volume.center.x - e.x, volume.center.y - e.y, volume.center.z - e.z);
+      volume.aabbMax = XMFLOAT3(volume.center.x + e.x, volume.center.y + e.y, volume.center.z + e.z);
+      volume.radius = std::sqrt(e.x * e.x + e.y * e.y + e.z * e.z);
+    }
+    return volumes;
+  }
+
+  /**
+   * @brief Referencia escalar de FrustumCuller::cull(): esfera y caja, un volumen a la vez.
+   *
+   * Evalúa las mismas operaciones en el mismo orden que el kernel SSE, así que el resultado
+   * debe coincidir exactamente.
+   */
+  void
+  cullScalar(const XMFLOAT4* planes, const std::vector<BoundingVolume>& volumes, std::vector<uint32_t>& visible) {
+    visible.clear();
+    for (size_t i = 0; i < volumes.size(); ++i) {
+      const BoundingVolume& v = volumes[i];
+      bool inside = true;
+      for (int p = 0; p < 6 && inside; ++p) {
+        const float distance = v.center.x * planes[p].x + v.center.y * planes[p].y +
+                               v.center.z * planes[p].z + planes[p].w;
+        inside = distance >= -v.radius;
+      }
+      const XMFLOAT3 c((v.aabbMin.x + v.aabbMax.x) * 0.5f, (v.aabbMin.y + v.aabbMax.y) * 0.5f,
+                       (v.aabbMin.z + v.aabbMax.z) * 0.5f);
+      const XMFLOAT3 e((v.aabbMax.x - v.aabbMin.x) * 0.5f, (v.aabbMax.y - v.aabbMin.y) * 0.5f,
+                       (v.aabbMax.z - v.aabbMin.z) * 0.5f);
+      for (int p = 0; p < 6 && inside; ++p) {
+        const float distance = planes[p].x * c.x + planes[p].y * c.y + planes[p].z * c.z + planes[p].w;
+        const float reach = std::fabs(planes[p].x) * e.x + std::fabs(planes[p].y) * e.y + std::fabs(planes[p].z) * e.z;
+        inside = distance + reach >= 0.0f;
+      }
+      if (inside) {
+        visible.push_back(static_cast<uint32_t>(i));
+      }
+    }
+  }
+
+  /**
+   * @brief Cámara en el origen mirando a +Z: 60 grados, 16:9, de 0.1 a 1000.
+   */
+  XMMATRIX
+  testViewProjection() {
+    return XMMatrixPerspectiveFovLH(XM_PI / 3.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+  }
+
+  void
+  testFrustumCuller(Report& report) {
+    FrustumCuller culler;
+    culler.setViewProjection(testViewProjection());
+
+    // Tamaños con y sin cola de menos de cuatro volúmenes.
+    const size_t counts[] = { 0, 1, 2, 3, 4, 5, 7, 10007 };
+    for (size_t count : counts) {
+      const std::vector<BoundingVolume> volumes = makeRandomVolumes(count, static_cast<uint32_t>(count) + 1);
+      culler.clear();
+      for (const BoundingVolume& volume : volumes) {
+        culler.add(volume);
+      }
+      std::vector<uint32_t> simd, scalar;
+      culler.cull(simd);
+      cullScalar(culler.getPlanes(), volumes, scalar);
+      report.check(simd == scalar && culler.getStats().tested == count && culler.getStats().visible == simd.size(),
+        format("%zu volúmenes: SSE y escalar coinciden (%zu visibles)", count, simd.size()));
+    }
+
+    // Casos conocidos: delante, detrás, a un lado y más allá del plano lejano.
+    const XMFLOAT3 centers[] = { { 0, 0, 10 }, { 0, 0, -10 }, { 100, 0, 10 }, { 0, 0, 1100 }, { 0, 0, 1000.5f } };
+    const bool expected[] = { true, false, false, false, true };
+    culler.clear();
+    for (const XMFLOAT3& center : centers) {
+      BoundingVolume volume;
+      volume.center = center;
+      volume.radius = std::sqrt(3.0f);
+      volume.aabbMin = XMFLOAT3(center.x - 1, center.y - 1, center.z - 1);
+      volume.aabbMax = XMFLOAT3(center.x + 1, center.y + 1, center.z + 1);
+      culler.add(volume);
+    }
+    std::vector<uint32_t> visible;
+    culler.cull(visible);
+    bool matches = true;
+    for (size_t i = 0; i < 5; ++i) {
+      matches = matches && (std::find(visible.begin(), visible.end(), static_cast<uint32_t>(i)) != visible.end()) == expected[i];
+    }
+    report.check(matches, "Delante visible; detrás, a un lado y tras el plano lejano descartados");
+  }
+
+  void
+  benchFrustumCuller(Report& report) {
+    const size_t kVolumes = 100000;
+    const int kPasses = 50;
+    const std::vector<BoundingVolume> volumes = makeRandomVolumes(kVolumes, 7);
+    FrustumCuller culler;
+    culler.setViewProjection(testViewProjection());
+    culler.reserve(kVolumes);
+
+    Clock::time_point start = Clock::now();
+    for (const BoundingVolume& volume : volumes) {
+      culler.add(volume);
+    }
+    const double addMs = elapsedMs(start);
+
+    // Mediana de varias pasadas: la primera calienta caché y reservas.
+    std::vector<uint32_t> simd, scalar;
+    std::vector<double> simdMs, scalarMs;
+    for (int pass = 0; pass < kPasses; ++pass) {
+      start = Clock::now();
+      culler.cull(simd);
+      simdMs.push_back(elapsedMs(start));
+      start = Clock::now();
+      cullScalar(culler.getPlanes(), volumes, scalar);
+      scalarMs.push_back(elapsedMs(start));
+    }
+    std::sort(simdMs.begin(), simdMs.end());
+    std::sort(scalarMs.begin(), scalarMs.end());
+
+    report.line(format("  %zu volúmenes, %zu visibles; add() %.2f ms", kVolumes, simd.size(), addMs));
+    report.line(format("  cull() SSE: mediana %.3f ms, mínimo %.3f ms (%.1f ns por volumen)",
+      simdMs[kPasses / 2], simdMs[0], simdMs[kPasses / 2] * 1e6 / kVolumes));
+    report.line(format("  referencia escalar: mediana %.3f ms, mínimo %.3f ms (x%.2f)",
+      scalarMs[kPasses / 2], scalarMs[0], scalarMs[kPasses / 2] / (std::max)(simdMs[kPasses / 2], 1e-6)));
+    report.check(simd == scalar, "SSE y escalar coinciden");
+  }
+
+  //------------------------------------------------------------------------------------
+  // Mips en CPU (MipGenerator, TextureCache)
+  //------------------------------------------------------------------------------------
+
+  std::vector<uint8_t>
+  makeNoiseRgba(uint32_t width, uint32_t height, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    for (uint8_t& value : pixels) {
+      value = static_cast<uint8_t>(random() & 0xFF);
+    }
+    return pixels;
+  }
+
+  double
+  srgbToLinear(double c) {
+    return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+  }
+
+  double
+  linearToSrgb(double l) {
+    return l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+  }
+
+  /**
+   * @brief Referencia escalar en doble precisión del filtro Box para dimensiones potencia de 2.
+   *
+   * Como MipGenerator, cada nivel se promedia a partir del anterior sin recuantizar.
+   *
+   * @return Mayor diferencia, en códigos de 8 bits, entre @p chain y la referencia.
+   */
+  int
+  compareBoxReference(const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height,
+                      bool srgb, const MipChain& chain) {
+    std::vector<double> level(pixels.size());
+    for (size_t i = 0; i < pixels.size(); ++i) {
+      const double c = pixels[i] / 255.0;
+      level[i] = (srgb && i % 4 != 3) ? srgbToLinear(c) : c;
+    }
+
+    int maxDifference = 0;
+    uint32_t w = width, h = height;
+    for (size_t mip = 1; mip < chain.levels.size(); ++mip) {
+      const uint32_t dw = (std::max)(1u, w / 2), dh = (std::max)(1u, h / 2);
+      const uint32_t bx = w / dw, by = h / dh;
+      std::vector<double> next(static_cast<size_t>(dw) * dh * 4, 0.0);
+      for (uint32_t y = 0; y < dh; ++y) {
+        for (uint32_t x = 0; x < dw; ++x) {
+          for (uint32_t j = 0; j < by; ++j) {
+            for (uint32_t i = 0; i < bx; ++i) {
+              for (int c = 0; c < 4; ++c) {
+                next[(static_cast<size_t>(y) * dw + x) * 4 + c] +=
+                  level[(static_cast<size_t>(y * by + j) * w + x * bx + i) * 4 + c] / (bx * by);
+              }
+            }
+          }
+        }
+      }
+
+      const uint8_t* actual = chain.getLevelData(mip);
+      for (size_t i = 0; i < next.size(); ++i) {
+        const double value = (srgb && i % 4 != 3) ? linearToSrgb(next[i]) : next[i];
+        const int expected = static_cast<int>(std::floor(value * 255.0 + 0.5));
+        maxDifference = (std::max)(maxDifference, std::abs(expected - actual[i]));
+      }
+      level.swap(next);
+      w = dw;
+      h = dh;
+    }
+    return maxDifference;
+  }
+
+  //------------------------------------------------------------------------------------
+  // Rangos de meshlets visibles (MeshletBuilder::cull)
+  //------------------------------------------------------------------------------------
+
+  void
+  testMeshletRanges(Report& report) {
+    FrustumCuller frustum;
+    frustum.setViewProjection(testViewProjection());
+    const XMFLOAT3 camera(0.0f, 0.0f, 0.0f);
+    const uint32_t kIndices = static_cast<uint32_t>(MeshletBuilder::kMaxTriangles * 3);
+
+    // Clústeres llenos y contiguos; los visibles delante de la cámara, los demás detrás.
+    auto makeMeshlets = [&](const std::string& pattern) {
+      std::vector<Meshlet> meshlets(pattern.size());
+      for (size_t i = 0; i < pattern.size(); ++i) {
+        Meshlet& m = meshlets[i];
+        m.indexStart = static_cast<uint32_t>(i) * kIndices;
+        m.indexCount = kIndices;
+        m.center = XMFLOAT3(0.0f, 0.0f, pattern[i] == '#' ? 50.0f : -50.0f);
+        m.radius = 1.0f;
+        m.coneAxis = XMFLOAT3(0.0f, 0.0f, 1.0f);
+        m.coneCutoff = 1.0f;
+      }
+      return meshlets;
+    };
+
+    struct Case {
+      const char* name;
+      std::string pattern;    ///< '#' = visible, '.' = descartado.
+      size_t expectedRanges;
+    };
+    const Case cases[] = {
+      { "Todos visibles: un rango", std::string(40, '#'), 1 },
+      { "Huecos de un clúster: se dibujan y queda un rango", "#.#.#.##.#", 1 },
+      { "Dos grupos lejanos: dos rangos", "###......###", 2 },
+      { "Muchos grupos lejanos: se cae a un rango", "#..#..#..#..#..#..#..#..#..#", 1 },
+      { "Nada visible: sin rangos", "......", 0 },
+    };
+    for (const Case& test : cases) {
+      const std::vector<Meshlet> meshlets = makeMeshlets(test.pattern);
+      std::vector<MeshletRange> ranges;
+      const size_t visible = MeshletBuilder::cull(meshlets, XMMatrixIdentity(), frustum, camera, ranges);
+
+      // Cada clúster visible queda cubierto por algún rango.
+      bool covered = visible == static_cast<size_t>(std::count(test.pattern.begin(), test.pattern.end(), '#'));
+      for (const Meshlet& m : meshlets) {
+        if (m.center.z < 0.0f) {
+          continue;
+        }
+        bool found = false;
+        for (const MeshletRange& r : ranges) {
+          found = found || (m.indexStart >= r.indexStart && m.indexStart + m.indexCount <= r.indexStart + r.indexCount);
+        }
+        covered = covered && found;
+      }
+      report.check(covered && ranges.size() == test.expectedRanges && ranges.size() <= MeshletBuilder::kMaxRanges,
+        format("%s (%zu rangos)", test.name, ranges.size()));
+    }
+  }
+
+  void
+  testMipGenerator(Report& report) {
+    report.check(MipGenerator::getMipCount(256, 128) == 9 && MipGenerator::getMipCount(37, 21) == 6 &&
+                 MipGenerator::getMipCount(1, 1) == 1, "Número de niveles hasta 1x1");
+
+    const std::vector<uint8_t> noise = makeNoiseRgba(256, 128, 11);
+    for (bool srgb : { false, true }) {
+      MipSettings settings;
+      settings.filter = MipFilter::Box;
+      settings.srgb = srgb;
+      MipChain chain;
+      const bool built = SUCCEEDED(MipGenerator::generate(noise.data(), 256, 128, settings, chain)) &&
+                         chain.levels.size() == 9 && chain.levels.back().width == 1 && chain.levels.back().height == 1;
+      const int difference = built ? compareBoxReference(noise, 256, 128, srgb, chain) : 255;
+      report.check(built && difference <= 1,
+        format("Box %s sobre ruido 256x128: máx %d LSB contra la referencia en doble precisión (límite 1)",
+          srgb ? "sRGB" : "lineal", difference));
+    }
+
+    // Damero blanco y negro de un píxel: en sRGB el gris medio perceptual es 188, no 128.
+    std::vector<uint8_t> checker(64 * 64 * 4);
+    for (uint32_t y = 0; y < 64; ++y) {
+      for (uint32_t x = 0; x < 64; ++x) {
+        uint8_t* texel = &checker[(static_cast<size_t>(y) * 64 + x) * 4];
+        texel[0] = texel[1] = texel[2] = ((x + y) & 1) ? 255 : 0;
+        texel[3] = 255;
+      }
+    }
+    for (bool srgb : { false, true }) {
+      MipSettings settings;
+      settings.filter = MipFilter::Box;
+      settings.srgb = srgb;
+      MipChain chain;
+      MipGenerator::generate(checker.data(), 64, 64, settings, chain);
+      const uint8_t expected = srgb ? 188 : 128;
+      bool uniform = chain.levels.size() == 7;
+      for (size_t mip = 1; uniform && mip < chain.levels.size(); ++mip) {
+        const uint8_t* texels = chain.getLevelData(mip);
+        for (uint32_t i = 0; uniform && i < chain.levels[mip].width * chain.levels[mip].height; ++i) {
+          uniform = texels[i * 4] == expected && texels[i * 4 + 2] == expected && texels[i * 4 + 3] == 255;
+        }
+      }
+      report.check(uniform, format("Damero %s: todos los niveles valen %u", srgb ? "sRGB" : "lineal", expected));
+    }
+
+    // Imagen constante de tamaño impar: los pesos de Kaiser suman 1, el color no cambia.
+    std::vector<uint8_t> constant(37 * 21 * 4);
+    for (size_t i = 0; i < constant.size(); i += 4) {
+      constant[i] = 37; constant[i + 1] = 140; constant[i + 2] = 250; constant[i + 3] = 90;
+    }
+    MipSettings kaiser;
+    MipChain chain;
+    MipGenerator::generate(constant.data(), 37, 21, kaiser, chain);
+    bool exact = chain.levels.size() == 6;
+    for (size_t mip = 1; exact && mip < chain.levels.size(); ++mip) {
+      exact = std::memcmp(chain.getLevelData(mip), constant.data(), chain.levels[mip].size) == 0;
+    }
+    report.check(exact, "Kaiser sobre imagen constante 37x21: todos los niveles exactos");
+  }
+
+  /**
+   * @brief Escribe una imagen TGA sin comprimir de 32 bits (origen arriba a la izquierda).
+   */
+  bool
+  writeTga(const std::string& path, const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    uint8_t header[18] = {};
+    header[2] = 2;  // Color verdadero sin comprimir.
+    header[12] = static_cast<uint8_t>(width);
+    header[13] = static_cast<uint8_t>(width >> 8);
+    header[14] = static_cast<uint8_t>(height);
+    header[15] = static_cast<uint8_t>(height >> 8);
+    header[16] = 32;
+    header[17] = 0x28;  // 8 bits de alfa, origen arriba.
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    std::vector<uint8_t> bgra(rgba);
+    for (size_t i = 0; i < bgra.size(); i += 4) {
+      std::swap(bgra[i], bgra[i + 2]);
+    }
+    file.write(reinterpret_cast<const char*>(bgra.data()), bgra.size());
+    return static_cast<bool>(file);
+  }
+
+  void
+  testTextureCache(Report& report) {
+    const std::string previousDirectory = TextureCache::getDirectory();
+    const std::string directory = tempPath("pc_selftest_textures");
+    std::error_code ec;
+    std::filesystem::remove_all(directory, ec);
+    TextureCache::setDirectory(directory);
+
+    const std::vector<uint8_t> noise = makeNoiseRgba(64, 32, 5);
+    MipChain built;
+    MipGenerator::generate(noise.data(), 64, 32, MipSettings(), built);
+    const uint64_t key = TextureCache::computeKey(noise.data(), noise.size(), MipSettings().toString());
+    const std::string cachePath = TextureCache::getCachePath(key);
+    report.check(SUCCEEDED(TextureCache::save(cachePath, key, built)), "save() escribe la cadena");
+
+    {
+      MipChain loaded;
+      const bool ok = TextureCache::load(cachePath, key, loaded) && loaded.format == built.format &&
+                      loaded.width == 64 && loaded.height == 32 && loaded.levels.size() == built.levels.size() &&
+                      loaded.getDataSize() == built.getDataSize() &&
+                      std::memcmp(loaded.getData(), built.getData(), built.getDataSize()) == 0;
+      report.check(ok, "load() devuelve los mismos niveles y texeles");
+      MipChain stale;
+      report.check(!TextureCache::load(cachePath, key + 1, stale) && stale.levels.empty(),
+        "Una clave distinta invalida la entrada");
+    }
+
+    // loadOrBuild(): la primera llamada genera y guarda, la segunda proyecta la caché.
+    const std::string source = tempPath("pc_selftest_noise.tga");
+    TextureImportSettings settings;
+    settings.compression = BlockFormat::None;
+    writeTga(source, noise, 64, 32);
+    MipChain first, second;
+    const bool ok = SUCCEEDED(TextureCache::loadOrBuild(source, settings, first)) &&
+                    SUCCEEDED(TextureCache::loadOrBuild(source, settings, second));
+    report.check(ok && !first.mapping && second.mapping && second.getDataSize() == built.getDataSize() &&
+                 std::memcmp(second.getData(), built.getData(), built.getDataSize()) == 0,
+      "loadOrBuild(): genera, guarda y luego carga de la caché sin cambios");
+
+    first = MipChain();
+    second = MipChain();
+
+    // Con compresión el DDS va al directorio de caché, nunca junto a la fuente.
+    settings.compression = BlockFormat::BC1;
+    const bool compressed = SUCCEEDED(TextureCache::loadOrBuild(source, settings, first)) &&
+                            SUCCEEDED(TextureCache::loadOrBuild(source, settings, second));
+    std::ifstream sourceFile(source, std::ios::binary);
+    const std::vector<char> sourceBytes((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
+    const uint64_t bcKey = TextureCache::computeKey(sourceBytes.data(), sourceBytes.size(), settings.toString());
+    report.check(compressed && first.format == DXGI_FORMAT_BC1_UNORM && second.mapping &&
+                 std::filesystem::exists(TextureCache::getDdsPath(bcKey), ec) &&
+                 !std::filesystem::exists(std::filesystem::path(source).replace_extension(".dds"), ec),
+      "loadOrBuild() con BC1: el DDS se escribe en el directorio de caché");
+    first = MipChain();
+    second = MipChain();
+
+    // evict(): borra primero las entradas usadas hace más tiempo hasta caber en el límite.
+    std::filesystem::remove_all(directory, ec);
+    std::vector<std::string> entries;
+    for (uint64_t i = 0; i < 3; ++i) {
+      entries.push_back(TextureCache::getCachePath(key + i));
+      TextureCache::save(entries.back(), key + i, built);
+      std::filesystem::last_write_time(entries.back(),
+        std::filesystem::file_time_type::clock::now() - std::chrono::hours(3 - i), ec);
+    }
+    const uint64_t entrySize = std::filesystem::file_size(entries[0], ec);
+    const uint64_t freed = TextureCache::evict(entrySize * 2);
+    report.check(freed == entrySize && !std::filesystem::exists(entries[0], ec) &&
+                 std::filesystem::exists(entries[1], ec) && std::filesystem::exists(entries[2], ec),
+      "evict(): borra la entrada más antigua y conserva las recientes");
+
+    std::filesystem::remove(source, ec);
+    std::filesystem::remove_all(directory, ec);
+    TextureCache::setDirectory(previousDirectory);
+  }
+
+  void
+  benchMipGenerator(Report& report) {
+    const uint32_t kSize = 2048;
+    const std::vector<uint8_t> noise = makeNoiseRgba(kSize, kSize, 3);
+    report.line(format("  Cadena completa de %ux%u (%u hilos):", kSize, kSize, std::thread::hardware_concurrency()));
+    for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser }) {
+      for (bool srgb : { false, true }) {
+        MipSettings settings;
+        settings.filter = filter;
+        settings.srgb = srgb;
+        MipChain chain;
+        const Clock::time_point start = Clock::now();
+        const HRESULT hr = MipGenerator::generate(noise.data(), kSize, kSize, settings, chain);
+        report.line(format("    %-6s %-6s %8.1f ms", filter == MipFilter::Box ? "box" : "kaiser",
+          srgb ? "sRGB" : "lineal", elapsedMs(start)));
+        report.check(SUCCEEDED(hr) && chain.levels.size() == 12, "12 niveles");
+      }
+    }
+
+    // Caché: fallo (decodificar TGA, generar y escribir) contra acierto (proyectar).
+    const std::string previousDirectory = TextureCache::getDirectory();
+    const std::string directory = tempPath("pc_bench_textures");
+    const std::string source = tempPath("pc_bench_texture.tga");
+    std::error_code ec;
+    TextureCache::setDirectory(directory);
+    writeTga(source, makeNoiseRgba(512, 512, 9), 512, 512);
+    TextureImportSettings settings;
+    settings.compression = BlockFormat::None;
+
+    std::vector<double> missMs, hitMs;
+    for (int pass = 0; pass < 5; ++pass) {
+      std::filesystem::remove_all(directory, ec);
+      MipChain chain;
+      Clock::time_point start = Clock::now();
+      TextureCache::loadOrBuild(source, settings, chain);
+      missMs.push_back(elapsedMs(start));
+      chain = MipChain();
+      start = Clock::now();
+      TextureCache::loadOrBuild(source, settings, chain);
+      hitMs.push_back(elapsedMs(start));
+    }
+    std::sort(missMs.begin(), missMs.end());
+    std::sort(hitMs.begin(), hitMs.end());
+    report.line(format("  512x512 Kaiser sRGB: sin caché %.1f ms, con caché %.2f ms (medianas de 5)",
+      missMs[2], hitMs[2]));
+    report.check(hitMs[2] < missMs[2], "La caché es más rápida que generar");
+
+    std::filesystem::remove(source, ec);
+    std::filesystem::remove_all(directory, ec);
+    TextureCache::setDirectory(previousDirectory);
+  }
+
+  //------------------------------------------------------------------------------------
+  // Compresión por bloques (BlockCompressor, DdsFile)
+  //------------------------------------------------------------------------------------
+
+  /**
+   * @brief Decodificadores de bloque escritos a partir de la especificación de D3D11,
+   *        independientes del compresor. Escriben 16 texeles RGBA8 en orden de filas.
+   */
+  void
+  decodeBc1Block(const uint8_t* block, uint8_t* out, bool forceFourColors) {
+    const uint16_t c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+    const uint16_t c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+    int palette[4][4];
+    for (int e = 0; e < 2; ++e) {
+      const uint16_t c = e == 0 ? c0 : c1;
+      const int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+      palette[e][0] = (r << 3) | (r >> 2);
+      palette[e][1] = (g << 2) | (g >> 4);
+      palette[e][2] = (b << 3) | (b >> 2);
+      palette[e][3] = 255;
+    }
+    const bool fourColors = forceFourColors || c0 > c1;
+    for (int ch = 0; ch < 3; ++ch) {
+      if (fourColors) {
+        palette[2][ch] = (2 * palette[0][ch] + palette[1][ch]) / 3;
+        palette[3][ch] = (palette[0][ch] + 2 * palette[1][ch]) / 3;
+      }
+      else {
+        palette[2][ch] = (palette[0][ch] + palette[1][ch]) / 2;
+        palette[3][ch] = 0;
+      }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = fourColors ? 255 : 0;
+
+    const uint32_t bits = static_cast<uint32_t>(block[4] | (block[5] << 8) | (block[6] << 16)) |
+                          (static_cast<uint32_t>(block[7]) << 24);
+    for (int t = 0; t < 16; ++t) {
+      const int* color = palette[(bits >> (2 * t)) & 3];
+      for (int ch = 0; ch < 4; ++ch) {
+        out[t * 4 + ch] = static_cast<uint8_t>(color[ch]);
+      }
+    }
+  }
+
+  /**
+   * @brief BC4 sin signo: escribe un canal (@p channel) de los 16 texeles.
+   */
+  void
+  decodeBc4Block(const uint8_t* block, uint8_t* out, int channel) {
+    const int a0 = block[0], a1 = block[1];
+    int palette[8] = { a0, a1 };
+    if (a0 > a1) {
+      for (int i = 1; i < 7; ++i) {
+        palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+      }
+    }
+    else {
+      for (int i = 1; i < 5; ++i) {
+        palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+      }
+      palette[6] = 0;
+      palette[7] = 255;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i) {
+      bits |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+    }
+    for (int t = 0; t < 16; ++t) {
+      out[t * 4 + channel] = static_cast<uint8_t>(palette[(bits >> (3 * t)) & 7]);
+    }
+  }
+
+  /**
+   * @brief BC7; solo el modo 6, el único que emite el compresor.
+   * @return @c false si el bloque usa otro modo.
+   */
+  bool
+  decodeBc7Block(const uint8_t* block, uint8_t* out) {
+    auto bitsAt = [block](int first, int count) {
+      uint32_t value = 0;
+      for (int i = 0; i < count; ++i) {
+        value |= static_cast<uint32_t>((block[(first + i) >> 3] >> ((first + i) & 7)) & 1) << i;
+      }
+      return value;
+    };
+    if (bitsAt(0, 7) != 0x40) {
+      return false;
+    }
+    int endpoints[2][4];
+    for (int ch = 0; ch < 4; ++ch) {
+      for (int e = 0; e < 2; ++e) {
+        endpoints[e][ch] = static_cast<int>(bitsAt(7 + ch * 14 + e * 7, 7) << 1);
+      }
+    }
+    for (int e = 0; e < 2; ++e) {
+      const int pBit = static_cast<int>(bitsAt(63 + e, 1));
+      for (int ch = 0; ch < 4; ++ch) {
+        endpoints[e][ch] |= pBit;
+      }
+    }
+    static const int kWeights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+    int position = 65;
+    for (int t = 0; t < 16; ++t) {
+      const int count = t == 0 ? 3 : 4;  // El texel ancla tiene un bit implícito a 0.
+      const int w = kWeights[bitsAt(position, count)];
+      position += count;
+      for (int ch = 0; ch < 4; ++ch) {
+        out[t * 4 + ch] = static_cast<uint8_t>(((64 - w) * endpoints[0][ch] + w * endpoints[1][ch] + 32) >> 6);
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Decodifica el nivel 0 de una cadena BC a RGBA8 (canales ausentes: 0 y alfa 255).
+   */
+  bool
+  decodeBlockLevel(const MipChain& chain, std::vector<uint8_t>& rgba) {
+    const MipLevel& level = chain.levels[0];
+    rgba.assign(static_cast<size_t>(level.width) * level.height * 4, 0);
+    const uint8_t* blocks = chain.getLevelData(0);
+    const uint32_t blocksX = level.width / 4;
+    for (uint32_t by = 0; by < level.height / 4; ++by) {
+      for (uint32_t bx = 0; bx < blocksX; ++bx) {
+        uint8_t texels[64] = {};
+        switch (chain.format) {
+        case DXGI_FORMAT_BC1_UNORM:
+          decodeBc1Block(blocks, texels, false);
+          blocks += 8;
+          break;
+        case DXGI_FORMAT_BC3_UNORM:
+          decodeBc1Block(blocks + 8, texels, true);
+          decodeBc4Block(blocks, texels, 3);
+          blocks += 16;
+          break;
+        case DXGI_FORMAT_BC5_UNORM:
+          decodeBc4Block(blocks, texels, 0);
+          decodeBc4Block(blocks + 8, texels, 1);
+          for (int t = 0; t < 16; ++t) texels[t * 4 + 3] = 255;
+          blocks += 16;
+          break;
+        case DXGI_FORMAT_BC7_UNORM:
+          if (!decodeBc7Block(blocks, texels)) return false;
+          blocks += 16;
+          break;
+        default:
+          return false;
+        }
+        for (int t = 0; t < 16; ++t) {
+          const size_t x = bx * 4 + (t & 3), y = by * 4 + (t >> 2);
+          std::memcpy(&rgba[(y * level.width + x) * 4], &texels[t * 4], 4);
+        }
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief PSNR en dB sobre los canales indicados por @p channelMask (bit 0 = R ... bit 3 = A).
+   */
+  double
+  psnr(const uint8_t* a, const uint8_t* b, size_t texelCount, int channelMask) {
+    double squared = 0.0;
+    size_t samples = 0;
+    for (size_t i = 0; i < texelCount; ++i) {
+      for (int ch = 0; ch < 4; ++ch) {
+        if (channelMask & (1 << ch)) {
+          const double d = static_cast<double>(a[i * 4 + ch]) - b[i * 4 + ch];
+          squared += d * d;
+          ++samples;
+        }
+      }
+    }
+    const double mse = squared / (std::max)(samples, size_t(1));
+    return mse <= 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+  }
+
+  /**
+   * @brief Imagen sintética: degradados suaves, una onda, bordes duros y alfa en rampa.
+   */
+  std::vector<uint8_t>
+  makeSyntheticImage(uint32_t size) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * 4);
+    for (uint32_t y = 0; y < size; ++y) {
+      for (uint32_t x = 0; x < size; ++x) {
+        uint8_t* texel = &pixels[(static_cast<size_t>(y) * size + x) * 4];
+        const bool edge = ((x / 64) + (y / 64)) % 5 == 0;
+        texel[0] = static_cast<uint8_t>(x * 255 / (size - 1));
+        texel[1] = static_cast<uint8_t>(y * 255 / (size - 1));
+        texel[2] = static_cast<uint8_t>(edge ? 30 : 128 + 100 * std::sin(x * 0.05) * std::cos(y * 0.03));
+        texel[3] = static_cast<uint8_t>((x + y) * 255 / (2 * (size - 1)));
+      }
+    }
+    return pixels;
+  }
+
+  void
+  testBlockCompressor(Report& report) {
+    const uint32_t kSize = 512;
+    const std::vector<uint8_t> image = makeSyntheticImage(kSize);
+    MipSettings settings;
+    settings.srgb = false;
+    MipChain source;
+    MipGenerator::generate(image.data(), kSize, kSize, settings, source);
+    const size_t texelCount = static_cast<size_t>(kSize) * kSize;
+
+    struct Case {
+      BlockFormat format;
+      const char* name;
+      int channels;     ///< Canales comparados (máscara RGBA).
+      double minimum;   ///< PSNR mínima aceptada en dB (Fast).
+      uint32_t ratio;   ///< Reducción del nivel 0 frente a RGBA8.
+    };
+    const Case cases[] = {
+      { BlockFormat::BC1, "BC1", 0x7, 35.0, 8 },
+      { BlockFormat::BC3, "BC3", 0xF, 35.0, 4 },
+      { BlockFormat::BC5, "BC5", 0x3, 45.0, 4 },
+      { BlockFormat::BC7, "BC7", 0xF, 40.0, 4 },
+    };
+    const CompressionQuality qualities[] = { CompressionQuality::Fast, CompressionQuality::Normal, CompressionQuality::High };
+    const char* qualityNames[] = { "Fast", "Normal", "High" };
+
+    for (const Case& test : cases) {
+      std::string line = format("  %s:", test.name);
+      double previous = 0.0;
+      bool ok = true, monotonic = true;
+      for (int q = 0; q < 3; ++q) {
+        MipChain blocks;
+        std::vector<uint8_t> decoded;
+        const bool built = SUCCEEDED(BlockCompressor::compress(source, test.format, qualities[q], blocks)) &&
+                           blocks.levels.size() == source.levels.size() &&
+                           blocks.levels[0].size * test.ratio == source.levels[0].size &&
+                           decodeBlockLevel(blocks, decoded);
+        const double db = built ? psnr(image.data(), decoded.data(), texelCount, test.channels) : 0.0;
+        ok = ok && built && db >= test.minimum;
+        monotonic = monotonic && db >= previous - 0.05;
+        previous = db;
+        line += format(" %s %.2f dB", qualityNames[q], db);
+      }
+      report.line(line);
+      report.check(ok, format("%s: decodifica con la referencia, %ux más pequeño, PSNR >= %.0f dB",
+        test.name, test.ratio, test.minimum));
+      report.check(monotonic, format("%s: la calidad no baja de Fast a High", test.name));
+    }
+
+    // Auto: BC1 para imágenes opacas, BC3 con alfa.
+    std::vector<uint8_t> opaque = image;
+    for (size_t i = 3; i < opaque.size(); i += 4) {
+      opaque[i] = 255;
+    }
+    MipChain opaqueChain;
+    MipGenerator::generate(opaque.data(), kSize, kSize, settings, opaqueChain);
+    report.check(BlockCompressor::resolve(BlockFormat::Auto, opaqueChain) == BlockFormat::BC1 &&
+                 BlockCompressor::resolve(BlockFormat::Auto, source) == BlockFormat::BC3,
+      "Auto: BC1 si es opaca, BC3 si tiene alfa");
+
+    MipChain odd, rejected;
+    MipGenerator::generate(image.data(), 6, 6, settings, odd);
+    report.check(FAILED(BlockCompressor::compress(odd, BlockFormat::BC1, CompressionQuality::Fast, rejected)),
+      "Nivel 0 que no es múltiplo de 4: rechazado");
+  }
+
+  void
+  benchBlockCompressor(Report& report) {
+    const uint32_t kSize = 2048;
+    const std::vector<uint8_t> image = makeSyntheticImage(kSize);
+    MipSettings settings;
+    MipChain source;
+    MipGenerator::generate(image.data(), kSize, kSize, settings, source);
+
+    report.line(format("  Cadena de %ux%u (%u hilos), ms por formato y calidad:", kSize, kSize,
+      std::thread::hardware_concurrency()));
+    report.line("           Fast    Normal      High");
+    for (BlockFormat format : { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC5, BlockFormat::BC7 }) {
+      std::string line = format == BlockFormat::BC1 ? "  BC1 " : format == BlockFormat::BC3 ? "  BC3 " :
+                         format == BlockFormat::BC5 ? "  BC5 " : "  BC7 ";
+      for (CompressionQuality quality : { CompressionQuality::Fast, CompressionQuality::Normal, CompressionQuality::High }) {
+        MipChain blocks;
+        const Clock::time_point start = Clock::now();
+        BlockCompressor::compress(source, format, quality, blocks);
+        line += ::format("%10.1f", elapsedMs(start));
+      }
+      report.line(line);
+    }
+
+    // Acierto de la caché DDS: proyectar un BC1 de 1024x1024 con todos sus mips.
+    MipChain small, blocks;
+    MipGenerator::generate(makeSyntheticImage(1024).data(), 1024, 1024, settings, small);
+    BlockCompressor::compress(small, BlockFormat::BC1, CompressionQuality::Fast, blocks);
+    const std::string path = tempPath("pc_bench_texture.dds");
+    const uint64_t key = 0x5E1F7E57ull;
+    const bool saved = SUCCEEDED(DdsFile::save(path, key, blocks));
+    std::vector<double> loadMs;
+    bool loaded = saved;
+    for (int pass = 0; pass < 5 && loaded; ++pass) {
+      MipChain chain;
+      const Clock::time_point start = Clock::now();
+      loaded = DdsFile::load(path, key, chain) && chain.getDataSize() == blocks.getDataSize();
+      loadMs.push_back(elapsedMs(start));
+    }
+    std::sort(loadMs.begin(), loadMs.end());
+    report.check(loaded, "DDS guardado y proyectado");
+    if (loaded) {
+      report.line(format("  Acierto de caché DDS 1024x1024 BC1: %.2f ms (mediana de 5)", loadMs[2]));
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+  }
+
+  //------------------------------------------------------------------------------------
+  // Atlas de texturas (TextureAtlas)
+  //------------------------------------------------------------------------------------
+
+  void
+  testTextureAtlas(Report& report) {
+    // Texturas de un solo color: en cualquier nivel, un texel de una región solo puede
+    // tener el color de esa región. La de 300x300 supera maxTextureSize y queda fuera.
+    struct Source {
+      uint32_t width;
+      uint32_t height;
+      uint8_t rgb[3];
+    };
+    const Source sources[] = {
+      { 30, 20, { 255, 0, 0 } },
+      { 16, 16, { 0, 255, 0 } },
+      { 50, 7, { 0, 0, 255 } },
+      { 300, 300, { 255, 255, 0 } },
+    };
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < std::size(sources); ++i) {
+      const Source& source = sources[i];
+      std::vector<uint8_t> rgba(static_cast<size_t>(source.width) * source.height * 4, 255);
+      for (size_t t = 0; t < rgba.size(); t += 4) {
+        std::memcpy(&rgba[t], source.rgb, 3);
+      }
+      paths.push_back(tempPath(format("pc_selftest_atlas%zu.tga", i)));
+      writeTga(paths.back(), rgba, source.width, source.height);
+    }
+
+    AtlasSettings settings;
+    settings.pageSize = 256;
+    settings.padding = 8;
+    settings.import.compression = BlockFormat::None;
+
+    TextureAtlas atlas;
+    const bool built = SUCCEEDED(atlas.build(paths, settings)) && atlas.getPageCount() == 1;
+    report.check(built && !atlas.findRegion(paths[3]), "build(): una página; la textura grande queda fuera");
+
+    const MipChain* page = built ? atlas.getPageMips(0) : nullptr;
+    bool separated = page && page->levels.size() == 4;
+    for (size_t i = 0; separated && i < 3; ++i) {
+      const AtlasRegion* region = atlas.findRegion(paths[i]);
+      separated = region && region->width == sources[i].width && region->height == sources[i].height;
+      for (size_t mip = 0; separated && mip < page->levels.size(); ++mip) {
+        const MipLevel& level = page->levels[mip];
+        const uint32_t x0 = region->x >> mip;
+        const uint32_t y0 = region->y >> mip;
+        const uint32_t x1 = (region->x + region->width + (1u << mip) - 1) >> mip;
+        const uint32_t y1 = (region->y + region->height + (1u << mip) - 1) >> mip;
+        for (uint32_t y = y0; separated && y < y1; ++y) {
+          for (uint32_t x = x0; separated && x < x1; ++x) {
+            separated = std::memcmp(page->getLevelData(mip) + y * level.rowPitch + x * 4, sources[i].rgb, 3) == 0;
+          }
+        }
+      }
+    }
+    report.check(separated, "RGBA8: mips hasta log2(padding) sin mezclar texturas");
+
+    // BC1: solo niveles con los rectángulos alineados a 4; cada bloque cae en una sola región.
+    settings.import.compression = BlockFormat::BC1;
+    TextureAtlas compressed;
+    page = SUCCEEDED(compressed.build(paths, settings)) ? compressed.getPageMips(0) : nullptr;
+    bool uniform = page && page->levels.size() == 2 && page->format == DXGI_FORMAT_BC1_UNORM;
+    for (size_t mip = 0; uniform && mip < page->levels.size(); ++mip) {
+      const MipLevel& level = page->levels[mip];
+      for (uint32_t by = 0; uniform && by < (level.height + 3) / 4; ++by) {
+        for (uint32_t bx = 0; uniform && bx < (level.width + 3) / 4; ++bx) {
+          uint8_t texels[16 * 4];
+          decodeBc1Block(page->getLevelData(mip) + by * level.rowPitch + bx * 8, texels, false);
+          for (int t = 1; uniform && t < 16; ++t) {
+            uniform = std::memcmp(texels, texels + t * 4, 4) == 0;
+          }
+        }
+      }
+    }
+    report.check(uniform, "BC1: mips hasta log2(padding) - 2, ningún bloque mezcla dos regiones");
+    settings.padding = 2;
+    report.check(compressed.build(paths, settings) == E_INVALIDARG, "BC con padding menor que 4: rechazado");
+
+    // remapUVs(): las esquinas de la textura caen en las de su región, también en half.
+    const AtlasRegion* region = atlas.findRegion(paths[0]);
+    bool remapped = region != nullptr;
+    if (remapped) {
+      const float pageWidth = static_cast<float>(atlas.getPageMips(0)->width);
+      const float pageHeight = static_cast<float>(atlas.getPageMips(0)->height);
+      const XMFLOAT2 uvs[] = { XMFLOAT2(0.0f, 0.0f), XMFLOAT2(1.0f, 1.0f), XMFLOAT2(0.25f, 0.75f) };
+      MeshComponent mesh;
+      for (const XMFLOAT2& uv : uvs) {
+        SimpleVertex vertex = {};
+        vertex.Tex = uv;
+        mesh.m_vertex.push_back(vertex);
+        CompactVertex compact = {};
+        compact.Tex[0] = VertexCodec::floatToHalf(uv.x);
+        compact.Tex[1] = VertexCodec::floatToHalf(uv.y);
+        mesh.m_compactVertex.push_back(compact);
+      }
+      remapped = TextureAtlas::remapUVs(mesh, *region);
+      for (size_t i = 0; remapped && i < std::size(uvs); ++i) {
+        const float u = (region->x + uvs[i].x * region->width) / pageWidth;
+        const float v = (region->y + uvs[i].y * region->height) / pageHeight;
+        remapped = std::fabs(mesh.m_vertex[i].Tex.x - u) < 1e-6f && std::fabs(mesh.m_vertex[i].Tex.y - v) < 1e-6f &&
+                   std::fabs(VertexCodec::halfToFloat(mesh.m_compactVertex[i].Tex[0]) - u) < 1.0f / 2048.0f &&
+                   std::fabs(VertexCodec::halfToFloat(mesh.m_compactVertex[i].Tex[1]) - v) < 1.0f / 2048.0f;
+      }
+
+      MeshComponent tiled;
+      SimpleVertex vertex = {};
+      vertex.Tex = XMFLOAT2(1.5f, 0.5f);
+      tiled.m_vertex.push_back(vertex);
+      remapped = remapped && !TextureAtlas::remapUVs(tiled, *region) && tiled.m_vertex[0].Tex.x == 1.5f;
+    }
+    report.check(remapped, "remapUVs(): UV normales y compactas a la región; rechaza UV repetidas");
+
+    atlas.destroy();
+    compressed.destroy();
+    std::error_code ec;
+    for (const std::string& path : paths) {
+      std::filesystem::remove(path, ec);
+    }
+  }
+}
+
+int
+SelfTest::run(bool benchmarks) {
+  Report report("SelfTest.log");
+  const TestEntry tests[] = {
+    { "Soldadura OBJ por hash (ModelLoader)", testObjWelding, false },
+    { "Carga OBJ: 10k-5M caras, tiempo y pico de memoria", benchObjWelding, true },
+    { "Parseo OBJ en paralelo (ModelLoader)", testObjParallelParse, false },
+    { "Parseo OBJ: escalado de 1 a 32 hilos", benchObjParallelParse, true },
+    { "Excepciones en parallelFor (ThreadPool)", testThreadPoolExceptions, false },
+    { "Codificación de vértice compacto (VertexCodec)", testVertexCodec, false },
+    { "Importación glTF (GltfLoader)", testGltfLoader, false },
+    { "Ejes y unidades de FBX binario (FbxBinaryReader)", testFbxAxisConversion, false },
+    { "Frustum culling SSE contra referencia escalar (FrustumCuller)", testFrustumCuller, false },
+    { "Frustum culling: 100k volúmenes", benchFrustumCuller, true },
+    { "Rangos de meshlets visibles (MeshletBuilder)", testMeshletRanges, false },
+    { "Mips en CPU contra referencia escalar (MipGenerator)", testMipGenerator, false },
+    { "Caché de texturas (TextureCache)", testTextureCache, false },
+    { "Mips: cadena de 2048x2048 y acierto de caché", benchMipGenerator, true },
+    { "Compresión BC contra decodificadores de referencia (BlockCompressor)", testBlockCompressor, false },
+    { "Compresión BC: cadena de 2048x2048 y acierto de caché DDS", benchBlockCompressor, true },
+    { "Atlas de texturas (TextureAtlas)", testTextureAtlas, false },
+  };
+
+  for (const TestEntry& test : tests) {
+    if (test.benchmark && !benchmarks) {
+      continue;
+    }
+    report.line(std::string(test.benchmark ? "[medición] " : "[prueba] ") + test.name);
+    const Clock::time_point start = Clock::now();
+    test.run(report);
+    report.line(format("  (%.1f ms)", elapsedMs(start)));
+  }
+
+  report.line(report.getFailures() == 0 ? "Todas las comprobaciones pasaron." :
+    format("%d comprobaciones fallaron.", report.getFailures()));
+  return report.getFailures();
+}
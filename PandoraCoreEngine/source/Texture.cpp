@@ -3,6 +3,10 @@
 #include "Texture.h"
 #include "Device.h"
 #include "DeviceContext.h"
+#include "FileSystem.h"
+#include "ImageDecoder.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
 
 HRESULT 
 Texture::init(Device& device, 
@@ -23,10 +27,17 @@ Texture::init(Device& device,
 	case DDS: {
 		m_textureName = textureName + ".dds";
 
-		// Cargar textura DDS
-		hr = D3DX11CreateShaderResourceViewFromFile(
+		// Cargar textura DDS desde la proyección (archivo suelto o paquete)
+		FileSpan file;
+		if (FAILED(FileSystem::open(m_textureName, file))) {
+			ERROR("Texture", "init",
+				("Failed to load DDS texture. Verify filepath: " + m_textureName).c_str());
+			return E_FAIL;
+		}
+		hr = D3DX11CreateShaderResourceViewFromMemory(
 			device.m_device,
-			m_textureName.c_str(),
+			file.data,
+			file.size,
 			nullptr,
 			nullptr,
 			&m_textureFromImg,
@@ -41,110 +52,191 @@ Texture::init(Device& device,
 		break;
 	}
 
-	case PNG: {
-    m_textureName = textureName + ".png";
-    int width, height, channels;
-    unsigned char* data = stbi_load(m_textureName.c_str(), &width, &height, &channels, 4); // 4 bytes por pixel (RGBA)
-    if (!data) {
+	case PNG:
+	case JPG: {
+    const std::string extension = (extensionType == PNG) ? "PNG" : "JPG";
+    m_textureName = textureName + ((extensionType == PNG) ? ".png" : ".jpg");
+    MipChain chain;
+    std::string error;
+    if (FAILED(TextureCache::loadOrBuild(m_textureName, TextureImportSettings(), chain, &error))) {
       ERROR("Texture", "init",
-        ("Failed to load PNG texture: " + std::string(stbi_failure_reason())).c_str());
+        ("Failed to load " + extension + " texture: " + error).c_str());
       return E_FAIL;
     }
 
-    // Crear descripci�n de textura
-    D3D11_TEXTURE2D_DESC textureDesc = {};
-    textureDesc.Width = width;
-    textureDesc.Height = height;
-    textureDesc.MipLevels = 1;
-    textureDesc.ArraySize = 1;
-    textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    textureDesc.SampleDesc.Count = 1;
-    textureDesc.Usage = D3D11_USAGE_DEFAULT;
-    textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-
-    // Crear datos de subrecarga
-    D3D11_SUBRESOURCE_DATA initData = {};
-    initData.pSysMem = data;
-    initData.SysMemPitch = width * 4;
-
-    hr = device.CreateTexture2D(&textureDesc, &initData, &m_texture);
-    stbi_image_free(data); // Liberar los datos de imagen inmediatamente
-		
+    hr = initFromMips(device, chain);
     if (FAILED(hr)) {
-      ERROR("Texture", "init", "Failed to create texture from PNG data");
       return hr;
     }
+		break;
+	}
+	default:
+		ERROR("Texture", "init", "Unsupported extension type");
+		return E_INVALIDARG;
+	}
 
-    // Crear vista del recurso de la textura
-    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-    srvDesc.Format = textureDesc.Format;
-    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-    srvDesc.Texture2D.MipLevels = 1;
+	return hr;
+}
 
-    hr = device.m_device->CreateShaderResourceView(m_texture, &srvDesc, &m_textureFromImg);
-    SAFE_RELEASE(m_texture); // Liberar textura intermedia
+HRESULT
+Texture::initFromPixels(Device& device,
+                        const unsigned char* pixels,
+                        unsigned int width,
+                        unsigned int height) {
+  if (!device.m_device) {
+    ERROR("Texture", "initFromPixels", "Device is null.");
+    return E_POINTER;
+  }
+  if (!pixels || width == 0 || height == 0) {
+    ERROR("Texture", "initFromPixels", "Pixel data is empty.");
+    return E_INVALIDARG;
+  }
 
-    if (FAILED(hr)) {
-      ERROR("Texture", "init", "Failed to create shader resource view for PNG texture");
-      return hr;
-    }
-		break;
-	}
-	case JPG: {
-    m_textureName = textureName + ".jpg";
-    int width, height, channels;
-    unsigned char* data = stbi_load(m_textureName.c_str(), &width, &height, &channels, 4); // 4 bytes por pixel (RGBA)
-    if (!data) {
-      ERROR("Texture", "init",
-        ("Failed to load JPG texture: " + std::string(stbi_failure_reason())).c_str());
-      return E_FAIL;
-    }
+  // Crear descripción de textura
+  D3D11_TEXTURE2D_DESC textureDesc = {};
+  textureDesc.Width = width;
+  textureDesc.Height = height;
+  textureDesc.MipLevels = 1;
+  textureDesc.ArraySize = 1;
+  textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+  textureDesc.SampleDesc.Count = 1;
+  textureDesc.Usage = D3D11_USAGE_DEFAULT;
+  textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+  // Crear datos de subrecarga
+  D3D11_SUBRESOURCE_DATA initData = {};
+  initData.pSysMem = pixels;
+  initData.SysMemPitch = width * 4;
+
+  HRESULT hr = device.CreateTexture2D(&textureDesc, &initData, &m_texture);
+  if (FAILED(hr)) {
+    ERROR("Texture", "initFromPixels", ("Failed to create texture from image data: " + m_textureName).c_str());
+    return hr;
+  }
 
-    // Crear descripci�n de textura
-    D3D11_TEXTURE2D_DESC textureDesc = {};
-    textureDesc.Width = width;
-    textureDesc.Height = height;
-    textureDesc.MipLevels = 1;
-    textureDesc.ArraySize = 1;
-    textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    textureDesc.SampleDesc.Count = 1;
-    textureDesc.Usage = D3D11_USAGE_DEFAULT;
-    textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-
-    // Crear datos de subrecarga
-    D3D11_SUBRESOURCE_DATA initData = {};
-    initData.pSysMem = data;
-    initData.SysMemPitch = width * 4;
-
-    hr = device.CreateTexture2D(&textureDesc, &initData, &m_texture);
-    stbi_image_free(data); // Liberar los datos de imagen inmediatamente
+  // Crear vista del recurso de la textura
+  D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+  srvDesc.Format = textureDesc.Format;
+  srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+  srvDesc.Texture2D.MipLevels = 1;
 
-    if (FAILED(hr)) {
-      ERROR("Texture", "init", "Failed to create texture from PNG data");
-      return hr;
-    }
+  hr = device.m_device->CreateShaderResourceView(m_texture, &srvDesc, &m_textureFromImg);
+  SAFE_RELEASE(m_texture); // Liberar textura intermedia
+
+  if (FAILED(hr)) {
+    ERROR("Texture", "initFromPixels",
+      ("Failed to create shader resource view for texture: " + m_textureName).c_str());
+    return hr;
+  }
+  return S_OK;
+}
+
+HRESULT
+Texture::initFromMips(Device& device, const MipChain& chain, uint32_t firstMip) {
+  if (!device.m_device) {
+    ERROR("Texture", "initFromMips", "Device is null.");
+    return E_POINTER;
+  }
+  if (chain.levels.empty() || chain.getDataSize() == 0) {
+    ERROR("Texture", "initFromMips", "Mip chain is empty.");
+    return E_INVALIDARG;
+  }
+  if (firstMip >= chain.levels.size()) {
+    ERROR("Texture", "initFromMips", "First mip is out of range.");
+    return E_INVALIDARG;
+  }
+
+  D3D11_TEXTURE2D_DESC textureDesc = {};
+  textureDesc.Width = chain.levels[firstMip].width;
+  textureDesc.Height = chain.levels[firstMip].height;
+  textureDesc.MipLevels = static_cast<UINT>(chain.levels.size() - firstMip);
+  textureDesc.ArraySize = 1;
+  textureDesc.Format = chain.format;
+  textureDesc.SampleDesc.Count = 1;
+  textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+  textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+  // Un subrecurso por nivel de mip
+  std::vector<D3D11_SUBRESOURCE_DATA> initData(textureDesc.MipLevels);
+  for (size_t i = 0; i < initData.size(); ++i) {
+    initData[i].pSysMem = chain.getLevelData(firstMip + i);
+    initData[i].SysMemPitch = chain.levels[firstMip + i].rowPitch;
+  }
 
-    // Crear vista del recurso de la textura
-    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-    srvDesc.Format = textureDesc.Format;
-    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-    srvDesc.Texture2D.MipLevels = 1;
+  HRESULT hr = device.CreateTexture2D(&textureDesc, initData.data(), &m_texture);
+  if (FAILED(hr)) {
+    ERROR("Texture", "initFromMips", ("Failed to create texture from mip chain: " + m_textureName).c_str());
+    return hr;
+  }
 
-    hr = device.m_device->CreateShaderResourceView(m_texture, &srvDesc, &m_textureFromImg);
-    SAFE_RELEASE(m_texture); // Liberar textura intermedia
+  D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+  srvDesc.Format = textureDesc.Format;
+  srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+  srvDesc.Texture2D.MipLevels = textureDesc.MipLevels;
 
-    if (FAILED(hr)) {
-      ERROR("Texture", "init", "Failed to create shader resource view for JPG texture");
-      return hr;
+  hr = device.m_device->CreateShaderResourceView(m_texture, &srvDesc, &m_textureFromImg);
+  SAFE_RELEASE(m_texture); // Liberar textura intermedia
+
+  if (FAILED(hr)) {
+    ERROR("Texture", "initFromMips",
+      ("Failed to create shader resource view for texture: " + m_textureName).c_str());
+    return hr;
+  }
+  return S_OK;
+}
+
+HRESULT
+Texture::initBatch(Device& device,
+                   std::vector<Texture>& textures,
+                   const std::vector<std::string>& textureNames,
+                   ExtensionType extensionType) {
+  textures.assign(textureNames.size(), Texture());
+
+  // D3DX carga los DDS directamente; no pasan por stb_image.
+  if (extensionType == DDS) {
+    HRESULT result = S_OK;
+    for (size_t i = 0; i < textureNames.size(); ++i) {
+      const HRESULT hr = textures[i].init(device, textureNames[i], extensionType);
+      if (FAILED(hr)) {
+        result = hr;
+      }
     }
-		break;
-	}
-	default:
-		ERROR("Texture", "init", "Unsupported extension type");
-		return E_INVALIDARG;
-	}
+    return result;
+  }
+  if (extensionType != PNG && extensionType != JPG) {
+    ERROR("Texture", "initBatch", "Unsupported extension type");
+    return E_INVALIDARG;
+  }
 
-	return hr;
+  std::vector<std::string> paths(textureNames.size());
+  for (size_t i = 0; i < textureNames.size(); ++i) {
+    paths[i] = textureNames[i] + ((extensionType == PNG) ? ".png" : ".jpg");
+  }
+
+  // Caché o decodificación + mips en paralelo; la creación en GPU se hace aquí, en el hilo del dispositivo.
+  std::vector<MipChain> chains(paths.size());
+  std::vector<std::string> errors(paths.size());
+  std::vector<HRESULT> results(paths.size(), S_OK);
+  ThreadPool::getInstance().parallelFor(paths.size(), [&](size_t i) {
+    results[i] = TextureCache::loadOrBuild(paths[i], TextureImportSettings(), chains[i], &errors[i]);
+  });
+
+  HRESULT result = S_OK;
+  for (size_t i = 0; i < chains.size(); ++i) {
+    textures[i].m_textureName = paths[i];
+    HRESULT hr = results[i];
+    if (FAILED(hr)) {
+      ERROR("Texture", "initBatch", ("Failed to load " + paths[i] + ": " + errors[i]).c_str());
+    }
+    else {
+      hr = textures[i].initFromMips(device, chains[i]);
+    }
+    if (FAILED(hr)) {
+      result = hr;
+    }
+    chains[i] = MipChain(); // Liberar los texeles en cuanto están en GPU
+  }
+  return result;
 }
 
 HRESULT 
@@ -257,101 +349,58 @@ Texture::CreateCubemap(Device& device,
   // 0) Limpieza si ya hab�a recursos
   destroy();
 
-  // 1) Cargar caras con stb_image (forzar RGBA)
-  stbi_set_flip_vertically_on_load(false);
-
-  int width = 0, height = 0, channels = 0;
-  std::array<unsigned char*, 6> facePixels{};
-  facePixels.fill(nullptr);
-
-  for (int i = 0; i < 6; ++i) {
-		int w = 0, h = 0, c = 0;
-    facePixels[i] = stbi_load(facePaths[i].c_str(), &w, &h, &c, 4);
-    if (!facePixels[i]) {
-      // liberar lo ya cargado
-      for (int k = 0; k < i; ++k) {
-        if (facePixels[k]) {
-          stbi_image_free(facePixels[k]);
-					return E_FAIL;
-        }
-      }
+  // 1) Obtener las seis caras con sus mips en paralelo (caché o decodificación).
+  //    Sin compresión: BaseApp crea vistas R8G8B8A8 de cada cara.
+  TextureImportSettings settings;
+  settings.compression = BlockFormat::None;
+  std::array<MipChain, 6> faces;
+  std::array<std::string, 6> errors;
+  std::array<HRESULT, 6> results{};
+  ThreadPool::getInstance().parallelFor(facePaths.size(), [&](size_t i) {
+    results[i] = TextureCache::loadOrBuild(facePaths[i], settings, faces[i], &errors[i]);
+  });
+  for (size_t i = 0; i < faces.size(); ++i) {
+    if (FAILED(results[i])) {
+      ERROR("Texture", "CreateCubemap", ("Failed to load cubemap face " + facePaths[i] + ": " + errors[i]).c_str());
+      return E_FAIL;
     }
-
-    if (i == 0) {
-      width = w;
-      height = h;
+    if (faces[i].width != faces[0].width || faces[i].height != faces[0].height ||
+        faces[i].format != faces[0].format) {
+      ERROR("Texture", "CreateCubemap", "All cubemap faces must have the same dimensions.");
+      return E_FAIL;
     }
-    else {
-      if (w != width || h != height) {
-        ERROR("Texture", "CreateCubemap", "All cubemap faces must have the same dimensions.");
-        // liberar lo ya cargado
-        for (int k = 0; k <= i; ++k) {
-          if (facePixels[k]) {
-            stbi_image_free(facePixels[k]);
-            return E_FAIL;
-          }
-        }
-      }
-		}
   }
 
-  // 2) Crear Texture2D array (6 slices) y marcarla como cubemap
+  // 2) Crear Texture2D array (6 slices) y marcarla como cubemap, con los mips ya generados
+  const unsigned int mipLevels = generateMips ? static_cast<unsigned int>(faces[0].levels.size()) : 1;
   D3D11_TEXTURE2D_DESC texDesc{};
-  texDesc.Width = static_cast<unsigned int>(width);
-  texDesc.Height = static_cast<unsigned int>(height);
-  texDesc.MipLevels = generateMips ? 0 : 1;
+  texDesc.Width = faces[0].width;
+  texDesc.Height = faces[0].height;
+  texDesc.MipLevels = mipLevels;
   texDesc.ArraySize = 6;
-  texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+  texDesc.Format = faces[0].format;
   texDesc.SampleDesc.Count = 1;
   texDesc.SampleDesc.Quality = 0;
-  texDesc.Usage = D3D11_USAGE_DEFAULT;
-  texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | (generateMips ? D3D11_BIND_RENDER_TARGET : 0);
+  texDesc.Usage = D3D11_USAGE_IMMUTABLE;
+  texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
   texDesc.CPUAccessFlags = 0;
-  texDesc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE | (generateMips ? D3D11_RESOURCE_MISC_GENERATE_MIPS : 0);
-
-  HRESULT hr = S_OK;
-
-  if (!generateMips) {
-    std::array<D3D11_SUBRESOURCE_DATA, 6> initData{};
-    for (int face = 0; face < 6; ++face)
-    {
-      initData[face].pSysMem = facePixels[face];
-      initData[face].SysMemPitch = static_cast<unsigned int>(width * 4);
-      initData[face].SysMemSlicePitch = 0;
-    }
-
-		hr = device.CreateTexture2D(&texDesc, initData.data(), &m_texture);
-    if (FAILED(hr)) {
-      for (auto* p : facePixels) {
-        if (p) {
-          stbi_image_free(p);
-        }
-      } 
-      return hr;
+  texDesc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;
+
+  // Subrecurso = mip + cara * mipLevels
+  std::vector<D3D11_SUBRESOURCE_DATA> initData(6 * mipLevels);
+  for (unsigned int face = 0; face < 6; ++face) {
+    for (unsigned int mip = 0; mip < mipLevels; ++mip) {
+      D3D11_SUBRESOURCE_DATA& sub = initData[D3D11CalcSubresource(mip, face, mipLevels)];
+      sub.pSysMem = faces[face].getLevelData(mip);
+      sub.SysMemPitch = faces[face].levels[mip].rowPitch;
+      sub.SysMemSlicePitch = 0;
     }
   }
-  else {
-    // crear vac�o y subir mip 0 por cara
-    hr = device.CreateTexture2D(&texDesc, nullptr, &m_texture);
-    if (FAILED(hr)) {
-      for (auto* p : facePixels) {
-        if (p) {
-          stbi_image_free(p);
-        }
-      }
-      return hr;
-    }
 
-    for (unsigned int face = 0; face < 6; ++face)
-    {
-      // Mip 0, ArraySlice=face
-      unsigned int sub = D3D11CalcSubresource(0, face, 0 /*MipLevels=0*/);
-      deviceContext.UpdateSubresource(m_texture, 
-                                      sub, 
-                                      nullptr, 
-                                      facePixels[face], 
-                                      static_cast<unsigned int>(width * 4), 0);
-    }
+  HRESULT hr = device.CreateTexture2D(&texDesc, initData.data(), &m_texture);
+  if (FAILED(hr)) {
+    ERROR("Texture", "CreateCubemap", ("Failed to create cubemap texture. HRESULT: " + std::to_string(hr)).c_str());
+    return hr;
   }
 
   // 3) Crear SRV dimension TEXTURECUBE
@@ -359,31 +408,12 @@ Texture::CreateCubemap(Device& device,
   srvDesc.Format = texDesc.Format;
   srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
   srvDesc.TextureCube.MostDetailedMip = 0;
-  srvDesc.TextureCube.MipLevels = generateMips ? (unsigned int)-1 : 1;
-  
-  hr = device.m_device->CreateShaderResourceView(m_texture, &srvDesc, &m_textureFromImg);
+  srvDesc.TextureCube.MipLevels = mipLevels;
 
+  hr = device.m_device->CreateShaderResourceView(m_texture, &srvDesc, &m_textureFromImg);
   if (FAILED(hr)) {
-    for (auto* p : facePixels) {
-      if (p) {
-        stbi_image_free(p);
-			}
-    }
     destroy();
-		return hr;
-  }
-
-  // 4) Generar mips si aplica
-  if (generateMips)
-  {
-    deviceContext.m_deviceContext->GenerateMips(m_textureFromImg);
-  }
-
-  // 5) Liberar CPU pixels
-  for (auto* p : facePixels) {
-    if (p) {
-      stbi_image_free(p);
-    }
+    return hr;
   }
 
   // 6) Guarda nombre (opcional)
@@ -0,0 +1,479 @@
+﻿#include "TextureAtlas.h"
+#include "BlockCompressor.h"
+#include "ContentHash.h"
+#include "Device.h"
+#include "ImageDecoder.h"
+#include "MappedFile.h"
+#include "MeshComponent.h"
+#include "ThreadPool.h"
+#include "VertexCodec.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace {
+  const char kManifestMagic[4] = { 'P', 'C', 'A', 'T' };
+
+  struct ManifestHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t pageCount;
+    uint32_t regionCount;
+  };
+
+  /**
+   * @brief Región en el manifiesto; le sigue la ruta fuente (@c pathLength bytes).
+   */
+  struct ManifestRegion {
+    uint32_t page;
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pathLength;
+  };
+
+  static_assert(sizeof(ManifestHeader) == 24, "ManifestHeader layout changed");
+  static_assert(sizeof(ManifestRegion) == 24, "ManifestRegion layout changed");
+
+  /**
+   * @brief Textura colocada: esquina de su rectángulo (con borde) en una página.
+   */
+  struct Placement {
+    size_t image;
+    uint32_t page;
+    uint32_t x;
+    uint32_t y;
+  };
+
+  bool
+    isPowerOfTwo(uint32_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+  }
+
+  uint32_t
+    alignUp(uint32_t value, uint32_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+  }
+
+  uint32_t
+    nextPowerOfTwo(uint32_t value) {
+    uint32_t result = 1;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  uint64_t
+    getPageKey(uint64_t atlasKey, uint32_t page) {
+    return ContentHash::hashBytes(&page, sizeof(page), atlasKey);
+  }
+
+  /**
+   * @brief Calcula escala y desplazamiento de UV de una región en una página.
+   */
+  void
+    computeUvTransform(AtlasRegion& region, uint32_t pageWidth, uint32_t pageHeight) {
+    region.uvScale = XMFLOAT2(static_cast<float>(region.width) / pageWidth,
+                              static_cast<float>(region.height) / pageHeight);
+    region.uvBias = XMFLOAT2(static_cast<float>(region.x) / pageWidth,
+                             static_cast<float>(region.y) / pageHeight);
+  }
+}
+
+HRESULT
+TextureAtlas::build(const std::vector<std::string>& sourcePaths, const AtlasSettings& settings) {
+  if (!isPowerOfTwo(settings.pageSize) || !isPowerOfTwo(settings.padding) ||
+      settings.maxTextureSize == 0 || settings.pageSize < 4 * settings.padding) {
+    ERROR("TextureAtlas", "build", "Page size and padding must be powers of two, with room for the borders.");
+    return E_INVALIDARG;
+  }
+  const bool compressed = settings.import.compression != BlockFormat::None;
+  if (compressed && settings.padding < 4) {
+    ERROR("TextureAtlas", "build", "Block-compressed pages need a padding of at least 4 texels.");
+    return E_INVALIDARG;
+  }
+  destroy();
+
+  std::vector<DecodedImage> images(sourcePaths.size());
+  std::vector<HRESULT> results(sourcePaths.size(), S_OK);
+  ThreadPool::getInstance().parallelFor(sourcePaths.size(), [&](size_t i) {
+    results[i] = ImageDecoder::decode(sourcePaths[i], images[i]);
+  });
+
+  // Rectángulo con borde, alineado a padding para que los mips no mezclen texturas.
+  const uint32_t padding = settings.padding;
+  auto footprint = [padding](int size) {
+    return alignUp(static_cast<uint32_t>(size), padding) + 2 * padding;
+  };
+
+  std::vector<size_t> members;
+  for (size_t i = 0; i < images.size(); ++i) {
+    if (FAILED(results[i])) {
+      ERROR("TextureAtlas", "build", ("Failed to load " + sourcePaths[i] + ": " + images[i].error).c_str());
+      continue;
+    }
+    const uint32_t largest = static_cast<uint32_t>((std::max)(images[i].width, images[i].height));
+    if (largest > settings.maxTextureSize ||
+        footprint(images[i].width) > settings.pageSize || footprint(images[i].height) > settings.pageSize) {
+      images[i].release();
+      continue;
+    }
+    members.push_back(i);
+  }
+
+  // Empaquetado por estantes, de la textura más alta a la más baja.
+  std::sort(members.begin(), members.end(), [&](size_t a, size_t b) {
+    if (images[a].height != images[b].height) {
+      return images[a].height > images[b].height;
+    }
+    return images[a].width > images[b].width;
+  });
+
+  std::vector<Placement> placements;
+  std::vector<PageSize> used;
+  uint32_t cursorX = 0;
+  uint32_t shelfY = 0;
+  uint32_t shelfHeight = 0;
+  for (size_t image : members) {
+    const uint32_t width = footprint(images[image].width);
+    const uint32_t height = footprint(images[image].height);
+    if (used.empty()) {
+      used.push_back({ 0, 0 });
+    }
+    if (cursorX + width > settings.pageSize) {
+      shelfY += shelfHeight;
+      cursorX = 0;
+      shelfHeight = 0;
+    }
+    if (shelfY + height > settings.pageSize) {
+      used.push_back({ 0, 0 });
+      cursorX = 0;
+      shelfY = 0;
+      shelfHeight = 0;
+    }
+    const uint32_t page = static_cast<uint32_t>(used.size() - 1);
+    placements.push_back({ image, page, cursorX, shelfY });
+    cursorX += width;
+    shelfHeight = (std::max)(shelfHeight, height);
+    used[page].width = (std::max)(used[page].width, cursorX);
+    used[page].height = (std::max)(used[page].height, shelfY + height);
+  }
+
+  // Cada página se recorta a la potencia de 2 que cubre lo usado.
+  for (const PageSize& size : used) {
+    m_pageSizes.push_back({ (std::max)(4u, nextPowerOfTwo(size.width)), (std::max)(4u, nextPowerOfTwo(size.height)) });
+  }
+  std::vector<std::vector<uint8_t>> pixels(m_pageSizes.size());
+  for (size_t page = 0; page < m_pageSizes.size(); ++page) {
+    pixels[page].assign(static_cast<size_t>(m_pageSizes[page].width) * m_pageSizes[page].height * 4, 0);
+  }
+
+  // Copiar cada textura con su borde (texeles de orilla replicados); los rectángulos no se solapan.
+  ThreadPool::getInstance().parallelFor(placements.size(), [&](size_t i) {
+    const Placement& placement = placements[i];
+    const DecodedImage& image = images[placement.image];
+    const uint32_t pageWidth = m_pageSizes[placement.page].width;
+    const uint32_t width = footprint(image.width);
+    const uint32_t height = footprint(image.height);
+    for (uint32_t y = 0; y < height; ++y) {
+      const int sourceY = (std::min)((std::max)(static_cast<int>(y) - static_cast<int>(padding), 0), image.height - 1);
+      uint8_t* row = &pixels[placement.page][((static_cast<size_t>(placement.y) + y) * pageWidth + placement.x) * 4];
+      for (uint32_t x = 0; x < width; ++x) {
+        const int sourceX = (std::min)((std::max)(static_cast<int>(x) - static_cast<int>(padding), 0), image.width - 1);
+        std::memcpy(row + x * 4, image.pixels + (static_cast<size_t>(sourceY) * image.width + sourceX) * 4, 4);
+      }
+    }
+  });
+
+  for (const Placement& placement : placements) {
+    DecodedImage& image = images[placement.image];
+    AtlasRegion region;
+    region.page = placement.page;
+    region.x = placement.x + padding;
+    region.y = placement.y + padding;
+    region.width = static_cast<uint32_t>(image.width);
+    region.height = static_cast<uint32_t>(image.height);
+    computeUvTransform(region, m_pageSizes[placement.page].width, m_pageSizes[placement.page].height);
+    m_regions[sourcePaths[placement.image]] = region;
+    image.release();
+  }
+
+  // Mips de caja hasta log2(padding): en ese nivel el borde aún mide un texel. Con
+  // compresión BC se para en log2(padding) - 2, el último nivel en que los rectángulos
+  // siguen alineados a 4 y ningún bloque de 4x4 toma texeles de dos regiones.
+  MipSettings mipSettings;
+  mipSettings.filter = MipFilter::Box;
+  mipSettings.srgb = settings.import.mips.srgb;
+  const uint32_t lastBorder = compressed ? 4 : 1;
+  size_t mipCount = 1;
+  for (uint32_t border = padding; border > lastBorder; border >>= 1) {
+    ++mipCount;
+  }
+
+  m_pageChains.resize(m_pageSizes.size());
+  for (size_t page = 0; page < m_pageSizes.size(); ++page) {
+    MipChain& chain = m_pageChains[page];
+    HRESULT hr = MipGenerator::generate(pixels[page].data(), m_pageSizes[page].width, m_pageSizes[page].height,
+                                        mipSettings, chain);
+    std::vector<uint8_t>().swap(pixels[page]);
+    if (FAILED(hr)) {
+      ERROR("TextureAtlas", "build", "Mip generation failed for an atlas page.");
+      destroy();
+      return hr;
+    }
+    if (chain.levels.size() > mipCount) {
+      chain.levels.resize(mipCount);
+      chain.data.resize(chain.levels.back().offset + chain.levels.back().size);
+    }
+
+    if (compressed) {
+      MipChain blocks;
+      if (SUCCEEDED(BlockCompressor::compress(chain, settings.import.compression, settings.import.quality, blocks))) {
+        chain = std::move(blocks);
+      }
+      else {
+        ERROR("TextureAtlas", "build", "Block compression failed, keeping the page uncompressed.");
+      }
+    }
+  }
+
+  MESSAGE("TextureAtlas", "build", (std::to_string(m_regions.size()) + " of " +
+    std::to_string(sourcePaths.size()) + " textures packed into " + std::to_string(m_pageSizes.size()) +
+    " pages").c_str());
+  return S_OK;
+}
+
+std::string
+TextureAtlas::getManifestPath(uint64_t key) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.pcatlas", static_cast<unsigned long long>(key));
+  return (std::filesystem::path(TextureCache::getDirectory()) / name).string();
+}
+
+bool
+TextureAtlas::loadCache(uint64_t key) {
+  const std::string manifestPath = getManifestPath(key);
+  std::error_code ec;
+  if (!std::filesystem::exists(manifestPath, ec)) {
+    return false;
+  }
+
+  MappedFile file;
+  if (FAILED(file.init(manifestPath)) || file.size() < sizeof(ManifestHeader)) {
+    return false;
+  }
+  ManifestHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (std::memcmp(header.magic, kManifestMagic, sizeof(kManifestMagic)) != 0 ||
+      header.version != kVersion || header.key != key) {
+    MESSAGE("TextureAtlas", "loadCache", ("Atlas manifest is stale, rebuilding: " + manifestPath).c_str());
+    return false;
+  }
+
+  size_t offset = sizeof(header);
+  const size_t pageBytes = static_cast<size_t>(header.pageCount) * sizeof(PageSize);
+  if (file.size() < offset + pageBytes) {
+    ERROR("TextureAtlas", "loadCache", ("Truncated atlas manifest: " + manifestPath).c_str());
+    return false;
+  }
+  std::vector<PageSize> pageSizes(header.pageCount);
+  std::memcpy(pageSizes.data(), file.data() + offset, pageBytes);
+  offset += pageBytes;
+
+  std::unordered_map<std::string, AtlasRegion> regions;
+  for (uint32_t i = 0; i < header.regionCount; ++i) {
+    ManifestRegion stored;
+    if (file.size() < offset + sizeof(stored)) {
+      ERROR("TextureAtlas", "loadCache", ("Truncated atlas manifest: " + manifestPath).c_str());
+      return false;
+    }
+    std::memcpy(&stored, file.data() + offset, sizeof(stored));
+    offset += sizeof(stored);
+    if (file.size() < offset + stored.pathLength || stored.page >= header.pageCount) {
+      ERROR("TextureAtlas", "loadCache", ("Invalid atlas region: " + manifestPath).c_str());
+      return false;
+    }
+    AtlasRegion region;
+    region.page = stored.page;
+    region.x = stored.x;
+    region.y = stored.y;
+    region.width = stored.width;
+    region.height = stored.height;
+    computeUvTransform(region, pageSizes[stored.page].width, pageSizes[stored.page].height);
+    regions[std::string(file.data() + offset, stored.pathLength)] = region;
+    offset += stored.pathLength;
+  }
+
+  // Las páginas pueden haber sido desalojadas de la caché: entonces se reconstruye todo.
+  std::vector<MipChain> chains(header.pageCount);
+  for (uint32_t page = 0; page < header.pageCount; ++page) {
+    const uint64_t pageKey = getPageKey(key, page);
+    if (!TextureCache::load(TextureCache::getCachePath(pageKey), pageKey, chains[page])) {
+      return false;
+    }
+  }
+
+  m_regions = std::move(regions);
+  m_pageSizes = std::move(pageSizes);
+  m_pageChains = std::move(chains);
+  return true;
+}
+
+HRESULT
+TextureAtlas::saveCache(uint64_t key) const {
+  for (uint32_t page = 0; page < m_pageChains.size(); ++page) {
+    const uint64_t pageKey = getPageKey(key, page);
+    HRESULT hr = TextureCache::save(TextureCache::getCachePath(pageKey), pageKey, m_pageChains[page]);
+    if (FAILED(hr)) {
+      return hr;
+    }
+  }
+
+  const std::string manifestPath = getManifestPath(key);
+  const std::string tempPath = manifestPath + ".tmp" +
+    std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xFFFF);
+  {
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      ERROR("TextureAtlas", "saveCache", ("Failed to create atlas manifest: " + tempPath).c_str());
+      return E_FAIL;
+    }
+
+    ManifestHeader header = {};
+    std::memcpy(header.magic, kManifestMagic, sizeof(kManifestMagic));
+    header.version = kVersion;
+    header.key = key;
+    header.pageCount = static_cast<uint32_t>(m_pageSizes.size());
+    header.regionCount = static_cast<uint32_t>(m_regions.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(m_pageSizes.data()), m_pageSizes.size() * sizeof(PageSize));
+    for (const auto& entry : m_regions) {
+      const AtlasRegion& region = entry.second;
+      const ManifestRegion stored = { region.page, region.x, region.y, region.width, region.height,
+                                      static_cast<uint32_t>(entry.first.size()) };
+      out.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+      out.write(entry.first.data(), entry.first.size());
+    }
+    if (!out) {
+      ERROR("TextureAtlas", "saveCache", ("Failed to write atlas manifest: " + tempPath).c_str());
+      return E_FAIL;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tempPath, manifestPath, ec);
+  if (ec) {
+    ERROR("TextureAtlas", "saveCache", ("Failed to replace atlas manifest: " + manifestPath).c_str());
+    std::filesystem::remove(tempPath, ec);
+    return E_FAIL;
+  }
+  return S_OK;
+}
+
+HRESULT
+TextureAtlas::loadOrBuild(const std::vector<std::string>& sourcePaths, const AtlasSettings& settings) {
+  // Clave: opciones, versión, y ruta + contenido de cada fuente (un archivo faltante también cuenta).
+  uint64_t key = ContentHash::hashString(settings.toString());
+  key = ContentHash::hashBytes(&kVersion, sizeof(kVersion), key);
+  for (const std::string& path : sourcePaths) {
+    uint64_t contentHash = 0;
+    ContentHash::hashFile(path, contentHash);
+    key = ContentHash::hashString(path, key);
+    key = ContentHash::hashBytes(&contentHash, sizeof(contentHash), key);
+  }
+
+  destroy();
+  if (loadCache(key)) {
+    MESSAGE("TextureAtlas", "loadOrBuild", (std::to_string(m_regions.size()) + " textures in " +
+      std::to_string(m_pageSizes.size()) + " pages loaded from cache").c_str());
+    return S_OK;
+  }
+
+  HRESULT hr = build(sourcePaths, settings);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  // Un fallo al escribir la caché no impide usar el atlas.
+  if (SUCCEEDED(saveCache(key))) {
+    const uint64_t maxBytes = TextureCache::getMaxSize();
+    if (maxBytes > 0) {
+      TextureCache::evict(maxBytes);
+    }
+  }
+  return S_OK;
+}
+
+HRESULT
+TextureAtlas::init(Device& device) {
+  m_pages.assign(m_pageChains.size(), Texture());
+  for (size_t page = 0; page < m_pageChains.size(); ++page) {
+    m_pages[page].m_textureName = "Atlas page " + std::to_string(page);
+    HRESULT hr = m_pages[page].initFromMips(device, m_pageChains[page]);
+    if (FAILED(hr)) {
+      ERROR("TextureAtlas", "init", ("Failed to create atlas page " + std::to_string(page)).c_str());
+      return hr;
+    }
+  }
+  m_pageChains.clear();
+  return S_OK;
+}
+
+void
+TextureAtlas::destroy() {
+  for (Texture& page : m_pages) {
+    page.destroy();
+  }
+  m_pages.clear();
+  m_pageChains.clear();
+  m_pageSizes.clear();
+  m_regions.clear();
+}
+
+const AtlasRegion*
+TextureAtlas::findRegion(const std::string& sourcePath) const {
+  auto it = m_regions.find(sourcePath);
+  return it != m_regions.end() ? &it->second : nullptr;
+}
+
+bool
+TextureAtlas::remapUVs(MeshComponent& mesh, const AtlasRegion& region) {
+  // Tolerancia para UV exportadas apenas fuera de rango; se recortan a [0, 1].
+  const float kEpsilon = 1e-3f;
+  auto inRange = [kEpsilon](float value) {
+    return value >= -kEpsilon && value <= 1.0f + kEpsilon;
+  };
+  auto remap = [&region](float u, float v) {
+    u = (std::min)((std::max)(u, 0.0f), 1.0f);
+    v = (std::min)((std::max)(v, 0.0f), 1.0f);
+    return XMFLOAT2(u * region.uvScale.x + region.uvBias.x, v * region.uvScale.y + region.uvBias.y);
+  };
+
+  for (const SimpleVertex& vertex : mesh.m_vertex) {
+    if (!inRange(vertex.Tex.x) || !inRange(vertex.Tex.y)) {
+      return false;
+    }
+  }
+  for (const CompactVertex& vertex : mesh.m_compactVertex) {
+    if (!inRange(VertexCodec::halfToFloat(vertex.Tex[0])) || !inRange(VertexCodec::halfToFloat(vertex.Tex[1]))) {
+      return false;
+    }
+  }
+
+  for (SimpleVertex& vertex : mesh.m_vertex) {
+    vertex.Tex = remap(vertex.Tex.x, vertex.Tex.y);
+  }
+  // En half la UV pierde precisión (~1/2048 cerca de 1); el borde del atlas lo absorbe.
+  for (CompactVertex& vertex : mesh.m_compactVertex) {
+    const XMFLOAT2 uv = remap(VertexCodec::halfToFloat(vertex.Tex[0]), VertexCodec::halfToFloat(vertex.Tex[1]));
+    vertex.Tex[0] = VertexCodec::floatToHalf(uv.x);
+    vertex.Tex[1] = VertexCodec::floatToHalf(uv.y);
+  }
+  return true;
+}
@@ -0,0 +1,359 @@
+﻿#include "TextureCache.h"
+#include "ImageDecoder.h"
+#include "DdsFile.h"
+#include "MappedFile.h"
+#include "FileSystem.h"
+#include "ContentHash.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace {
+  const char kMagic[4] = { 'P', 'C', 'T', 'X' };
+
+  struct TextureCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipCount;
+  };
+
+  static_assert(sizeof(TextureCacheHeader) == 32, "TextureCacheHeader layout changed");
+  static_assert(sizeof(MipLevel) == 20, "MipLevel layout changed");
+
+  std::mutex g_configMutex;                                 ///< Protege directorio y límite.
+  std::string g_directory = "Cache/Textures";
+  uint64_t g_maxSize = TextureCache::kDefaultMaxSize;
+  std::mutex g_evictMutex;                                  ///< Un solo desalojo a la vez.
+}
+
+void
+TextureCache::setDirectory(const std::string& directory) {
+  std::lock_guard<std::mutex> lock(g_configMutex);
+  g_directory = directory;
+}
+
+std::string
+TextureCache::getDirectory() {
+  std::lock_guard<std::mutex> lock(g_configMutex);
+  return g_directory;
+}
+
+void
+TextureCache::setMaxSize(uint64_t maxBytes) {
+  std::lock_guard<std::mutex> lock(g_configMutex);
+  g_maxSize = maxBytes;
+}
+
+uint64_t
+TextureCache::getMaxSize() {
+  std::lock_guard<std::mutex> lock(g_configMutex);
+  return g_maxSize;
+}
+
+std::string
+TextureCache::getCachePath(uint64_t key) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.pctex", static_cast<unsigned long long>(key));
+  return (std::filesystem::path(getDirectory()) / name).string();
+}
+
+std::string
+TextureCache::getDdsPath(uint64_t key) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.dds", static_cast<unsigned long long>(key));
+  return (std::filesystem::path(getDirectory()) / name).string();
+}
+
+uint64_t
+TextureCache::computeKey(const void* sourceData,
+                         size_t sourceSize,
+                         const std::string& importSettings) {
+  const uint64_t contentHash = ContentHash::hashBytes(sourceData, sourceSize);
+  const uint64_t settingsHash = ContentHash::hashString(importSettings, contentHash);
+  return ContentHash::hashBytes(&kVersion, sizeof(kVersion), settingsHash);
+}
+
+bool
+TextureCache::load(const std::string& cachePath, uint64_t key, MipChain& chain) {
+  // Renovar la fecha antes de proyectar: evict() desaloja primero lo menos usado.
+  // Dentro de un paquete no hay fecha que renovar y el error se ignora.
+  std::error_code ec;
+  std::filesystem::last_write_time(cachePath, std::filesystem::file_time_type::clock::now(), ec);
+
+  FileSpan file;
+  if (FAILED(FileSystem::open(cachePath, file))) {
+    return false;
+  }
+  if (file.size < sizeof(TextureCacheHeader)) {
+    ERROR("TextureCache", "load", ("Truncated cache file: " + cachePath).c_str());
+    return false;
+  }
+
+  TextureCacheHeader header;
+  std::memcpy(&header, file.data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+    MESSAGE("TextureCache", "load", ("Cache format mismatch, rebuilding: " + cachePath).c_str());
+    return false;
+  }
+  if (header.key != key) {
+    MESSAGE("TextureCache", "load", ("Cache is stale, rebuilding: " + cachePath).c_str());
+    return false;
+  }
+
+  const size_t levelBytes = static_cast<size_t>(header.mipCount) * sizeof(MipLevel);
+  if (header.mipCount == 0 || file.size < sizeof(header) + levelBytes) {
+    ERROR("TextureCache", "load", ("Truncated mip table: " + cachePath).c_str());
+    return false;
+  }
+
+  MipChain loaded;
+  loaded.format = static_cast<DXGI_FORMAT>(header.format);
+  loaded.width = header.width;
+  loaded.height = header.height;
+  loaded.levels.resize(header.mipCount);
+  std::memcpy(loaded.levels.data(), file.data + sizeof(header), levelBytes);
+
+  const size_t dataBytes = file.size - sizeof(header) - levelBytes;
+  for (const MipLevel& level : loaded.levels) {
+    if (static_cast<uint64_t>(level.offset) + level.size > dataBytes) {
+      ERROR("TextureCache", "load", ("Invalid mip range: " + cachePath).c_str());
+      return false;
+    }
+  }
+  loaded.mappedData = file.data + sizeof(header) + levelBytes;
+  loaded.mappedSize = dataBytes;
+  loaded.mapping = std::move(file.mapping);
+
+  chain = std::move(loaded);
+  return true;
+}
+
+HRESULT
+TextureCache::save(const std::string& cachePath, uint64_t key, const MipChain& chain) {
+  std::error_code ec;
+  const std::filesystem::path directory = std::filesystem::path(cachePath).parent_path();
+  if (!directory.empty()) {
+    std::filesystem::create_directories(directory, ec);
+  }
+
+  // Sufijo por hilo: dos cargas simultáneas de la misma imagen no comparten el temporal.
+  const std::string tempPath = cachePath + ".tmp" +
+    std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xFFFF);
+  {
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      ERROR("TextureCache", "save", ("Failed to create cache file: " + tempPath).c_str());
+      return E_FAIL;
+    }
+
+    TextureCacheHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.key = key;
+    header.format = static_cast<uint32_t>(chain.format);
+    header.width = chain.width;
+    header.height = chain.height;
+    header.mipCount = static_cast<uint32_t>(chain.levels.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(chain.levels.data()), chain.levels.size() * sizeof(MipLevel));
+    out.write(reinterpret_cast<const char*>(chain.getData()), chain.getDataSize());
+
+    if (!out) {
+      ERROR("TextureCache", "save", ("Failed to write cache file: " + tempPath).c_str());
+      return E_FAIL;
+    }
+  }
+
+  std::filesystem::rename(tempPath, cachePath, ec);
+  if (ec) {
+    ERROR("TextureCache", "save", ("Failed to replace cache file: " + cachePath).c_str());
+    std::filesystem::remove(tempPath, ec);
+    return E_FAIL;
+  }
+  return S_OK;
+}
+
+HRESULT
+TextureCache::loadOrBuild(const std::string& sourcePath,
+                          const TextureImportSettings& settings,
+                          MipChain& chain,
+                          std::string* error) {
+  FileSpan source;
+  if (FAILED(FileSystem::open(sourcePath, source)) || source.size == 0) {
+    if (error) *error = "can't open file";
+    return E_FAIL;
+  }
+
+  const bool compressed = settings.compression != BlockFormat::None;
+  const uint64_t key = computeKey(source.data, source.size, settings.toString());
+  const std::string cachePath = getCachePath(key);
+  const std::string ddsPath = getDdsPath(key);
+  if (compressed && DdsFile::load(ddsPath, key, chain)) {
+    return S_OK;
+  }
+  if (load(cachePath, key, chain)) {
+    return S_OK;
+  }
+
+  DecodedImage image;
+  if (FAILED(ImageDecoder::decode(source.data, source.size, sourcePath, image))) {
+    if (error) *error = image.error;
+    return E_FAIL;
+  }
+  HRESULT hr = MipGenerator::generate(image.pixels,
+                                      static_cast<uint32_t>(image.width),
+                                      static_cast<uint32_t>(image.height),
+                                      settings.mips,
+                                      chain);
+  image.release();
+  if (FAILED(hr)) {
+    if (error) *error = "mip generation failed";
+    return hr;
+  }
+
+  bool written = false;
+  if (compressed) {
+    if (chain.width % 4 != 0 || chain.height % 4 != 0) {
+      MESSAGE("TextureCache", "loadOrBuild", ("Size is not a multiple of 4, storing uncompressed: " +
+        sourcePath).c_str());
+    }
+    else {
+      MipChain blocks;
+      hr = BlockCompressor::compress(chain, settings.compression, settings.quality, blocks);
+      if (FAILED(hr)) {
+        if (error) *error = "block compression failed";
+        return hr;
+      }
+      chain = std::move(blocks);
+      std::error_code ec;
+      std::filesystem::create_directories(getDirectory(), ec);
+      if (SUCCEEDED(DdsFile::save(ddsPath, key, chain))) {
+        MESSAGE("TextureCache", "loadOrBuild", ("Wrote " + std::to_string(chain.levels.size()) +
+          " compressed mips to DDS cache: " + ddsPath).c_str());
+        written = true;
+      }
+    }
+  }
+
+  // Un fallo al escribir la caché no impide usar la textura.
+  if (!written && SUCCEEDED(save(cachePath, key, chain))) {
+    MESSAGE("TextureCache", "loadOrBuild", ("Wrote " + std::to_string(chain.levels.size()) +
+      " mips to cache: " + cachePath).c_str());
+    written = true;
+  }
+  if (written) {
+    const uint64_t maxBytes = getMaxSize();
+    if (maxBytes > 0) {
+      evict(maxBytes);
+    }
+  }
+  return S_OK;
+}
+
+uint64_t
+TextureCache::evict(uint64_t maxBytes) {
+  struct Entry {
+    std::filesystem::path path;
+    uint64_t size;
+    std::filesystem::file_time_type lastUse;
+  };
+
+  std::lock_guard<std::mutex> lock(g_evictMutex);
+  std::error_code ec;
+  std::vector<Entry> entries;
+  uint64_t totalBytes = 0;
+  for (std::filesystem::directory_iterator it(getDirectory(), ec), end; !ec && it != end; it.increment(ec)) {
+    // Cada consulta lleva su propio código: una entrada ilegible se salta sin cortar el recorrido.
+    std::error_code typeError;
+    const std::filesystem::path extension = it->path().extension();
+    if (!it->is_regular_file(typeError) || typeError || (extension != ".pctex" && extension != ".dds")) {
+      continue;
+    }
+    std::error_code sizeError;
+    std::error_code timeError;
+    Entry entry{ it->path(), it->file_size(sizeError), it->last_write_time(timeError) };
+    if (sizeError || timeError) {
+      continue;
+    }
+    totalBytes += entry.size;
+    entries.push_back(std::move(entry));
+  }
+  if (totalBytes <= maxBytes) {
+    return 0;
+  }
+
+  std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+    return a.lastUse < b.lastUse;
+  });
+  uint64_t freedBytes = 0;
+  size_t removed = 0;
+  for (const Entry& entry : entries) {
+    if (totalBytes - freedBytes <= maxBytes) {
+      break;
+    }
+    // Si la entrada está proyectada el sistema no permite borrarla; se salta.
+    std::error_code removeError;
+    if (std::filesystem::remove(entry.path, removeError) && !removeError) {
+      freedBytes += entry.size;
+      ++removed;
+    }
+  }
+  MESSAGE("TextureCache", "evict", ("Evicted " + std::to_string(removed) + " entries, " +
+    std::to_string(freedBytes / 1024) + " KiB").c_str());
+  return freedBytes;
+}
+
+HRESULT
+TextureCache::warm(const std::vector<std::string>& sourcePaths,
+                   const TextureImportSettings& settings) {
+  const auto start = std::chrono::steady_clock::now();
+  std::atomic<size_t> failed{ 0 };
+  ThreadPool::getInstance().parallelFor(sourcePaths.size(), [&](size_t i) {
+    MipChain chain;
+    std::string error;
+    if (FAILED(loadOrBuild(sourcePaths[i], settings, chain, &error))) {
+      ERROR("TextureCache", "warm", ("Failed to cache " + sourcePaths[i] + ": " + error).c_str());
+      ++failed;
+    }
+  });
+
+  const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  MESSAGE("TextureCache", "warm", (std::to_string(sourcePaths.size() - failed) + "/" +
+    std::to_string(sourcePaths.size()) + " textures cached in " + std::to_string(ms) + " ms").c_str());
+  return failed == 0 ? S_OK : E_FAIL;
+}
+
+HRESULT
+TextureCache::warmDirectory(const std::string& directory,
+                            const TextureImportSettings& settings) {
+  std::error_code ec;
+  std::vector<std::string> sourcePaths;
+  for (std::filesystem::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+    if (!it->is_regular_file(ec)) {
+      continue;
+    }
+    std::string extension = it->path().extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".png" || extension == ".jpg" || extension == ".jpeg") {
+      sourcePaths.push_back(it->path().string());
+    }
+  }
+  if (ec) {
+    ERROR("TextureCache", "warmDirectory", ("Failed to scan directory: " + directory).c_str());
+    return E_FAIL;
+  }
+  return warm(sourcePaths, settings);
+}
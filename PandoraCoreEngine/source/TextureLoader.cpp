@@ -0,0 +1,190 @@
+﻿#include "TextureLoader.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "FileSystem.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+  double
+    nowMs() {
+    return std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+}
+
+void
+AsyncTexture::render(DeviceContext& deviceContext, unsigned int startSlot, unsigned int numViews) {
+  ID3D11ShaderResourceView* srv = getShaderResourceView();
+  if (srv) {
+    deviceContext.PSSetShaderResources(startSlot, numViews, &srv);
+  }
+}
+
+HRESULT
+TextureLoader::init(Device& device, size_t frameBudget) {
+  m_frameBudget = frameBudget;
+
+  // Damero gris 4x4: se nota que falta la textura sin desentonar con la escena.
+  unsigned char pixels[4 * 4 * 4];
+  for (unsigned int y = 0; y < 4; ++y) {
+    for (unsigned int x = 0; x < 4; ++x) {
+      const unsigned char value = ((x + y) & 1) ? 96 : 160;
+      unsigned char* texel = &pixels[(y * 4 + x) * 4];
+      texel[0] = value;
+      texel[1] = value;
+      texel[2] = value;
+      texel[3] = 255;
+    }
+  }
+
+  HRESULT hr = m_placeholder.initFromPixels(device, pixels, 4, 4);
+  if (FAILED(hr)) {
+    ERROR("TextureLoader", "init", "Failed to create placeholder texture");
+    return hr;
+  }
+  return S_OK;
+}
+
+EU::TSharedPointer<AsyncTexture>
+TextureLoader::request(const std::string& textureName, ExtensionType extensionType) {
+  EU::TSharedPointer<AsyncTexture> texture = EU::MakeShared<AsyncTexture>();
+  switch (extensionType) {
+  case DDS: texture->m_texture.m_textureName = textureName + ".dds"; break;
+  case PNG: texture->m_texture.m_textureName = textureName + ".png"; break;
+  case JPG: texture->m_texture.m_textureName = textureName + ".jpg"; break;
+  default:  texture->m_texture.m_textureName = textureName; break;
+  }
+  texture->m_placeholder = m_placeholder.m_textureFromImg;
+  texture->m_requestTime = nowMs();
+
+  // El conteo de referencias de TSharedPointer no es atómico: el hilo de trabajo solo
+  // recibe el puntero crudo y m_requests mantiene viva la textura hasta destroy().
+  m_requests.push_back(texture);
+  ++m_pendingCount;
+
+  AsyncTexture* target = texture.get();
+  const std::string path = target->m_texture.m_textureName;
+  m_inFlight.push_back(ThreadPool::getInstance().enqueue([this, target, path, extensionType]() {
+    stage(target, path, extensionType);
+  }));
+  return texture;
+}
+
+void
+TextureLoader::stage(AsyncTexture* target, const std::string& path, ExtensionType extensionType) {
+  StagedTexture staged;
+  staged.target = target;
+  staged.type = extensionType;
+
+  if (extensionType == DDS) {
+    // Sin copia: el span mantiene la proyección hasta la subida.
+    if (SUCCEEDED(FileSystem::open(path, staged.file)) && staged.file.size > 0) {
+      staged.bytes = staged.file.size;
+    }
+    else {
+      staged.error = "can't open file";
+    }
+  }
+  else if (SUCCEEDED(TextureCache::loadOrBuild(path, TextureImportSettings(), staged.chain, &staged.error))) {
+    staged.bytes = staged.chain.getDataSize();
+  }
+  else if (staged.error.empty()) {
+    staged.error = "unknown error";
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_staged.push_back(std::move(staged));
+}
+
+HRESULT
+TextureLoader::upload(Device& device, StagedTexture& staged) {
+  if (!staged.error.empty()) {
+    return E_FAIL;
+  }
+
+  Texture& texture = staged.target->m_texture;
+  if (staged.type == DDS) {
+    return D3DX11CreateShaderResourceViewFromMemory(device.m_device,
+                                                    staged.file.data,
+                                                    staged.file.size,
+                                                    nullptr,
+                                                    nullptr,
+                                                    &texture.m_textureFromImg,
+                                                    nullptr);
+  }
+  return texture.initFromMips(device, staged.chain);
+}
+
+unsigned int
+TextureLoader::update(Device& device) {
+  m_lastFrameBytes = 0;
+  unsigned int completed = 0;
+
+  while (true) {
+    StagedTexture staged;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_staged.empty()) {
+        break;
+      }
+      // Al menos una por frame, aunque exceda el presupuesto por sí sola.
+      if (completed > 0 && m_lastFrameBytes + m_staged.front().bytes > m_frameBudget) {
+        break;
+      }
+      staged = std::move(m_staged.front());
+      m_staged.pop_front();
+    }
+
+    AsyncTexture* target = staged.target;
+    const std::string& name = target->m_texture.m_textureName;
+    HRESULT hr = upload(device, staged);
+    if (SUCCEEDED(hr)) {
+      target->m_state = AsyncTextureState::Ready;
+      MESSAGE("TextureLoader", "update", (name + " lista en " +
+        std::to_string(nowMs() - target->m_requestTime) + " ms").c_str());
+    }
+    else {
+      target->m_state = AsyncTextureState::Failed;
+      ERROR("TextureLoader", "update", ("Failed to load texture " + name +
+        (staged.error.empty() ? std::string() : ": " + staged.error)).c_str());
+    }
+
+    m_lastFrameBytes += staged.bytes;
+    ++completed;
+    --m_pendingCount;
+  }
+
+  // Descartar los futures de las decodificaciones que ya terminaron.
+  m_inFlight.erase(std::remove_if(m_inFlight.begin(), m_inFlight.end(),
+    [](const std::future<void>& task) {
+      return task.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }), m_inFlight.end());
+
+  return completed;
+}
+
+void
+TextureLoader::destroy() {
+  for (std::future<void>& task : m_inFlight) {
+    task.wait();
+  }
+  m_inFlight.clear();
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_staged.clear();
+  }
+
+  for (EU::TSharedPointer<AsyncTexture>& texture : m_requests) {
+    texture->m_texture.destroy();
+    texture->m_placeholder = nullptr;
+    texture->m_state = AsyncTextureState::Failed;
+  }
+  m_requests.clear();
+  m_placeholder.destroy();
+  m_pendingCount = 0;
+  m_lastFrameBytes = 0;
+}
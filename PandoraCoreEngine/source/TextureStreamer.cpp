@@ -0,0 +1,291 @@
+﻿#include "TextureStreamer.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+  /**
+   * @brief Formatos BC: D3D11 exige que el nivel 0 mida un múltiplo de 4.
+   */
+  bool
+    isBlockCompressed(DXGI_FORMAT format) {
+    return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) ||
+      (format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+  }
+
+  /**
+   * @brief Indica si @p mip puede ser el nivel 0 de una textura recreada.
+   */
+  bool
+    canStartAt(const MipChain& chain, uint32_t mip) {
+    if (!isBlockCompressed(chain.format)) {
+      return true;
+    }
+    return chain.levels[mip].width % 4 == 0 && chain.levels[mip].height % 4 == 0;
+  }
+
+  bool
+    isReady(const std::future<void>& task) {
+    return task.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+  }
+}
+
+uint64_t
+StreamedTexture::getBytesFrom(uint32_t mip) const {
+  uint64_t bytes = 0;
+  for (size_t i = mip; i < m_chain.levels.size(); ++i) {
+    bytes += m_chain.levels[i].size;
+  }
+  return bytes;
+}
+
+void
+StreamedTexture::requestScreenSize(float pixels) {
+  if (m_chain.levels.empty() || pixels <= 0.0f) {
+    return;
+  }
+  const float size = static_cast<float>((std::max)(m_chain.width, m_chain.height));
+  const float level = std::floor(std::log2((std::max)(size / pixels, 1.0f)));
+  requestMip((std::min)(static_cast<uint32_t>(level), getMipCount() - 1));
+}
+
+void
+StreamedTexture::render(DeviceContext& deviceContext, unsigned int startSlot, unsigned int numViews) {
+  ID3D11ShaderResourceView* srv = getShaderResourceView();
+  if (srv) {
+    deviceContext.PSSetShaderResources(startSlot, numViews, &srv);
+  }
+}
+
+HRESULT
+TextureStreamer::init(Device& device, uint64_t budget, uint64_t frameUploadBudget) {
+  m_budget = budget;
+  m_frameUploadBudget = frameUploadBudget;
+
+  const unsigned char grey[4] = { 128, 128, 128, 255 };
+  HRESULT hr = m_placeholder.initFromPixels(device, grey, 1, 1);
+  if (FAILED(hr)) {
+    ERROR("TextureStreamer", "init", "Failed to create placeholder texture");
+    return hr;
+  }
+  return S_OK;
+}
+
+EU::TSharedPointer<StreamedTexture>
+TextureStreamer::request(const std::string& textureName, ExtensionType extensionType) {
+  EU::TSharedPointer<StreamedTexture> texture = EU::MakeShared<StreamedTexture>();
+  texture->m_placeholder = m_placeholder.m_textureFromImg;
+  m_textures.push_back(texture);
+
+  if (extensionType != PNG && extensionType != JPG) {
+    texture->m_texture.m_textureName = textureName;
+    texture->m_failed = true;
+    ERROR("TextureStreamer", "request", ("Only PNG and JPG textures can be streamed: " + textureName).c_str());
+    return texture;
+  }
+  texture->m_texture.m_textureName = textureName + ((extensionType == PNG) ? ".png" : ".jpg");
+
+  // Igual que en TextureLoader: el hilo de trabajo solo recibe el puntero crudo y
+  // m_textures mantiene viva la textura hasta destroy().
+  StreamedTexture* target = texture.get();
+  const std::string path = target->m_texture.m_textureName;
+  target->m_load = ThreadPool::getInstance().enqueue([target, path]() {
+    return TextureCache::loadOrBuild(path, TextureImportSettings(), target->m_chain, &target->m_error);
+  });
+  return texture;
+}
+
+HRESULT
+TextureStreamer::finishLoad(Device& device, StreamedTexture& texture) {
+  HRESULT hr = texture.m_load.get();
+  if (FAILED(hr)) {
+    texture.m_failed = true;
+    ERROR("TextureStreamer", "update", ("Failed to load texture " + texture.getName() + ": " +
+      texture.m_error).c_str());
+    return hr;
+  }
+
+  const MipChain& chain = texture.m_chain;
+  const uint32_t mipCount = texture.getMipCount();
+  uint32_t initialMip = 0;
+  while (initialMip + 1 < mipCount &&
+         (std::max)(chain.levels[initialMip].width, chain.levels[initialMip].height) > kInitialResolution) {
+    ++initialMip;
+  }
+  while (initialMip > 0 && !canStartAt(chain, initialMip)) {
+    --initialMip;
+  }
+
+  texture.m_initialMip = initialMip;
+  texture.m_residentMip = mipCount;
+  texture.m_wantedMip = initialMip;
+  texture.m_targetMip = initialMip;
+  texture.m_wantedFrame = m_frame;
+  return makeResident(device, texture, initialMip);
+}
+
+HRESULT
+TextureStreamer::makeResident(Device& device, StreamedTexture& texture, uint32_t mip) {
+  Texture resident;
+  resident.m_textureName = texture.m_texture.m_textureName;
+  HRESULT hr = resident.initFromMips(device, texture.m_chain, mip);
+  if (FAILED(hr)) {
+    ERROR("TextureStreamer", "makeResident", ("Failed to stream mip " + std::to_string(mip) + " of " +
+      texture.getName()).c_str());
+    return hr;
+  }
+  texture.m_texture.destroy();
+  texture.m_texture = resident;
+  texture.m_residentMip = mip;
+  return S_OK;
+}
+
+void
+TextureStreamer::updateWantedMip(StreamedTexture& texture) {
+  const uint32_t requested = (texture.m_requestedMip == StreamedTexture::kNoRequest) ?
+    texture.m_initialMip : (std::min)(texture.m_requestedMip, texture.m_initialMip);
+  texture.m_requestedMip = StreamedTexture::kNoRequest;
+
+  // Más detalle: de inmediato. Menos detalle: solo si no se ha pedido más en kDropDelayFrames.
+  if (requested <= texture.m_wantedMip || m_frame - texture.m_wantedFrame >= kDropDelayFrames) {
+    texture.m_wantedMip = requested;
+    texture.m_wantedFrame = m_frame;
+  }
+  while (texture.m_wantedMip > 0 && !canStartAt(texture.m_chain, texture.m_wantedMip)) {
+    --texture.m_wantedMip;
+  }
+}
+
+void
+TextureStreamer::applyBudget() {
+  uint64_t total = 0;
+  for (EU::TSharedPointer<StreamedTexture>& texture : m_textures) {
+    if (texture->isLoaded()) {
+      texture->m_targetMip = texture->m_wantedMip;
+      total += texture->getBytesFrom(texture->m_targetMip);
+    }
+  }
+
+  // Quitar un nivel a la vez a la textura cuyo nivel superior ocupa más.
+  while (total > m_budget) {
+    StreamedTexture* largest = nullptr;
+    uint32_t largestSize = 0;
+    for (EU::TSharedPointer<StreamedTexture>& texture : m_textures) {
+      if (!texture->isLoaded() || texture->m_targetMip >= texture->m_initialMip) {
+        continue;
+      }
+      const uint32_t size = texture->m_chain.levels[texture->m_targetMip].size;
+      if (size > largestSize) {
+        largest = texture.get();
+        largestSize = size;
+      }
+    }
+    if (!largest) {
+      break; // Solo quedan los niveles iniciales, que no se descartan.
+    }
+
+    const uint64_t before = largest->getBytesFrom(largest->m_targetMip);
+    do {
+      ++largest->m_targetMip;
+    } while (largest->m_targetMip < largest->m_initialMip &&
+             !canStartAt(largest->m_chain, largest->m_targetMip));
+    total -= before - largest->getBytesFrom(largest->m_targetMip);
+  }
+}
+
+void
+TextureStreamer::update(Device& device) {
+  m_stats = TextureStreamingStats();
+  m_stats.budgetBytes = m_budget;
+  m_stats.textures = static_cast<uint32_t>(m_textures.size());
+
+  for (EU::TSharedPointer<StreamedTexture>& texture : m_textures) {
+    if (texture->m_load.valid() &&
+        texture->m_load.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+      finishLoad(device, *texture);
+    }
+    if (texture->m_load.valid()) {
+      ++m_stats.loading;
+    }
+    else if (texture->isLoaded()) {
+      updateWantedMip(*texture);
+    }
+  }
+
+  applyBudget();
+
+  uint64_t uploadedBytes = 0;
+  for (EU::TSharedPointer<StreamedTexture>& texture : m_textures) {
+    if (!texture->isLoaded()) {
+      continue;
+    }
+    const uint32_t target = texture->m_targetMip;
+    const uint32_t resident = texture->m_residentMip;
+
+    if (target > resident) {
+      // Bajar de detalle libera memoria: sin esperar ni contar contra la subida.
+      if (SUCCEEDED(makeResident(device, *texture, target))) {
+        ++m_stats.drops;
+      }
+    }
+    else if (target < resident) {
+      // Leer antes en un hilo de trabajo las páginas de la caché que se van a subir, para
+      // que los fallos de página no ocurran al crear la textura en este hilo.
+      if (!texture->m_prefetch.valid() || (isReady(texture->m_prefetch) && texture->m_prefetchMip > target)) {
+        const MipChain& chain = texture->m_chain;
+        const uint8_t* begin = chain.getLevelData(target);
+        const uint8_t* end = chain.getLevelData(resident - 1) + chain.levels[resident - 1].size;
+        texture->m_prefetchMip = target;
+        texture->m_prefetch = ThreadPool::getInstance().enqueue([begin, end]() {
+          volatile uint8_t sink = 0;
+          for (const uint8_t* page = begin; page < end; page += 4096) {
+            sink = sink + *page;
+          }
+        });
+      }
+      if (!isReady(texture->m_prefetch) || texture->m_prefetchMip > target) {
+        continue;
+      }
+
+      // Al menos una por frame, aunque exceda el presupuesto por sí sola.
+      const uint64_t bytes = texture->getBytesFrom(target);
+      if (m_stats.uploads > 0 && uploadedBytes + bytes > m_frameUploadBudget) {
+        continue;
+      }
+      if (SUCCEEDED(makeResident(device, *texture, target))) {
+        uploadedBytes += bytes;
+        ++m_stats.uploads;
+      }
+    }
+  }
+
+  for (EU::TSharedPointer<StreamedTexture>& texture : m_textures) {
+    if (texture->isLoaded()) {
+      m_stats.residentBytes += texture->getBytesFrom(texture->m_residentMip);
+      m_stats.wantedBytes += texture->getBytesFrom(texture->m_wantedMip);
+    }
+  }
+  ++m_frame;
+}
+
+void
+TextureStreamer::destroy() {
+  for (EU::TSharedPointer<StreamedTexture>& texture : m_textures) {
+    if (texture->m_load.valid()) {
+      texture->m_load.wait();
+    }
+    if (texture->m_prefetch.valid()) {
+      texture->m_prefetch.wait();
+    }
+    texture->m_texture.destroy();
+    texture->m_placeholder = nullptr;
+    texture->m_chain = MipChain();
+  }
+  m_textures.clear();
+  m_placeholder.destroy();
+  m_stats = TextureStreamingStats();
+}
@@ -0,0 +1,127 @@
+﻿#include "ThreadPool.h"
+
+ThreadPool&
+ThreadPool::getInstance() {
+  // Deja un núcleo libre para el hilo principal (render y mensajes).
+  static ThreadPool instance((std::max)(2u, std::thread::hardware_concurrency()) - 1);
+  return instance;
+}
+
+HRESULT
+ThreadPool::init(unsigned int threadCount) {
+  destroy();
+
+  if (threadCount == 0) {
+    threadCount = (std::max)(1u, std::thread::hardware_concurrency());
+  }
+
+  m_stopping = false;
+  m_workers.reserve(threadCount);
+  for (unsigned int i = 0; i < threadCount; ++i) {
+    m_workers.emplace_back(&ThreadPool::workerLoop, this);
+  }
+
+  MESSAGE("ThreadPool", "init", ("Worker threads: " + std::to_string(threadCount)).c_str());
+  return S_OK;
+}
+
+void
+ThreadPool::destroy() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_condition.notify_all();
+
+  for (auto& worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  m_workers.clear();
+}
+
+void
+ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+  if (count == 0) {
+    return;
+  }
+  if (count == 1 || m_workers.empty()) {
+    for (size_t i = 0; i < count; ++i) {
+      body(i);
+    }
+    return;
+  }
+
+  // Estado compartido: los ayudantes que arranquen tarde simplemente no
+  // encuentran iteraciones libres y terminan.
+  struct ForState {
+    std::atomic<size_t> next{ 0 };
+    std::atomic<size_t> done{ 0 };
+    std::atomic<bool> failed{ false };
+    std::exception_ptr error;  ///< Primera excepción de body; protegida por @c mutex.
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::function<void(size_t)> body;
+  };
+  auto state = std::make_shared<ForState>();
+  state->body = body;
+
+  // Una excepción no sale de work(): en un hilo del pool llamaría a std::terminate y en el
+  // llamador dejaría a los ayudantes usando un body que captura locales ya destruidos.
+  // Tras la primera, las iteraciones restantes se cuentan sin ejecutarse.
+  auto work = [state, count]() {
+    for (size_t i = state->next++; i < count; i = state->next++) {
+      if (!state->failed) {
+        try {
+          state->body(i);
+        }
+        catch (...) {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          if (!state->error) {
+            state->error = std::current_exception();
+          }
+          state->failed = true;
+        }
+      }
+      if (++state->done == count) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->finished.notify_all();
+      }
+    }
+  };
+
+  const size_t helpers = (std::min)(count - 1, m_workers.size());
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < helpers; ++i) {
+      m_tasks.emplace(work);
+    }
+  }
+  m_condition.notify_all();
+
+  work();
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->finished.wait(lock, [&]() { return state->done.load() == count; });
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
+
+void
+ThreadPool::workerLoop() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+      if (m_stopping && m_tasks.empty()) {
+        return;
+      }
+      task = std::move(m_tasks.front());
+      m_tasks.pop();
+    }
+    task();
+  }
+}
@@ -0,0 +1,227 @@
+#include "VertexCodec.h"
+#include "MeshComponent.h"
+#include <cmath>
+
+namespace {
+  inline int16_t
+  toSnorm16(float value) {
+    const float clamped = (std::max)(-1.0f, (std::min)(1.0f, value));
+    return static_cast<int16_t>(std::lround(clamped * 32767.0f));
+  }
+
+  // Misma regla que aplica D3D al leer SNORM: -32768 y -32767 equivalen a -1.
+  inline float
+  fromSnorm16(int16_t value) {
+    return (std::max)(-1.0f, value / 32767.0f);
+  }
+
+  inline float
+  distance3(const XMFLOAT3& a, const XMFLOAT3& b) {
+    const float dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+  }
+
+  inline float
+  distance2(const XMFLOAT2& a, const XMFLOAT2& b) {
+    const float dx = a.x - b.x, dy = a.y - b.y;
+    return std::sqrt(dx * dx + dy * dy);
+  }
+}
+
+uint16_t
+VertexCodec::floatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  const uint32_t sign = (bits >> 16) & 0x8000u;
+  const uint32_t exponent = (bits >> 23) & 0xFFu;
+  uint32_t mantissa = bits & 0x7FFFFFu;
+
+  if (exponent == 0xFFu) {
+    // Inf o NaN (se conserva un bit de mantisa para que NaN siga siendo NaN).
+    return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+  }
+
+  const int halfExponent = static_cast<int>(exponent) - 127 + 15;
+  if (halfExponent >= 31) {
+    return static_cast<uint16_t>(sign | 0x7C00u);
+  }
+
+  if (halfExponent <= 0) {
+    // Subnormal en half (o cero).
+    if (halfExponent < -10) {
+      return static_cast<uint16_t>(sign);
+    }
+    mantissa |= 0x800000u;
+    const uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+    uint32_t halfMantissa = mantissa >> shift;
+    const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (halfMantissa & 1u))) {
+      ++halfMantissa;
+    }
+    return static_cast<uint16_t>(sign | halfMantissa);
+  }
+
+  uint32_t half = sign | (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+  const uint32_t remainder = mantissa & 0x1FFFu;
+  if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+    // El acarreo puede subir el exponente; llega a Inf de forma correcta.
+    ++half;
+  }
+  return static_cast<uint16_t>(half);
+}
+
+float
+VertexCodec::halfToFloat(uint16_t value) {
+  const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+  uint32_t exponent = (value >> 10) & 0x1Fu;
+  uint32_t mantissa = value & 0x3FFu;
+
+  uint32_t bits;
+  if (exponent == 0) {
+    if (mantissa == 0) {
+      bits = sign;
+    }
+    else {
+      // Normaliza el subnormal.
+      exponent = 127 - 15 + 1;
+      while ((mantissa & 0x400u) == 0) {
+        mantissa <<= 1;
+        --exponent;
+      }
+      mantissa &= 0x3FFu;
+      bits = sign | (exponent << 23) | (mantissa << 13);
+    }
+  }
+  else if (exponent == 0x1Fu) {
+    bits = sign | 0x7F800000u | (mantissa << 13);
+  }
+  else {
+    bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+  }
+
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+CBVertexDequant
+VertexCodec::computeDequant(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax) {
+  auto halfExtent = [](float lo, float hi) {
+    const float extent = (hi - lo) * 0.5f;
+    return extent > 0.0f ? extent : 1.0f;
+  };
+
+  CBVertexDequant dequant;
+  dequant.vPosScale = XMFLOAT4(halfExtent(boundsMin.x, boundsMax.x),
+                               halfExtent(boundsMin.y, boundsMax.y),
+                               halfExtent(boundsMin.z, boundsMax.z),
+                               0.0f);
+  dequant.vPosBias = XMFLOAT4((boundsMin.x + boundsMax.x) * 0.5f,
+                              (boundsMin.y + boundsMax.y) * 0.5f,
+                              (boundsMin.z + boundsMax.z) * 0.5f,
+                              1.0f);
+  return dequant;
+}
+
+CompactVertex
+VertexCodec::encode(const SimpleVertex& vertex, const CBVertexDequant& dequant) {
+  CompactVertex out;
+  out.Pos[0] = toSnorm16((vertex.Pos.x - dequant.vPosBias.x) / dequant.vPosScale.x);
+  out.Pos[1] = toSnorm16((vertex.Pos.y - dequant.vPosBias.y) / dequant.vPosScale.y);
+  out.Pos[2] = toSnorm16((vertex.Pos.z - dequant.vPosBias.z) / dequant.vPosScale.z);
+  out.Pos[3] = 0;
+  out.Tex[0] = floatToHalf(vertex.Tex.x);
+  out.Tex[1] = floatToHalf(vertex.Tex.y);
+  return out;
+}
+
+SimpleVertex
+VertexCodec::decode(const CompactVertex& vertex, const CBVertexDequant& dequant) {
+  SimpleVertex out;
+  out.Pos = XMFLOAT3(fromSnorm16(vertex.Pos[0]) * dequant.vPosScale.x + dequant.vPosBias.x,
+                     fromSnorm16(vertex.Pos[1]) * dequant.vPosScale.y + dequant.vPosBias.y,
+                     fromSnorm16(vertex.Pos[2]) * dequant.vPosScale.z + dequant.vPosBias.z);
+  out.Tex = XMFLOAT2(halfToFloat(vertex.Tex[0]), halfToFloat(vertex.Tex[1]));
+  return out;
+}
+
+void
+VertexCodec::encode(const std::vector<SimpleVertex>& vertices,
+                    const CBVertexDequant& dequant,
+                    std::vector<CompactVertex>& out) {
+  out.resize(vertices.size());
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    out[i] = encode(vertices[i], dequant);
+  }
+}
+
+VertexCodecError
+VertexCodec::measureError(const std::vector<SimpleVertex>& original,
+                          const std::vector<CompactVertex>& encoded,
+                          const CBVertexDequant& dequant) {
+  VertexCodecError error;
+  const size_t count = (std::min)(original.size(), encoded.size());
+  if (count == 0) {
+    return error;
+  }
+
+  double sumPosition = 0.0;
+  double sumTexcoord = 0.0;
+  for (size_t i = 0; i < count; ++i) {
+    const SimpleVertex decoded = decode(encoded[i], dequant);
+    const float dp = distance3(original[i].Pos, decoded.Pos);
+    const float dt = distance2(original[i].Tex, decoded.Tex);
+    error.maxPosition = (std::max)(error.maxPosition, dp);
+    error.maxTexcoord = (std::max)(error.maxTexcoord, dt);
+    sumPosition += static_cast<double>(dp) * dp;
+    sumTexcoord += static_cast<double>(dt) * dt;
+  }
+  error.rmsPosition = static_cast<float>(std::sqrt(sumPosition / count));
+  error.rmsTexcoord = static_cast<float>(std::sqrt(sumTexcoord / count));
+  return error;
+}
+
+VertexCodecError
+VertexCodec::encodeMesh(MeshComponent& mesh, bool keepSource) {
+  mesh.m_dequant = computeDequant(mesh.m_boundsMin, mesh.m_boundsMax);
+  encode(mesh.m_vertex, mesh.m_dequant, mesh.m_compactVertex);
+
+  const VertexCodecError error = measureError(mesh.m_vertex, mesh.m_compactVertex, mesh.m_dequant);
+  MESSAGE("VertexCodec", "encodeMesh", (mesh.m_name +
+    " bytes " + std::to_string(mesh.m_vertex.size() * sizeof(SimpleVertex)) +
+    " -> " + std::to_string(mesh.m_compactVertex.size() * sizeof(CompactVertex)) +
+    ", pos err max " + std::to_string(error.maxPosition) +
+    " rms " + std::to_string(error.rmsPosition) +
+    ", uv err max " + std::to_string(error.maxTexcoord) +
+    " rms " + std::to_string(error.rmsTexcoord)).c_str());
+
+  if (!keepSource) {
+    std::vector<SimpleVertex>().swap(mesh.m_vertex);
+  }
+  return error;
+}
+
+std::vector<D3D11_INPUT_ELEMENT_DESC>
+VertexCodec::getInputLayout() {
+  std::vector<D3D11_INPUT_ELEMENT_DESC> layout(2);
+
+  layout[0].SemanticName = "POSITION";
+  layout[0].SemanticIndex = 0;
+  layout[0].Format = DXGI_FORMAT_R16G16B16A16_SNORM;
+  layout[0].InputSlot = 0;
+  layout[0].AlignedByteOffset = 0;
+  layout[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+  layout[0].InstanceDataStepRate = 0;
+
+  layout[1].SemanticName = "TEXCOORD";
+  layout[1].SemanticIndex = 0;
+  layout[1].Format = DXGI_FORMAT_R16G16_FLOAT;
+  layout[1].InputSlot = 0;
+  layout[1].AlignedByteOffset = offsetof(CompactVertex, Tex);
+  layout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+  layout[1].InstanceDataStepRate = 0;
+
+  return layout;
+}